@@ -105,6 +105,8 @@ idCommon *			common = &commonLocal;
 
 void			Sys_Mkdir( const char *path ) {}
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp ) { return 0; }
+void *			Sys_MapFile( FILE *fp, int offset, int length, sysFileMapping_t &mapping ) { return NULL; }
+void			Sys_UnmapFile( sysFileMapping_t &mapping ) {}
 
 #ifdef _WIN32
 
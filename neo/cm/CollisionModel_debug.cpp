@@ -93,6 +93,7 @@ idCVar cm_drawInternal(		"cm_drawInternal",		"1",		CVAR_GAME | CVAR_BOOL,	"draw
 idCVar cm_drawNormals(		"cm_drawNormals",		"0",		CVAR_GAME | CVAR_BOOL,	"draw polygon and edge normals" );
 idCVar cm_backFaceCull(		"cm_backFaceCull",		"0",		CVAR_GAME | CVAR_BOOL,	"cull back facing polygons" );
 idCVar cm_debugCollision(	"cm_debugCollision",	"0",		CVAR_GAME | CVAR_BOOL,	"debug the collision detection" );
+idCVar cm_simdEdgeTests(	"cm_simdEdgeTests",		"1",		CVAR_GAME | CVAR_BOOL,	"test trace model edges and vertices against several polygon edges at once" );
 
 static idVec4 cm_color;
 
@@ -350,6 +351,7 @@ static idCVar cm_testWalk(			"cm_testWalk",			"1",					CVAR_GAME | CVAR_BOOL,		"
 static idCVar cm_testLength(		"cm_testLength",		"1024",					CVAR_GAME | CVAR_FLOAT,		"" );
 static idCVar cm_testRadius(		"cm_testRadius",		"64",					CVAR_GAME | CVAR_FLOAT,		"" );
 static idCVar cm_testAngle(			"cm_testAngle",			"60",					CVAR_GAME | CVAR_FLOAT,		"" );
+static idCVar cm_testSIMD(			"cm_testSIMD",			"0",					CVAR_GAME | CVAR_BOOL,		"verify the SIMD edge tests give the same trace results as the scalar edge tests" );
 
 static int total_translation;
 static int min_translation = 999999;
@@ -364,6 +366,80 @@ static idVec3 *testend;
 
 #include "../sys/sys_public.h"
 
+/*
+================
+CM_SameTrace
+================
+*/
+static bool CM_SameTrace( const trace_t &t1, const trace_t &t2 ) {
+	if ( t1.fraction != t2.fraction || !t1.endpos.Compare( t2.endpos ) ) {
+		return false;
+	}
+	if ( t1.fraction == 1.0f ) {
+		return true;
+	}
+	return ( t1.c.type == t2.c.type && t1.c.normal.Compare( t2.c.normal ) && t1.c.dist == t2.c.dist &&
+				t1.c.modelFeature == t2.c.modelFeature && t1.c.trmFeature == t2.c.trmFeature );
+}
+
+/*
+================
+idCollisionModelManagerLocal::TestSIMD
+
+  runs the test traces with the scalar and with the SIMD edge tests and compares the results
+================
+*/
+void idCollisionModelManagerLocal::TestSIMD( const idTraceModel &itm, const idMat3 &boxAxis, const idRotation *rotation ) {
+	int i, j, numFailed, t[2];
+	bool simdEdgeTests;
+	trace_t *traces[2];
+	idMat3 modelAxis;
+	idTimer timer;
+
+	modelAxis.Identity();
+	simdEdgeTests = cm_simdEdgeTests.GetBool();
+
+	traces[0] = (trace_t *) Mem_Alloc( cm_testTimes.GetInteger() * sizeof( trace_t ) );
+	traces[1] = (trace_t *) Mem_Alloc( cm_testTimes.GetInteger() * sizeof( trace_t ) );
+
+	for ( j = 0; j < 2; j++ ) {
+		cm_simdEdgeTests.SetBool( j != 0 );
+		timer.Clear();
+		timer.Start();
+		for ( i = 0; i < cm_testTimes.GetInteger(); i++ ) {
+			if ( rotation ) {
+				idRotation r = *rotation;
+				r.SetOrigin( testend[i] );
+				Rotation( &traces[j][i], start, r, &itm, boxAxis, CONTENTS_SOLID|CONTENTS_PLAYERCLIP, cm_testModel.GetInteger(), vec3_origin, modelAxis );
+			} else {
+				Translation( &traces[j][i], start, testend[i], &itm, boxAxis, CONTENTS_SOLID|CONTENTS_PLAYERCLIP, cm_testModel.GetInteger(), vec3_origin, modelAxis );
+			}
+		}
+		timer.Stop();
+		t[j] = timer.Milliseconds();
+	}
+
+	cm_simdEdgeTests.SetBool( simdEdgeTests );
+
+	numFailed = 0;
+	for ( i = 0; i < cm_testTimes.GetInteger(); i++ ) {
+		if ( !CM_SameTrace( traces[0][i], traces[1][i] ) ) {
+			if ( numFailed < 8 ) {
+				common->Printf( "trace %d: scalar fraction %1.9f normal (%s) simd fraction %1.9f normal (%s)\n", i,
+								traces[0][i].fraction, traces[0][i].c.normal.ToString( 6 ),
+								traces[1][i].fraction, traces[1][i].c.normal.ToString( 6 ) );
+			}
+			numFailed++;
+		}
+	}
+
+	common->Printf( "%s SIMD edge tests: %d of %d traces differ, scalar %d msec, simd %d msec\n",
+					rotation ? "rotation" : "translation", numFailed, cm_testTimes.GetInteger(), t[0], t[1] );
+
+	Mem_Free( traces[0] );
+	Mem_Free( traces[1] );
+}
+
 void idCollisionModelManagerLocal::DebugOutput( const idVec3 &origin ) {
 	int i, k, t;
 	char buf[128];
@@ -421,6 +497,10 @@ void idCollisionModelManagerLocal::DebugOutput( const idVec3 &origin ) {
 		}
 	}
 
+	if ( cm_testSIMD.GetBool() ) {
+		TestSIMD( itm, boxAxis, NULL );
+	}
+
 	// translational collision detection
 	timer.Clear();
 	timer.Start();
@@ -463,6 +543,10 @@ void idCollisionModelManagerLocal::DebugOutput( const idVec3 &origin ) {
 		vec.Normalize();
 		idRotation rotation( vec3_origin, vec, cm_testAngle.GetFloat() );
 
+		if ( cm_testSIMD.GetBool() ) {
+			TestSIMD( itm, boxAxis, &rotation );
+		}
+
 		timer.Clear();
 		timer.Start();
 		for ( i = 0; i < cm_testTimes.GetInteger(); i++ ) {
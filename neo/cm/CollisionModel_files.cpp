@@ -43,6 +43,196 @@ If you have questions concerning this license or the applicable additional terms
 #define CM_FILEID			"CM"
 #define CM_FILEVERSION		"1.00"
 
+/*
+
+Binary collision model files
+
+After a .cm file has been parsed, the models are also written to a .cmb file in the save
+path.  Later loads memory map the .cmb file if it was written from a .cm file with the same
+timestamp and length, and the vertex and edge arrays are used straight from the mapping.
+The mapping is private, so the trace code can still write the check counts and sidedness
+bits of the vertexes and edges.  Everything else is stored with indexes instead of pointers,
+and the tree, polygons, brushes and references of a model are rebuilt in a few allocations
+of exactly the right size instead of being filtered into the tree one by one.
+
+Everything is stored in the native byte order and structure layout, the header makes sure
+a file written by a different build is written again instead of being used.
+
+*/
+
+#define CM_BINARYFILE_EXT	"cmb"
+
+const int CMB_IDENT				= ( 'L' << 24 ) + ( 'B' << 16 ) + ( 'M' << 8 ) + 'C';
+const int CMB_VERSION			= 1;
+
+idCVar cm_useBinaryModels( "cm_useBinaryModels", "1", CVAR_GAME | CVAR_BOOL, "load collision models from memory mapped .cmb files when they are up to date" );
+
+typedef struct {
+	int						ident;
+	int						version;
+	int						vertexSize;			// sizeof( cm_vertex_t ), vertexes are stored as they are in memory
+	int						edgeSize;			// sizeof( cm_edge_t ), edges are stored as they are in memory
+	unsigned int			mapFileCRC;
+	int						sourceTimeStamp;	// of the .cm file it was written from
+	int						sourceLength;
+	int						numModels;
+} cmbHeader_t;
+
+typedef struct {
+	idBounds				bounds;
+	int						contents;
+	int						isConvex;
+	int						numInternalEdges;
+	int						numSharpEdges;
+	int						numMaterials;
+	int						numVertices;
+	int						numEdges;
+	int						numNodes;
+	int						numPolygons;
+	int						numPolygonEdges;
+	int						numBrushes;
+	int						numBrushPlanes;
+	int						numPolygonRefs;
+	int						numBrushRefs;
+} cmbModel_t;
+
+typedef struct {
+	int						planeType;
+	float					planeDist;
+	int						numPolygonRefs;		// references are stored in tree order
+	int						numBrushRefs;
+} cmbNode_t;
+
+typedef struct {
+	idBounds				bounds;
+	idPlane					plane;
+	int						material;			// index into the model material names
+	int						numEdges;
+	int						firstEdge;			// index into the polygon edge list
+} cmbPolygon_t;
+
+typedef struct {
+	idBounds				bounds;
+	int						contents;
+	int						primitiveNum;
+	int						numPlanes;
+	int						firstPlane;			// index into the brush plane list
+} cmbBrush_t;
+
+typedef struct cmbCursor_s {
+	byte *					data;
+	int						length;
+	int						offset;
+	bool					error;				// set when anything would be read past the end or is out of range
+	const cmbNode_t *		nodes;
+	int						numNodes;
+	int						nextNode;
+	const int *				polygonRefs;
+	int						nextPolygonRef;
+	int						numPolygonRefs;
+	const int *				brushRefs;
+	int						nextBrushRef;
+	int						numBrushRefs;
+	cm_polygon_t **			polygons;
+	int						numPolygons;
+	cm_brush_t **			brushes;
+	int						numBrushes;
+	cm_node_t *				nodeMemory;			// all nodes of the model in tree order
+	cm_polygonRef_t *		polygonRefMemory;	// all polygon references of the model in tree order
+	cm_brushRef_t *			brushRefMemory;		// all brush references of the model in tree order
+} cmbCursor_t;
+
+/*
+================
+CM_AlignBinary
+================
+*/
+static void CM_AlignBinary( idFile *f, int alignment ) {
+	static const byte pad[16] = { 0 };
+	int remainder = f->Length() & ( alignment - 1 );
+	if ( remainder ) {
+		f->Write( pad, alignment - remainder );
+	}
+}
+
+/*
+================
+CM_WriteBinaryInt
+================
+*/
+static void CM_WriteBinaryInt( idFile *f, int value ) {
+	f->Write( &value, sizeof( value ) );
+}
+
+/*
+================
+CM_WriteBinaryString
+================
+*/
+static void CM_WriteBinaryString( idFile *f, const char *string ) {
+	int length = strlen( string ) + 1;
+	CM_WriteBinaryInt( f, length );
+	f->Write( string, length );
+	CM_AlignBinary( f, 4 );
+}
+
+/*
+================
+CM_WriteBinaryArray
+================
+*/
+static void CM_WriteBinaryArray( idFile *f, const void *data, int count, int elementSize ) {
+	CM_AlignBinary( f, 4 );
+	f->Write( data, count * elementSize );
+}
+
+/*
+================
+CM_ReadBinaryArray
+
+Returns a pointer into the file data, or NULL and sets the error flag
+================
+*/
+static const void *CM_ReadBinaryArray( cmbCursor_t &cursor, int count, int elementSize, int alignment = 4 ) {
+	if ( cursor.error || count < 0 || count > ( cursor.length - cursor.offset ) / elementSize ) {
+		cursor.error = true;
+		return NULL;
+	}
+	int offset = ( cursor.offset + alignment - 1 ) & ~( alignment - 1 );
+	int size = count * elementSize;
+	if ( offset + size > cursor.length ) {
+		cursor.error = true;
+		return NULL;
+	}
+	cursor.offset = offset + size;
+	return cursor.data + offset;
+}
+
+/*
+================
+CM_ReadBinaryInt
+================
+*/
+static int CM_ReadBinaryInt( cmbCursor_t &cursor ) {
+	const int *value = (const int *)CM_ReadBinaryArray( cursor, 1, sizeof( int ) );
+	return value ? *value : 0;
+}
+
+/*
+================
+CM_ReadBinaryString
+================
+*/
+static const char *CM_ReadBinaryString( cmbCursor_t &cursor ) {
+	int length = CM_ReadBinaryInt( cursor );
+	const char *string = (const char *)CM_ReadBinaryArray( cursor, length, 1 );
+	if ( string == NULL || length < 1 || string[length - 1] != '\0' ) {
+		cursor.error = true;
+		return "";
+	}
+	return string;
+}
+
 
 /*
 ===============================================================================
@@ -305,6 +495,203 @@ bool idCollisionModelManagerLocal::WriteCollisionModelForMapEntity( const idMapE
 	return true;
 }
 
+/*
+================
+CM_BinaryIndex
+
+Returns the index of the pointer in the list, appending it when it is not in the list yet.
+================
+*/
+template< class type >
+static int CM_BinaryIndex( type *ptr, idList<type *> &list, idHashIndex &hash ) {
+	int i, key;
+
+	key = hash.GenerateKey( (int)( (intptr_t)ptr >> 4 ), 0 );
+	for ( i = hash.First( key ); i != -1; i = hash.Next( i ) ) {
+		if ( list[i] == ptr ) {
+			return i;
+		}
+	}
+	i = list.Append( ptr );
+	hash.Add( key, i );
+	return i;
+}
+
+/*
+================
+CM_CollectBinaryNodes_r
+
+Gathers the nodes in tree order with their references, and every polygon and brush once.
+================
+*/
+static void CM_CollectBinaryNodes_r( cm_node_t *node, idList<cmbNode_t> &nodes,
+									idList<cm_polygon_t *> &polygons, idHashIndex &polygonHash, idList<int> &polygonRefs,
+									idList<cm_brush_t *> &brushes, idHashIndex &brushHash, idList<int> &brushRefs ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	cmbNode_t n;
+
+	n.planeType = node->planeType;
+	n.planeDist = node->planeDist;
+	n.numPolygonRefs = 0;
+	n.numBrushRefs = 0;
+
+	// polygon and brush references freed by polygon merging are left out
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		if ( pref->p ) {
+			polygonRefs.Append( CM_BinaryIndex( pref->p, polygons, polygonHash ) );
+			n.numPolygonRefs++;
+		}
+	}
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		if ( bref->b ) {
+			brushRefs.Append( CM_BinaryIndex( bref->b, brushes, brushHash ) );
+			n.numBrushRefs++;
+		}
+	}
+	nodes.Append( n );
+
+	if ( node->planeType != -1 ) {
+		CM_CollectBinaryNodes_r( node->children[0], nodes, polygons, polygonHash, polygonRefs, brushes, brushHash, brushRefs );
+		CM_CollectBinaryNodes_r( node->children[1], nodes, polygons, polygonHash, polygonRefs, brushes, brushHash, brushRefs );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	idList<cmbNode_t> nodes;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idList<int> polygonRefs, brushRefs, polygonEdges;
+	idList<idPlane> brushPlanes;
+	idList<cmbPolygon_t> binaryPolygons;
+	idList<cmbBrush_t> binaryBrushes;
+	idList<const idMaterial *> materials;
+	idHashIndex polygonHash, brushHash, materialHash;
+	cmbModel_t header;
+	int i, j;
+
+	polygonHash.Clear( idMath::CeilPowerOfTwo( Max( model->numPolygons, 1024 ) ), 1024 );
+	brushHash.Clear( idMath::CeilPowerOfTwo( Max( model->numBrushes, 1024 ) ), 1024 );
+
+	nodes.SetGranularity( 1024 );
+	polygons.SetGranularity( 1024 );
+	brushes.SetGranularity( 1024 );
+	polygonRefs.SetGranularity( 1024 );
+	brushRefs.SetGranularity( 1024 );
+	polygonEdges.SetGranularity( 1024 );
+	brushPlanes.SetGranularity( 1024 );
+	binaryPolygons.SetGranularity( 1024 );
+	binaryBrushes.SetGranularity( 1024 );
+
+	CM_CollectBinaryNodes_r( model->node, nodes, polygons, polygonHash, polygonRefs, brushes, brushHash, brushRefs );
+
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		const cm_polygon_t *p = polygons[i];
+		cmbPolygon_t &bp = binaryPolygons.Alloc();
+		bp.bounds = p->bounds;
+		bp.plane = p->plane;
+		bp.material = CM_BinaryIndex( p->material, materials, materialHash );
+		bp.numEdges = p->numEdges;
+		bp.firstEdge = polygonEdges.Num();
+		for ( j = 0; j < p->numEdges; j++ ) {
+			polygonEdges.Append( p->edges[j] );
+		}
+	}
+
+	// brush materials are not stored in the .cm files either
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		const cm_brush_t *b = brushes[i];
+		cmbBrush_t &bb = binaryBrushes.Alloc();
+		bb.bounds = b->bounds;
+		bb.contents = b->contents;
+		bb.primitiveNum = b->primitiveNum;
+		bb.numPlanes = b->numPlanes;
+		bb.firstPlane = brushPlanes.Num();
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			brushPlanes.Append( b->planes[j] );
+		}
+	}
+
+	header.bounds = model->bounds;
+	header.contents = model->contents;
+	header.isConvex = model->isConvex;
+	header.numInternalEdges = model->numInternalEdges;
+	header.numSharpEdges = model->numSharpEdges;
+	header.numMaterials = materials.Num();
+	header.numVertices = model->numVertices;
+	header.numEdges = model->numEdges;
+	header.numNodes = nodes.Num();
+	header.numPolygons = binaryPolygons.Num();
+	header.numPolygonEdges = polygonEdges.Num();
+	header.numBrushes = binaryBrushes.Num();
+	header.numBrushPlanes = brushPlanes.Num();
+	header.numPolygonRefs = polygonRefs.Num();
+	header.numBrushRefs = brushRefs.Num();
+
+	CM_WriteBinaryString( fp, model->name );
+	CM_WriteBinaryArray( fp, &header, 1, sizeof( header ) );
+	for ( i = 0; i < materials.Num(); i++ ) {
+		CM_WriteBinaryString( fp, materials[i]->GetName() );
+	}
+
+	// the vertexes and edges are used in place, so clear everything the trace code changes
+	CM_AlignBinary( fp, 16 );
+	for ( i = 0; i < model->numVertices; i++ ) {
+		cm_vertex_t v = model->vertices[i];
+		v.checkcount = 0;
+		v.side = 0;
+		v.sideSet = 0;
+		fp->Write( &v, sizeof( v ) );
+	}
+	CM_AlignBinary( fp, 16 );
+	for ( i = 0; i < model->numEdges; i++ ) {
+		cm_edge_t e = model->edges[i];
+		e.checkcount = 0;
+		e.side = 0;
+		e.sideSet = 0;
+		fp->Write( &e, sizeof( e ) );
+	}
+
+	CM_WriteBinaryArray( fp, nodes.Ptr(), nodes.Num(), sizeof( cmbNode_t ) );
+	CM_WriteBinaryArray( fp, binaryPolygons.Ptr(), binaryPolygons.Num(), sizeof( cmbPolygon_t ) );
+	CM_WriteBinaryArray( fp, polygonEdges.Ptr(), polygonEdges.Num(), sizeof( int ) );
+	CM_WriteBinaryArray( fp, binaryBrushes.Ptr(), binaryBrushes.Num(), sizeof( cmbBrush_t ) );
+	CM_WriteBinaryArray( fp, brushPlanes.Ptr(), brushPlanes.Num(), sizeof( idPlane ) );
+	CM_WriteBinaryArray( fp, polygonRefs.Ptr(), polygonRefs.Num(), sizeof( int ) );
+	CM_WriteBinaryArray( fp, brushRefs.Ptr(), brushRefs.Num(), sizeof( int ) );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile( const char *fileName, int firstModel, int lastModel, unsigned int mapFileCRC, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	idFile_Memory f( fileName );
+	cmbHeader_t header;
+	int i;
+
+	header.ident = CMB_IDENT;
+	header.version = CMB_VERSION;
+	header.vertexSize = sizeof( cm_vertex_t );
+	header.edgeSize = sizeof( cm_edge_t );
+	header.mapFileCRC = mapFileCRC;
+	header.sourceTimeStamp = (int)sourceTimeStamp;
+	header.sourceLength = sourceLength;
+	header.numModels = lastModel - firstModel;
+	f.Write( &header, sizeof( header ) );
+
+	for ( i = firstModel; i < lastModel; i++ ) {
+		WriteBinaryCollisionModel( &f, models[i] );
+	}
+
+	fileSystem->WriteFile( fileName, f.GetDataPtr(), f.Length() );
+}
 
 /*
 ===============================================================================
@@ -468,6 +855,7 @@ void idCollisionModelManagerLocal::ParseBrushes( idLexer *src, cm_model_t *model
 		} else {
 			b->contents = ContentsFromString( token );
 		}
+		b->material = NULL;
 		b->checkcount = 0;
 		b->primitiveNum = 0;
 		// filter brush into tree
@@ -547,6 +935,312 @@ bool idCollisionModelManagerLocal::ParseCollisionModel( idLexer *src ) {
 	return true;
 }
 
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryNodes_r
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::ReadBinaryNodes_r( cmbCursor_s &cursor, cm_node_t *parent ) {
+	cm_polygonRef_t **prevPref;
+	cm_brushRef_t **prevBref;
+	cm_node_t *node;
+	int i, index;
+
+	if ( cursor.nextNode >= cursor.numNodes ) {
+		cursor.error = true;
+		return NULL;
+	}
+	const cmbNode_t &n = cursor.nodes[cursor.nextNode];
+	node = &cursor.nodeMemory[cursor.nextNode];
+	cursor.nextNode++;
+
+	node->planeType = n.planeType;
+	node->planeDist = n.planeDist;
+	node->parent = parent;
+	node->children[0] = NULL;
+	node->children[1] = NULL;
+
+	// link the references in the order they were stored
+	if ( n.numPolygonRefs < 0 || n.numPolygonRefs > cursor.numPolygonRefs - cursor.nextPolygonRef ||
+			n.numBrushRefs < 0 || n.numBrushRefs > cursor.numBrushRefs - cursor.nextBrushRef ) {
+		cursor.error = true;
+		return node;
+	}
+	prevPref = &node->polygons;
+	for ( i = 0; i < n.numPolygonRefs; i++ ) {
+		index = cursor.polygonRefs[cursor.nextPolygonRef];
+		if ( index < 0 || index >= cursor.numPolygons ) {
+			cursor.error = true;
+			break;
+		}
+		*prevPref = &cursor.polygonRefMemory[cursor.nextPolygonRef++];
+		(*prevPref)->p = cursor.polygons[index];
+		prevPref = &(*prevPref)->next;
+	}
+	*prevPref = NULL;
+	prevBref = &node->brushes;
+	for ( i = 0; i < n.numBrushRefs; i++ ) {
+		index = cursor.brushRefs[cursor.nextBrushRef];
+		if ( index < 0 || index >= cursor.numBrushes ) {
+			cursor.error = true;
+			break;
+		}
+		*prevBref = &cursor.brushRefMemory[cursor.nextBrushRef++];
+		(*prevBref)->b = cursor.brushes[index];
+		prevBref = &(*prevBref)->next;
+	}
+	*prevBref = NULL;
+
+	if ( node->planeType != -1 && !cursor.error ) {
+		if ( node->planeType < 0 || node->planeType > 2 ) {
+			cursor.error = true;
+			return node;
+		}
+		node->children[0] = ReadBinaryNodes_r( cursor, node );
+		if ( !cursor.error ) {
+			node->children[1] = ReadBinaryNodes_r( cursor, node );
+		}
+	}
+	return node;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryCollisionModel
+================
+*/
+bool idCollisionModelManagerLocal::ReadBinaryCollisionModel( cmbCursor_s &cursor ) {
+	idList<const idMaterial *> materials;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	cm_nodeBlock_t *nodeBlock;
+	cm_polygonRefBlock_t *prefBlock;
+	cm_brushRefBlock_t *brefBlock;
+	cm_model_t *model;
+	int i, j, size;
+
+	if ( numModels >= MAX_SUBMODELS ) {
+		return false;
+	}
+	model = AllocModel();
+	models[numModels] = model;
+	numModels++;
+
+	model->name = CM_ReadBinaryString( cursor );
+	const cmbModel_t *header = (const cmbModel_t *)CM_ReadBinaryArray( cursor, 1, sizeof( cmbModel_t ) );
+	if ( header == NULL || header->numMaterials < 0 || header->numNodes < 1 ) {
+		return false;
+	}
+
+	materials.SetNum( header->numMaterials );
+	for ( i = 0; i < header->numMaterials && !cursor.error; i++ ) {
+		materials[i] = declManager->FindMaterial( CM_ReadBinaryString( cursor ) );
+	}
+
+	// the vertexes and edges are used straight from the mapping
+	cm_vertex_t *vertices = (cm_vertex_t *)CM_ReadBinaryArray( cursor, header->numVertices, sizeof( cm_vertex_t ), 16 );
+	cm_edge_t *edges = (cm_edge_t *)CM_ReadBinaryArray( cursor, header->numEdges, sizeof( cm_edge_t ), 16 );
+	const cmbNode_t *nodes = (const cmbNode_t *)CM_ReadBinaryArray( cursor, header->numNodes, sizeof( cmbNode_t ) );
+	const cmbPolygon_t *binaryPolygons = (const cmbPolygon_t *)CM_ReadBinaryArray( cursor, header->numPolygons, sizeof( cmbPolygon_t ) );
+	const int *polygonEdges = (const int *)CM_ReadBinaryArray( cursor, header->numPolygonEdges, sizeof( int ) );
+	const cmbBrush_t *binaryBrushes = (const cmbBrush_t *)CM_ReadBinaryArray( cursor, header->numBrushes, sizeof( cmbBrush_t ) );
+	const idPlane *brushPlanes = (const idPlane *)CM_ReadBinaryArray( cursor, header->numBrushPlanes, sizeof( idPlane ) );
+	cursor.polygonRefs = (const int *)CM_ReadBinaryArray( cursor, header->numPolygonRefs, sizeof( int ) );
+	cursor.brushRefs = (const int *)CM_ReadBinaryArray( cursor, header->numBrushRefs, sizeof( int ) );
+	if ( cursor.error ) {
+		return false;
+	}
+
+	model->numVertices = model->maxVertices = header->numVertices;
+	model->vertices = vertices;
+	model->numEdges = model->maxEdges = header->numEdges;
+	model->edges = edges;
+	model->mappedGeometry = true;
+	for ( i = 0; i < model->numEdges; i++ ) {
+		if ( (unsigned int)edges[i].vertexNum[0] >= (unsigned int)model->numVertices ||
+				(unsigned int)edges[i].vertexNum[1] >= (unsigned int)model->numVertices ) {
+			return false;
+		}
+	}
+
+	// allocate all polygons in one block of exactly the right size
+	size = 0;
+	for ( i = 0; i < header->numPolygons; i++ ) {
+		const cmbPolygon_t &bp = binaryPolygons[i];
+		if ( bp.numEdges < 1 || bp.firstEdge < 0 || bp.numEdges > header->numPolygonEdges - bp.firstEdge ||
+				(unsigned int)bp.material >= (unsigned int)materials.Num() ) {
+			return false;
+		}
+		size += sizeof( cm_polygon_t ) + ( bp.numEdges - 1 ) * sizeof( polygons[0]->edges[0] );
+	}
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + size );
+	model->polygonBlock->bytesRemaining = size;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+
+	polygons.SetNum( header->numPolygons );
+	for ( i = 0; i < header->numPolygons; i++ ) {
+		const cmbPolygon_t &bp = binaryPolygons[i];
+		cm_polygon_t *p = AllocPolygon( model, bp.numEdges );
+		p->numEdges = bp.numEdges;
+		for ( j = 0; j < p->numEdges; j++ ) {
+			p->edges[j] = polygonEdges[bp.firstEdge + j];
+			if ( abs( p->edges[j] ) >= model->numEdges ) {
+				return false;
+			}
+		}
+		p->plane = bp.plane;
+		p->bounds = bp.bounds;
+		p->material = materials[bp.material];
+		p->contents = p->material->GetContentFlags();
+		p->checkcount = 0;
+		polygons[i] = p;
+	}
+
+	// allocate all brushes in one block of exactly the right size
+	size = 0;
+	for ( i = 0; i < header->numBrushes; i++ ) {
+		const cmbBrush_t &bb = binaryBrushes[i];
+		if ( bb.numPlanes < 0 || bb.firstPlane < 0 || bb.numPlanes > header->numBrushPlanes - bb.firstPlane ) {
+			return false;
+		}
+		size += sizeof( cm_brush_t ) + ( bb.numPlanes - 1 ) * sizeof( brushes[0]->planes[0] );
+	}
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + size );
+	model->brushBlock->bytesRemaining = size;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+
+	brushes.SetNum( header->numBrushes );
+	for ( i = 0; i < header->numBrushes; i++ ) {
+		const cmbBrush_t &bb = binaryBrushes[i];
+		cm_brush_t *b = AllocBrush( model, bb.numPlanes );
+		b->numPlanes = bb.numPlanes;
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			b->planes[j] = brushPlanes[bb.firstPlane + j];
+		}
+		b->bounds = bb.bounds;
+		b->contents = bb.contents;
+		b->material = NULL;
+		b->primitiveNum = bb.primitiveNum;
+		b->checkcount = 0;
+		brushes[i] = b;
+	}
+
+	// the nodes and references are allocated in single blocks which are freed with the model
+	nodeBlock = (cm_nodeBlock_t *) Mem_ClearedAlloc( sizeof( cm_nodeBlock_t ) + header->numNodes * sizeof( cm_node_t ) );
+	nodeBlock->nextNode = NULL;
+	nodeBlock->next = NULL;
+	model->nodeBlocks = nodeBlock;
+	model->numNodes = header->numNodes;
+
+	prefBlock = (cm_polygonRefBlock_t *) Mem_Alloc( sizeof( cm_polygonRefBlock_t ) + header->numPolygonRefs * sizeof( cm_polygonRef_t ) );
+	prefBlock->nextRef = NULL;
+	prefBlock->next = NULL;
+	model->polygonRefBlocks = prefBlock;
+	model->numPolygonRefs = header->numPolygonRefs;
+
+	brefBlock = (cm_brushRefBlock_t *) Mem_Alloc( sizeof( cm_brushRefBlock_t ) + header->numBrushRefs * sizeof( cm_brushRef_t ) );
+	brefBlock->nextRef = NULL;
+	brefBlock->next = NULL;
+	model->brushRefBlocks = brefBlock;
+	model->numBrushRefs = header->numBrushRefs;
+
+	cursor.nodes = nodes;
+	cursor.numNodes = header->numNodes;
+	cursor.nextNode = 0;
+	cursor.nextPolygonRef = 0;
+	cursor.numPolygonRefs = header->numPolygonRefs;
+	cursor.nextBrushRef = 0;
+	cursor.numBrushRefs = header->numBrushRefs;
+	cursor.polygons = polygons.Ptr();
+	cursor.numPolygons = polygons.Num();
+	cursor.brushes = brushes.Ptr();
+	cursor.numBrushes = brushes.Num();
+	cursor.nodeMemory = (cm_node_t *) ( ( (byte *) nodeBlock ) + sizeof( cm_nodeBlock_t ) );
+	cursor.polygonRefMemory = (cm_polygonRef_t *) ( ( (byte *) prefBlock ) + sizeof( cm_polygonRefBlock_t ) );
+	cursor.brushRefMemory = (cm_brushRef_t *) ( ( (byte *) brefBlock ) + sizeof( cm_brushRefBlock_t ) );
+
+	model->node = ReadBinaryNodes_r( cursor, NULL );
+	if ( cursor.error || cursor.nextNode != cursor.numNodes ||
+			cursor.nextPolygonRef != cursor.numPolygonRefs || cursor.nextBrushRef != cursor.numBrushRefs ) {
+		return false;
+	}
+
+	model->bounds = header->bounds;
+	model->contents = header->contents;
+	model->isConvex = ( header->isConvex != 0 );
+	model->numInternalEdges = header->numInternalEdges;
+	model->numSharpEdges = header->numSharpEdges;
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *fileName, unsigned int mapFileCRC, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	cmbCursor_t cursor;
+	void *buffer;
+	int i, firstModel;
+
+	cursor.length = fileSystem->MapFile( fileName, &buffer );
+	if ( cursor.length < 0 ) {
+		return false;
+	}
+	cursor.data = (byte *)buffer;
+	cursor.offset = 0;
+	cursor.error = false;
+
+	const cmbHeader_t *header = (const cmbHeader_t *)CM_ReadBinaryArray( cursor, 1, sizeof( cmbHeader_t ) );
+	if ( header == NULL || header->ident != CMB_IDENT || header->version != CMB_VERSION ||
+			header->vertexSize != sizeof( cm_vertex_t ) || header->edgeSize != sizeof( cm_edge_t ) ) {
+		common->Printf( "%s is from a different version\n", fileName );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+	if ( header->sourceTimeStamp != (int)sourceTimeStamp || header->sourceLength != sourceLength ||
+			( mapFileCRC && header->mapFileCRC != mapFileCRC ) ) {
+		common->Printf( "%s is out of date\n", fileName );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	firstModel = numModels;
+	for ( i = 0; i < header->numModels; i++ ) {
+		if ( !ReadBinaryCollisionModel( cursor ) ) {
+			cursor.error = true;
+			break;
+		}
+	}
+
+	if ( cursor.error ) {
+		common->Printf( "%s is damaged\n", fileName );
+		// everything is allocated in blocks, so the trees don't have to be walked
+		for ( i = firstModel; i < numModels; i++ ) {
+			models[i]->node = NULL;
+			FreeModel( models[i] );
+			models[i] = NULL;
+		}
+		numModels = firstModel;
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	// the model vertexes and edges point into the mapping, so FreeMap releases it
+	mappedFiles.Append( buffer );
+
+	return true;
+}
+
 /*
 ================
 idCollisionModelManagerLocal::LoadCollisionModelFile
@@ -555,12 +1249,24 @@ idCollisionModelManagerLocal::LoadCollisionModelFile
 bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, unsigned int mapFileCRC ) {
 	idStr fileName;
 	idToken token;
+	idStr binaryFileName;
 	idLexer *src;
 	unsigned int crc;
+	ID_TIME_T sourceTimeStamp;
+	int sourceLength, firstModel;
 
-	// load it
 	fileName = name;
 	fileName.SetFileExtension( CM_FILE_EXT );
+	binaryFileName = name;
+	binaryFileName.SetFileExtension( CM_BINARYFILE_EXT );
+
+	// use the binary file if it was written from this exact .cm file
+	sourceLength = fileSystem->ReadFile( fileName, NULL, &sourceTimeStamp );
+	if ( cm_useBinaryModels.GetBool() && sourceLength >= 0 && LoadBinaryCollisionModelFile( binaryFileName, mapFileCRC, sourceTimeStamp, sourceLength ) ) {
+		return true;
+	}
+
+	// load it
 	src = new idLexer( fileName );
 	src->SetFlags( LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
 	if ( !src->IsLoaded() ) {
@@ -594,6 +1300,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	}
 
 	// parse the file
+	firstModel = numModels;
 	while ( 1 ) {
 		if ( !src->ReadToken( &token ) ) {
 			break;
@@ -610,6 +1317,10 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 		src->Error( "idCollisionModelManagerLocal::LoadCollisionModelFile: bad token \"%s\"", token.c_str() );
 	}
 
+	if ( cm_useBinaryModels.GetBool() && sourceLength >= 0 && !src->HadError() ) {
+		WriteBinaryCollisionModelsToFile( binaryFileName, firstModel, numModels, crc, sourceTimeStamp, sourceLength );
+	}
+
 	delete src;
 
 	return true;
@@ -391,10 +391,11 @@ void idCollisionModelManagerLocal::FreeModel( cm_model_t *model ) {
 	Mem_Free( model->polygonBlock );
 	// free block allocated brushes
 	Mem_Free( model->brushBlock );
-	// free edges
-	Mem_Free( model->edges );
-	// free vertices
-	Mem_Free( model->vertices );
+	// free edges and vertices unless they are in a memory mapped file
+	if ( !model->mappedGeometry ) {
+		Mem_Free( model->edges );
+		Mem_Free( model->vertices );
+	}
 	// free the model
 	delete model;
 }
@@ -423,6 +424,12 @@ void idCollisionModelManagerLocal::FreeMap( void ) {
 
 	Mem_Free( models );
 
+	// release the .cmb files the model vertices and edges pointed into
+	for ( i = 0; i < mappedFiles.Num(); i++ ) {
+		fileSystem->UnmapFile( mappedFiles[i] );
+	}
+	mappedFiles.Clear();
+
 	Clear();
 
 	ShutdownHash();
@@ -547,6 +554,7 @@ cm_model_t *idCollisionModelManagerLocal::AllocModel( void ) {
 	model->maxEdges = 0;
 	model->numEdges = 0;
 	model->edges= NULL;
+	model->mappedGeometry = false;
 	model->node = NULL;
 	model->nodeBlocks = NULL;
 	model->polygonRefBlocks = NULL;
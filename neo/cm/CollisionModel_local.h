@@ -39,6 +39,7 @@ If you have questions concerning this license or the applicable additional terms
 #define MIN_NODE_SIZE						64.0f
 #define MAX_NODE_POLYGONS					128
 #define CM_MAX_POLYGON_EDGES				64
+#define CM_MAX_POLYGON_EDGES_SIMD			(CM_MAX_POLYGON_EDGES+8)	// room to pad the edge count to the SIMD width
 #define CIRCLE_APPROXIMATION_LENGTH			64.0f
 
 #define	MAX_SUBMODELS						2048
@@ -171,6 +172,7 @@ typedef struct cm_model_s {
 	int						maxEdges;			// size of edge array
 	int						numEdges;			// number of edges
 	cm_edge_t *				edges;				// array with all edges used by the model
+	bool					mappedGeometry;		// set if the vertices and edges point into a memory mapped .cmb file
 	cm_node_t *				node;				// first node of spatial subdivision
 	// blocks with allocated memory
 	cm_nodeBlock_t *		nodeBlocks;			// list with blocks of nodes
@@ -201,6 +203,10 @@ Data used during collision detection calculations
 ===============================================================================
 */
 
+typedef struct cm_plueckerSoA_s {
+	float p[6][CM_MAX_POLYGON_EDGES_SIMD];			// pluecker coordinates stored per component for the SIMD edge tests
+} cm_plueckerSoA_t;
+
 typedef struct cm_trmVertex_s {
 	int used;										// true if this vertex is used for collision detection
 	idVec3 p;										// vertex position
@@ -255,6 +261,7 @@ typedef struct cm_traceWork_s {
 	bool axisIntersectsTrm;							// true if the rotation axis intersects the trace model
 	bool getContacts;								// true if retrieving contacts
 	bool quickExit;									// set to quickly stop the collision detection calculations
+	bool simdEdgeTests;								// true if testing polygon edges several at a time
 
 	idVec3 origin;									// origin of rotation in model space
 	idVec3 axis;									// rotation axis in model space
@@ -275,8 +282,18 @@ typedef struct cm_traceWork_s {
 	idPluecker polygonEdgePlueckerCache[CM_MAX_POLYGON_EDGES];
 	idPluecker polygonVertexPlueckerCache[CM_MAX_POLYGON_EDGES];
 	idVec3 polygonRotationOriginCache[CM_MAX_POLYGON_EDGES];
+	cm_plueckerSoA_t polygonEdgePlueckerSoA;		// polygonEdgePlueckerCache packed for the SIMD edge tests
+	cm_plueckerSoA_t polygonVertexPlueckerSoA;		// polygonVertexPlueckerCache packed for the SIMD edge tests
+	unsigned long polygonEdgeSidesSet;				// each bit tells if the polygon edge sidedness for the trm vertex is calculated
 } cm_traceWork_t;
 
+// pack pluecker coordinates per component and pad the count to the SIMD width with zeros
+void				CM_PackPlueckerSoA( cm_plueckerSoA_t &soa, const idPluecker *src, const int count );
+// dst[i] = soa[i].PermutedInnerProduct( pl ), summed in the same order as the scalar product
+void				CM_SoAPermutedInnerProducts( float *dst, const cm_plueckerSoA_t &soa, const idPluecker &pl, const int count );
+// dst[i] = pl.PermutedInnerProduct( soa[i] ), summed in the same order as the scalar product
+void				CM_PermutedInnerProductsSoA( float *dst, const idPluecker &pl, const cm_plueckerSoA_t &soa, const int count );
+
 /*
 ===============================================================================
 
@@ -489,6 +506,12 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, unsigned int mapFileCRC );
+					// binary files
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelsToFile( const char *fileName, int firstModel, int lastModel, unsigned int mapFileCRC, ID_TIME_T sourceTimeStamp, int sourceLength );
+	cm_node_t *		ReadBinaryNodes_r( struct cmbCursor_s &cursor, cm_node_t *parent );
+	bool			ReadBinaryCollisionModel( struct cmbCursor_s &cursor );
+	bool			LoadBinaryCollisionModelFile( const char *fileName, unsigned int mapFileCRC, ID_TIME_T sourceTimeStamp, int sourceLength );
 
 private:			// CollisionMap_debug
 	int				ContentsFromString( const char *string ) const;
@@ -498,6 +521,7 @@ private:			// CollisionMap_debug
 								const idVec3 &viewOrigin );
 	void			DrawNodePolygons( cm_model_t *model, cm_node_t *node, const idVec3 &origin, const idMat3 &axis,
 								const idVec3 &viewOrigin, const float radius );
+	void			TestSIMD( const idTraceModel &itm, const idMat3 &boxAxis, const idRotation *rotation );
 
 private:			// collision map data
 	idStr			mapName;
@@ -509,6 +533,7 @@ private:			// collision map data
 	int				maxModels;
 	int				numModels;
 	cm_model_t **	models;
+	idList<void *>	mappedFiles;		// memory mapped .cmb files the models point into
 					// polygons and brush for trm model
 	cm_polygonRef_t*trmPolygons[MAX_TRACEMODEL_POLYS];
 	cm_brushRef_t *	trmBrushes[1];
@@ -525,3 +550,4 @@ private:			// collision map data
 
 // for debugging
 extern idCVar cm_debugCollision;
+extern idCVar cm_simdEdgeTests;
@@ -483,6 +483,7 @@ void idCollisionModelManagerLocal::RotateTrmEdgeThroughPolygon( cm_traceWork_t *
 	idVec3 collisionPoint, collisionNormal, origin, epsDir;
 	idPluecker epsPl;
 	idBounds bounds;
+	float fl[CM_MAX_POLYGON_EDGES_SIMD];
 
 	// if the trm is convex and the rotation axis intersects the trm
 	if ( tw->isConvex && tw->axisIntersectsTrm ) {
@@ -502,6 +503,11 @@ void idCollisionModelManagerLocal::RotateTrmEdgeThroughPolygon( cm_traceWork_t *
 		return;
 	}
 
+	// calculate the sides at which the trm edge passes all polygon edges at once
+	if ( tw->simdEdgeTests ) {
+		CM_PermutedInnerProductsSoA( fl, trmEdge->pl, tw->polygonEdgePlueckerSoA, poly->numEdges );
+	}
+
 	// check edges for a collision
 	for ( i = 0; i < poly->numEdges; i++ ) {
 		edgeNum = poly->edges[i];
@@ -537,7 +543,12 @@ void idCollisionModelManagerLocal::RotateTrmEdgeThroughPolygon( cm_traceWork_t *
 			continue;
 		}
 
-		f1 = trmEdge->pl.PermutedInnerProduct( tw->polygonEdgePlueckerCache[i] );
+		if ( tw->simdEdgeTests ) {
+			f1 = fl[i];
+		}
+		else {
+			f1 = trmEdge->pl.PermutedInnerProduct( tw->polygonEdgePlueckerCache[i] );
+		}
 
 		// pluecker coordinate for epsilon expanded edge
 		epsDir = edge->normal * (CM_CLIP_EPSILON+CM_PL_RANGE_EPSILON);
@@ -923,9 +934,10 @@ idCollisionModelManagerLocal::RotateTrmVertexThroughPolygon
 */
 void idCollisionModelManagerLocal::RotateTrmVertexThroughPolygon( cm_traceWork_t *tw, cm_polygon_t *poly, cm_trmVertex_t *v, int vertexNum ) {
 	int i;
-	float tanHalfAngle;
+	float tanHalfAngle, d;
 	idVec3 endDir, collisionPoint;
 	idPluecker pl;
+	float fl[CM_MAX_POLYGON_EDGES_SIMD];
 
 	// if the trm vertex is behind the polygon plane it cannot collide with the polygon within a 180 degrees rotation
 	if ( tw->isConvex && tw->axisIntersectsTrm && v->polygonSide ) {
@@ -951,14 +963,23 @@ void idCollisionModelManagerLocal::RotateTrmVertexThroughPolygon( cm_traceWork_t
 	if ( idMath::Fabs( tanHalfAngle ) < tw->maxTan ) {
 		// verify if 'collisionPoint' moving along 'endDir' moves between polygon edges
 		pl.FromRay( collisionPoint, endDir );
+		if ( tw->simdEdgeTests ) {
+			CM_PermutedInnerProductsSoA( fl, pl, tw->polygonEdgePlueckerSoA, poly->numEdges );
+		}
 		for ( i = 0; i < poly->numEdges; i++ ) {
+			if ( tw->simdEdgeTests ) {
+				d = fl[i];
+			}
+			else {
+				d = pl.PermutedInnerProduct( tw->polygonEdgePlueckerCache[i] );
+			}
 			if ( poly->edges[i] < 0 ) {
-				if ( pl.PermutedInnerProduct( tw->polygonEdgePlueckerCache[i] ) > 0.0f ) {
+				if ( d > 0.0f ) {
 					return;
 				}
 			}
 			else {
-				if ( pl.PermutedInnerProduct( tw->polygonEdgePlueckerCache[i] ) < 0.0f ) {
+				if ( d < 0.0f ) {
 					return;
 				}
 			}
@@ -1135,6 +1156,11 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 	// copy first to last so we can easily cycle through
 	tw->polygonRotationOriginCache[p->numEdges] = tw->polygonRotationOriginCache[0];
 
+	// pack the pluecker coordinates for the SIMD edge tests
+	if ( tw->simdEdgeTests ) {
+		CM_PackPlueckerSoA( tw->polygonEdgePlueckerSoA, tw->polygonEdgePlueckerCache, p->numEdges );
+	}
+
 	// fast point rotation
 	if ( tw->pointTrace ) {
 		RotateTrmVertexThroughPolygon( tw, p, &tw->vertices[0], 0 );
@@ -1285,6 +1311,7 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 	tw.positionTest = false;
 	tw.axisIntersectsTrm = false;
 	tw.quickExit = false;
+	tw.simdEdgeTests = cm_simdEdgeTests.GetBool();
 	tw.angle = endAngle - startAngle;
 	assert( tw.angle > -180.0f && tw.angle < 180.0f );
 	tw.maxTan = initialTan = idMath::Fabs( tan( ( idMath::PI / 360.0f ) * tw.angle ) );
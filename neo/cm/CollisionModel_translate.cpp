@@ -39,6 +39,155 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "CollisionModel_local.h"
 
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define CM_AVX_EDGE_TESTS
+#elif defined( _MSC_VER ) || defined( __SSE__ )
+#include <xmmintrin.h>
+#define CM_SSE_EDGE_TESTS
+#endif
+
+/*
+===============================================================================
+
+SIMD edge tests
+
+	The polygon edge pluecker coordinates are packed per component so one trace
+	model vertex or edge can be tested against 8 (AVX) or 4 (SSE) polygon edges
+	at once. The products are summed in the same order as in
+	idPluecker::PermutedInnerProduct. That does not make the results bit
+	identical to the scalar code, which may evaluate with x87 extended
+	precision, but only the sign of each product is used. cm_testSIMD
+	cross-checks the trace results against the scalar edge tests.
+
+===============================================================================
+*/
+
+#define CM_SIMD_WIDTH			8
+
+/*
+================
+CM_PackPlueckerSoA
+================
+*/
+void CM_PackPlueckerSoA( cm_plueckerSoA_t &soa, const idPluecker *src, const int count ) {
+	int i, j, padded;
+
+	assert( count <= CM_MAX_POLYGON_EDGES );
+
+	padded = ( count + CM_SIMD_WIDTH - 1 ) & ~( CM_SIMD_WIDTH - 1 );
+	for ( j = 0; j < 6; j++ ) {
+		for ( i = 0; i < count; i++ ) {
+			soa.p[j][i] = src[i][j];
+		}
+		for ( ; i < padded; i++ ) {
+			soa.p[j][i] = 0.0f;
+		}
+	}
+}
+
+/*
+================
+CM_InnerProducts
+
+  dst[i] = c[0] * r[0][i] + c[1] * r[1][i] + c[2] * r[2][i] + c[3] * r[3][i] + c[4] * r[4][i] + c[5] * r[5][i]
+  dst must have room for the count padded to the SIMD width
+================
+*/
+static void CM_InnerProducts( float *dst, const float c[6], const float *r[6], const int count ) {
+	int i;
+
+#if defined( CM_AVX_EDGE_TESTS )
+
+	__m256 c0, c1, c2, c3, c4, c5, d;
+
+	c0 = _mm256_set1_ps( c[0] );
+	c1 = _mm256_set1_ps( c[1] );
+	c2 = _mm256_set1_ps( c[2] );
+	c3 = _mm256_set1_ps( c[3] );
+	c4 = _mm256_set1_ps( c[4] );
+	c5 = _mm256_set1_ps( c[5] );
+
+	for ( i = 0; i < count; i += 8 ) {
+		d = _mm256_mul_ps( c0, _mm256_loadu_ps( r[0] + i ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( c1, _mm256_loadu_ps( r[1] + i ) ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( c2, _mm256_loadu_ps( r[2] + i ) ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( c3, _mm256_loadu_ps( r[3] + i ) ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( c4, _mm256_loadu_ps( r[4] + i ) ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( c5, _mm256_loadu_ps( r[5] + i ) ) );
+		_mm256_storeu_ps( dst + i, d );
+	}
+
+#elif defined( CM_SSE_EDGE_TESTS )
+
+	__m128 c0, c1, c2, c3, c4, c5, d;
+
+	c0 = _mm_set1_ps( c[0] );
+	c1 = _mm_set1_ps( c[1] );
+	c2 = _mm_set1_ps( c[2] );
+	c3 = _mm_set1_ps( c[3] );
+	c4 = _mm_set1_ps( c[4] );
+	c5 = _mm_set1_ps( c[5] );
+
+	for ( i = 0; i < count; i += 4 ) {
+		d = _mm_mul_ps( c0, _mm_loadu_ps( r[0] + i ) );
+		d = _mm_add_ps( d, _mm_mul_ps( c1, _mm_loadu_ps( r[1] + i ) ) );
+		d = _mm_add_ps( d, _mm_mul_ps( c2, _mm_loadu_ps( r[2] + i ) ) );
+		d = _mm_add_ps( d, _mm_mul_ps( c3, _mm_loadu_ps( r[3] + i ) ) );
+		d = _mm_add_ps( d, _mm_mul_ps( c4, _mm_loadu_ps( r[4] + i ) ) );
+		d = _mm_add_ps( d, _mm_mul_ps( c5, _mm_loadu_ps( r[5] + i ) ) );
+		_mm_storeu_ps( dst + i, d );
+	}
+
+#else
+
+	for ( i = 0; i < count; i++ ) {
+		dst[i] = c[0] * r[0][i] + c[1] * r[1][i] + c[2] * r[2][i] + c[3] * r[3][i] + c[4] * r[4][i] + c[5] * r[5][i];
+	}
+
+#endif
+}
+
+/*
+================
+CM_SoAPermutedInnerProducts
+
+  dst[i] = soa[i].PermutedInnerProduct( pl )
+================
+*/
+void CM_SoAPermutedInnerProducts( float *dst, const cm_plueckerSoA_t &soa, const idPluecker &pl, const int count ) {
+	float c[6];
+	const float *r[6];
+
+	c[0] = pl[4]; r[0] = soa.p[0];
+	c[1] = pl[5]; r[1] = soa.p[1];
+	c[2] = pl[3]; r[2] = soa.p[2];
+	c[3] = pl[0]; r[3] = soa.p[4];
+	c[4] = pl[1]; r[4] = soa.p[5];
+	c[5] = pl[2]; r[5] = soa.p[3];
+	CM_InnerProducts( dst, c, r, count );
+}
+
+/*
+================
+CM_PermutedInnerProductsSoA
+
+  dst[i] = pl.PermutedInnerProduct( soa[i] )
+================
+*/
+void CM_PermutedInnerProductsSoA( float *dst, const idPluecker &pl, const cm_plueckerSoA_t &soa, const int count ) {
+	float c[6];
+	const float *r[6];
+
+	c[0] = pl[0]; r[0] = soa.p[4];
+	c[1] = pl[1]; r[1] = soa.p[5];
+	c[2] = pl[2]; r[2] = soa.p[3];
+	c[3] = pl[4]; r[3] = soa.p[0];
+	c[4] = pl[5]; r[4] = soa.p[1];
+	c[5] = pl[3]; r[5] = soa.p[2];
+	CM_InnerProducts( dst, c, r, count );
+}
+
 /*
 ===============================================================================
 
@@ -225,6 +374,59 @@ ID_INLINE void CM_SetEdgeSidedness( cm_edge_t *edge, const idPluecker &vpl, cons
 	}
 }
 
+/*
+================
+CM_SetPolygonEdgeSidedness
+
+  stores for all polygon edges at which side the trm vertex passes
+================
+*/
+ID_INLINE void CM_SetPolygonEdgeSidedness( cm_traceWork_t *tw, const cm_polygon_t *poly, const int bitNum ) {
+	int i;
+	cm_edge_t *edge;
+	float fl[CM_MAX_POLYGON_EDGES_SIMD];
+
+	if ( tw->polygonEdgeSidesSet & (1<<bitNum) ) {
+		return;
+	}
+	tw->polygonEdgeSidesSet |= (1<<bitNum);
+
+	CM_SoAPermutedInnerProducts( fl, tw->polygonEdgePlueckerSoA, tw->vertices[bitNum].pl, poly->numEdges );
+	for ( i = 0; i < poly->numEdges; i++ ) {
+		edge = tw->model->edges + abs(poly->edges[i]);
+		if ( !(edge->sideSet & (1<<bitNum)) ) {
+			edge->side = (edge->side & ~(1<<bitNum)) | (FLOATSIGNBITSET(fl[i]) << bitNum);
+			edge->sideSet |= (1 << bitNum);
+		}
+	}
+}
+
+/*
+================
+CM_SetPolygonVertexSidedness
+
+  stores for all polygon vertices at which side of the trm edge they pass
+================
+*/
+ID_INLINE void CM_SetPolygonVertexSidedness( cm_traceWork_t *tw, const cm_polygon_t *poly, const cm_trmEdge_t *trmEdge ) {
+	int i, edgeNum, bitNum;
+	cm_edge_t *edge;
+	cm_vertex_t *v;
+	float fl[CM_MAX_POLYGON_EDGES_SIMD];
+
+	CM_SoAPermutedInnerProducts( fl, tw->polygonVertexPlueckerSoA, trmEdge->pl, poly->numEdges );
+	bitNum = trmEdge->bitNum;
+	for ( i = 0; i < poly->numEdges; i++ ) {
+		edgeNum = poly->edges[i];
+		edge = tw->model->edges + abs(edgeNum);
+		v = tw->model->vertices + edge->vertexNum[INTSIGNBITSET(edgeNum)];
+		if ( !(v->sideSet & (1<<bitNum)) ) {
+			v->side = (v->side & ~(1<<bitNum)) | (FLOATSIGNBITSET(fl[i]) << bitNum);
+			v->sideSet |= (1 << bitNum);
+		}
+	}
+}
+
 /*
 ================
 idCollisionModelManagerLocal::TranslateTrmEdgeThroughPolygon
@@ -238,6 +440,13 @@ void idCollisionModelManagerLocal::TranslateTrmEdgeThroughPolygon( cm_traceWork_
 	cm_vertex_t *v1, *v2;
 	idPluecker *pl, epsPl;
 
+	// calculate the sidedness for all polygon edges and vertices at once
+	if ( tw->simdEdgeTests ) {
+		CM_SetPolygonEdgeSidedness( tw, poly, trmEdge->vertexNum[0] );
+		CM_SetPolygonEdgeSidedness( tw, poly, trmEdge->vertexNum[1] );
+		CM_SetPolygonVertexSidedness( tw, poly, trmEdge );
+	}
+
 	// check edges for a collision
 	for ( i = 0; i < poly->numEdges; i++) {
 		edgeNum = poly->edges[i];
@@ -401,6 +610,10 @@ void idCollisionModelManagerLocal::TranslateTrmVertexThroughPolygon( cm_traceWor
 	f = CM_TranslationPlaneFraction( poly->plane, v->p, v->endp );
 	if ( f < tw->trace.fraction ) {
 
+		if ( tw->simdEdgeTests ) {
+			CM_SetPolygonEdgeSidedness( tw, poly, bitNum );
+		}
+
 		for ( i = 0; i < poly->numEdges; i++ ) {
 			edgeNum = poly->edges[i];
 			edge = tw->model->edges + abs(edgeNum);
@@ -620,6 +833,13 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 		// copy first to last so we can easily cycle through for the edges
 		tw->polygonVertexPlueckerCache[p->numEdges] = tw->polygonVertexPlueckerCache[0];
 
+		// pack the pluecker coordinates for the SIMD edge tests
+		if ( tw->simdEdgeTests ) {
+			CM_PackPlueckerSoA( tw->polygonEdgePlueckerSoA, tw->polygonEdgePlueckerCache, p->numEdges );
+			CM_PackPlueckerSoA( tw->polygonVertexPlueckerSoA, tw->polygonVertexPlueckerCache, p->numEdges );
+			tw->polygonEdgeSidesSet = 0;
+		}
+
 		// trace trm vertices through polygon
 		for ( i = 0; i < tw->numVerts; i++ ) {
 			bv = tw->vertices + i;
@@ -824,6 +1044,7 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 	tw.positionTest = false;
 	tw.quickExit = false;
 	tw.getContacts = idCollisionModelManagerLocal::getContacts;
+	tw.simdEdgeTests = cm_simdEdgeTests.GetBool();
 	tw.contacts = idCollisionModelManagerLocal::contacts;
 	tw.maxContacts = idCollisionModelManagerLocal::maxContacts;
 	tw.numContacts = 0;
@@ -160,6 +160,7 @@ public:
 	void					SetFOV( float fov );
 	bool					CheckFOV( const idVec3 &pos ) const;
 	bool					CanSee( idEntity *ent, bool useFOV ) const;
+	int						CanSeeBatch( idEntity * const *ents, int numEnts, bool useFOV, bool *visible ) const;
 	bool					PointVisible( const idVec3 &point ) const;
 	virtual void			GetAIAimTargets( const idVec3 &lastSightPos, idVec3 &headPos, idVec3 &chestPos );
 
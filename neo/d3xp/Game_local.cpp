@@ -46,6 +46,7 @@ idUserInterfaceManager *	uiManager = NULL;
 idDeclManager *				declManager = NULL;
 idAASFileManager *			AASFileManager = NULL;
 idCollisionModelManager *	collisionModelManager = NULL;
+idJobSystem *				jobSystem = NULL;
 idCVar *					idCVar::staticVars = NULL;
 
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL|CVAR_SYSTEM, "force generic platform independent SIMD" );
@@ -136,6 +137,7 @@ extern "C" gameExport_t *GetGameAPI( gameImport_t *import ) {
 		declManager					= import->declManager;
 		AASFileManager				= import->AASFileManager;
 		collisionModelManager		= import->collisionModelManager;
+		jobSystem					= import->jobSystem;
 	}
 
 	// set interface pointers used by idLib
@@ -177,6 +179,7 @@ void TestGameAPI( void ) {
 	testImport.declManager				= ::declManager;
 	testImport.AASFileManager			= ::AASFileManager;
 	testImport.collisionModelManager	= ::collisionModelManager;
+	testImport.jobSystem				= ::jobSystem;
 
 	testExport = *GetGameAPI( &testImport );
 }
@@ -2443,6 +2446,10 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 		}
 #endif
 
+		// anim poses are only shared within a game frame
+		animationLib.ClearPoseCache();
+		idAnimator::ClearLODStats();
+
 		// make sure the random number counter is used each frame so random events
 		// are influenced by the player's actions
 		random.RandomInt();
@@ -2548,6 +2555,9 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 		timer_events.Clear();
 		timer_events.Start();
 
+		// run the script threads whose wait is over
+		idThread::RunScheduledThreads();
+
 		// service any pending events
 		idEvent::ServiceEvents();
 
@@ -1528,6 +1528,9 @@ gameReturn_t idGameLocal::ClientPrediction( int clientNum, const usercmd_t *clie
 	previousTime = time;
 	time += msec;
 
+	// anim poses are only shared within a game frame
+	animationLib.ClearPoseCache();
+
 	// update the real client time and the new frame flag
 	if ( time > realClientTime ) {
 		realClientTime = time;
@@ -1550,6 +1553,9 @@ gameReturn_t idGameLocal::ClientPrediction( int clientNum, const usercmd_t *clie
 		ent->ClientPredictionThink();
 	}
 
+	// run the script threads whose wait is over
+	idThread::RunScheduledThreads();
+
 	// service any pending events
 	idEvent::ServiceEvents();
 
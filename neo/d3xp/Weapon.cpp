@@ -31,6 +31,8 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Game_local.h"
 
+static const int MAX_PREDICTED_PELLETS = 32;
+
 /***********************************************************************
 
   idWeapon  
@@ -3385,15 +3387,28 @@ void idWeapon::Event_LaunchProjectiles( int num_projectiles, float spread, float
 		// predict instant hit projectiles
 		if ( projectileDict.GetBool( "net_instanthit" ) ) {
 			float spreadRad = DEG2RAD( spread );
+			idVec3 pelletStart[ MAX_PREDICTED_PELLETS ];
+			idVec3 pelletEnd[ MAX_PREDICTED_PELLETS ];
+			trace_t pelletTrace[ MAX_PREDICTED_PELLETS ];
+			int j, numPellets;
+
 			muzzle_pos = muzzleOrigin + playerViewAxis[ 0 ] * 2.0f;
-			for( i = 0; i < num_projectiles; i++ ) {
-				ang = idMath::Sin( spreadRad * gameLocal.random.RandomFloat() );
-				spin = (float)DEG2RAD( 360.0f ) * gameLocal.random.RandomFloat();
-				dir = playerViewAxis[ 0 ] + playerViewAxis[ 2 ] * ( ang * idMath::Sin( spin ) ) - playerViewAxis[ 1 ] * ( ang * idMath::Cos( spin ) );
-				dir.Normalize();
-				gameLocal.clip.Translation( tr, muzzle_pos, muzzle_pos + dir * 4096.0f, NULL, mat3_identity, MASK_SHOT_RENDERMODEL, owner );
-				if ( tr.fraction < 1.0f ) {
-					idProjectile::ClientPredictionCollide( this, projectileDict, tr, vec3_origin, true );
+			for( i = 0; i < num_projectiles; i += numPellets ) {
+				numPellets = Min( num_projectiles - i, MAX_PREDICTED_PELLETS );
+				for( j = 0; j < numPellets; j++ ) {
+					ang = idMath::Sin( spreadRad * gameLocal.random.RandomFloat() );
+					spin = (float)DEG2RAD( 360.0f ) * gameLocal.random.RandomFloat();
+					dir = playerViewAxis[ 0 ] + playerViewAxis[ 2 ] * ( ang * idMath::Sin( spin ) ) - playerViewAxis[ 1 ] * ( ang * idMath::Cos( spin ) );
+					dir.Normalize();
+					pelletStart[ j ] = muzzle_pos;
+					pelletEnd[ j ] = muzzle_pos + dir * 4096.0f;
+				}
+				// the pellets all start at the muzzle so one clip model gather serves them all
+				gameLocal.clip.TracePointBatch( pelletTrace, pelletStart, pelletEnd, numPellets, MASK_SHOT_RENDERMODEL, owner );
+				for( j = 0; j < numPellets; j++ ) {
+					if ( pelletTrace[ j ].fraction < 1.0f ) {
+						idProjectile::ClientPredictionCollide( this, projectileDict, pelletTrace[ j ], vec3_origin, true );
+					}
 				}
 			}
 		}
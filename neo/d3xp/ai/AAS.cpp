@@ -55,6 +55,7 @@ idAASLocal::idAASLocal
 */
 idAASLocal::idAASLocal( void ) {
 	file = NULL;
+	concurrentRouting = false;
 }
 
 /*
@@ -136,6 +136,14 @@ public:
 	virtual void				ShowFlyPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const = 0;
 								// Find the nearest goal which satisfies the callback.
 	virtual bool				FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 origin, const idVec3 &target, int travelFlags, aasObstacle_t *obstacles, int numObstacles, idAASCallback &callback ) const = 0;
+								// Between these calls route queries and FindNearestGoal may run on several threads at once.
+								// Area states and obstacles may not change and routing cache is only freed at the end.
+								// Only threads of the job system may route in between, the game itself still routes
+								// from the main thread and testAASRouting is the only caller so far.
+	virtual void				BeginConcurrentRouting( void ) = 0;
+	virtual void				EndConcurrentRouting( void ) = 0;
+								// Runs random route queries on all job threads and compares the results with single threaded routing.
+	virtual void				TestConcurrentRouting( int numQueries ) = 0;
 };
 
 #endif /* !__AAS_H__ */
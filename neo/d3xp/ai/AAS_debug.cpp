@@ -506,3 +506,189 @@ void idAASLocal::Test( const idVec3 &origin ) {
 		ShowPushIntoArea( origin );
 	}
 }
+
+/*
+===============================================================================
+
+	Concurrent routing test
+
+===============================================================================
+*/
+
+#define ROUTE_TEST_QUERIES_PER_JOB		32
+
+static const int routeTestTravelFlags[] = {
+	TFL_WALK|TFL_AIR,
+	TFL_WALK|TFL_AIR|TFL_FLY,
+	TFL_WALK|TFL_AIR|TFL_WATER
+};
+
+typedef struct routeTestQuery_s {
+	int							areaNum;
+	int							goalAreaNum;
+	int							travelFlags;
+	idVec3						origin;
+	bool						findGoal;			// also find the goal area with a flood fill
+	bool						result;
+	int							travelTime;
+	idReachability *			reach;
+	int							nearestAreaNum;
+} routeTestQuery_t;
+
+typedef struct routeTestJob_s {
+	const idAAS *				aas;
+	routeTestQuery_t *			queries;
+	int							numQueries;
+} routeTestJob_t;
+
+class idAASRouteTestCallback : public idAASCallback {
+public:
+	int							goalAreaNum;
+
+	virtual bool				TestArea( const idAAS *aas, int areaNum ) { return areaNum == goalAreaNum; }
+};
+
+/*
+============
+RouteTestQueries
+============
+*/
+static void RouteTestQueries( const idAAS *aas, routeTestQuery_t *queries, int numQueries ) {
+	int i;
+	aasGoal_t goal;
+	idAASRouteTestCallback callback;
+
+	for ( i = 0; i < numQueries; i++ ) {
+		routeTestQuery_t &q = queries[i];
+		q.result = aas->RouteToGoalArea( q.areaNum, q.origin, q.goalAreaNum, q.travelFlags, q.travelTime, &q.reach );
+		q.nearestAreaNum = 0;
+		if ( q.findGoal ) {
+			callback.goalAreaNum = q.goalAreaNum;
+			if ( aas->FindNearestGoal( goal, q.areaNum, q.origin, aas->AreaCenter( q.goalAreaNum ), q.travelFlags, NULL, 0, callback ) ) {
+				q.nearestAreaNum = goal.areaNum;
+			}
+		}
+	}
+}
+
+/*
+============
+RouteTestJob
+============
+*/
+static void RouteTestJob( void *data ) {
+	routeTestJob_t *job = (routeTestJob_t *)data;
+	RouteTestQueries( job->aas, job->queries, job->numQueries );
+}
+
+/*
+============
+idAASLocal::TestConcurrentRouting
+
+  runs the same random route queries single threaded and spread over jobs and compares the results,
+  the first concurrent pass starts without routing cache so the threads compete to create it
+============
+*/
+void idAASLocal::TestConcurrentRouting( int numQueries ) {
+	int i, pass, numJobs, numErrors, cacheMemory;
+	idList<int> areas;
+	routeTestQuery_t *reference, *queries;
+	routeTestJob_t *jobs;
+	idJobGroup *group;
+	idRandom random( 0x5a3d );
+	idTimer timer;
+
+	if ( !file ) {
+		return;
+	}
+
+	assert( !concurrentRouting );
+
+	for ( i = 1; i < file->GetNumAreas(); i++ ) {
+		if ( file->GetArea( i ).flags & ( AREA_REACHABLE_WALK | AREA_REACHABLE_FLY ) ) {
+			areas.Append( i );
+		}
+	}
+	if ( areas.Num() < 2 ) {
+		gameLocal.Printf( "%s has no reachable areas\n", file->GetName() );
+		return;
+	}
+
+	reference = new routeTestQuery_t[numQueries];
+	queries = new routeTestQuery_t[numQueries];
+	for ( i = 0; i < numQueries; i++ ) {
+		reference[i].areaNum = areas[random.RandomInt( areas.Num() )];
+		reference[i].goalAreaNum = areas[random.RandomInt( areas.Num() )];
+		reference[i].travelFlags = routeTestTravelFlags[random.RandomInt( sizeof( routeTestTravelFlags ) / sizeof( routeTestTravelFlags[0] ) )];
+		reference[i].origin = AreaCenter( reference[i].areaNum );
+		reference[i].findGoal = ( i & 15 ) == 0;
+	}
+
+	numJobs = ( numQueries + ROUTE_TEST_QUERIES_PER_JOB - 1 ) / ROUTE_TEST_QUERIES_PER_JOB;
+	jobs = new routeTestJob_t[numJobs];
+	for ( i = 0; i < numJobs; i++ ) {
+		jobs[i].aas = this;
+		jobs[i].queries = queries + i * ROUTE_TEST_QUERIES_PER_JOB;
+		jobs[i].numQueries = Min( ROUTE_TEST_QUERIES_PER_JOB, numQueries - i * ROUTE_TEST_QUERIES_PER_JOB );
+	}
+
+	gameLocal.Printf( "%d route queries on %s with %d threads\n", numQueries, file->GetName(), jobSystem->GetNumThreads() );
+
+	// single threaded reference without routing cache
+	DeleteRoutingCache();
+	timer.Start();
+	RouteTestQueries( this, reference, numQueries );
+	timer.Stop();
+	gameLocal.Printf( "single thread:        %6d msec\n", (int) timer.Milliseconds() );
+
+	group = jobSystem->AllocJobGroup( "testConcurrentRouting" );
+
+	for ( pass = 0; pass < 2; pass++ ) {
+
+		if ( pass == 0 ) {
+			DeleteRoutingCache();
+			for ( i = 0; i < file->GetNumClusters(); i++ ) {
+				InvalidatePortalTravelTables( i );
+			}
+		}
+
+		memcpy( queries, reference, numQueries * sizeof( queries[0] ) );
+		for ( i = 0; i < numQueries; i++ ) {
+			queries[i].result = false;
+			queries[i].travelTime = -1;
+			queries[i].reach = NULL;
+			queries[i].nearestAreaNum = -1;
+		}
+
+		BeginConcurrentRouting();
+		timer.Clear();
+		timer.Start();
+		for ( i = 0; i < numJobs; i++ ) {
+			group->AddJob( RouteTestJob, &jobs[i] );
+		}
+		group->Run();
+		timer.Stop();
+		cacheMemory = totalCacheMemory;
+		EndConcurrentRouting();
+
+		numErrors = 0;
+		for ( i = 0; i < numQueries; i++ ) {
+			if ( queries[i].result != reference[i].result || queries[i].travelTime != reference[i].travelTime ||
+					queries[i].reach != reference[i].reach || queries[i].nearestAreaNum != reference[i].nearestAreaNum ) {
+				if ( numErrors < 8 ) {
+					gameLocal.Printf( "query %d from area %d to area %d differs\n", i, queries[i].areaNum, queries[i].goalAreaNum );
+				}
+				numErrors++;
+			}
+		}
+
+		gameLocal.Printf( "%s %6d msec, %d KB cache, %d errors\n", pass == 0 ? "threads without cache:" : "threads with cache:   ",
+							(int) timer.Milliseconds(), cacheMemory >> 10, numErrors );
+	}
+
+	jobSystem->FreeJobGroup( group );
+
+	delete[] jobs;
+	delete[] queries;
+	delete[] reference;
+}
@@ -32,6 +32,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "AAS.h"
 #include "../Pvs.h"
 
+#define ROUTING_CACHE_LOCKS			64		// number of locks the routing cache is striped over, power of two
+
 
 class idRoutingCache {
 	friend class idAASLocal;
@@ -40,6 +42,10 @@ public:
 								idRoutingCache( int size );
 								~idRoutingCache( void );
 
+								// routing cache is allocated with malloc so it can be created from any thread
+	void *						operator new( size_t s );
+	void						operator delete( void *ptr );
+
 	int							Size( void ) const;
 
 private:
@@ -53,11 +59,32 @@ private:
 	idRoutingCache *			time_next;				// next in time based list
 	idRoutingCache *			time_prev;				// previous in time based list
 	unsigned short				startTravelTime;		// travel time to start with
+	bool						used;					// used since the last time the cache was considered for removal
 	unsigned char *				reachabilities;			// reachabilities used for routing
 	unsigned short *			travelTimes;			// travel time for every area
 };
 
 
+class idPortalTravelTable {
+	friend class idAASLocal;
+
+public:
+								idPortalTravelTable( int size, int numClusters );
+								~idPortalTravelTable( void );
+
+	int							Size( void ) const;
+
+private:
+	int							travelFlags;			// combinations of the travel flags
+	int							size;					// number of portal to portal travel times
+	int							numClusters;			// number of clusters
+	volatile int *				clusterValid;			// non-zero if the travel times between the portals of the cluster are up to date
+	idPortalTravelTable *		next;					// next in list
+	unsigned char *				reachabilities;			// reachabilities used to travel from portal to portal
+	unsigned short *			travelTimes;			// travel times from every portal of a cluster to every other portal of the cluster
+};
+
+
 class idRoutingUpdate {
 	friend class idAASLocal;
 
@@ -73,6 +100,13 @@ private:
 };
 
 
+typedef struct routingThreadData_s {
+	idRoutingUpdate *			areaUpdate;				// memory used to update the area routing cache
+	idRoutingUpdate *			portalUpdate;			// memory used to update the portal routing cache
+	unsigned short *			goalAreaTravelTimes;	// travel times to goal areas
+} routingThreadData_t;
+
+
 class idRoutingObstacle {
 	friend class idAASLocal;
 								idRoutingObstacle( void ) { }
@@ -118,6 +152,9 @@ public:
 	virtual void				ShowWalkPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const;
 	virtual void				ShowFlyPath( const idVec3 &origin, int goalAreaNum, const idVec3 &goalOrigin ) const;
 	virtual bool				FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 origin, const idVec3 &target, int travelFlags, aasObstacle_t *obstacles, int numObstacles, idAASCallback &callback ) const;
+	virtual void				BeginConcurrentRouting( void );
+	virtual void				EndConcurrentRouting( void );
+	virtual void				TestConcurrentRouting( int numQueries );
 
 private:
 	idAASFile *					file;
@@ -128,14 +165,22 @@ private:	// routing data
 	int							areaCacheIndexSize;		// number of area cache entries
 	idRoutingCache **			portalCacheIndex;		// for each area in the world the travel times from each portal
 	int							portalCacheIndexSize;	// number of portal cache entries
-	idRoutingUpdate *			areaUpdate;				// memory used to update the area routing cache
-	idRoutingUpdate *			portalUpdate;			// memory used to update the portal routing cache
-	unsigned short *			goalAreaTravelTimes;	// travel times to goal areas
+	routingThreadData_t *		threadData;				// update memory for each thread of the job system
+	int							numThreadData;			// number of threads with update memory
 	unsigned short *			areaTravelTimes;		// travel times through the areas
 	int							numAreaTravelTimes;		// number of area travel times
 	mutable idRoutingCache *	cacheListStart;			// start of list with cache sorted from oldest to newest
 	mutable idRoutingCache *	cacheListEnd;			// end of list with cache sorted from oldest to newest
 	mutable int					totalCacheMemory;		// total cache memory used
+	bool						concurrentRouting;		// true while route queries may run on several threads
+	mutable idSysSpinLock		cacheListLock;			// lock for the time sorted cache list
+	mutable idSysSpinLock		areaCacheLocks[ROUTING_CACHE_LOCKS];	// locks for creating area cache
+	mutable idSysSpinLock		portalCacheLocks[ROUTING_CACHE_LOCKS];	// locks for creating portal cache
+	mutable idSysSpinLock		portalTableLocks[ROUTING_CACHE_LOCKS];	// locks for updating the portal tables of a cluster
+	int *						portalTableOffsets;		// for each cluster the offset of the portal travel times in the portal tables
+	int *						portalTableIndex;		// for each portal the number of the portal in the front and back cluster
+	int							portalTableSize;		// number of portal to portal travel times in a portal table
+	mutable idPortalTravelTable *portalTables;			// portal to portal travel times for each combination of travel flags
 	idList<idRoutingObstacle *>	obstacleList;			// list with obstacles
 
 private:	// routing
@@ -148,10 +193,19 @@ private:	// routing
 	void						DeleteClusterCache( int clusterNum );
 	void						DeletePortalCache( void );
 	void						ShutdownRoutingCache( void );
+	void						DeleteRoutingCache( void );
 	void						RoutingStats( void ) const;
 	void						LinkCache( idRoutingCache *cache ) const;
 	void						UnlinkCache( idRoutingCache *cache ) const;
 	void						DeleteOldestCache( void ) const;
+	routingThreadData_t &		GetThreadData( void ) const;
+	void						SetupPortalTravelTables( void );
+	void						ShutdownPortalTravelTables( void );
+	void						InvalidatePortalTravelTables( int clusterNum );
+	idPortalTravelTable *		GetPortalTravelTable( int travelFlags ) const;
+	void						UpdatePortalTravelTable( idPortalTravelTable *table, int clusterNum ) const;
+	bool						LoadPortalTravelTables( const char *fileName );
+	void						WritePortalTravelTables( const char *fileName ) const;
 	idReachability *			GetAreaReachability( int areaNum, int reachabilityNum ) const;
 	int							ClusterAreaNum( int clusterNum, int areaNum ) const;
 	void						UpdateAreaRoutingCache( idRoutingCache *areaCache ) const;
@@ -39,6 +39,17 @@ If you have questions concerning this license or the applicable additional terms
 
 #define LEDGE_TRAVELTIME_PANALTY	250
 
+#define PORTALTABLE_IDENT			( ( 'T' << 24 ) + ( 'R' << 16 ) + ( 'S' << 8 ) + 'A' )
+#define PORTALTABLE_VERSION			1
+#define PORTALTABLE_FILEEXT			"route"
+
+// travel flag combinations used by the AI, the portal tables for these are precomputed
+static const int portalTableTravelFlags[] = {
+	TFL_WALK|TFL_AIR,
+	TFL_WALK|TFL_AIR|TFL_FLY
+};
+static const int numPortalTableTravelFlags = sizeof( portalTableTravelFlags ) / sizeof( portalTableTravelFlags[0] );
+
 /*
 ============
 idRoutingCache::idRoutingCache
@@ -51,8 +62,62 @@ idRoutingCache::idRoutingCache( int size ) {
 	time_next = time_prev = NULL;
 	travelFlags = 0;
 	startTravelTime = 0;
+	used = false;
 	type = 0;
 	this->size = size;
+	reachabilities = (byte *) calloc( size, sizeof( reachabilities[0] ) );
+	travelTimes = (unsigned short *) calloc( size, sizeof( travelTimes[0] ) );
+}
+
+/*
+============
+idRoutingCache::~idRoutingCache
+============
+*/
+idRoutingCache::~idRoutingCache( void ) {
+	free( reachabilities );
+	free( travelTimes );
+}
+
+/*
+============
+idRoutingCache::operator new
+============
+*/
+void *idRoutingCache::operator new( size_t s ) {
+	return malloc( s );
+}
+
+/*
+============
+idRoutingCache::operator delete
+============
+*/
+void idRoutingCache::operator delete( void *ptr ) {
+	free( ptr );
+}
+
+/*
+============
+idRoutingCache::Size
+============
+*/
+int idRoutingCache::Size( void ) const {
+	return sizeof( idRoutingCache ) + size * sizeof( reachabilities[0] ) + size * sizeof( travelTimes[0] );
+}
+
+/*
+============
+idPortalTravelTable::idPortalTravelTable
+============
+*/
+idPortalTravelTable::idPortalTravelTable( int size, int numClusters ) {
+	travelFlags = 0;
+	next = NULL;
+	this->size = size;
+	this->numClusters = numClusters;
+	clusterValid = new int[numClusters];
+	memset( (void *)clusterValid, 0, numClusters * sizeof( clusterValid[0] ) );
 	reachabilities = new byte[size];
 	memset( reachabilities, 0, size * sizeof( reachabilities[0] ) );
 	travelTimes = new unsigned short[size];
@@ -61,21 +126,22 @@ idRoutingCache::idRoutingCache( int size ) {
 
 /*
 ============
-idRoutingCache::~idRoutingCache
+idPortalTravelTable::~idPortalTravelTable
 ============
 */
-idRoutingCache::~idRoutingCache( void ) {
+idPortalTravelTable::~idPortalTravelTable( void ) {
+	delete [] (int *)clusterValid;
 	delete [] reachabilities;
 	delete [] travelTimes;
 }
 
 /*
 ============
-idRoutingCache::Size
+idPortalTravelTable::Size
 ============
 */
-int idRoutingCache::Size( void ) const {
-	return sizeof( idRoutingCache ) + size * sizeof( reachabilities[0] ) + size * sizeof( travelTimes[0] );
+int idPortalTravelTable::Size( void ) const {
+	return sizeof( idPortalTravelTable ) + numClusters * sizeof( clusterValid[0] ) + size * sizeof( reachabilities[0] ) + size * sizeof( travelTimes[0] );
 }
 
 /*
@@ -205,13 +271,20 @@ void idAASLocal::SetupRoutingCache( void ) {
 	portalCacheIndexSize = file->GetNumAreas();
 	portalCacheIndex = (idRoutingCache **) Mem_ClearedAlloc( portalCacheIndexSize * sizeof( idRoutingCache * ) );
 
-	areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
-	portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( (file->GetNumPortals()+1) * sizeof( idRoutingUpdate ) );
-
-	goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( unsigned short ) );
+	// every thread that routes needs its own update memory
+	numThreadData = Max( 1, jobSystem->GetNumThreads() );
+	threadData = (routingThreadData_t *) Mem_ClearedAlloc( numThreadData * sizeof( routingThreadData_t ) );
+	for ( i = 0; i < numThreadData; i++ ) {
+		threadData[i].areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
+		threadData[i].portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc( (file->GetNumPortals()+1) * sizeof( idRoutingUpdate ) );
+		threadData[i].goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( unsigned short ) );
+	}
 
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
+	concurrentRouting = false;
+
+	SetupPortalTravelTables();
 }
 
 /*
@@ -252,10 +325,10 @@ void idAASLocal::DeletePortalCache( void ) {
 
 /*
 ============
-idAASLocal::ShutdownRoutingCache
+idAASLocal::DeleteRoutingCache
 ============
 */
-void idAASLocal::ShutdownRoutingCache( void ) {
+void idAASLocal::DeleteRoutingCache( void ) {
 	int i;
 
 	for ( i = 0; i < file->GetNumClusters(); i++ ) {
@@ -263,6 +336,17 @@ void idAASLocal::ShutdownRoutingCache( void ) {
 	}
 
 	DeletePortalCache();
+}
+
+/*
+============
+idAASLocal::ShutdownRoutingCache
+============
+*/
+void idAASLocal::ShutdownRoutingCache( void ) {
+	int i;
+
+	DeleteRoutingCache();
 
 	Mem_Free( areaCacheIndex );
 	areaCacheIndex = NULL;
@@ -270,15 +354,332 @@ void idAASLocal::ShutdownRoutingCache( void ) {
 	Mem_Free( portalCacheIndex );
 	portalCacheIndex = NULL;
 	portalCacheIndexSize = 0;
-	Mem_Free( areaUpdate );
-	areaUpdate = NULL;
-	Mem_Free( portalUpdate );
-	portalUpdate = NULL;
-	Mem_Free( goalAreaTravelTimes );
-	goalAreaTravelTimes = NULL;
+	for ( i = 0; i < numThreadData; i++ ) {
+		Mem_Free( threadData[i].areaUpdate );
+		Mem_Free( threadData[i].portalUpdate );
+		Mem_Free( threadData[i].goalAreaTravelTimes );
+	}
+	Mem_Free( threadData );
+	threadData = NULL;
+	numThreadData = 0;
 
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
+
+	ShutdownPortalTravelTables();
+}
+
+/*
+============
+idAASLocal::SetupPortalTravelTables
+
+  precomputes the travel times between the portals of each cluster for the travel flags used by the AI,
+  the tables are stored next to the AAS file so only the first load of the map has to calculate them
+============
+*/
+void idAASLocal::SetupPortalTravelTables( void ) {
+	int i, j, side, portalNum;
+	const aasCluster_t *cluster;
+	idPortalTravelTable *table;
+	idStr fileName, extension;
+	idTimer timer;
+
+	portalTableOffsets = (int *) Mem_ClearedAlloc( file->GetNumClusters() * sizeof( int ) );
+	portalTableIndex = (int *) Mem_ClearedAlloc( file->GetNumPortals() * 2 * sizeof( int ) );
+	portalTableSize = 0;
+	portalTables = NULL;
+
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		cluster = &file->GetCluster( i );
+		portalTableOffsets[i] = portalTableSize;
+		portalTableSize += cluster->numPortals * cluster->numPortals;
+		for ( j = 0; j < cluster->numPortals; j++ ) {
+			portalNum = file->GetPortalIndex( cluster->firstPortal + j );
+			side = file->GetPortal( portalNum ).clusters[0] != i;
+			portalTableIndex[portalNum * 2 + side] = j;
+		}
+	}
+
+	if ( !aas_portalTables.GetBool() ) {
+		return;
+	}
+
+	// maps/name.aas48 -> maps/name.route48
+	fileName = file->GetName();
+	fileName.ExtractFileExtension( extension );
+	if ( extension.Icmpn( "aas", 3 ) == 0 ) {
+		extension = PORTALTABLE_FILEEXT + extension.Right( extension.Length() - 3 );
+	} else {
+		extension += PORTALTABLE_FILEEXT;
+	}
+	fileName.SetFileExtension( extension );
+
+	if ( LoadPortalTravelTables( fileName ) ) {
+		return;
+	}
+
+	timer.Start();
+
+	for ( i = 0; i < numPortalTableTravelFlags; i++ ) {
+		table = GetPortalTravelTable( portalTableTravelFlags[i] );
+		for ( j = 0; j < file->GetNumClusters(); j++ ) {
+			UpdatePortalTravelTable( table, j );
+		}
+	}
+
+	// free the area cache used to calculate the tables
+	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
+		DeleteOldestCache();
+	}
+
+	timer.Stop();
+
+	WritePortalTravelTables( fileName );
+
+	gameLocal.Printf( "calculated %d portal travel tables for %s in %d msec\n", numPortalTableTravelFlags, file->GetName(), (int) timer.Milliseconds() );
+}
+
+/*
+============
+idAASLocal::ShutdownPortalTravelTables
+============
+*/
+void idAASLocal::ShutdownPortalTravelTables( void ) {
+	idPortalTravelTable *table;
+
+	while( portalTables ) {
+		table = portalTables;
+		portalTables = table->next;
+		delete table;
+	}
+
+	Mem_Free( portalTableOffsets );
+	portalTableOffsets = NULL;
+	Mem_Free( portalTableIndex );
+	portalTableIndex = NULL;
+	portalTableSize = 0;
+}
+
+/*
+============
+idAASLocal::InvalidatePortalTravelTables
+============
+*/
+void idAASLocal::InvalidatePortalTravelTables( int clusterNum ) {
+	idPortalTravelTable *table;
+
+	for ( table = portalTables; table; table = table->next ) {
+		table->clusterValid[clusterNum] = 0;
+	}
+}
+
+/*
+============
+idAASLocal::GetPortalTravelTable
+============
+*/
+idPortalTravelTable *idAASLocal::GetPortalTravelTable( int travelFlags ) const {
+	idPortalTravelTable *table;
+
+	if ( !aas_portalTables.GetBool() ) {
+		return NULL;
+	}
+
+	for ( table = portalTables; table; table = table->next ) {
+		if ( table->travelFlags == travelFlags ) {
+			return table;
+		}
+	}
+
+	// the table list cannot grow while other threads may walk it, route without table instead
+	if ( concurrentRouting ) {
+		return NULL;
+	}
+
+	// the travel times for the clusters are calculated when they are first needed
+	table = new idPortalTravelTable( portalTableSize, file->GetNumClusters() );
+	table->travelFlags = travelFlags;
+	table->next = portalTables;
+	portalTables = table;
+	return table;
+}
+
+/*
+============
+idAASLocal::UpdatePortalTravelTable
+
+  calculates the travel times from every portal of the cluster to every other portal of the cluster
+============
+*/
+void idAASLocal::UpdatePortalTravelTable( idPortalTravelTable *table, int clusterNum ) const {
+	int i, j, clusterAreaNum;
+	const aasCluster_t *cluster;
+	unsigned short *travelTimes;
+	byte *reachabilities;
+	idRoutingCache *cache;
+	idSysSpinLock *lock;
+
+	// another thread may have updated the cluster while waiting for the lock
+	lock = &portalTableLocks[clusterNum & ( ROUTING_CACHE_LOCKS - 1 )];
+	lock->Lock();
+	if ( table->clusterValid[clusterNum] ) {
+		lock->Unlock();
+		return;
+	}
+
+	cluster = &file->GetCluster( clusterNum );
+
+	for ( j = 0; j < cluster->numPortals; j++ ) {
+		travelTimes = table->travelTimes + portalTableOffsets[clusterNum] + j * cluster->numPortals;
+		reachabilities = table->reachabilities + portalTableOffsets[clusterNum] + j * cluster->numPortals;
+		memset( travelTimes, 0, cluster->numPortals * sizeof( travelTimes[0] ) );
+		memset( reachabilities, 0, cluster->numPortals * sizeof( reachabilities[0] ) );
+
+		// get the cache of the portal area
+		clusterAreaNum = ClusterAreaNum( clusterNum, file->GetPortal( file->GetPortalIndex( cluster->firstPortal + j ) ).areaNum );
+		if ( clusterAreaNum >= cluster->numReachableAreas ) {
+			continue;
+		}
+		cache = GetAreaRoutingCache( clusterNum, file->GetPortal( file->GetPortalIndex( cluster->firstPortal + j ) ).areaNum, table->travelFlags );
+
+		for ( i = 0; i < cluster->numPortals; i++ ) {
+			clusterAreaNum = ClusterAreaNum( clusterNum, file->GetPortal( file->GetPortalIndex( cluster->firstPortal + i ) ).areaNum );
+			if ( clusterAreaNum >= cluster->numReachableAreas ) {
+				continue;
+			}
+			travelTimes[i] = cache->travelTimes[clusterAreaNum];
+			reachabilities[i] = cache->reachabilities[clusterAreaNum];
+		}
+	}
+
+	// the travel times have to be visible before the cluster is marked valid
+	Sys_InterlockedExchange( table->clusterValid[clusterNum], 1 );
+	lock->Unlock();
+}
+
+/*
+============
+idAASLocal::LoadPortalTravelTables
+============
+*/
+bool idAASLocal::LoadPortalTravelTables( const char *fileName ) {
+	int i, j, value, numTables;
+	ID_TIME_T aasTime;
+	idFile *f;
+	idPortalTravelTable *table;
+
+	if ( fileSystem->ReadFile( file->GetName(), NULL, &aasTime ) < 0 ) {
+		return false;
+	}
+
+	f = fileSystem->OpenFileRead( fileName );
+	if ( !f ) {
+		return false;
+	}
+
+	// the tables are only valid for the AAS file they were calculated for
+	f->ReadInt( value );
+	if ( value != PORTALTABLE_IDENT ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != PORTALTABLE_VERSION ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != (int) file->GetCRC() ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != (int) aasTime ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != file->GetNumAreas() ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != file->GetNumClusters() ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( value );
+	if ( value != portalTableSize ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	f->ReadInt( numTables );
+	if ( numTables < 0 || f->Length() != (int)( 8 * sizeof( int ) + numTables * ( sizeof( int ) + portalTableSize * ( sizeof( unsigned short ) + sizeof( byte ) ) ) ) ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	for ( i = 0; i < numTables; i++ ) {
+		f->ReadInt( value );
+		table = GetPortalTravelTable( value );
+		for ( j = 0; j < portalTableSize; j++ ) {
+			f->ReadUnsignedShort( table->travelTimes[j] );
+		}
+		f->Read( table->reachabilities, portalTableSize * sizeof( table->reachabilities[0] ) );
+		for ( j = 0; j < table->numClusters; j++ ) {
+			table->clusterValid[j] = 1;
+		}
+	}
+
+	fileSystem->CloseFile( f );
+
+	return true;
+}
+
+/*
+============
+idAASLocal::WritePortalTravelTables
+============
+*/
+void idAASLocal::WritePortalTravelTables( const char *fileName ) const {
+	int i, numTables;
+	ID_TIME_T aasTime;
+	idFile *f;
+	idPortalTravelTable *table;
+
+	if ( fileSystem->ReadFile( file->GetName(), NULL, &aasTime ) < 0 ) {
+		return;
+	}
+
+	f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't write %s", fileName );
+		return;
+	}
+
+	numTables = 0;
+	for ( table = portalTables; table; table = table->next ) {
+		numTables++;
+	}
+
+	f->WriteInt( PORTALTABLE_IDENT );
+	f->WriteInt( PORTALTABLE_VERSION );
+	f->WriteInt( file->GetCRC() );
+	f->WriteInt( aasTime );
+	f->WriteInt( file->GetNumAreas() );
+	f->WriteInt( file->GetNumClusters() );
+	f->WriteInt( portalTableSize );
+	f->WriteInt( numTables );
+
+	for ( table = portalTables; table; table = table->next ) {
+		f->WriteInt( table->travelFlags );
+		for ( i = 0; i < portalTableSize; i++ ) {
+			f->WriteUnsignedShort( table->travelTimes[i] );
+		}
+		f->Write( table->reachabilities, portalTableSize * sizeof( table->reachabilities[0] ) );
+	}
+
+	fileSystem->CloseFile( f );
 }
 
 /*
@@ -309,8 +710,9 @@ idAASLocal::RoutingStats
 */
 void idAASLocal::RoutingStats( void ) const {
 	idRoutingCache *cache;
-	int numAreaCache, numPortalCache;
-	int totalAreaCacheMemory, totalPortalCacheMemory;
+	idPortalTravelTable *table;
+	int numAreaCache, numPortalCache, numPortalTables;
+	int totalAreaCacheMemory, totalPortalCacheMemory, totalPortalTableMemory;
 
 	numAreaCache = numPortalCache = 0;
 	totalAreaCacheMemory = totalPortalCacheMemory = 0;
@@ -330,6 +732,13 @@ void idAASLocal::RoutingStats( void ) const {
 	gameLocal.Printf( "%6d area travel times (%d KB)\n", numAreaTravelTimes, ( numAreaTravelTimes * sizeof( unsigned short ) ) >> 10 );
 	gameLocal.Printf( "%6d area cache entries (%d KB)\n", areaCacheIndexSize, ( areaCacheIndexSize * sizeof( idRoutingCache * ) ) >> 10 );
 	gameLocal.Printf( "%6d portal cache entries (%d KB)\n", portalCacheIndexSize, ( portalCacheIndexSize * sizeof( idRoutingCache * ) ) >> 10 );
+
+	numPortalTables = totalPortalTableMemory = 0;
+	for ( table = portalTables; table; table = table->next ) {
+		numPortalTables++;
+		totalPortalTableMemory += table->Size();
+	}
+	gameLocal.Printf( "%6d portal travel tables (%d KB)\n", numPortalTables, totalPortalTableMemory >> 10 );
 }
 
 /*
@@ -340,15 +749,21 @@ idAASLocal::RemoveRoutingCacheUsingArea
 void idAASLocal::RemoveRoutingCacheUsingArea( int areaNum ) {
 	int clusterNum;
 
+	// area states may not change while other threads are routing
+	assert( !concurrentRouting );
+
 	clusterNum = file->GetArea( areaNum ).cluster;
 	if ( clusterNum > 0 ) {
 		// remove all the cache in the cluster the area is in
 		DeleteClusterCache( clusterNum );
+		InvalidatePortalTravelTables( clusterNum );
 	}
 	else {
 		// if this is a portal remove all cache in both the front and back cluster
 		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[0] );
 		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[1] );
+		InvalidatePortalTravelTables( file->GetPortal( -clusterNum ).clusters[0] );
+		InvalidatePortalTravelTables( file->GetPortal( -clusterNum ).clusters[1] );
 	}
 	DeletePortalCache();
 }
@@ -486,6 +901,9 @@ void idAASLocal::SetObstacleState( const idRoutingObstacle *obstacle, bool enabl
 	idReachability *reach, *rev_reach;
 	bool inside;
 
+	// obstacles may not change while other threads are routing
+	assert( !concurrentRouting );
+
 	for ( i = 0; i < obstacle->areas.Num(); i++ ) {
 
 		RemoveRoutingCacheUsingArea( obstacle->areas[i] );
@@ -591,7 +1009,8 @@ void idAASLocal::RemoveAllObstacles( void ) {
 ============
 idAASLocal::LinkCache
 
-  link the cache in the cache list sorted from oldest to newest cache
+  link the cache in the cache list sorted from oldest to newest cache,
+  while routing concurrently the caller has to hold the cache list lock
 ============
 */
 void idAASLocal::LinkCache( idRoutingCache *cache ) const {
@@ -647,6 +1066,15 @@ void idAASLocal::DeleteOldestCache( void ) const {
 	idRoutingCache *cache;
 
 	assert( cacheListStart );
+	assert( !concurrentRouting );
+
+	// cache used since the last pass gets a second chance at the end of the list,
+	// this way using a cache only has to set a flag instead of relinking it
+	while( cacheListStart->used ) {
+		cache = cacheListStart;
+		cache->used = false;
+		LinkCache( cache );
+	}
 
 	// unlink the oldest cache
 	cache = cacheListStart;
@@ -669,6 +1097,40 @@ void idAASLocal::DeleteOldestCache( void ) const {
 	delete cache;
 }
 
+/*
+============
+idAASLocal::GetThreadData
+============
+*/
+routingThreadData_t &idAASLocal::GetThreadData( void ) const {
+	int threadNum;
+
+	threadNum = jobSystem->GetThreadIndex();
+	if ( threadNum < 0 || threadNum >= numThreadData ) {
+		// sharing the update memory would corrupt the routing of the thread that owns it
+		if ( concurrentRouting ) {
+			gameLocal.Error( "idAASLocal::GetThreadData: thread %d has no routing memory during concurrent routing", threadNum );
+		}
+		// without concurrent routing only one thread routes at a time, so threads
+		// outside the job system can use the update memory of the main thread
+		threadNum = 0;
+	}
+	return threadData[threadNum];
+}
+
+/*
+============
+PublishRoutingCache
+
+  adds fully calculated cache to the front of a cache list, threads that look for cache walk the lists
+  without locking so the cache contents have to be visible before the cache itself
+============
+*/
+static void PublishRoutingCache( idRoutingCache **list, idRoutingCache *cache, idRoutingCache *next ) {
+	// the caller holds the lock for the list so the exchange always succeeds, it is only used as a memory barrier
+	Sys_InterlockedCompareExchangePointer( *(void * volatile *)list, next, cache );
+}
+
 /*
 ============
 idAASLocal::GetAreaReachability
@@ -712,9 +1174,12 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 	int i, nextAreaNum, cluster, badTravelFlags, clusterAreaNum, numReachableAreas;
 	unsigned short t, startAreaTravelTimes[MAX_REACH_PER_AREA];
 	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	idRoutingUpdate *areaUpdate;
 	idReachability *reach;
 	const aasArea_t *nextArea;
 
+	areaUpdate = GetThreadData().areaUpdate;
+
 	// number of reachability areas within this cluster
 	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
 
@@ -824,39 +1289,58 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 /*
 ============
 idAASLocal::GetAreaRoutingCache
+
+  Cache is never changed once it is in the cache lists, so looking for cache does not lock.
+  Only the thread that holds the lock for the list calculates missing cache. Locks are always
+  taken in the order portal cache lock, portal table lock and area cache lock.
 ============
 */
 idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
 	int clusterAreaNum;
 	idRoutingCache *cache, *clusterCache;
+	idSysSpinLock *lock;
 
 	// number of the area in the cluster
 	clusterAreaNum = ClusterAreaNum( clusterNum, areaNum );
-	// pointer to the cache for the area in the cluster
-	clusterCache = areaCacheIndex[clusterNum][clusterAreaNum];
 	// check if cache without undesired travel flags already exists
-	for ( cache = clusterCache; cache; cache = cache->next ) {
+	for ( cache = areaCacheIndex[clusterNum][clusterAreaNum]; cache; cache = cache->next ) {
 		if ( cache->travelFlags == travelFlags ) {
 			break;
 		}
 	}
 	// if no cache found
 	if ( !cache ) {
-		cache = new idRoutingCache( file->GetCluster( clusterNum ).numReachableAreas );
-		cache->type = CACHETYPE_AREA;
-		cache->cluster = clusterNum;
-		cache->areaNum = areaNum;
-		cache->startTravelTime = 1;
-		cache->travelFlags = travelFlags;
-		cache->prev = NULL;
-		cache->next = clusterCache;
-		if ( clusterCache ) {
-			clusterCache->prev = cache;
+		lock = &areaCacheLocks[( clusterNum * 31 + clusterAreaNum ) & ( ROUTING_CACHE_LOCKS - 1 )];
+		lock->Lock();
+		// pointer to the cache for the area in the cluster
+		clusterCache = areaCacheIndex[clusterNum][clusterAreaNum];
+		// another thread may have added the cache while waiting for the lock
+		for ( cache = clusterCache; cache; cache = cache->next ) {
+			if ( cache->travelFlags == travelFlags ) {
+				break;
+			}
 		}
-		areaCacheIndex[clusterNum][clusterAreaNum] = cache;
-		UpdateAreaRoutingCache( cache );
+		if ( !cache ) {
+			cache = new idRoutingCache( file->GetCluster( clusterNum ).numReachableAreas );
+			cache->type = CACHETYPE_AREA;
+			cache->cluster = clusterNum;
+			cache->areaNum = areaNum;
+			cache->startTravelTime = 1;
+			cache->travelFlags = travelFlags;
+			cache->prev = NULL;
+			cache->next = clusterCache;
+			UpdateAreaRoutingCache( cache );
+			if ( clusterCache ) {
+				clusterCache->prev = cache;
+			}
+			PublishRoutingCache( &areaCacheIndex[clusterNum][clusterAreaNum], cache, clusterCache );
+			cacheListLock.Lock();
+			LinkCache( cache );
+			cacheListLock.Unlock();
+		}
+		lock->Unlock();
 	}
-	LinkCache( cache );
+	cache->used = true;
 	return cache;
 }
 
@@ -866,12 +1350,16 @@ idAASLocal::UpdatePortalRoutingCache
 ============
 */
 void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
-	int i, portalNum, clusterAreaNum;
+	int i, portalNum, clusterAreaNum, reachNum, tableIndex;
 	unsigned short t;
 	const aasPortal_t *portal;
 	const aasCluster_t *cluster;
 	idRoutingCache *cache;
-	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	idRoutingUpdate *portalUpdate, *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	idPortalTravelTable *table;
+
+	portalUpdate = GetThreadData().portalUpdate;
+	table = GetPortalTravelTable( portalCache->travelFlags );
 
 	curUpdate = &portalUpdate[ file->GetNumPortals() ];
 	curUpdate->cluster = portalCache->cluster;
@@ -900,7 +1388,22 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 		curUpdate->isInList = false;
 
 		cluster = &file->GetCluster( curUpdate->cluster );
-		cache = GetAreaRoutingCache( curUpdate->cluster, curUpdate->areaNum, portalCache->travelFlags );
+
+		// the first update starts at the goal area, all other updates start at a portal area
+		// for which the travel times to the other portals of the cluster can be read from the portal table
+		if ( table && curUpdate != &portalUpdate[ file->GetNumPortals() ] ) {
+			if ( !table->clusterValid[curUpdate->cluster] ) {
+				UpdatePortalTravelTable( table, curUpdate->cluster );
+			}
+			portalNum = curUpdate - portalUpdate;
+			tableIndex = portalTableOffsets[curUpdate->cluster] +
+							portalTableIndex[portalNum * 2 + ( file->GetPortal( portalNum ).clusters[0] != curUpdate->cluster )] * cluster->numPortals;
+			cache = NULL;
+		}
+		else {
+			tableIndex = 0;
+			cache = GetAreaRoutingCache( curUpdate->cluster, curUpdate->areaNum, portalCache->travelFlags );
+		}
 
 		// take all portals of the cluster
 		for ( i = 0; i < cluster->numPortals; i++ ) {
@@ -908,12 +1411,19 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 			assert( portalNum < portalCache->size );
 			portal = &file->GetPortal( portalNum );
 
-			clusterAreaNum = ClusterAreaNum( curUpdate->cluster, portal->areaNum );
-			if ( clusterAreaNum >= cluster->numReachableAreas ) {
-				continue;
+			if ( cache ) {
+				clusterAreaNum = ClusterAreaNum( curUpdate->cluster, portal->areaNum );
+				if ( clusterAreaNum >= cluster->numReachableAreas ) {
+					continue;
+				}
+				t = cache->travelTimes[clusterAreaNum];
+				reachNum = cache->reachabilities[clusterAreaNum];
+			}
+			else {
+				t = table->travelTimes[tableIndex + i];
+				reachNum = table->reachabilities[tableIndex + i];
 			}
 
-			t = cache->travelTimes[clusterAreaNum];
 			if ( t == 0 ) {
 				continue;
 			}
@@ -922,7 +1432,7 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 			if ( !portalCache->travelTimes[portalNum] || t < portalCache->travelTimes[portalNum] ) {
 
 				portalCache->travelTimes[portalNum] = t;
-				portalCache->reachabilities[portalNum] = cache->reachabilities[clusterAreaNum];
+				portalCache->reachabilities[portalNum] = reachNum;
 				nextUpdate = &portalUpdate[portalNum];
 				if ( portal->clusters[0] == curUpdate->cluster ) {
 					nextUpdate->cluster = portal->clusters[1];
@@ -958,7 +1468,8 @@ idAASLocal::GetPortalRoutingCache
 ============
 */
 idRoutingCache *idAASLocal::GetPortalRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
-	idRoutingCache *cache;
+	idRoutingCache *cache, *areaCache;
+	idSysSpinLock *lock;
 
 	// check if cache without undesired travel flags already exists
 	for ( cache = portalCacheIndex[areaNum]; cache; cache = cache->next ) {
@@ -968,21 +1479,36 @@ idRoutingCache *idAASLocal::GetPortalRoutingCache( int clusterNum, int areaNum,
 	}
 	// if no cache found
 	if ( !cache ) {
-		cache = new idRoutingCache( file->GetNumPortals() );
-		cache->type = CACHETYPE_PORTAL;
-		cache->cluster = clusterNum;
-		cache->areaNum = areaNum;
-		cache->startTravelTime = 1;
-		cache->travelFlags = travelFlags;
-		cache->prev = NULL;
-		cache->next = portalCacheIndex[areaNum];
-		if ( portalCacheIndex[areaNum] ) {
-			portalCacheIndex[areaNum]->prev = cache;
+		lock = &portalCacheLocks[areaNum & ( ROUTING_CACHE_LOCKS - 1 )];
+		lock->Lock();
+		areaCache = portalCacheIndex[areaNum];
+		// another thread may have added the cache while waiting for the lock
+		for ( cache = areaCache; cache; cache = cache->next ) {
+			if ( cache->travelFlags == travelFlags ) {
+				break;
+			}
+		}
+		if ( !cache ) {
+			cache = new idRoutingCache( file->GetNumPortals() );
+			cache->type = CACHETYPE_PORTAL;
+			cache->cluster = clusterNum;
+			cache->areaNum = areaNum;
+			cache->startTravelTime = 1;
+			cache->travelFlags = travelFlags;
+			cache->prev = NULL;
+			cache->next = areaCache;
+			UpdatePortalRoutingCache( cache );
+			if ( areaCache ) {
+				areaCache->prev = cache;
+			}
+			PublishRoutingCache( &portalCacheIndex[areaNum], cache, areaCache );
+			cacheListLock.Lock();
+			LinkCache( cache );
+			cacheListLock.Unlock();
 		}
-		portalCacheIndex[areaNum] = cache;
-		UpdatePortalRoutingCache( cache );
+		lock->Unlock();
 	}
-	LinkCache( cache );
+	cache->used = true;
 	return cache;
 }
 
@@ -1019,8 +1545,11 @@ bool idAASLocal::RouteToGoalArea( int areaNum, const idVec3 origin, int goalArea
 		return false;
 	}
 
-	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
-		DeleteOldestCache();
+	// cache can only be freed while no other thread is routing
+	if ( !concurrentRouting ) {
+		while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
+			DeleteOldestCache();
+		}
 	}
 
 	clusterNum = file->GetArea( areaNum ).cluster;
@@ -1169,7 +1698,8 @@ idAASLocal::FindNearestGoal
 bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 origin, const idVec3 &target, int travelFlags, aasObstacle_t *obstacles, int numObstacles, idAASCallback &callback ) const {
 	int i, j, k, badTravelFlags, nextAreaNum, bestAreaNum;
 	unsigned short t, bestTravelTime;
-	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	idRoutingUpdate *areaUpdate, *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
+	unsigned short *goalAreaTravelTimes;
 	idReachability *reach;
 	const aasArea_t *nextArea;
 	idVec3 v1, v2, p;
@@ -1194,6 +1724,9 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 		obstacles[k].expAbsBounds[1] = obstacles[k].absBounds[1] - file->GetSettings().boundingBoxes[0][0];
 	}
 	
+	areaUpdate = GetThreadData().areaUpdate;
+	goalAreaTravelTimes = GetThreadData().goalAreaTravelTimes;
+
 	badTravelFlags = ~travelFlags;
 	SIMDProcessor->Memset( goalAreaTravelTimes, 0, file->GetNumAreas() * sizeof( unsigned short ) );
 
@@ -1347,3 +1880,32 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 
 	return false;
 }
+
+/*
+============
+idAASLocal::BeginConcurrentRouting
+============
+*/
+void idAASLocal::BeginConcurrentRouting( void ) {
+	assert( !concurrentRouting );
+	concurrentRouting = true;
+}
+
+/*
+============
+idAASLocal::EndConcurrentRouting
+============
+*/
+void idAASLocal::EndConcurrentRouting( void ) {
+	assert( concurrentRouting );
+	concurrentRouting = false;
+
+	if ( !file ) {
+		return;
+	}
+
+	// free the cache that was kept while routing concurrently
+	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
+		DeleteOldestCache();
+	}
+}
@@ -31,6 +31,8 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "../Game_local.h"
 
+static const int MAX_FINDENEMY_BATCH = 32;
+
 /***********************************************************************
 
 	AI Events
@@ -343,11 +345,14 @@ idAI::Event_FindEnemy
 =====================
 */
 void idAI::Event_FindEnemy( int useFOV ) {
-	int			i;
+	int			i, numActors;
 	idEntity	*ent;
 	idActor		*actor;
+	idEntity	*actors[ MAX_CLIENTS ];
+	bool		visible[ MAX_CLIENTS ];
 
 	if ( gameLocal.InPlayerPVS( this ) ) {
+		numActors = 0;
 		for ( i = 0; i < gameLocal.numClients ; i++ ) {
 			ent = gameLocal.entities[ i ];
 
@@ -360,9 +365,16 @@ void idAI::Event_FindEnemy( int useFOV ) {
 				continue;
 			}
 
-			if ( CanSee( actor, useFOV != 0 ) ) {
-				idThread::ReturnEntity( actor );
-				return;
+			actors[ numActors++ ] = actor;
+		}
+
+		// return the first visible client, with all sight traces done at once
+		if ( CanSeeBatch( actors, numActors, useFOV != 0, visible ) ) {
+			for ( i = 0; i < numActors; i++ ) {
+				if ( visible[ i ] ) {
+					idThread::ReturnEntity( actors[ i ] );
+					return;
+				}
 			}
 		}
 	}
@@ -383,12 +395,34 @@ void idAI::Event_FindEnemyAI( int useFOV ) {
 	float		dist;
 	idVec3		delta;
 	pvsHandle_t pvs;
+	idEntity	*candidates[ MAX_FINDENEMY_BATCH ];
+	float		candidateDist[ MAX_FINDENEMY_BATCH ];
+	bool		visible[ MAX_FINDENEMY_BATCH ];
+	int			i, numCandidates;
 
 	pvs = gameLocal.pvs.SetupCurrentPVS( GetPVSAreas(), GetNumPVSAreas() );
 
+	// the candidates are collected and checked for sight in batches, visiting
+	// them in order afterwards picks the same enemy as checking them one by one
 	bestDist = idMath::INFINITY;
 	bestEnemy = NULL;
-	for ( ent = gameLocal.activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
+	numCandidates = 0;
+	for ( ent = gameLocal.activeEntities.Next(); ; ent = ent->activeNode.Next() ) {
+		if ( numCandidates == MAX_FINDENEMY_BATCH || ( ent == NULL && numCandidates ) ) {
+			CanSeeBatch( candidates, numCandidates, useFOV != 0, visible );
+			for ( i = 0; i < numCandidates; i++ ) {
+				if ( visible[ i ] && candidateDist[ i ] < bestDist ) {
+					bestDist = candidateDist[ i ];
+					bestEnemy = static_cast<idActor *>( candidates[ i ] );
+				}
+			}
+			numCandidates = 0;
+		}
+
+		if ( ent == NULL ) {
+			break;
+		}
+
 		if ( ent->fl.hidden || ent->fl.isDormant || !ent->IsType( idActor::Type ) ) {
 			continue;
 		}
@@ -404,9 +438,10 @@ void idAI::Event_FindEnemyAI( int useFOV ) {
 
 		delta = physicsObj.GetOrigin() - actor->GetPhysics()->GetOrigin();
 		dist = delta.LengthSqr();
-		if ( ( dist < bestDist ) && CanSee( actor, useFOV != 0 ) ) {
-			bestDist = dist;
-			bestEnemy = actor;
+		if ( dist < bestDist ) {
+			candidates[ numCandidates ] = actor;
+			candidateDist[ numCandidates ] = dist;
+			numCandidates++;
 		}
 	}
 
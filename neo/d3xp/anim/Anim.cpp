@@ -33,6 +33,17 @@ If you have questions concerning this license or the applicable additional terms
 
 bool idAnimManager::forceExport = false;
 
+/*
+After a .md5anim file has been parsed the frames are quantized and the anim is
+written to a .bmd5anim file in the save path.  Later loads read the binary file
+if it was written from a .md5anim file with the same time stamp and length.
+*/
+
+#define MD5_BINARYANIM_EXT		"bmd5anim"
+
+const int MD5_BINARYANIM_IDENT		= ( 'B' << 24 ) + ( '5' << 16 ) + ( 'D' << 8 ) + 'M';
+const int MD5_BINARYANIM_VERSION	= 1;
+
 /***********************************************************************
 
 	idMD5Anim
@@ -50,6 +61,10 @@ idMD5Anim::idMD5Anim() {
 	numJoints	= 0;
 	frameRate	= 24;
 	animLength	= 0;
+	numAnimatedComponents = 0;
+	numTranslations = 0;
+	numRotations = 0;
+	frameSize	= 0;
 	totaldelta.Zero();
 }
 
@@ -73,12 +88,20 @@ void idMD5Anim::Free( void ) {
 	frameRate	= 24;
 	animLength	= 0;
 	name		= "";
+	numAnimatedComponents = 0;
+	numTranslations = 0;
+	numRotations = 0;
+	frameSize	= 0;
 
 	totaldelta.Zero();
 
 	jointInfo.Clear();
 	bounds.Clear();
+	componentJoints.Clear();
+	componentScale.Clear();
+	componentBias.Clear();
 	componentFrames.Clear();
+	jointLanes.Clear();
 }
 
 /*
@@ -146,7 +169,8 @@ idMD5Anim::Allocated
 ====================
 */
 size_t idMD5Anim::Allocated( void ) const {
-	size_t	size = bounds.Allocated() + jointInfo.Allocated() + componentFrames.Allocated() + name.Allocated();
+	size_t	size = bounds.Allocated() + jointInfo.Allocated() + baseFrame.Allocated() + componentJoints.Allocated() + componentScale.Allocated() +
+					componentBias.Allocated() + componentFrames.Allocated() + jointLanes.Allocated() + name.Allocated();
 	return size;
 }
 
@@ -161,6 +185,19 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	idToken	token;
 	int		i, j;
 	int		num;
+	idStr	binaryFileName;
+	ID_TIME_T	sourceTimeStamp;
+	int		sourceLength;
+
+	binaryFileName = filename;
+	binaryFileName.SetFileExtension( MD5_BINARYANIM_EXT );
+
+	// use the binary file if it was written from this exact .md5anim file
+	sourceLength = fileSystem->ReadFile( filename, NULL, &sourceTimeStamp );
+	if ( g_binaryAnims.GetBool() && sourceLength >= 0 && LoadBinaryAnim( binaryFileName, sourceTimeStamp, sourceLength ) ) {
+		name = filename;
+		return true;
+	}
 
 	if ( !parser.LoadFile( filename ) ) {
 		return false;
@@ -267,10 +304,10 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	parser.ExpectTokenString( "}" );
 
 	// parse frames
-	componentFrames.SetGranularity( 1 );
-	componentFrames.SetNum( numAnimatedComponents * numFrames );
+	idList<float> frames;
+	frames.SetNum( numAnimatedComponents * numFrames );
 
-	float *componentPtr = componentFrames.Ptr();
+	float *componentPtr = frames.Ptr();
 	for( i = 0; i < numFrames; i++ ) {
 		parser.ExpectTokenString( "frame" );
 		num = parser.ParseInt();
@@ -286,47 +323,470 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 		parser.ExpectTokenString( "}" );
 	}
 
-	// get total move delta
+	// make the origin movement relative to the base frame
+	if ( numAnimatedComponents ) {
+		componentPtr = &frames[ jointInfo[ 0 ].firstComponent ];
+		for ( j = 0; j < 3; j++ ) {
+			if ( jointInfo[ 0 ].animBits & ( ANIM_TX << j ) ) {
+				for( i = 0; i < numFrames; i++ ) {
+					componentPtr[ numAnimatedComponents * i ] -= baseFrame[ 0 ].t[ j ];
+				}
+				componentPtr++;
+			}
+		}
+	}
+	baseFrame[ 0 ].t.Zero();
+
+	QuantizeFrames( frames.Ptr() );
+	SetupJointLanes();
+
+	// get total move delta from the quantized last frame so cycling anims line up exactly
+	totaldelta.Zero();
+	if ( numAnimatedComponents ) {
+		GetRootTranslation( numFrames - 1, totaldelta );
+	}
+
+	// we don't count last frame because it would cause a 1 frame pause at the end
+	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
+
+	if ( g_binaryAnims.GetBool() && sourceLength >= 0 && !parser.HadError() ) {
+		WriteBinaryAnim( binaryFileName, sourceTimeStamp, sourceLength );
+	}
+
+	// done
+	return true;
+}
+
+/*
+====================
+QuantizeComponent
+
+Scales one component to its range over all frames.
+====================
+*/
+static void QuantizeComponent( const float *src, int srcStride, unsigned short *dst, int dstStride, int numFrames, float &scale, float &bias ) {
+	int i, value;
+	float min, max;
+
+	min = max = src[ 0 ];
+	for ( i = 1; i < numFrames; i++ ) {
+		if ( src[ i * srcStride ] < min ) {
+			min = src[ i * srcStride ];
+		} else if ( src[ i * srcStride ] > max ) {
+			max = src[ i * srcStride ];
+		}
+	}
+
+	bias = min;
+	scale = ( max - min ) / 65535.0f;
+	if ( scale <= 0.0f ) {
+		scale = 0.0f;
+		return;
+	}
+
+	for ( i = 0; i < numFrames; i++ ) {
+		value = idMath::Ftoi( ( src[ i * srcStride ] - min ) / scale + 0.5f );
+		dst[ i * dstStride ] = idMath::ClampInt( 0, 65535, value );
+	}
+}
+
+/*
+====================
+idMD5Anim::QuantizeFrames
+
+Stores the animated joints as 16 bit components in structure of arrays layout.
+Each frame holds the x, y and z lanes of the joints with animated translation
+components followed by those of the joints with animated rotation components.
+Every component is scaled to its own range over all frames, components that
+are not animated are constant at their base frame value.
+====================
+*/
+void idMD5Anim::QuantizeFrames( const float *frames ) {
+	int i, j, c, t, r, tLane, rLane, animBits;
+	const float *componentPtr;
+
+	numTranslations = 0;
+	numRotations = 0;
+	for ( i = 0; i < numJoints; i++ ) {
+		if ( jointInfo[ i ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) {
+			numTranslations++;
+		}
+		if ( jointInfo[ i ].animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) {
+			numRotations++;
+		}
+	}
+
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	r = ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	frameSize = 3 * ( t + r );
+
+	// padding lanes decompress to zero and are never written to a joint
+	componentJoints.SetGranularity( 1 );
+	componentJoints.AssureSize( t + r, 0 );
+	componentScale.SetGranularity( 1 );
+	componentScale.AssureSize( frameSize, 0.0f );
+	componentBias.SetGranularity( 1 );
+	componentBias.AssureSize( frameSize, 0.0f );
+	componentFrames.SetGranularity( 1 );
+	componentFrames.AssureSize( frameSize * numFrames, 0 );
+
 	if ( !numAnimatedComponents ) {
-		totaldelta.Zero();
-	} else {
-		componentPtr = &componentFrames[ jointInfo[ 0 ].firstComponent ];
-		if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
-			for( i = 0; i < numFrames; i++ ) {
-				componentPtr[ numAnimatedComponents * i ] -= baseFrame[ 0 ].t.x;
+		return;
+	}
+
+	tLane = 0;
+	rLane = 0;
+	for ( i = 0; i < numJoints; i++ ) {
+		animBits = jointInfo[ i ].animBits;
+		componentPtr = frames + jointInfo[ i ].firstComponent;
+
+		if ( animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) {
+			componentJoints[ tLane ] = i;
+			for ( j = 0; j < 3; j++ ) {
+				c = j * t + tLane;
+				if ( animBits & ( ANIM_TX << j ) ) {
+					QuantizeComponent( componentPtr++, numAnimatedComponents, &componentFrames[ c ], frameSize, numFrames, componentScale[ c ], componentBias[ c ] );
+				} else {
+					componentBias[ c ] = baseFrame[ i ].t[ j ];
+				}
 			}
-			totaldelta.x = componentPtr[ numAnimatedComponents * ( numFrames - 1 ) ];
-			componentPtr++;
-		} else {
-			totaldelta.x = 0.0f;
+			tLane++;
 		}
-		if ( jointInfo[ 0 ].animBits & ANIM_TY ) {
-			for( i = 0; i < numFrames; i++ ) {
-				componentPtr[ numAnimatedComponents * i ] -= baseFrame[ 0 ].t.y;
+
+		if ( animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) {
+			componentJoints[ t + rLane ] = i;
+			for ( j = 0; j < 3; j++ ) {
+				c = 3 * t + j * r + rLane;
+				if ( animBits & ( ANIM_QX << j ) ) {
+					QuantizeComponent( componentPtr++, numAnimatedComponents, &componentFrames[ c ], frameSize, numFrames, componentScale[ c ], componentBias[ c ] );
+				} else {
+					componentBias[ c ] = baseFrame[ i ].q[ j ];
+				}
+			}
+			rLane++;
+		}
+	}
+}
+
+/*
+====================
+idMD5Anim::SetupJointLanes
+
+Maps each joint back to its translation and rotation lane so single joints
+can be decompressed without going through the whole frame.
+====================
+*/
+void idMD5Anim::SetupJointLanes( void ) {
+	int i, t;
+
+	jointLanes.SetGranularity( 1 );
+	jointLanes.SetNum( numJoints * 2 );
+	for ( i = 0; i < jointLanes.Num(); i++ ) {
+		jointLanes[ i ] = -1;
+	}
+
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	for ( i = 0; i < numTranslations; i++ ) {
+		jointLanes[ componentJoints[ i ] * 2 + 0 ] = i;
+	}
+	for ( i = 0; i < numRotations; i++ ) {
+		jointLanes[ componentJoints[ t + i ] * 2 + 1 ] = i;
+	}
+}
+
+/*
+====================
+idMD5Anim::DecompressFrame
+
+Only writes the animated joints, the others keep what is in the joints array.
+====================
+*/
+void idMD5Anim::DecompressFrame( int framenum, idJointQuat *joints ) const {
+	SIMDProcessor->DecompressJoints( joints, &componentFrames[ framenum * frameSize ], componentScale.Ptr(), componentBias.Ptr(), componentJoints.Ptr(), numTranslations, numRotations );
+}
+
+/*
+====================
+idMD5Anim::DecompressJoints
+
+Like DecompressFrame but only for the joints in the index list.
+====================
+*/
+void idMD5Anim::DecompressJoints( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const {
+	int i, j, k, c, t, r, lane;
+	const unsigned short *frame;
+
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	r = ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	frame = &componentFrames[ framenum * frameSize ];
+
+	for ( i = 0; i < numIndexes; i++ ) {
+		j = index[ i ];
+
+		lane = jointLanes[ j * 2 + 0 ];
+		if ( lane >= 0 ) {
+			idVec3 &v = joints[ j ].t;
+			for ( k = 0; k < 3; k++ ) {
+				c = k * t + lane;
+				v[ k ] = componentBias[ c ] + componentScale[ c ] * (float) frame[ c ];
 			}
-			totaldelta.y = componentPtr[ numAnimatedComponents * ( numFrames - 1 ) ];
-			componentPtr++;
-		} else {
-			totaldelta.y = 0.0f;
 		}
-		if ( jointInfo[ 0 ].animBits & ANIM_TZ ) {
-			for( i = 0; i < numFrames; i++ ) {
-				componentPtr[ numAnimatedComponents * i ] -= baseFrame[ 0 ].t.z;
+
+		lane = jointLanes[ j * 2 + 1 ];
+		if ( lane >= 0 ) {
+			idQuat &q = joints[ j ].q;
+			for ( k = 0; k < 3; k++ ) {
+				c = 3 * t + k * r + lane;
+				q[ k ] = componentBias[ c ] + componentScale[ c ] * (float) frame[ c ];
 			}
-			totaldelta.z = componentPtr[ numAnimatedComponents * ( numFrames - 1 ) ];
-		} else {
-			totaldelta.z = 0.0f;
+			q.w = q.CalcW();
 		}
 	}
-	baseFrame[ 0 ].t.Zero();
+}
+
+/*
+====================
+idMD5Anim::GetRootTranslation
+====================
+*/
+void idMD5Anim::GetRootTranslation( int framenum, idVec3 &translation ) const {
+	int j, c, t;
+	const unsigned short *frame;
+
+	if ( !( jointInfo[ 0 ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) ) {
+		translation = baseFrame[ 0 ].t;
+		return;
+	}
+
+	// the root joint is always in the first translation lane
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	frame = &componentFrames[ framenum * frameSize ];
+	for ( j = 0; j < 3; j++ ) {
+		c = j * t;
+		translation[ j ] = componentBias[ c ] + componentScale[ c ] * (float) frame[ c ];
+	}
+}
+
+/*
+====================
+idMD5Anim::GetRootRotation
+====================
+*/
+void idMD5Anim::GetRootRotation( int framenum, idQuat &rotation ) const {
+	int j, c, t, r;
+	const unsigned short *frame;
+
+	if ( !( jointInfo[ 0 ].animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) ) {
+		rotation = baseFrame[ 0 ].q;
+		return;
+	}
+
+	// the root joint is always in the first rotation lane
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	r = ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	frame = &componentFrames[ framenum * frameSize ];
+	for ( j = 0; j < 3; j++ ) {
+		c = 3 * t + j * r;
+		rotation[ j ] = componentBias[ c ] + componentScale[ c ] * (float) frame[ c ];
+	}
+	rotation.w = rotation.CalcW();
+}
+
+/*
+====================
+idMD5Anim::LoadBinaryAnim
+====================
+*/
+bool idMD5Anim::LoadBinaryAnim( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	int i, value, length;
+	void *buffer;
+	idStr jointName;
+
+	length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory f( fileName, (const char *)buffer, length );
+
+	Free();
+
+	// the binary file is only valid for the .md5anim file it was written from
+	f.ReadInt( value );
+	if ( value != MD5_BINARYANIM_IDENT ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	f.ReadInt( value );
+	if ( value != MD5_BINARYANIM_VERSION ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	f.ReadInt( value );
+	if ( value != (int) sourceTimeStamp ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	f.ReadInt( value );
+	if ( value != sourceLength ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	f.ReadInt( numFrames );
+	f.ReadInt( frameRate );
+	f.ReadInt( numJoints );
+	f.ReadInt( numAnimatedComponents );
+	f.ReadInt( numTranslations );
+	f.ReadInt( numRotations );
+	f.ReadInt( frameSize );
+	if ( numFrames <= 0 || frameRate < 0 || numJoints <= 0 || numTranslations < 0 || numTranslations > numJoints || numRotations < 0 || numRotations > numJoints ||
+			frameSize != 3 * ( ( ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 ) ) + ( ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 ) ) ) ) {
+		fileSystem->FreeFile( buffer );
+		Free();
+		return false;
+	}
+
+	jointInfo.SetGranularity( 1 );
+	jointInfo.SetNum( numJoints );
+	for ( i = 0; i < numJoints; i++ ) {
+		f.ReadString( jointName );
+		jointInfo[ i ].nameIndex = animationLib.JointIndex( jointName );
+		f.ReadInt( jointInfo[ i ].parentNum );
+		f.ReadInt( jointInfo[ i ].animBits );
+		f.ReadInt( jointInfo[ i ].firstComponent );
+	}
+
+	// everything after the joint names has a fixed size
+	if ( f.Length() - f.Tell() != (int)( numFrames * sizeof( idBounds ) + numJoints * 7 * sizeof( float ) + sizeof( idVec3 ) +
+			frameSize / 3 * sizeof( int ) + frameSize * 2 * sizeof( float ) + numFrames * frameSize * sizeof( unsigned short ) ) ) {
+		fileSystem->FreeFile( buffer );
+		Free();
+		return false;
+	}
+
+	bounds.SetGranularity( 1 );
+	bounds.SetNum( numFrames );
+	for ( i = 0; i < numFrames; i++ ) {
+		f.ReadVec3( bounds[ i ][ 0 ] );
+		f.ReadVec3( bounds[ i ][ 1 ] );
+	}
+
+	baseFrame.SetGranularity( 1 );
+	baseFrame.SetNum( numJoints );
+	for ( i = 0; i < numJoints; i++ ) {
+		f.ReadFloat( baseFrame[ i ].q.x );
+		f.ReadFloat( baseFrame[ i ].q.y );
+		f.ReadFloat( baseFrame[ i ].q.z );
+		f.ReadFloat( baseFrame[ i ].q.w );
+		f.ReadVec3( baseFrame[ i ].t );
+	}
+
+	f.ReadVec3( totaldelta );
+
+	componentJoints.SetGranularity( 1 );
+	componentJoints.SetNum( frameSize / 3 );
+	for ( i = 0; i < componentJoints.Num(); i++ ) {
+		f.ReadInt( componentJoints[ i ] );
+		if ( componentJoints[ i ] < 0 || componentJoints[ i ] >= numJoints ) {
+			fileSystem->FreeFile( buffer );
+			Free();
+			return false;
+		}
+	}
+
+	componentScale.SetGranularity( 1 );
+	componentScale.SetNum( frameSize );
+	componentBias.SetGranularity( 1 );
+	componentBias.SetNum( frameSize );
+	for ( i = 0; i < frameSize; i++ ) {
+		f.ReadFloat( componentScale[ i ] );
+		f.ReadFloat( componentBias[ i ] );
+	}
+
+	componentFrames.SetGranularity( 1 );
+	componentFrames.SetNum( numFrames * frameSize );
+	for ( i = 0; i < componentFrames.Num(); i++ ) {
+		f.ReadUnsignedShort( componentFrames[ i ] );
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	SetupJointLanes();
 
 	// we don't count last frame because it would cause a 1 frame pause at the end
 	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
 
-	// done
 	return true;
 }
 
+/*
+====================
+idMD5Anim::WriteBinaryAnim
+====================
+*/
+void idMD5Anim::WriteBinaryAnim( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) const {
+	int i;
+	idFile *f;
+
+	f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't write %s", fileName );
+		return;
+	}
+
+	f->WriteInt( MD5_BINARYANIM_IDENT );
+	f->WriteInt( MD5_BINARYANIM_VERSION );
+	f->WriteInt( sourceTimeStamp );
+	f->WriteInt( sourceLength );
+
+	f->WriteInt( numFrames );
+	f->WriteInt( frameRate );
+	f->WriteInt( numJoints );
+	f->WriteInt( numAnimatedComponents );
+	f->WriteInt( numTranslations );
+	f->WriteInt( numRotations );
+	f->WriteInt( frameSize );
+
+	// joint name indexes are only valid for this session
+	for ( i = 0; i < numJoints; i++ ) {
+		f->WriteString( animationLib.JointName( jointInfo[ i ].nameIndex ) );
+		f->WriteInt( jointInfo[ i ].parentNum );
+		f->WriteInt( jointInfo[ i ].animBits );
+		f->WriteInt( jointInfo[ i ].firstComponent );
+	}
+
+	for ( i = 0; i < numFrames; i++ ) {
+		f->WriteVec3( bounds[ i ][ 0 ] );
+		f->WriteVec3( bounds[ i ][ 1 ] );
+	}
+
+	for ( i = 0; i < numJoints; i++ ) {
+		f->WriteFloat( baseFrame[ i ].q.x );
+		f->WriteFloat( baseFrame[ i ].q.y );
+		f->WriteFloat( baseFrame[ i ].q.z );
+		f->WriteFloat( baseFrame[ i ].q.w );
+		f->WriteVec3( baseFrame[ i ].t );
+	}
+
+	f->WriteVec3( totaldelta );
+
+	for ( i = 0; i < componentJoints.Num(); i++ ) {
+		f->WriteInt( componentJoints[ i ] );
+	}
+
+	for ( i = 0; i < frameSize; i++ ) {
+		f->WriteFloat( componentScale[ i ] );
+		f->WriteFloat( componentBias[ i ] );
+	}
+
+	for ( i = 0; i < componentFrames.Num(); i++ ) {
+		f->WriteUnsignedShort( componentFrames[ i ] );
+	}
+
+	fileSystem->CloseFile( f );
+}
+
 /*
 ====================
 idMD5Anim::IncreaseRefs
@@ -433,6 +893,7 @@ idMD5Anim::GetOrigin
 */
 void idMD5Anim::GetOrigin( idVec3 &offset, int time, int cyclecount ) const {
 	frameBlend_t frame;
+	idVec3 offset1, offset2;
 
 	offset = baseFrame[ 0 ].t;
 	if ( !( jointInfo[ 0 ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) ) {
@@ -442,24 +903,9 @@ void idMD5Anim::GetOrigin( idVec3 &offset, int time, int cyclecount ) const {
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
-
-	if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
-		offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-		componentPtr1++;
-		componentPtr2++;
-	}
-
-	if ( jointInfo[ 0 ].animBits & ANIM_TY ) {
-		offset.y = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-		componentPtr1++;
-		componentPtr2++;
-	}
-
-	if ( jointInfo[ 0 ].animBits & ANIM_TZ ) {
-		offset.z = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-	}
+	GetRootTranslation( frame.frame1, offset1 );
+	GetRootTranslation( frame.frame2, offset2 );
+	offset = offset1 * frame.frontlerp + offset2 * frame.backlerp;
 
 	if ( frame.cycleCount ) {
 		offset += totaldelta * ( float )frame.cycleCount;
@@ -473,10 +919,10 @@ idMD5Anim::GetOriginRotation
 */
 void idMD5Anim::GetOriginRotation( idQuat &rotation, int time, int cyclecount ) const {
 	frameBlend_t	frame;
-	int				animBits;
-	
-	animBits = jointInfo[ 0 ].animBits;
-	if ( !( animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) ) {
+	idQuat			q1;
+	idQuat			q2;
+
+	if ( !( jointInfo[ 0 ].animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) ) {
 		// just use the baseframe		
 		rotation = baseFrame[ 0 ].q;
 		return;
@@ -484,99 +930,8 @@ void idMD5Anim::GetOriginRotation( idQuat &rotation, int time, int cyclecount )
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float	*jointframe1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float	*jointframe2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
-
-	if ( animBits & ANIM_TX ) {
-		jointframe1++;
-		jointframe2++;
-	}
-
-	if ( animBits & ANIM_TY ) {
-		jointframe1++;
-		jointframe2++;
-	}
-
-	if ( animBits & ANIM_TZ ) {
-		jointframe1++;
-		jointframe2++;
-	}
-
-	idQuat q1;
-	idQuat q2;
-
-	switch( animBits & (ANIM_QX|ANIM_QY|ANIM_QZ) ) {
-		case ANIM_QX:
-			q1.x = jointframe1[0];
-			q2.x = jointframe2[0];
-			q1.y = baseFrame[ 0 ].q.y;
-			q2.y = q1.y;
-			q1.z = baseFrame[ 0 ].q.z;
-			q2.z = q1.z;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QY:
-			q1.y = jointframe1[0];
-			q2.y = jointframe2[0];
-			q1.x = baseFrame[ 0 ].q.x;
-			q2.x = q1.x;
-			q1.z = baseFrame[ 0 ].q.z;
-			q2.z = q1.z;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QZ:
-			q1.z = jointframe1[0];
-			q2.z = jointframe2[0];
-			q1.x = baseFrame[ 0 ].q.x;
-			q2.x = q1.x;
-			q1.y = baseFrame[ 0 ].q.y;
-			q2.y = q1.y;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QX|ANIM_QY:
-			q1.x = jointframe1[0];
-			q1.y = jointframe1[1];
-			q2.x = jointframe2[0];
-			q2.y = jointframe2[1];
-			q1.z = baseFrame[ 0 ].q.z;
-			q2.z = q1.z;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QX|ANIM_QZ:
-			q1.x = jointframe1[0];
-			q1.z = jointframe1[1];
-			q2.x = jointframe2[0];
-			q2.z = jointframe2[1];
-			q1.y = baseFrame[ 0 ].q.y;
-			q2.y = q1.y;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QY|ANIM_QZ:
-			q1.y = jointframe1[0];
-			q1.z = jointframe1[1];
-			q2.y = jointframe2[0];
-			q2.z = jointframe2[1];
-			q1.x = baseFrame[ 0 ].q.x;
-			q2.x = q1.x;
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-		case ANIM_QX|ANIM_QY|ANIM_QZ:
-			q1.x = jointframe1[0];
-			q1.y = jointframe1[1];
-			q1.z = jointframe1[2];
-			q2.x = jointframe2[0];
-			q2.y = jointframe2[1];
-			q2.z = jointframe2[2];
-			q1.w = q1.CalcW();
-			q2.w = q2.CalcW();
-			break;
-	}
+	GetRootRotation( frame.frame1, q1 );
+	GetRootRotation( frame.frame2, q2 );
 
 	rotation.Slerp( q1, q2, frame.backlerp );
 }
@@ -588,7 +943,7 @@ idMD5Anim::GetBounds
 */
 void idMD5Anim::GetBounds( idBounds &bnds, int time, int cyclecount ) const {
 	frameBlend_t	frame;
-	idVec3			offset;
+	idVec3			offset, offset1, offset2;
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
@@ -598,24 +953,9 @@ void idMD5Anim::GetBounds( idBounds &bnds, int time, int cyclecount ) const {
 	// origin position
 	offset = baseFrame[ 0 ].t;
 	if ( jointInfo[ 0 ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) {
-		const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-		const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
-
-		if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
-			offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-			componentPtr1++;
-			componentPtr2++;
-		}
-
-		if ( jointInfo[ 0 ].animBits & ANIM_TY ) {
-			offset.y = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-			componentPtr1++;
-			componentPtr2++;
-		}
-
-		if ( jointInfo[ 0 ].animBits & ANIM_TZ ) {
-			offset.z = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-		}
+		GetRootTranslation( frame.frame1, offset1 );
+		GetRootTranslation( frame.frame2, offset2 );
+		offset = offset1 * frame.frontlerp + offset2 * frame.backlerp;
 	}
 
 	bnds[ 0 ] -= offset;
@@ -625,19 +965,14 @@ void idMD5Anim::GetBounds( idBounds &bnds, int time, int cyclecount ) const {
 /*
 ====================
 idMD5Anim::GetInterpolatedFrame
+
+All animated joints are decompressed, only the joints in the index list are
+interpolated.  The other animated joints are left at frame1.
 ====================
 */
 void idMD5Anim::GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) const {
 	int						i, numLerpJoints;
-	const float				*frame1;
-	const float				*frame2;
-	const float				*jointframe1;
-	const float				*jointframe2;
-	const jointAnimInfo_t	*infoPtr;
-	int						animBits;
 	idJointQuat				*blendJoints;
-	idJointQuat				*jointPtr;
-	idJointQuat				*blendPtr;
 	int						*lerpIndex;
 
 	// copy the baseframe
@@ -648,164 +983,26 @@ void idMD5Anim::GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints,
 		return;
 	}
 
-	blendJoints = (idJointQuat *)_alloca16( baseFrame.Num() * sizeof( blendPtr[ 0 ] ) );
-	lerpIndex = (int *)_alloca16( baseFrame.Num() * sizeof( lerpIndex[ 0 ] ) );
-	numLerpJoints = 0;
+	DecompressFrame( frame.frame1, joints );
 
-	frame1 = &componentFrames[ frame.frame1 * numAnimatedComponents ];
-	frame2 = &componentFrames[ frame.frame2 * numAnimatedComponents ];
+	if ( frame.backlerp > 0.0f ) {
+		blendJoints = (idJointQuat *)_alloca16( baseFrame.Num() * sizeof( blendJoints[ 0 ] ) );
+		lerpIndex = (int *)_alloca16( baseFrame.Num() * sizeof( lerpIndex[ 0 ] ) );
+		numLerpJoints = 0;
 
-	for ( i = 0; i < numIndexes; i++ ) {
-		int j = index[i];
-		jointPtr = &joints[j];
-		blendPtr = &blendJoints[j];
-		infoPtr = &jointInfo[j];
-
-		animBits = infoPtr->animBits;
-		if ( animBits ) {
-
-			lerpIndex[numLerpJoints++] = j;
-
-			jointframe1 = frame1 + infoPtr->firstComponent;
-			jointframe2 = frame2 + infoPtr->firstComponent;
-
-			switch( animBits & (ANIM_TX|ANIM_TY|ANIM_TZ) ) {
-				case 0:
-					blendPtr->t = jointPtr->t;
-					break;
-				case ANIM_TX:
-					jointPtr->t.x = jointframe1[0];
-					blendPtr->t.x = jointframe2[0];
-					blendPtr->t.y = jointPtr->t.y;
-					blendPtr->t.z = jointPtr->t.z;
-					jointframe1++;
-					jointframe2++;
-					break;
-				case ANIM_TY:
-					jointPtr->t.y = jointframe1[0];
-					blendPtr->t.y = jointframe2[0];
-					blendPtr->t.x = jointPtr->t.x;
-					blendPtr->t.z = jointPtr->t.z;
-					jointframe1++;
-					jointframe2++;
-					break;
-				case ANIM_TZ:
-					jointPtr->t.z = jointframe1[0];
-					blendPtr->t.z = jointframe2[0];
-					blendPtr->t.x = jointPtr->t.x;
-					blendPtr->t.y = jointPtr->t.y;
-					jointframe1++;
-					jointframe2++;
-					break;
-				case ANIM_TX|ANIM_TY:
-					jointPtr->t.x = jointframe1[0];
-					jointPtr->t.y = jointframe1[1];
-					blendPtr->t.x = jointframe2[0];
-					blendPtr->t.y = jointframe2[1];
-					blendPtr->t.z = jointPtr->t.z;
-					jointframe1 += 2;
-					jointframe2 += 2;
-					break;
-				case ANIM_TX|ANIM_TZ:
-					jointPtr->t.x = jointframe1[0];
-					jointPtr->t.z = jointframe1[1];
-					blendPtr->t.x = jointframe2[0];
-					blendPtr->t.z = jointframe2[1];
-					blendPtr->t.y = jointPtr->t.y;
-					jointframe1 += 2;
-					jointframe2 += 2;
-					break;
-				case ANIM_TY|ANIM_TZ:
-					jointPtr->t.y = jointframe1[0];
-					jointPtr->t.z = jointframe1[1];
-					blendPtr->t.y = jointframe2[0];
-					blendPtr->t.z = jointframe2[1];
-					blendPtr->t.x = jointPtr->t.x;
-					jointframe1 += 2;
-					jointframe2 += 2;
-					break;
-				case ANIM_TX|ANIM_TY|ANIM_TZ:
-					jointPtr->t.x = jointframe1[0];
-					jointPtr->t.y = jointframe1[1];
-					jointPtr->t.z = jointframe1[2];
-					blendPtr->t.x = jointframe2[0];
-					blendPtr->t.y = jointframe2[1];
-					blendPtr->t.z = jointframe2[2];
-					jointframe1 += 3;
-					jointframe2 += 3;
-					break;
-			}
+		// joints with only translation or only rotation animated need the base frame for the other half
+		SIMDProcessor->Memcpy( blendJoints, baseFrame.Ptr(), baseFrame.Num() * sizeof( baseFrame[ 0 ] ) );
+		DecompressFrame( frame.frame2, blendJoints );
 
-			switch( animBits & (ANIM_QX|ANIM_QY|ANIM_QZ) ) {
-				case 0:
-					blendPtr->q = jointPtr->q;
-					break;
-				case ANIM_QX:
-					jointPtr->q.x = jointframe1[0];
-					blendPtr->q.x = jointframe2[0];
-					blendPtr->q.y = jointPtr->q.y;
-					blendPtr->q.z = jointPtr->q.z;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QY:
-					jointPtr->q.y = jointframe1[0];
-					blendPtr->q.y = jointframe2[0];
-					blendPtr->q.x = jointPtr->q.x;
-					blendPtr->q.z = jointPtr->q.z;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QZ:
-					jointPtr->q.z = jointframe1[0];
-					blendPtr->q.z = jointframe2[0];
-					blendPtr->q.x = jointPtr->q.x;
-					blendPtr->q.y = jointPtr->q.y;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QX|ANIM_QY:
-					jointPtr->q.x = jointframe1[0];
-					jointPtr->q.y = jointframe1[1];
-					blendPtr->q.x = jointframe2[0];
-					blendPtr->q.y = jointframe2[1];
-					blendPtr->q.z = jointPtr->q.z;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QX|ANIM_QZ:
-					jointPtr->q.x = jointframe1[0];
-					jointPtr->q.z = jointframe1[1];
-					blendPtr->q.x = jointframe2[0];
-					blendPtr->q.z = jointframe2[1];
-					blendPtr->q.y = jointPtr->q.y;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QY|ANIM_QZ:
-					jointPtr->q.y = jointframe1[0];
-					jointPtr->q.z = jointframe1[1];
-					blendPtr->q.y = jointframe2[0];
-					blendPtr->q.z = jointframe2[1];
-					blendPtr->q.x = jointPtr->q.x;
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
-				case ANIM_QX|ANIM_QY|ANIM_QZ:
-					jointPtr->q.x = jointframe1[0];
-					jointPtr->q.y = jointframe1[1];
-					jointPtr->q.z = jointframe1[2];
-					blendPtr->q.x = jointframe2[0];
-					blendPtr->q.y = jointframe2[1];
-					blendPtr->q.z = jointframe2[2];
-					jointPtr->q.w = jointPtr->q.CalcW();
-					blendPtr->q.w = blendPtr->q.CalcW();
-					break;
+		for ( i = 0; i < numIndexes; i++ ) {
+			int j = index[i];
+			if ( jointInfo[j].animBits ) {
+				lerpIndex[numLerpJoints++] = j;
 			}
 		}
-	}
 
-	SIMDProcessor->BlendJoints( joints, blendJoints, frame.backlerp, lerpIndex, numLerpJoints );
+		SIMDProcessor->BlendJoints( joints, blendJoints, frame.backlerp, lerpIndex, numLerpJoints );
+	}
 
 	if ( frame.cycleCount ) {
 		joints[ 0 ].t += totaldelta * ( float )frame.cycleCount;
@@ -815,15 +1012,11 @@ void idMD5Anim::GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints,
 /*
 ====================
 idMD5Anim::GetSingleFrame
+
+Like GetInterpolatedFrame all animated joints are decompressed.
 ====================
 */
 void idMD5Anim::GetSingleFrame( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const {
-	int						i;
-	const float				*frame;
-	const float				*jointframe;
-	int						animBits;
-	idJointQuat				*jointPtr;
-	const jointAnimInfo_t	*infoPtr;
 
 	// copy the baseframe
 	SIMDProcessor->Memcpy( joints, baseFrame.Ptr(), baseFrame.Num() * sizeof( baseFrame[ 0 ] ) );
@@ -833,51 +1026,79 @@ void idMD5Anim::GetSingleFrame( int framenum, idJointQuat *joints, const int *in
 		return;
 	}
 
-	frame = &componentFrames[ framenum * numAnimatedComponents ];
+	DecompressFrame( framenum, joints );
+}
 
-	for ( i = 0; i < numIndexes; i++ ) {
-		int j = index[i];
-		jointPtr = &joints[j];
-		infoPtr = &jointInfo[j];
+/*
+====================
+idMD5Anim::GetInterpolatedJoints
 
-		animBits = infoPtr->animBits;
-		if ( animBits ) {
+Only the joints in the index list are decompressed and written, the other
+joints are left alone.
+====================
+*/
+void idMD5Anim::GetInterpolatedJoints( frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) const {
+	int						i, j, numLerpJoints;
+	bool					hasOrigin;
+	idJointQuat				*blendJoints;
+	int						*lerpIndex;
 
-			jointframe = frame + infoPtr->firstComponent;
+	hasOrigin = false;
+	for ( i = 0; i < numIndexes; i++ ) {
+		j = index[i];
+		joints[j] = baseFrame[j];
+		hasOrigin |= ( j == 0 );
+	}
 
-			if ( animBits & (ANIM_TX|ANIM_TY|ANIM_TZ) ) {
+	if ( !numAnimatedComponents ) {
+		// just use the base frame
+		return;
+	}
 
-				if ( animBits & ANIM_TX ) {
-					jointPtr->t.x = *jointframe++;
-				}
+	DecompressJoints( frame.frame1, joints, index, numIndexes );
 
-				if ( animBits & ANIM_TY ) {
-					jointPtr->t.y = *jointframe++;
-				}
+	if ( frame.backlerp > 0.0f ) {
+		blendJoints = (idJointQuat *)_alloca16( baseFrame.Num() * sizeof( blendJoints[ 0 ] ) );
+		lerpIndex = (int *)_alloca16( baseFrame.Num() * sizeof( lerpIndex[ 0 ] ) );
+		numLerpJoints = 0;
 
-				if ( animBits & ANIM_TZ ) {
-					jointPtr->t.z = *jointframe++;
-				}
+		for ( i = 0; i < numIndexes; i++ ) {
+			j = index[i];
+			if ( jointInfo[j].animBits ) {
+				blendJoints[j] = baseFrame[j];
+				lerpIndex[numLerpJoints++] = j;
 			}
+		}
 
-			if ( animBits & (ANIM_QX|ANIM_QY|ANIM_QZ) ) {
+		DecompressJoints( frame.frame2, blendJoints, lerpIndex, numLerpJoints );
+		SIMDProcessor->BlendJoints( joints, blendJoints, frame.backlerp, lerpIndex, numLerpJoints );
+	}
 
-				if ( animBits & ANIM_QX ) {
-					jointPtr->q.x = *jointframe++;
-				}
+	if ( frame.cycleCount && hasOrigin ) {
+		joints[ 0 ].t += totaldelta * ( float )frame.cycleCount;
+	}
+}
 
-				if ( animBits & ANIM_QY ) {
-					jointPtr->q.y = *jointframe++;
-				}
+/*
+====================
+idMD5Anim::GetSingleJoints
 
-				if ( animBits & ANIM_QZ ) {
-					jointPtr->q.z = *jointframe;
-				}
+Like GetInterpolatedJoints only the joints in the index list are written.
+====================
+*/
+void idMD5Anim::GetSingleJoints( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const {
+	int i;
 
-				jointPtr->q.w = jointPtr->q.CalcW();
-			}
-		}
+	for ( i = 0; i < numIndexes; i++ ) {
+		joints[ index[ i ] ] = baseFrame[ index[ i ] ];
 	}
+
+	if ( ( framenum == 0 ) || !numAnimatedComponents ) {
+		// just use the base frame
+		return;
+	}
+
+	DecompressJoints( framenum, joints, index, numIndexes );
 }
 
 /*
@@ -923,6 +1144,8 @@ idAnimManager::idAnimManager
 ====================
 */
 idAnimManager::idAnimManager() {
+	poseCacheHits = 0;
+	poseCacheMisses = 0;
 }
 
 /*
@@ -943,6 +1166,11 @@ void idAnimManager::Shutdown( void ) {
 	animations.DeleteContents();
 	jointnames.Clear();
 	jointnamesHash.Free();
+	poses.Clear();
+	poseJoints.Clear();
+	poseHash.Free();
+	poseCacheHits = 0;
+	poseCacheMisses = 0;
 }
 
 /*
@@ -988,6 +1216,9 @@ void idAnimManager::ReloadAnims( void ) {
 	int			i;
 	idMD5Anim	**animptr;
 
+	// the cached poses are invalid once the anims change
+	ClearPoseCache();
+
 	for( i = 0; i < animations.Num(); i++ ) {
 		animptr = animations.GetIndex( i );
 		if ( animptr && *animptr ) {
@@ -1080,8 +1311,148 @@ void idAnimManager::FlushUnusedAnims( void ) {
 		}
 	}
 
+	if ( removeAnims.Num() ) {
+		ClearPoseCache();
+	}
+
 	for( i = 0; i < removeAnims.Num(); i++ ) {
 		animations.Remove( removeAnims[ i ]->Name() );
 		delete removeAnims[ i ];
 	}
 }
+
+/*
+====================
+idAnimManager::ClearPoseCache
+====================
+*/
+void idAnimManager::ClearPoseCache( void ) {
+	int maxJoints;
+
+	if ( g_showAnimPoseCache.GetBool() && ( poseCacheHits || poseCacheMisses ) ) {
+		gameLocal.Printf( "anim pose cache: %4d hits %4d misses (%.0f%%), %d poses, %d KB\n", poseCacheHits, poseCacheMisses,
+							100.0f * poseCacheHits / ( poseCacheHits + poseCacheMisses ), poses.Num(), ( poseJoints.Num() * (int)sizeof( idJointQuat ) ) >> 10 );
+	}
+
+	poses.SetNum( 0, false );
+	poseJoints.SetNum( 0, false );
+	poseHash.Clear();
+	poseCacheHits = 0;
+	poseCacheMisses = 0;
+
+	// the joint memory is allocated once so it never moves while poses are added
+	maxJoints = Max( 0, g_animPoseCacheSize.GetInteger() ) * 1024 / sizeof( idJointQuat );
+	if ( poseJoints.NumAllocated() != maxJoints ) {
+		poseJoints.Resize( maxJoints );
+	}
+}
+
+/*
+====================
+idAnimManager::FindPose
+====================
+*/
+const idJointQuat *idAnimManager::FindPose( const idMD5Anim *anim, const frameBlend_t &frame, const int *index, int numIndexes, int &hash ) const {
+	int i;
+
+	hash = ( (int)(size_t)anim >> 4 ) ^ ( (int)(size_t)index >> 2 ) ^ ( frame.frame1 * 4099 ) ^ ( frame.frame2 * 131 ) ^ ( frame.cycleCount * 8191 ) ^ reinterpret_cast<const int &>( frame.backlerp );
+	for ( i = poseHash.First( hash ); i != -1; i = poseHash.Next( i ) ) {
+		const animPose_t &pose = poses[i];
+		if ( pose.anim == anim && pose.index == index && pose.numIndexes == numIndexes && pose.cycleCount == frame.cycleCount && pose.frame1 == frame.frame1 && pose.frame2 == frame.frame2 &&
+				pose.frontlerp == frame.frontlerp && pose.backlerp == frame.backlerp ) {
+			return &poseJoints[pose.firstJoint];
+		}
+	}
+	return NULL;
+}
+
+/*
+====================
+idAnimManager::AddPose
+====================
+*/
+void idAnimManager::AddPose( int hash, const idMD5Anim *anim, const frameBlend_t &frame, const int *index, int numIndexes, const idJointQuat *joints ) {
+	animPose_t pose;
+
+	// just stop caching when the cache is full until it is cleared
+	if ( poseJoints.Num() + anim->NumJoints() > poseJoints.NumAllocated() ) {
+		return;
+	}
+
+	pose.anim = anim;
+	pose.index = index;
+	pose.numIndexes = numIndexes;
+	pose.cycleCount = frame.cycleCount;
+	pose.frame1 = frame.frame1;
+	pose.frame2 = frame.frame2;
+	pose.frontlerp = frame.frontlerp;
+	pose.backlerp = frame.backlerp;
+	pose.firstJoint = poseJoints.Num();
+
+	poseJoints.SetNum( pose.firstJoint + anim->NumJoints(), false );
+	SIMDProcessor->Memcpy( &poseJoints[pose.firstJoint], joints, anim->NumJoints() * sizeof( joints[0] ) );
+	poseHash.Add( hash, poses.Append( pose ) );
+}
+
+/*
+====================
+idAnimManager::GetInterpolatedFrame
+
+  the frame only depends on the anim, the frame blend including the cycle count and the joints of the channel
+  so entities playing the same anim at the same time can share it
+====================
+*/
+void idAnimManager::GetInterpolatedFrame( const idMD5Anim *anim, frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) {
+	const idJointQuat *pose;
+	int hash;
+
+	if ( !g_animPoseCache.GetBool() ) {
+		anim->GetInterpolatedFrame( frame, joints, index, numIndexes );
+		return;
+	}
+
+	pose = FindPose( anim, frame, index, numIndexes, hash );
+	if ( pose ) {
+		SIMDProcessor->Memcpy( joints, pose, anim->NumJoints() * sizeof( joints[0] ) );
+		poseCacheHits++;
+		return;
+	}
+
+	anim->GetInterpolatedFrame( frame, joints, index, numIndexes );
+	AddPose( hash, anim, frame, index, numIndexes, joints );
+	poseCacheMisses++;
+}
+
+/*
+====================
+idAnimManager::GetSingleFrame
+====================
+*/
+void idAnimManager::GetSingleFrame( const idMD5Anim *anim, int framenum, idJointQuat *joints, const int *index, int numIndexes ) {
+	const idJointQuat *pose;
+	frameBlend_t frame;
+	int hash;
+
+	if ( !g_animPoseCache.GetBool() ) {
+		anim->GetSingleFrame( framenum, joints, index, numIndexes );
+		return;
+	}
+
+	// a negative backlerp keeps single frames apart from interpolated frames
+	frame.cycleCount = 0;
+	frame.frame1 = framenum;
+	frame.frame2 = framenum;
+	frame.frontlerp = 0.0f;
+	frame.backlerp = -1.0f;
+
+	pose = FindPose( anim, frame, index, numIndexes, hash );
+	if ( pose ) {
+		SIMDProcessor->Memcpy( joints, pose, anim->NumJoints() * sizeof( joints[0] ) );
+		poseCacheHits++;
+		return;
+	}
+
+	anim->GetSingleFrame( framenum, joints, index, numIndexes );
+	AddPose( hash, anim, frame, index, numIndexes, joints );
+	poseCacheMisses++;
+}
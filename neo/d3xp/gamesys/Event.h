@@ -84,8 +84,11 @@ public:
 
 class idSaveGame;
 class idRestoreGame;
+class idEventHeap;
 
 class idEvent {
+	friend class idEventHeap;
+
 private:
 	const idEventDef			*eventdef;
 	byte						*data;
@@ -93,7 +96,10 @@ private:
 	idClass						*object;
 	const idTypeInfo			*typeinfo;
 
-	idLinkList<idEvent>			eventNode;
+	idLinkList<idEvent>			eventNode;		// free list
+	idEventHeap *				heap;			// heap the event is scheduled in
+	int							heapIndex;		// index in the heap, 0 when not scheduled
+	unsigned int				sequence;		// orders events scheduled for the same time
 
 	static idDynamicBlockAlloc<byte, 16 * 1024, 256> eventDataAllocator;
 
@@ -49,6 +49,15 @@ extern idCVar	g_doubleVision;
 extern idCVar	g_muzzleFlash;
 
 extern idCVar	g_disasm;
+extern idCVar	g_scriptCache;
+extern idCVar	g_scriptProfile;
+extern idCVar	g_clipTree;
+extern idCVar	g_animPoseCache;
+extern idCVar	g_animPoseCacheSize;
+extern idCVar	g_binaryAnims;
+extern idCVar	g_animLOD;
+extern idCVar	g_showAnimLOD;
+extern idCVar	g_showAnimPoseCache;
 extern idCVar	g_debugBounds;
 extern idCVar	g_debugAnim;
 extern idCVar	g_debugMove;
@@ -265,6 +274,7 @@ extern idCVar	aas_pullPlayer;
 extern idCVar	aas_randomPullPlayer;
 extern idCVar	aas_goalArea;
 extern idCVar	aas_showPushIntoArea;
+extern idCVar	aas_portalTables;
 
 extern idCVar	net_clientPredictGUI;
 
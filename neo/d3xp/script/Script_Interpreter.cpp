@@ -31,6 +31,18 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "../Game_local.h"
 
+int idInterpreter::statementCount = 0;
+
+idList<scriptProfile_t>		idInterpreter::profile;
+idList<int>					idInterpreter::profileStatements;
+int *						idInterpreter::profileHits = NULL;
+idList<scriptTraceCall_t>	idInterpreter::profileTrace;
+idInterpreter *				idInterpreter::profileActive = NULL;
+double						idInterpreter::profileMark = 0.0;
+int							idInterpreter::profileCharge = 0;
+
+#define MAX_SCRIPT_TRACE_CALLS	262144
+
 /*
 ================
 idInterpreter::idInterpreter()
@@ -42,9 +54,21 @@ idInterpreter::idInterpreter() {
 	debug = 0;
 	memset( localstack, 0, sizeof( localstack ) );
 	memset( callStack, 0, sizeof( callStack ) );
+	memset( profileEnterTicks, 0, sizeof( profileEnterTicks ) );
 	Reset();
 }
 
+/*
+================
+idInterpreter::~idInterpreter()
+================
+*/
+idInterpreter::~idInterpreter() {
+	if ( profileActive == this ) {
+		profileActive = NULL;
+	}
+}
+
 /*
 ================
 idInterpreter::Save
@@ -166,6 +190,7 @@ void idInterpreter::Reset( void ) {
 	popParms = 0;
 	multiFrameEvent = NULL;
 	eventEntity = NULL;
+	profileEvent = NULL;
 
 	currentFunction = 0;
 	NextInstruction( 0 );
@@ -591,10 +616,18 @@ void idInterpreter::EnterFunction( const function_t *func, bool clearStack ) {
 		}
 	}
 
+	if ( g_scriptProfile.GetBool() && profileActive == this ) {
+		ProfileCharge();
+	}
+
 	currentFunction = func;
 	assert( !func->eventdef );
 	NextInstruction( func->firstStatement );
 
+	if ( g_scriptProfile.GetBool() ) {
+		ProfileEnterFunction();
+	}
+
 	// allocate space on the stack for locals
 	// parms are already on stack
 	c = func->locals - func->parmTotal;
@@ -660,6 +693,10 @@ void idInterpreter::LeaveFunction( idVarDef *returnDef ) {
 		}
 	}
 
+	if ( g_scriptProfile.GetBool() ) {
+		ProfileLeaveFunction();
+	}
+
 	// up stack
 	callStackDepth--;
 	stack = &callStack[ callStackDepth ]; 
@@ -791,7 +828,13 @@ void idInterpreter::CallEvent( const function_t *func, int argsize ) {
 	}
 
 	popParms = argsize;
-	eventEntity->ProcessEventArgPtr( evdef, data );
+	if ( g_scriptProfile.GetBool() ) {
+		double startTicks = ProfileBeginEvent( func );
+		eventEntity->ProcessEventArgPtr( evdef, data );
+		ProfileEndEvent( func, startTicks );
+	} else {
+		eventEntity->ProcessEventArgPtr( evdef, data );
+	}
 
 	if ( !multiFrameEvent ) {
 		if ( popParms ) {
@@ -921,16 +964,64 @@ void idInterpreter::CallSysEvent( const function_t *func, int argsize ) {
 	}
 
 	popParms = argsize;
-	thread->ProcessEventArgPtr( evdef, data );
+	if ( g_scriptProfile.GetBool() ) {
+		double startTicks = ProfileBeginEvent( func );
+		thread->ProcessEventArgPtr( evdef, data );
+		ProfileEndEvent( func, startTicks );
+	} else {
+		thread->ProcessEventArgPtr( evdef, data );
+	}
 	if ( popParms ) {
 		PopParms( popParms );
 	}
 	popParms = 0;
 }
 
+#if defined( __GNUC__ ) && !defined( ID_SCRIPT_SWITCH_DISPATCH )
+#define ID_SCRIPT_THREADED_DISPATCH
+#endif
+
+#define SCRIPT_RUNAWAY			5000000
+
+#ifdef ID_SCRIPT_THREADED_DISPATCH
+
+#define SCRIPT_OPCODE( op )		op_##op
+
+#define SCRIPT_DISPATCH()												\
+	if ( doneProcessing || threadDying ) {								\
+		goto done;														\
+	}																	\
+	instructionPointer++;												\
+	if ( !--runaway ) {													\
+		Error( "runaway loop error" );									\
+	}																	\
+	if ( profileHits ) {												\
+		profileHits[ instructionPointer ]++;							\
+	}																	\
+	st = &gameLocal.program.GetStatement( instructionPointer );			\
+	assert( st->op < NUM_OPCODES );										\
+	goto *dispatchTable[ st->op ]
+
+#else
+
+#define SCRIPT_OPCODE( op )		case op
+#define SCRIPT_DISPATCH()		break
+
+#endif
+
+// the jump of a compare and jump superinstruction is the next statement
+#define SCRIPT_FUSED_IFNOT()												\
+	instructionPointer++;												\
+	if ( *var_c.intPtr == 0 ) {											\
+		NextInstruction( instructionPointer + gameLocal.program.GetStatement( instructionPointer ).b->value.jumpOffset );	\
+	}
+
 /*
 ====================
 idInterpreter::Execute
+
+With gcc the statements are dispatched through a table of label addresses, with
+the dispatch copied to the end of every opcode.  Otherwise a switch is used.
 ====================
 */
 bool idInterpreter::Execute( void ) {
@@ -944,19 +1035,62 @@ bool idInterpreter::Execute( void ) {
 	float		floatVal;
 	idScriptObject *obj;
 	const function_t *func;
+	idInterpreter *profileCaller;
+	bool		profiling;
 
 	if ( threadDying || !currentFunction ) {
 		return true;
 	}
 
+	profiling = g_scriptProfile.GetBool();
+	profileCaller = NULL;
+	if ( profiling ) {
+		profileCaller = ProfileBeginExecute();
+	}
+
 	if ( multiFrameEvent ) {
 		// move to previous instruction and call it again
 		instructionPointer--;
 	}
 
-	runaway = 5000000;
+	runaway = SCRIPT_RUNAWAY;
 
 	doneProcessing = false;
+
+#ifdef ID_SCRIPT_THREADED_DISPATCH
+	// one entry for each opcode, in the order of the opcode enum
+	static void * const dispatchTable[] = {
+		&&op_OP_RETURN, &&op_OP_UINC_F, &&op_OP_UINCP_F, &&op_OP_UDEC_F, &&op_OP_UDECP_F, &&op_OP_COMP_F,
+		&&op_OP_MUL_F, &&op_OP_MUL_V, &&op_OP_MUL_FV, &&op_OP_MUL_VF, &&op_OP_DIV_F, &&op_OP_MOD_F,
+		&&op_OP_ADD_F, &&op_OP_ADD_V, &&op_OP_ADD_S, &&op_OP_ADD_FS, &&op_OP_ADD_SF, &&op_OP_ADD_VS, &&op_OP_ADD_SV,
+		&&op_OP_SUB_F, &&op_OP_SUB_V,
+		&&op_OP_EQ_F, &&op_OP_EQ_V, &&op_OP_EQ_S, &&op_OP_EQ_E, &&op_OP_EQ_EO, &&op_OP_EQ_OE, &&op_OP_EQ_OO,
+		&&op_OP_NE_F, &&op_OP_NE_V, &&op_OP_NE_S, &&op_OP_NE_E, &&op_OP_NE_EO, &&op_OP_NE_OE, &&op_OP_NE_OO,
+		&&op_OP_LE, &&op_OP_GE, &&op_OP_LT, &&op_OP_GT,
+		&&op_OP_INDIRECT_F, &&op_OP_INDIRECT_V, &&op_OP_INDIRECT_S, &&op_OP_INDIRECT_ENT, &&op_OP_INDIRECT_BOOL, &&op_OP_INDIRECT_OBJ,
+		&&op_OP_ADDRESS,
+		&&op_OP_EVENTCALL, &&op_OP_OBJECTCALL, &&op_OP_SYSCALL,
+		&&op_OP_STORE_F, &&op_OP_STORE_V, &&op_OP_STORE_S, &&op_OP_STORE_ENT, &&op_OP_STORE_BOOL, &&op_OP_STORE_OBJENT, &&op_OP_STORE_OBJ, &&op_OP_STORE_ENTOBJ,
+		&&op_OP_STORE_FTOS, &&op_OP_STORE_BTOS, &&op_OP_STORE_VTOS, &&op_OP_STORE_FTOBOOL, &&op_OP_STORE_BOOLTOF,
+		&&op_OP_STOREP_F, &&op_OP_STOREP_V, &&op_OP_STOREP_S, &&op_OP_STOREP_ENT, &&op_OP_STOREP_FLD, &&op_OP_STOREP_BOOL, &&op_OP_STOREP_OBJ, &&op_OP_STOREP_OBJENT,
+		&&op_OP_STOREP_FTOS, &&op_OP_STOREP_BTOS, &&op_OP_STOREP_VTOS, &&op_OP_STOREP_FTOBOOL, &&op_OP_STOREP_BOOLTOF,
+		&&op_OP_UMUL_F, &&op_OP_UMUL_V, &&op_OP_UDIV_F, &&op_OP_UDIV_V, &&op_OP_UMOD_F, &&op_OP_UADD_F, &&op_OP_UADD_V, &&op_OP_USUB_F, &&op_OP_USUB_V, &&op_OP_UAND_F, &&op_OP_UOR_F,
+		&&op_OP_NOT_BOOL, &&op_OP_NOT_F, &&op_OP_NOT_V, &&op_OP_NOT_S, &&op_OP_NOT_ENT,
+		&&op_OP_NEG_F, &&op_OP_NEG_V,
+		&&op_OP_INT_F, &&op_OP_IF, &&op_OP_IFNOT,
+		&&op_OP_CALL, &&op_OP_THREAD, &&op_OP_OBJTHREAD,
+		&&op_OP_PUSH_F, &&op_OP_PUSH_V, &&op_OP_PUSH_S, &&op_OP_PUSH_ENT, &&op_OP_PUSH_OBJ, &&op_OP_PUSH_OBJENT, &&op_OP_PUSH_FTOS, &&op_OP_PUSH_BTOF, &&op_OP_PUSH_FTOB, &&op_OP_PUSH_VTOS, &&op_OP_PUSH_BTOS,
+		&&op_OP_GOTO,
+		&&op_OP_AND, &&op_OP_AND_BOOLF, &&op_OP_AND_FBOOL, &&op_OP_AND_BOOLBOOL, &&op_OP_OR, &&op_OP_OR_BOOLF, &&op_OP_OR_FBOOL, &&op_OP_OR_BOOLBOOL,
+		&&op_OP_BITAND, &&op_OP_BITOR,
+		&&op_OP_EQ_F_IFNOT, &&op_OP_NE_F_IFNOT, &&op_OP_LE_IFNOT, &&op_OP_GE_IFNOT, &&op_OP_LT_IFNOT, &&op_OP_GT_IFNOT, &&op_OP_INDIRECT_F_EQ_F, &&op_OP_INDIRECT_F_NE_F,
+		&&op_OP_BREAK, &&op_OP_CONTINUE
+	};
+	assert( ( sizeof( dispatchTable ) / sizeof( dispatchTable[ 0 ] ) ) == NUM_OPCODES );
+
+	SCRIPT_DISPATCH();
+	{
+#else
 	while( !doneProcessing && !threadDying ) {
 		instructionPointer++;
 
@@ -964,24 +1098,29 @@ bool idInterpreter::Execute( void ) {
 			Error( "runaway loop error" );
 		}
 
+		if ( profileHits ) {
+			profileHits[ instructionPointer ]++;
+		}
+
 		// next statement
 		st = &gameLocal.program.GetStatement( instructionPointer );
 
 		switch( st->op ) {
-		case OP_RETURN:
+#endif
+		SCRIPT_OPCODE( OP_RETURN ):
 			LeaveFunction( st->a );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_THREAD:
+		SCRIPT_OPCODE( OP_THREAD ):
 			newThread = new idThread( this, st->a->value.functionPtr, st->b->value.argSize );
 			newThread->Start();
 
 			// return the thread number to the script
 			gameLocal.program.ReturnFloat( newThread->GetThreadNum() );
 			PopParms( st->b->value.argSize );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_OBJTHREAD:
+		SCRIPT_OPCODE( OP_OBJTHREAD ):
 			var_a = GetVariable( st->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
@@ -997,17 +1136,17 @@ bool idInterpreter::Execute( void ) {
 				gameLocal.program.ReturnFloat( 0.0f );
 			}
 			PopParms( st->c->value.argSize );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_CALL:
+		SCRIPT_OPCODE( OP_CALL ):
 			EnterFunction( st->a->value.functionPtr, false );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_EVENTCALL:
+		SCRIPT_OPCODE( OP_EVENTCALL ):
 			CallEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_OBJECTCALL:	
+		SCRIPT_OPCODE( OP_OBJECTCALL ):
 			var_a = GetVariable( st->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
@@ -1019,116 +1158,116 @@ bool idInterpreter::Execute( void ) {
 				gameLocal.program.ReturnString( "" );
 				PopParms( st->c->value.argSize );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_SYSCALL:
+		SCRIPT_OPCODE( OP_SYSCALL ):
 			CallSysEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_IFNOT:
+		SCRIPT_OPCODE( OP_IFNOT ):
 			var_a = GetVariable( st->a );
 			if ( *var_a.intPtr == 0 ) {
 				NextInstruction( instructionPointer + st->b->value.jumpOffset );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_IF:
+		SCRIPT_OPCODE( OP_IF ):
 			var_a = GetVariable( st->a );
 			if ( *var_a.intPtr != 0 ) {
 				NextInstruction( instructionPointer + st->b->value.jumpOffset );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_GOTO:
+		SCRIPT_OPCODE( OP_GOTO ):
 			NextInstruction( instructionPointer + st->a->value.jumpOffset );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_F:
+		SCRIPT_OPCODE( OP_ADD_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = *var_a.floatPtr + *var_b.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_V:
+		SCRIPT_OPCODE( OP_ADD_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.vectorPtr = *var_a.vectorPtr + *var_b.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_S:
+		SCRIPT_OPCODE( OP_ADD_S ):
 			SetString( st->c, GetString( st->a ) );
 			AppendString( st->c, GetString( st->b ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_FS:
+		SCRIPT_OPCODE( OP_ADD_FS ):
 			var_a = GetVariable( st->a );
 			SetString( st->c, FloatToString( *var_a.floatPtr ) );
 			AppendString( st->c, GetString( st->b ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_SF:
+		SCRIPT_OPCODE( OP_ADD_SF ):
 			var_b = GetVariable( st->b );
 			SetString( st->c, GetString( st->a ) );
 			AppendString( st->c, FloatToString( *var_b.floatPtr ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_VS:
+		SCRIPT_OPCODE( OP_ADD_VS ):
 			var_a = GetVariable( st->a );
 			SetString( st->c, var_a.vectorPtr->ToString() );
 			AppendString( st->c, GetString( st->b ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADD_SV:
+		SCRIPT_OPCODE( OP_ADD_SV ):
 			var_b = GetVariable( st->b );
 			SetString( st->c, GetString( st->a ) );
 			AppendString( st->c, var_b.vectorPtr->ToString() );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_SUB_F:
+		SCRIPT_OPCODE( OP_SUB_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = *var_a.floatPtr - *var_b.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_SUB_V:
+		SCRIPT_OPCODE( OP_SUB_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.vectorPtr = *var_a.vectorPtr - *var_b.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_MUL_F:
+		SCRIPT_OPCODE( OP_MUL_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = *var_a.floatPtr * *var_b.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_MUL_V:
+		SCRIPT_OPCODE( OP_MUL_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = *var_a.vectorPtr * *var_b.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_MUL_FV:
+		SCRIPT_OPCODE( OP_MUL_FV ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.vectorPtr = *var_a.floatPtr * *var_b.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_MUL_VF:
+		SCRIPT_OPCODE( OP_MUL_VF ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.vectorPtr = *var_a.vectorPtr * *var_b.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_DIV_F:
+		SCRIPT_OPCODE( OP_DIV_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
@@ -1139,9 +1278,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.floatPtr = *var_a.floatPtr / *var_b.floatPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_MOD_F:
+		SCRIPT_OPCODE( OP_MOD_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable ( st->c );
@@ -1152,250 +1291,250 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) % static_cast<int>( *var_b.floatPtr );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_BITAND:
+		SCRIPT_OPCODE( OP_BITAND ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) & static_cast<int>( *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_BITOR:
+		SCRIPT_OPCODE( OP_BITOR ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) | static_cast<int>( *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_GE:
+		SCRIPT_OPCODE( OP_GE ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr >= *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_LE:
+		SCRIPT_OPCODE( OP_LE ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr <= *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_GT:
+		SCRIPT_OPCODE( OP_GT ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr > *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_LT:
+		SCRIPT_OPCODE( OP_LT ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr < *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_AND:
+		SCRIPT_OPCODE( OP_AND ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_AND_BOOLF:
+		SCRIPT_OPCODE( OP_AND_BOOLF ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_AND_FBOOL:
+		SCRIPT_OPCODE( OP_AND_FBOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_AND_BOOLBOOL:
+		SCRIPT_OPCODE( OP_AND_BOOLBOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_OR:	
+		SCRIPT_OPCODE( OP_OR ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_OR_BOOLF:
+		SCRIPT_OPCODE( OP_OR_BOOLF ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_OR_FBOOL:
+		SCRIPT_OPCODE( OP_OR_FBOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_DISPATCH();
 			
-		case OP_OR_BOOLBOOL:
+		SCRIPT_OPCODE( OP_OR_BOOLBOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_DISPATCH();
 			
-		case OP_NOT_BOOL:
+		SCRIPT_OPCODE( OP_NOT_BOOL ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.intPtr == 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NOT_F:
+		SCRIPT_OPCODE( OP_NOT_F ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr == 0.0f );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NOT_V:
+		SCRIPT_OPCODE( OP_NOT_V ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.vectorPtr == vec3_zero );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NOT_S:
+		SCRIPT_OPCODE( OP_NOT_S ):
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( strlen( GetString( st->a ) ) == 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NOT_ENT:
+		SCRIPT_OPCODE( OP_NOT_ENT ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( GetEntity( *var_a.entityNumberPtr ) == NULL );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NEG_F:
+		SCRIPT_OPCODE( OP_NEG_F ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = -*var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NEG_V:
+		SCRIPT_OPCODE( OP_NEG_V ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.vectorPtr = -*var_a.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INT_F:
+		SCRIPT_OPCODE( OP_INT_F ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_EQ_F:
+		SCRIPT_OPCODE( OP_EQ_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_EQ_V:
+		SCRIPT_OPCODE( OP_EQ_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.vectorPtr == *var_b.vectorPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_EQ_S:
+		SCRIPT_OPCODE( OP_EQ_S ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) == 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_EQ_E:
-		case OP_EQ_EO:
-		case OP_EQ_OE:
-		case OP_EQ_OO:
+		SCRIPT_OPCODE( OP_EQ_E ):
+		SCRIPT_OPCODE( OP_EQ_EO ):
+		SCRIPT_OPCODE( OP_EQ_OE ):
+		SCRIPT_OPCODE( OP_EQ_OO ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.entityNumberPtr == *var_b.entityNumberPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NE_F:
+		SCRIPT_OPCODE( OP_NE_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NE_V:
+		SCRIPT_OPCODE( OP_NE_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.vectorPtr != *var_b.vectorPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NE_S:
+		SCRIPT_OPCODE( OP_NE_S ):
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) != 0 );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_NE_E:
-		case OP_NE_EO:
-		case OP_NE_OE:
-		case OP_NE_OO:
+		SCRIPT_OPCODE( OP_NE_E ):
+		SCRIPT_OPCODE( OP_NE_EO ):
+		SCRIPT_OPCODE( OP_NE_OE ):
+		SCRIPT_OPCODE( OP_NE_OO ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ( *var_a.entityNumberPtr != *var_b.entityNumberPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UADD_F:
+		SCRIPT_OPCODE( OP_UADD_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr += *var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UADD_V:
+		SCRIPT_OPCODE( OP_UADD_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.vectorPtr += *var_a.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_USUB_F:
+		SCRIPT_OPCODE( OP_USUB_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr -= *var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_USUB_V:
+		SCRIPT_OPCODE( OP_USUB_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.vectorPtr -= *var_a.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UMUL_F:
+		SCRIPT_OPCODE( OP_UMUL_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr *= *var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UMUL_V:
+		SCRIPT_OPCODE( OP_UMUL_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.vectorPtr *= *var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UDIV_F:
+		SCRIPT_OPCODE( OP_UDIV_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 
@@ -1405,9 +1544,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.floatPtr = *var_b.floatPtr / *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UDIV_V:
+		SCRIPT_OPCODE( OP_UDIV_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 
@@ -1417,9 +1556,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.vectorPtr = *var_b.vectorPtr / *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UMOD_F:
+		SCRIPT_OPCODE( OP_UMOD_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 
@@ -1429,73 +1568,73 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) % static_cast<int>( *var_a.floatPtr );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UOR_F:
+		SCRIPT_OPCODE( OP_UOR_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) | static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UAND_F:
+		SCRIPT_OPCODE( OP_UAND_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) & static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UINC_F:
+		SCRIPT_OPCODE( OP_UINC_F ):
 			var_a = GetVariable( st->a );
 			( *var_a.floatPtr )++;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UINCP_F:
+		SCRIPT_OPCODE( OP_UINCP_F ):
 			var_a = GetVariable( st->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
 				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
 				( *var.floatPtr )++;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UDEC_F:
+		SCRIPT_OPCODE( OP_UDEC_F ):
 			var_a = GetVariable( st->a );
 			( *var_a.floatPtr )--;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_UDECP_F:
+		SCRIPT_OPCODE( OP_UDECP_F ):
 			var_a = GetVariable( st->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
 				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
 				( *var.floatPtr )--;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_COMP_F:
+		SCRIPT_OPCODE( OP_COMP_F ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			*var_c.floatPtr = ~static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_F:
+		SCRIPT_OPCODE( OP_STORE_F ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr = *var_a.floatPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_ENT:
+		SCRIPT_OPCODE( OP_STORE_ENT ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_BOOL:	
+		SCRIPT_OPCODE( OP_STORE_BOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.intPtr = *var_a.intPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_OBJENT:
+		SCRIPT_OPCODE( OP_STORE_OBJENT ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1507,41 +1646,41 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_OBJ:
-		case OP_STORE_ENTOBJ:
+		SCRIPT_OPCODE( OP_STORE_OBJ ):
+		SCRIPT_OPCODE( OP_STORE_ENTOBJ ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_S:
+		SCRIPT_OPCODE( OP_STORE_S ):
 			SetString( st->b, GetString( st->a ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_V:
+		SCRIPT_OPCODE( OP_STORE_V ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.vectorPtr = *var_a.vectorPtr;
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_FTOS:
+		SCRIPT_OPCODE( OP_STORE_FTOS ):
 			var_a = GetVariable( st->a );
 			SetString( st->b, FloatToString( *var_a.floatPtr ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_BTOS:
+		SCRIPT_OPCODE( OP_STORE_BTOS ):
 			var_a = GetVariable( st->a );
 			SetString( st->b, *var_a.intPtr ? "true" : "false" );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_VTOS:
+		SCRIPT_OPCODE( OP_STORE_VTOS ):
 			var_a = GetVariable( st->a );
 			SetString( st->b, var_a.vectorPtr->ToString() );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_FTOBOOL:
+		SCRIPT_OPCODE( OP_STORE_FTOBOOL ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			if ( *var_a.floatPtr != 0.0f ) {
@@ -1549,70 +1688,70 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.intPtr = 0;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STORE_BOOLTOF:
+		SCRIPT_OPCODE( OP_STORE_BOOLTOF ):
 			var_a = GetVariable( st->a );
 			var_b = GetVariable( st->b );
 			*var_b.floatPtr = static_cast<float>( *var_a.intPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_F:
+		SCRIPT_OPCODE( OP_STOREP_F ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->floatPtr = *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_ENT:
+		SCRIPT_OPCODE( OP_STOREP_ENT ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_FLD:
+		SCRIPT_OPCODE( OP_STOREP_FLD ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->intPtr = *var_a.intPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_BOOL:
+		SCRIPT_OPCODE( OP_STOREP_BOOL ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->intPtr = *var_a.intPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_S:
+		SCRIPT_OPCODE( OP_STOREP_S ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
 				idStr::Copynz( var_b.evalPtr->stringPtr, GetString( st->a ), MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_V:
+		SCRIPT_OPCODE( OP_STOREP_V ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->vectorPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->vectorPtr = *var_a.vectorPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 		
-		case OP_STOREP_FTOS:
+		SCRIPT_OPCODE( OP_STOREP_FTOS ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
 				var_a = GetVariable( st->a );
 				idStr::Copynz( var_b.evalPtr->stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_BTOS:
+		SCRIPT_OPCODE( OP_STOREP_BTOS ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
 				var_a = GetVariable( st->a );
@@ -1622,17 +1761,17 @@ bool idInterpreter::Execute( void ) {
 					idStr::Copynz( var_b.evalPtr->stringPtr, "false", MAX_STRING_LEN );
 				}
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_VTOS:
+		SCRIPT_OPCODE( OP_STOREP_VTOS ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
 				var_a = GetVariable( st->a );
 				idStr::Copynz( var_b.evalPtr->stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_FTOBOOL:
+		SCRIPT_OPCODE( OP_STOREP_FTOBOOL ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
 				var_a = GetVariable( st->a );
@@ -1642,25 +1781,25 @@ bool idInterpreter::Execute( void ) {
 					*var_b.evalPtr->intPtr = 0;
 				}
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_BOOLTOF:
+		SCRIPT_OPCODE( OP_STOREP_BOOLTOF ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->floatPtr = static_cast<float>( *var_a.intPtr );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_OBJ:
+		SCRIPT_OPCODE( OP_STOREP_OBJ ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
 				var_a = GetVariable( st->a );
 				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_STOREP_OBJENT:
+		SCRIPT_OPCODE( OP_STOREP_OBJENT ):
 			var_b = GetVariable( st->b );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
 				var_a = GetVariable( st->a );
@@ -1678,9 +1817,9 @@ bool idInterpreter::Execute( void ) {
 					*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 				}
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_ADDRESS:
+		SCRIPT_OPCODE( OP_ADDRESS ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1689,9 +1828,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				var_c.evalPtr->bytePtr = NULL;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_F:
+		SCRIPT_OPCODE( OP_INDIRECT_F ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1701,9 +1840,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.floatPtr = 0.0f;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_ENT:
+		SCRIPT_OPCODE( OP_INDIRECT_ENT ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1713,9 +1852,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.entityNumberPtr = 0;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_BOOL:
+		SCRIPT_OPCODE( OP_INDIRECT_BOOL ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1725,9 +1864,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.intPtr = 0;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_S:
+		SCRIPT_OPCODE( OP_INDIRECT_S ):
 			var_a = GetVariable( st->a );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
@@ -1736,9 +1875,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				SetString( st->c, "" );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_V:
+		SCRIPT_OPCODE( OP_INDIRECT_V ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1748,9 +1887,9 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				var_c.vectorPtr->Zero();
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_INDIRECT_OBJ:
+		SCRIPT_OPCODE( OP_INDIRECT_OBJ ):
 			var_a = GetVariable( st->a );
 			var_c = GetVariable( st->c );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
@@ -1760,76 +1899,523 @@ bool idInterpreter::Execute( void ) {
 				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
 				*var_c.entityNumberPtr = *var.entityNumberPtr;
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_F:
+		SCRIPT_OPCODE( OP_PUSH_F ):
 			var_a = GetVariable( st->a );
 			Push( *var_a.intPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_FTOS:
+		SCRIPT_OPCODE( OP_PUSH_FTOS ):
 			var_a = GetVariable( st->a );
 			PushString( FloatToString( *var_a.floatPtr ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_BTOF:
+		SCRIPT_OPCODE( OP_PUSH_BTOF ):
 			var_a = GetVariable( st->a );
 			floatVal = *var_a.intPtr;
 			Push( *reinterpret_cast<int *>( &floatVal ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_FTOB:
+		SCRIPT_OPCODE( OP_PUSH_FTOB ):
 			var_a = GetVariable( st->a );
 			if ( *var_a.floatPtr != 0.0f ) {
 				Push( 1 );
 			} else {
 				Push( 0 );
 			}
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_VTOS:
+		SCRIPT_OPCODE( OP_PUSH_VTOS ):
 			var_a = GetVariable( st->a );
 			PushString( var_a.vectorPtr->ToString() );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_BTOS:
+		SCRIPT_OPCODE( OP_PUSH_BTOS ):
 			var_a = GetVariable( st->a );
 			PushString( *var_a.intPtr ? "true" : "false" );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_ENT:
+		SCRIPT_OPCODE( OP_PUSH_ENT ):
 			var_a = GetVariable( st->a );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_S:
+		SCRIPT_OPCODE( OP_PUSH_S ):
 			PushString( GetString( st->a ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_V:
+		SCRIPT_OPCODE( OP_PUSH_V ):
 			var_a = GetVariable( st->a );
 			Push( *reinterpret_cast<int *>( &var_a.vectorPtr->x ) );
 			Push( *reinterpret_cast<int *>( &var_a.vectorPtr->y ) );
 			Push( *reinterpret_cast<int *>( &var_a.vectorPtr->z ) );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_OBJ:
+		SCRIPT_OPCODE( OP_PUSH_OBJ ):
 			var_a = GetVariable( st->a );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_DISPATCH();
 
-		case OP_PUSH_OBJENT:
+		SCRIPT_OPCODE( OP_PUSH_OBJENT ):
 			var_a = GetVariable( st->a );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_DISPATCH();
+
+
+		SCRIPT_OPCODE( OP_EQ_F_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_NE_F_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_LE_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr <= *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_GE_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr >= *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
 
-		case OP_BREAK:
-		case OP_CONTINUE:
+		SCRIPT_OPCODE( OP_LT_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr < *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_GT_IFNOT ):
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr > *var_b.floatPtr );
+			SCRIPT_FUSED_IFNOT();
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_INDIRECT_F_EQ_F ):
+			var_a = GetVariable( st->a );
+			var_c = GetVariable( st->c );
+			obj = GetScriptObject( *var_a.entityNumberPtr );
+			if ( obj ) {
+				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				*var_c.floatPtr = *var.floatPtr;
+			} else {
+				*var_c.floatPtr = 0.0f;
+			}
+			// the compare is the next statement
+			instructionPointer++;
+			st = &gameLocal.program.GetStatement( instructionPointer );
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_INDIRECT_F_NE_F ):
+			var_a = GetVariable( st->a );
+			var_c = GetVariable( st->c );
+			obj = GetScriptObject( *var_a.entityNumberPtr );
+			if ( obj ) {
+				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				*var_c.floatPtr = *var.floatPtr;
+			} else {
+				*var_c.floatPtr = 0.0f;
+			}
+			// the compare is the next statement
+			instructionPointer++;
+			st = &gameLocal.program.GetStatement( instructionPointer );
+			var_a = GetVariable( st->a );
+			var_b = GetVariable( st->b );
+			var_c = GetVariable( st->c );
+			*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
+			SCRIPT_DISPATCH();
+
+		SCRIPT_OPCODE( OP_BREAK ):
+		SCRIPT_OPCODE( OP_CONTINUE ):
+#ifndef ID_SCRIPT_THREADED_DISPATCH
 		default:
+#endif
 			Error( "Bad opcode %i", st->op );
-			break;
+			SCRIPT_DISPATCH();
+#ifdef ID_SCRIPT_THREADED_DISPATCH
+	}
+
+done:
+#else
 		}
 	}
+#endif
+
+	statementCount += SCRIPT_RUNAWAY - runaway;
+
+	if ( profiling ) {
+		ProfileEndExecute( profileCaller );
+	}
 
 	return threadDying;
 }
+
+/***********************************************************************
+
+  Profiling
+
+  With g_scriptProfile set, every script function and event counts its calls, and the clock
+  ticks spent while an interpreter executes are charged to the function or event it is in
+  (self time) and to every function on its call stack (inclusive time).  Time in a thread
+  that runs inside another one, like a thread that is started by a script, is only charged
+  to the functions of that thread.  Executed statements are counted per statement and summed
+  up per function when the profile is printed.  g_scriptProfile 2 also records every call
+  for a trace that can be loaded in chrome://tracing.
+
+***********************************************************************/
+
+/*
+================
+idInterpreter::GetProfile
+================
+*/
+scriptProfile_t &idInterpreter::GetProfile( const function_t *func ) {
+	int index = gameLocal.program.GetFunctionIndex( func );
+
+	if ( index >= profile.Num() ) {
+		scriptProfile_t empty;
+		memset( &empty, 0, sizeof( empty ) );
+		profile.AssureSize( gameLocal.program.NumFunctions(), empty );
+	}
+
+	return profile[ index ];
+}
+
+/*
+================
+idInterpreter::ProfileCharge
+
+Charges the time since the last charge to the current function or event.
+================
+*/
+void idInterpreter::ProfileCharge( void ) {
+	double	now;
+	double	ticks;
+	int		i;
+
+	now = Sys_GetClockTicks();
+	ticks = now - profileMark;
+	profileMark = now;
+	profileCharge++;
+
+	if ( profileEvent ) {
+		scriptProfile_t &eventProfile = GetProfile( profileEvent );
+		eventProfile.selfTicks += ticks;
+		eventProfile.inclusiveTicks += ticks;
+	} else if ( currentFunction ) {
+		GetProfile( currentFunction ).selfTicks += ticks;
+	}
+
+	for( i = 0; i <= callStackDepth; i++ ) {
+		const function_t *func = ( i < callStackDepth ) ? callStack[ i ].f : currentFunction;
+		if ( func ) {
+			scriptProfile_t &funcProfile = GetProfile( func );
+			if ( funcProfile.lastCharge != profileCharge ) {
+				funcProfile.lastCharge = profileCharge;
+				funcProfile.inclusiveTicks += ticks;
+			}
+		}
+	}
+}
+
+/*
+================
+idInterpreter::ProfileBeginExecute
+
+Returns the interpreter that was charged for the time before this one started executing.
+================
+*/
+idInterpreter *idInterpreter::ProfileBeginExecute( void ) {
+	idInterpreter *caller = profileActive;
+
+	if ( caller ) {
+		caller->ProfileCharge();
+	} else {
+		profileMark = Sys_GetClockTicks();
+	}
+	profileActive = this;
+
+	if ( profileStatements.Num() < gameLocal.program.NumStatements() ) {
+		profileStatements.AssureSize( gameLocal.program.NumStatements(), 0 );
+	}
+	profileHits = profileStatements.Ptr();
+
+	return caller;
+}
+
+/*
+================
+idInterpreter::ProfileEndExecute
+================
+*/
+void idInterpreter::ProfileEndExecute( idInterpreter *caller ) {
+	if ( profileActive == this ) {
+		ProfileCharge();
+	}
+	profileActive = caller;
+	if ( !caller ) {
+		profileHits = NULL;
+	}
+}
+
+/*
+================
+idInterpreter::ProfileEnterFunction
+
+Called after the current function changed to the entered one.
+================
+*/
+void idInterpreter::ProfileEnterFunction( void ) {
+	GetProfile( currentFunction ).calls++;
+	profileEnterTicks[ callStackDepth - 1 ] = ( profileActive == this ) ? profileMark : Sys_GetClockTicks();
+}
+
+/*
+================
+idInterpreter::ProfileLeaveFunction
+
+Called before the current function is removed from the call stack.
+================
+*/
+void idInterpreter::ProfileLeaveFunction( void ) {
+	if ( profileActive == this ) {
+		ProfileCharge();
+	}
+	if ( profileEnterTicks[ callStackDepth - 1 ] != 0.0 ) {
+		ProfileTraceCall( currentFunction, profileEnterTicks[ callStackDepth - 1 ] );
+		profileEnterTicks[ callStackDepth - 1 ] = 0.0;
+	}
+}
+
+/*
+================
+idInterpreter::ProfileBeginEvent
+
+Returns the clock ticks the event call started at.
+================
+*/
+double idInterpreter::ProfileBeginEvent( const function_t *func ) {
+	if ( profileActive == this ) {
+		ProfileCharge();
+	}
+	GetProfile( func ).calls++;
+	profileEvent = func;
+
+	return ( profileActive == this ) ? profileMark : Sys_GetClockTicks();
+}
+
+/*
+================
+idInterpreter::ProfileEndEvent
+================
+*/
+void idInterpreter::ProfileEndEvent( const function_t *func, double startTicks ) {
+	if ( profileActive == this ) {
+		ProfileCharge();
+	}
+	profileEvent = NULL;
+	ProfileTraceCall( func, startTicks );
+}
+
+/*
+================
+idInterpreter::ProfileTraceCall
+================
+*/
+void idInterpreter::ProfileTraceCall( const function_t *func, double startTicks ) {
+	if ( g_scriptProfile.GetInteger() < 2 || profileTrace.Num() >= MAX_SCRIPT_TRACE_CALLS ) {
+		return;
+	}
+
+	profileTrace.SetGranularity( 4096 );
+	scriptTraceCall_t &call = profileTrace.Alloc();
+	call.function	= gameLocal.program.GetFunctionIndex( func );
+	call.threadNum	= thread ? thread->GetThreadNum() : 0;
+	call.startTicks	= startTicks;
+	call.endTicks	= ( profileActive == this ) ? profileMark : Sys_GetClockTicks();
+}
+
+/*
+================
+idInterpreter::ClearProfile
+
+Function and statement numbers change when the program is restarted, so the profile is cleared with it.
+================
+*/
+void idInterpreter::ClearProfile( void ) {
+	profile.Clear();
+	profileStatements.Clear();
+	profileHits = NULL;
+	profileTrace.Clear();
+	profileActive = NULL;
+	profileCharge = 0;
+}
+
+static const scriptProfile_t *	profileSortList;
+static const int *				profileSortInstructions;
+static int						profileSortKey;
+
+/*
+================
+ProfileSortCompare
+================
+*/
+static int ProfileSortCompare( const int *a, const int *b ) {
+	const scriptProfile_t &pa = profileSortList[ *a ];
+	const scriptProfile_t &pb = profileSortList[ *b ];
+	double diff;
+
+	switch( profileSortKey ) {
+	case 1:		diff = pb.inclusiveTicks - pa.inclusiveTicks; break;
+	case 2:		diff = pb.calls - pa.calls; break;
+	case 3:		diff = profileSortInstructions[ *b ] - profileSortInstructions[ *a ]; break;
+	default:	diff = pb.selfTicks - pa.selfTicks; break;
+	}
+
+	if ( diff < 0.0 ) {
+		return -1;
+	} else if ( diff > 0.0 ) {
+		return 1;
+	}
+	return *a - *b;
+}
+
+/*
+================
+idInterpreter::Profile_f
+
+scriptProfile [self|inclusive|calls|instructions]
+scriptProfile trace <file>
+scriptProfile clear
+================
+*/
+void idInterpreter::Profile_f( const idCmdArgs &args ) {
+	idList<int>	sorted;
+	idList<int>	instructions;
+	double		msecPerTick;
+	double		totalTicks;
+	int			i, j;
+
+	if ( !idStr::Icmp( args.Argv( 1 ), "clear" ) ) {
+		ClearProfile();
+		gameLocal.Printf( "script profile cleared\n" );
+		return;
+	}
+
+	if ( !idStr::Icmp( args.Argv( 1 ), "trace" ) ) {
+		if ( args.Argc() < 3 ) {
+			gameLocal.Printf( "usage: scriptProfile trace <file>\n" );
+			return;
+		}
+		if ( !profileTrace.Num() ) {
+			gameLocal.Printf( "no script calls were traced, set g_scriptProfile 2 to trace them\n" );
+			return;
+		}
+
+		idStr fileName = args.Argv( 2 );
+		fileName.DefaultFileExtension( ".json" );
+		idFile *f = fileSystem->OpenFileWrite( fileName );
+		if ( !f ) {
+			gameLocal.Printf( "couldn't write %s\n", fileName.c_str() );
+			return;
+		}
+
+		double usecPerTick = 1000000.0 / Sys_ClockTicksPerSecond();
+		double startTicks = profileTrace[ 0 ].startTicks;
+		for( i = 1; i < profileTrace.Num(); i++ ) {
+			startTicks = Min( startTicks, profileTrace[ i ].startTicks );
+		}
+
+		f->Printf( "{\"traceEvents\":[\n" );
+		for( i = 0; i < profileTrace.Num(); i++ ) {
+			const scriptTraceCall_t &call = profileTrace[ i ];
+			const function_t *func = gameLocal.program.GetFunction( call.function );
+			f->Printf( "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+				func->Name(), func->eventdef ? "event" : "script", call.threadNum,
+				( call.startTicks - startTicks ) * usecPerTick, ( call.endTicks - call.startTicks ) * usecPerTick,
+				( i < profileTrace.Num() - 1 ) ? "," : "" );
+		}
+		f->Printf( "]}\n" );
+		fileSystem->CloseFile( f );
+
+		gameLocal.Printf( "wrote %d script calls to %s\n", profileTrace.Num(), fileName.c_str() );
+		return;
+	}
+
+	if ( !idStr::Icmp( args.Argv( 1 ), "inclusive" ) ) {
+		profileSortKey = 1;
+	} else if ( !idStr::Icmp( args.Argv( 1 ), "calls" ) ) {
+		profileSortKey = 2;
+	} else if ( !idStr::Icmp( args.Argv( 1 ), "instructions" ) ) {
+		profileSortKey = 3;
+	} else {
+		profileSortKey = 0;
+	}
+
+	if ( profile.Num() < gameLocal.program.NumFunctions() ) {
+		scriptProfile_t empty;
+		memset( &empty, 0, sizeof( empty ) );
+		profile.AssureSize( gameLocal.program.NumFunctions(), empty );
+	}
+
+	// sum up the statements executed in each function
+	instructions.SetNum( profile.Num() );
+	for( i = 0; i < profile.Num(); i++ ) {
+		const function_t *func = gameLocal.program.GetFunction( i );
+		instructions[ i ] = 0;
+		if ( !func->eventdef ) {
+			for( j = func->firstStatement; j < func->firstStatement + func->numStatements && j < profileStatements.Num(); j++ ) {
+				instructions[ i ] += profileStatements[ j ];
+			}
+		}
+	}
+
+	totalTicks = 0.0;
+	for( i = 0; i < profile.Num(); i++ ) {
+		if ( profile[ i ].calls || instructions[ i ] ) {
+			sorted.Append( i );
+			totalTicks += profile[ i ].selfTicks;
+		}
+	}
+
+	profileSortList = profile.Ptr();
+	profileSortInstructions = instructions.Ptr();
+	sorted.Sort( ProfileSortCompare );
+
+	msecPerTick = 1000.0 / Sys_ClockTicksPerSecond();
+
+	gameLocal.Printf( "    calls instructions   self ms  incl ms  self %% name\n" );
+	for( i = 0; i < sorted.Num(); i++ ) {
+		const scriptProfile_t &funcProfile = profile[ sorted[ i ] ];
+		const function_t *func = gameLocal.program.GetFunction( sorted[ i ] );
+		gameLocal.Printf( "%9d %12d %9.2f %8.2f %6.2f %s%s\n", funcProfile.calls, instructions[ sorted[ i ] ],
+			funcProfile.selfTicks * msecPerTick, funcProfile.inclusiveTicks * msecPerTick,
+			( totalTicks > 0.0 ) ? funcProfile.selfTicks * 100.0 / totalTicks : 0.0,
+			func->Name(), func->eventdef ? " (event)" : "" );
+	}
+	gameLocal.Printf( "%d functions and events, %.2f ms\n", sorted.Num(), totalTicks * msecPerTick );
+}
@@ -38,6 +38,20 @@ typedef struct prstack_s {
 	int 				stackbase;
 } prstack_t;
 
+typedef struct scriptProfile_s {
+	int					calls;
+	int					lastCharge;			// keeps recursive calls from adding the same time twice
+	double				selfTicks;
+	double				inclusiveTicks;
+} scriptProfile_t;
+
+typedef struct scriptTraceCall_s {
+	int					function;
+	int					threadNum;
+	double				startTicks;
+	double				endTicks;
+} scriptTraceCall_t;
+
 class idInterpreter {
 private:
 	prstack_t			callStack[ MAX_STACK_DEPTH ];
@@ -58,6 +72,18 @@ private:
 
 	idThread			*thread;
 
+	// profiling
+	double				profileEnterTicks[ MAX_STACK_DEPTH ];	// when the functions on the call stack were entered
+	const function_t	*profileEvent;							// event being called
+
+	static idList<scriptProfile_t>		profile;			// indexed by function number
+	static idList<int>					profileStatements;	// times each statement was executed
+	static int *						profileHits;		// profileStatements while an interpreter is profiled
+	static idList<scriptTraceCall_t>	profileTrace;
+	static idInterpreter *				profileActive;		// interpreter that is charged for the time
+	static double						profileMark;		// clock ticks when time was last charged
+	static int							profileCharge;
+
 	void				PopParms( int numParms );
 	void				PushString( const char *string );
 	void				Push( int value );
@@ -74,13 +100,26 @@ private:
 	void				CallEvent( const function_t *func, int argsize );
 	void				CallSysEvent( const function_t *func, int argsize );
 
+	static scriptProfile_t &GetProfile( const function_t *func );
+	void				ProfileCharge( void );
+	idInterpreter *		ProfileBeginExecute( void );
+	void				ProfileEndExecute( idInterpreter *caller );
+	void				ProfileEnterFunction( void );
+	void				ProfileLeaveFunction( void );
+	double				ProfileBeginEvent( const function_t *func );
+	void				ProfileEndEvent( const function_t *func, double startTicks );
+	void				ProfileTraceCall( const function_t *func, double startTicks );
+
 public:
 	bool				doneProcessing;
 	bool				threadDying;
 	bool				terminateOnExit;
 	bool				debug;
 
+	static int			statementCount;		// statements dispatched by all interpreters
+
 						idInterpreter();
+						~idInterpreter();
 
 	// save games
 	void				Save( idSaveGame *savefile ) const;				// archives object for save game file
@@ -114,6 +153,8 @@ public:
 	const function_t	*GetCurrentFunction( void ) const;
 	idThread			*GetThread( void ) const;
 
+	static void			ClearProfile( void );
+	static void			Profile_f( const idCmdArgs &args );
 };
 
 /*
@@ -1652,6 +1652,88 @@ void idProgram::DisassembleStatement( idFile *file, int instructionPointer ) con
 	file->Printf( "\n" );
 }
 
+/*
+==============
+idProgram::BaseOpcode
+
+Returns the opcode a superinstruction was created from.
+==============
+*/
+int idProgram::BaseOpcode( int op ) {
+	switch( op ) {
+		case OP_EQ_F_IFNOT:			return OP_EQ_F;
+		case OP_NE_F_IFNOT:			return OP_NE_F;
+		case OP_LE_IFNOT:			return OP_LE;
+		case OP_GE_IFNOT:			return OP_GE;
+		case OP_LT_IFNOT:			return OP_LT;
+		case OP_GT_IFNOT:			return OP_GT;
+		case OP_INDIRECT_F_EQ_F:
+		case OP_INDIRECT_F_NE_F:	return OP_INDIRECT_F;
+		default:					return op;
+	}
+}
+
+/*
+==============
+idProgram::FuseStatements
+
+Peephole pass that turns common statement pairs into superinstructions.  Only the
+opcode of the first statement changes, the second statement is left as it was so
+jumps into it still work, and the interpreter skips it after the superinstruction.
+==============
+*/
+void idProgram::FuseStatements( int first, int num ) {
+	int			i, op, next;
+	statement_t	*st;
+
+	for( i = first; i < first + num - 1; i++ ) {
+		st = &statements[ i ];
+		op = BaseOpcode( st->op );
+		next = BaseOpcode( st[ 1 ].op );
+
+		switch( op ) {
+			case OP_EQ_F:
+			case OP_NE_F:
+			case OP_LE:
+			case OP_GE:
+			case OP_LT:
+			case OP_GT:
+				// compare followed by a jump on the result
+				if ( next == OP_IFNOT && st[ 1 ].a == st->c ) {
+					switch( op ) {
+						case OP_EQ_F:	st->op = OP_EQ_F_IFNOT; break;
+						case OP_NE_F:	st->op = OP_NE_F_IFNOT; break;
+						case OP_LE:		st->op = OP_LE_IFNOT; break;
+						case OP_GE:		st->op = OP_GE_IFNOT; break;
+						case OP_LT:		st->op = OP_LT_IFNOT; break;
+						case OP_GT:		st->op = OP_GT_IFNOT; break;
+					}
+				}
+				break;
+
+			case OP_INDIRECT_F:
+				// field load followed by an equality test of the loaded value
+				if ( ( next == OP_EQ_F || next == OP_NE_F ) && ( st[ 1 ].a == st->c || st[ 1 ].b == st->c ) ) {
+					st->op = ( next == OP_EQ_F ) ? OP_INDIRECT_F_EQ_F : OP_INDIRECT_F_NE_F;
+				}
+				break;
+		}
+	}
+}
+
+/*
+==============
+idProgram::UnfuseStatements
+==============
+*/
+void idProgram::UnfuseStatements( int first, int num ) {
+	int i;
+
+	for( i = first; i < first + num; i++ ) {
+		statements[ i ].op = BaseOpcode( statements[ i ].op );
+	}
+}
+
 /*
 ==============
 idProgram::Disassemble
@@ -1843,6 +1925,7 @@ void idProgram::CompileFile( const char *filename ) {
 		gameLocal.Error( "Couldn't load %s\n", filename );
 	}
 
+	AddSourceFile( filename );
 	result = CompileText( filename, src, false );
 
 	fileSystem->FreeFile( src );
@@ -1888,6 +1971,7 @@ void idProgram::FreeData( void ) {
 
 	filename.Clear();
 	fileList.Clear();
+	sourceFiles.Clear();
 	statements.Clear();
 	functions.Clear();
 
@@ -1900,6 +1984,608 @@ void idProgram::FreeData( void ) {
 	filename = "";
 }
 
+/***********************************************************************
+
+  Compiled script cache
+
+  The default script is compiled once and the statement, function, variable and type tables
+  are written to a cache in the save path.  The cache is keyed on a checksum of every file the
+  parser read for it, including includes that only hold defines, so it is only used as long as
+  none of them changed, and the normal compile is done whenever it is missing, stale or was
+  written by a different build.
+
+  Pointers are stored as indices: types and defs are numbered by their position in the program
+  lists, with the static built-in types and defs numbered below -1, functions by their index
+  and def values that point into the global variables by their offset.
+
+***********************************************************************/
+
+const int		SCRIPT_CACHE_IDENT		= ( 'C' << 24 ) + ( 'S' << 16 ) + ( 'D' << 8 ) + 'I';
+const int		SCRIPT_CACHE_VERSION	= 2;
+const char *	SCRIPT_CACHE_EXTENSION	= "bin";
+
+typedef struct {
+	int							ident;
+	int							version;
+	int							valueSize;				// sizeof( varEval_t ), raw def values are stored as they are in memory
+	int							maxGlobals;
+	int							buildChecksum;			// checksum of the opcodes and event definitions
+	int							sourceChecksum;			// checksum of the source files
+	int							dataLength;				// length of everything after the header
+	int							dataChecksum;
+} scriptCacheHeader_t;
+
+typedef struct scriptCacheCursor_s {
+	const byte *				data;
+	int							length;
+	int							offset;
+	bool						error;					// set when anything would be read past the end or is out of range
+} scriptCacheCursor_t;
+
+enum {
+	SCRIPT_CACHE_VALUE_RAW,								// stack offset, jump offset, field offset, etc.
+	SCRIPT_CACHE_VALUE_VARIABLE,						// offset in the global variables
+	SCRIPT_CACHE_VALUE_FUNCTION							// function index
+};
+
+static idTypeDef *const scriptCacheTypes[] = {
+	&type_void, &type_scriptevent, &type_namespace, &type_string, &type_float, &type_vector, &type_entity, &type_field,
+	&type_function, &type_virtualfunction, &type_pointer, &type_object, &type_jumpoffset, &type_argsize, &type_boolean
+};
+
+static idVarDef *const scriptCacheDefs[] = {
+	&def_void, &def_scriptevent, &def_namespace, &def_string, &def_float, &def_vector, &def_entity, &def_field,
+	&def_function, &def_virtualfunction, &def_pointer, &def_object, &def_jumpoffset, &def_argsize, &def_boolean
+};
+
+static const int NUM_SCRIPT_CACHE_BUILTINS = sizeof( scriptCacheTypes ) / sizeof( scriptCacheTypes[0] );
+
+/*
+================
+ScriptCachePointerKey
+================
+*/
+static int ScriptCachePointerKey( const void *ptr ) {
+	return (int)( ( (size_t)ptr ) >> 3 );
+}
+
+/*
+================
+ScriptCacheBuildChecksum
+
+The compiled code depends on the opcode numbers and the events scripts can call.
+================
+*/
+static int ScriptCacheBuildChecksum( void ) {
+	idFile_Memory	f;
+	int				i;
+
+	for( i = 0; idCompiler::opcodes[ i ].name; i++ ) {
+		f.WriteString( idCompiler::opcodes[ i ].name );
+		f.WriteInt( idCompiler::opcodes[ i ].priority );
+	}
+	f.WriteInt( NUM_OPCODES );
+
+	for( i = 0; i < idEventDef::NumEventCommands(); i++ ) {
+		const idEventDef *ev = idEventDef::GetEventCommand( i );
+		f.WriteString( ev->GetName() );
+		f.WriteString( ev->GetArgFormat() );
+		f.WriteInt( ev->GetReturnType() );
+	}
+
+	return MD5_BlockChecksum( f.GetDataPtr(), f.Length() );
+}
+
+/*
+================
+ScriptCacheSourceChecksum
+
+Returns false if one of the files can't be read.
+================
+*/
+static bool ScriptCacheSourceChecksum( const idStrList &files, int &checksum ) {
+	idFile_Memory	f;
+	void			*buffer;
+	int				i, length;
+
+	for( i = 0; i < files.Num(); i++ ) {
+		length = fileSystem->ReadFile( files[ i ], &buffer );
+		if ( length < 0 ) {
+			return false;
+		}
+		f.WriteString( files[ i ] );
+		f.WriteInt( length );
+		f.WriteInt( MD5_BlockChecksum( buffer, length ) );
+		fileSystem->FreeFile( buffer );
+	}
+
+	checksum = MD5_BlockChecksum( f.GetDataPtr(), f.Length() );
+	return true;
+}
+
+/*
+================
+ReadScriptCacheData
+
+Returns a pointer into the cache data, or NULL and sets the error flag
+================
+*/
+static const void *ReadScriptCacheData( scriptCacheCursor_t &cursor, int count, int elementSize ) {
+	if ( cursor.error || count < 0 || count > ( cursor.length - cursor.offset ) / elementSize ) {
+		cursor.error = true;
+		return NULL;
+	}
+	const byte *data = cursor.data + cursor.offset;
+	cursor.offset += count * elementSize;
+	return data;
+}
+
+/*
+================
+ReadScriptCacheInt
+================
+*/
+static int ReadScriptCacheInt( scriptCacheCursor_t &cursor ) {
+	int value = 0;
+	const void *data = ReadScriptCacheData( cursor, 1, sizeof( value ) );
+	if ( data ) {
+		memcpy( &value, data, sizeof( value ) );
+	}
+	return LittleLong( value );
+}
+
+/*
+================
+ReadScriptCacheInt
+
+Sets the error flag if the value isn't in the range [min, max]
+================
+*/
+static int ReadScriptCacheInt( scriptCacheCursor_t &cursor, int min, int max ) {
+	int value = ReadScriptCacheInt( cursor );
+	if ( value < min || value > max ) {
+		cursor.error = true;
+		value = 0;
+	}
+	return value;
+}
+
+/*
+================
+ReadScriptCacheString
+
+Reads a string written by idFile::WriteString
+================
+*/
+static void ReadScriptCacheString( scriptCacheCursor_t &cursor, idStr &string ) {
+	int length = ReadScriptCacheInt( cursor, 0, cursor.length );
+	const char *data = (const char *)ReadScriptCacheData( cursor, length, 1 );
+	if ( data ) {
+		string.Clear();
+		string.Append( data, length );
+	} else {
+		string.Clear();
+	}
+}
+
+/*
+================
+idProgram::CacheTypeNum
+================
+*/
+int idProgram::CacheTypeNum( const idTypeDef *type, const idHashIndex &typeHash ) const {
+	int i;
+
+	if ( !type ) {
+		return -1;
+	}
+	for( i = 0; i < NUM_SCRIPT_CACHE_BUILTINS; i++ ) {
+		if ( type == scriptCacheTypes[ i ] ) {
+			return -2 - i;
+		}
+	}
+	for( i = typeHash.First( ScriptCachePointerKey( type ) ); i != -1; i = typeHash.Next( i ) ) {
+		if ( types[ i ] == type ) {
+			return i;
+		}
+	}
+	throw idCompileError( va( "type '%s' is not in the program", type->Name() ) );
+	return -1;
+}
+
+/*
+================
+idProgram::CacheDefNum
+================
+*/
+int idProgram::CacheDefNum( const idVarDef *def ) const {
+	int i;
+
+	if ( !def ) {
+		return -1;
+	}
+	for( i = 0; i < NUM_SCRIPT_CACHE_BUILTINS; i++ ) {
+		if ( def == scriptCacheDefs[ i ] ) {
+			return -2 - i;
+		}
+	}
+	if ( def->num < 0 || def->num >= varDefs.Num() || varDefs[ def->num ] != def ) {
+		throw idCompileError( va( "def '%s' is not in the program", def->Name() ) );
+	}
+	return def->num;
+}
+
+/*
+================
+idProgram::WriteCache
+================
+*/
+void idProgram::WriteCache( const char *cacheName ) const {
+	idFile_Memory			data( cacheName );
+	idFile_Memory			f( cacheName );
+	scriptCacheHeader_t		header;
+	idHashIndex				typeHash;
+	int						i, j;
+
+	if ( !ScriptCacheSourceChecksum( sourceFiles, header.sourceChecksum ) ) {
+		gameLocal.Warning( "couldn't write %s: the script source files can't be read", cacheName );
+		return;
+	}
+
+	typeHash.Clear( 1024, types.Num() );
+	for( i = 0; i < types.Num(); i++ ) {
+		typeHash.Add( ScriptCachePointerKey( types[ i ] ), i );
+	}
+
+	try {
+		data.WriteInt( sourceFiles.Num() );
+		for( i = 0; i < sourceFiles.Num(); i++ ) {
+			data.WriteString( sourceFiles[ i ] );
+		}
+
+		data.WriteInt( fileList.Num() );
+		for( i = 0; i < fileList.Num(); i++ ) {
+			data.WriteString( fileList[ i ] );
+		}
+
+		data.WriteInt( types.Num() );
+		data.WriteInt( varDefs.Num() );
+		data.WriteInt( functions.Num() );
+		data.WriteInt( statements.Num() );
+		data.WriteInt( numVariables );
+
+		data.WriteInt( CacheDefNum( returnDef ) );
+		data.WriteInt( CacheDefNum( returnStringDef ) );
+		data.WriteInt( CacheDefNum( sysDef ) );
+
+		for( i = 0; i < types.Num(); i++ ) {
+			const idTypeDef *type = types[ i ];
+
+			data.WriteInt( type->type );
+			data.WriteString( type->name );
+			data.WriteInt( type->size );
+			data.WriteInt( CacheTypeNum( type->auxType, typeHash ) );
+			data.WriteInt( CacheDefNum( type->def ) );
+			data.WriteInt( type->parmTypes.Num() );
+			for( j = 0; j < type->parmTypes.Num(); j++ ) {
+				data.WriteInt( CacheTypeNum( type->parmTypes[ j ], typeHash ) );
+				data.WriteString( type->parmNames[ j ] );
+			}
+			data.WriteInt( type->functions.Num() );
+			for( j = 0; j < type->functions.Num(); j++ ) {
+				data.WriteInt( type->functions[ j ] - functions.Ptr() );
+			}
+		}
+
+		for( i = 0; i < varDefs.Num(); i++ ) {
+			const idVarDef *def = varDefs[ i ];
+
+			data.WriteInt( CacheTypeNum( def->TypeDef(), typeHash ) );
+			data.WriteInt( CacheDefNum( def->scope ) );
+			data.WriteString( def->Name() );
+			data.WriteInt( def->numUsers );
+			data.WriteInt( def->initialized );
+
+			// jump offsets, arg sizes and virtual functions may have been given their value after
+			// space in the globals was allocated for them, so they are always stored as they are
+			const byte *ptr = def->value.bytePtr;
+			const etype_t etype = def->Type();
+			if ( def->initialized == idVarDef::stackVariable || etype == ev_jumpoffset || etype == ev_argsize || etype == ev_virtualfunction ) {
+				data.WriteInt( SCRIPT_CACHE_VALUE_RAW );
+				data.Write( &def->value, sizeof( def->value ) );
+			} else if ( etype == ev_function && def->value.functionPtr >= functions.Ptr() && def->value.functionPtr < functions.Ptr() + functions.Num() ) {
+				data.WriteInt( SCRIPT_CACHE_VALUE_FUNCTION );
+				data.WriteInt( def->value.functionPtr - functions.Ptr() );
+			} else if ( ptr >= variables && ptr <= variables + numVariables ) {
+				data.WriteInt( SCRIPT_CACHE_VALUE_VARIABLE );
+				data.WriteInt( ptr - variables );
+			} else {
+				data.WriteInt( SCRIPT_CACHE_VALUE_RAW );
+				data.Write( &def->value, sizeof( def->value ) );
+			}
+		}
+
+		for( i = 0; i < functions.Num(); i++ ) {
+			const function_t &func = functions[ i ];
+
+			data.WriteString( func.Name() );
+			data.WriteString( func.eventdef ? func.eventdef->GetName() : "" );
+			data.WriteInt( CacheDefNum( func.def ) );
+			data.WriteInt( CacheTypeNum( func.type, typeHash ) );
+			data.WriteInt( func.firstStatement );
+			data.WriteInt( func.numStatements );
+			data.WriteInt( func.parmTotal );
+			data.WriteInt( func.locals );
+			data.WriteInt( func.filenum );
+			data.WriteInt( func.parmSize.Num() );
+			for( j = 0; j < func.parmSize.Num(); j++ ) {
+				data.WriteInt( func.parmSize[ j ] );
+			}
+		}
+
+		for( i = 0; i < statements.Num(); i++ ) {
+			const statement_t &statement = statements[ i ];
+
+			data.WriteInt( statement.op );
+			data.WriteInt( CacheDefNum( statement.a ) );
+			data.WriteInt( CacheDefNum( statement.b ) );
+			data.WriteInt( CacheDefNum( statement.c ) );
+			data.WriteInt( statement.linenumber );
+			data.WriteInt( statement.file );
+		}
+
+		data.Write( variables, numVariables );
+	}
+
+	catch( idCompileError &err ) {
+		gameLocal.Warning( "couldn't write %s: %s", cacheName, err.error );
+		return;
+	}
+
+	header.ident = SCRIPT_CACHE_IDENT;
+	header.version = SCRIPT_CACHE_VERSION;
+	header.valueSize = sizeof( varEval_t );
+	header.maxGlobals = MAX_GLOBALS;
+	header.buildChecksum = ScriptCacheBuildChecksum();
+	header.dataLength = data.Length();
+	header.dataChecksum = MD5_BlockChecksum( data.GetDataPtr(), data.Length() );
+
+	f.Write( &header, sizeof( header ) );
+	f.Write( data.GetDataPtr(), data.Length() );
+	fileSystem->WriteFile( cacheName, f.GetDataPtr(), f.Length() );
+}
+
+/*
+================
+idProgram::ReadCache
+
+Replaces the program with the one in the cache.  Returns false, with the program
+as it was after BeginCompilation, if the cache is missing, stale or corrupt.
+================
+*/
+bool idProgram::ReadCache( const char *cacheName ) {
+	scriptCacheCursor_t			cursor;
+	const scriptCacheHeader_t	*header;
+	idStrList					sources;
+	idStrList					files;
+	idStr						string;
+	void						*buffer;
+	int							i, j, num, checksum;
+	int							numTypes, numDefs, numFunctions, numStatements, numBytes;
+	int							returnNum, returnStringNum, sysNum;
+
+	cursor.length = fileSystem->ReadFile( cacheName, &buffer );
+	if ( cursor.length == -1 ) {
+		return false;
+	}
+	cursor.data = (const byte *)buffer;
+	cursor.offset = 0;
+	cursor.error = false;
+
+	header = (const scriptCacheHeader_t *)ReadScriptCacheData( cursor, 1, sizeof( scriptCacheHeader_t ) );
+	if ( header == NULL || header->ident != SCRIPT_CACHE_IDENT || header->version != SCRIPT_CACHE_VERSION || header->valueSize != sizeof( varEval_t ) ||
+			header->maxGlobals != MAX_GLOBALS || header->buildChecksum != ScriptCacheBuildChecksum() ||
+			header->dataLength != cursor.length - cursor.offset || MD5_BlockChecksum( cursor.data + cursor.offset, header->dataLength ) != header->dataChecksum ) {
+		gameLocal.DPrintf( "ignoring %s: written by a different build or corrupt\n", cacheName );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	num = ReadScriptCacheInt( cursor, 0, 0xffff );
+	for( i = 0; i < num && !cursor.error; i++ ) {
+		ReadScriptCacheString( cursor, sources.Alloc() );
+	}
+	if ( cursor.error || !ScriptCacheSourceChecksum( sources, checksum ) || checksum != header->sourceChecksum ) {
+		gameLocal.DPrintf( "ignoring %s: the script source files changed\n", cacheName );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	num = ReadScriptCacheInt( cursor, 0, 0xffff );
+	for( i = 0; i < num && !cursor.error; i++ ) {
+		ReadScriptCacheString( cursor, files.Alloc() );
+	}
+
+	numTypes		= ReadScriptCacheInt( cursor, 0, cursor.length );
+	numDefs			= ReadScriptCacheInt( cursor, 0, cursor.length );
+	numFunctions	= ReadScriptCacheInt( cursor, 0, functions.Max() );
+	numStatements	= ReadScriptCacheInt( cursor, 0, statements.Max() );
+	numBytes		= ReadScriptCacheInt( cursor, 0, sizeof( variables ) );
+	returnNum		= ReadScriptCacheInt( cursor, 0, numDefs - 1 );
+	returnStringNum	= ReadScriptCacheInt( cursor, 0, numDefs - 1 );
+	sysNum			= ReadScriptCacheInt( cursor, 0, numDefs - 1 );
+	if ( cursor.error ) {
+		gameLocal.Warning( "%s is corrupt", cacheName );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	FreeData();
+
+	fileList = files;
+	sourceFiles = sources;
+
+	// allocate everything up front so that the type and def numbers can refer forward
+	types.SetNum( numTypes );
+	for( i = 0; i < numTypes; i++ ) {
+		types[ i ] = new idTypeDef( ev_void, NULL, "", 0, NULL );
+	}
+	varDefs.SetNum( numDefs );
+	for( i = 0; i < numDefs; i++ ) {
+		varDefs[ i ] = new idVarDef();
+		varDefs[ i ]->num = i;
+	}
+	functions.SetNum( numFunctions );
+	statements.SetNum( numStatements );
+	numVariables = numBytes;
+
+	returnDef		= varDefs[ returnNum ];
+	returnStringDef	= varDefs[ returnStringNum ];
+	sysDef			= varDefs[ sysNum ];
+
+	for( i = 0; i < numTypes && !cursor.error; i++ ) {
+		idTypeDef *type = types[ i ];
+
+		type->type		= (etype_t)ReadScriptCacheInt( cursor, ev_error, ev_boolean );
+		ReadScriptCacheString( cursor, type->name );
+		type->size		= ReadScriptCacheInt( cursor, 0, MAX_GLOBALS );
+		type->auxType	= CacheType( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numTypes - 1 ) );
+		type->def		= CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+
+		num = ReadScriptCacheInt( cursor, 0, cursor.length );
+		for( j = 0; j < num && !cursor.error; j++ ) {
+			type->parmTypes.Append( CacheType( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numTypes - 1 ) ) );
+			ReadScriptCacheString( cursor, type->parmNames.Alloc() );
+		}
+
+		num = ReadScriptCacheInt( cursor, 0, cursor.length );
+		for( j = 0; j < num && !cursor.error; j++ ) {
+			type->functions.Append( functions.Ptr() + ReadScriptCacheInt( cursor, 0, numFunctions - 1 ) );
+		}
+	}
+
+	for( i = 0; i < numDefs && !cursor.error; i++ ) {
+		idVarDef *def = varDefs[ i ];
+
+		def->SetTypeDef( CacheType( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numTypes - 1 ) ) );
+		def->scope = CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+		ReadScriptCacheString( cursor, string );
+		def->numUsers = ReadScriptCacheInt( cursor );
+		def->initialized = (idVarDef::initialized_t)ReadScriptCacheInt( cursor, idVarDef::uninitialized, idVarDef::stackVariable );
+
+		switch( ReadScriptCacheInt( cursor, SCRIPT_CACHE_VALUE_RAW, SCRIPT_CACHE_VALUE_FUNCTION ) ) {
+		case SCRIPT_CACHE_VALUE_RAW: {
+			const void *value = ReadScriptCacheData( cursor, 1, sizeof( def->value ) );
+			if ( value ) {
+				memcpy( &def->value, value, sizeof( def->value ) );
+			}
+			break;
+		}
+		case SCRIPT_CACHE_VALUE_VARIABLE:
+			def->value.bytePtr = &variables[ ReadScriptCacheInt( cursor, 0, numVariables ) ];
+			break;
+		case SCRIPT_CACHE_VALUE_FUNCTION:
+			def->value.functionPtr = functions.Ptr() + ReadScriptCacheInt( cursor, 0, numFunctions - 1 );
+			break;
+		}
+
+		// defs are added in the order they were allocated, which gives the same name lists
+		if ( !cursor.error ) {
+			AddDefToNameList( def, string );
+		}
+	}
+
+	for( i = 0; i < numFunctions && !cursor.error; i++ ) {
+		function_t &func = functions[ i ];
+
+		func.Clear();
+		ReadScriptCacheString( cursor, string );
+		func.SetName( string );
+		ReadScriptCacheString( cursor, string );
+		if ( string.Length() ) {
+			func.eventdef = idEventDef::FindEvent( string );
+			if ( !func.eventdef ) {
+				cursor.error = true;
+			}
+		}
+		func.def			= CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+		func.type			= CacheType( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numTypes - 1 ) );
+		func.firstStatement	= ReadScriptCacheInt( cursor, 0, numStatements );
+		func.numStatements	= ReadScriptCacheInt( cursor, 0, numStatements - func.firstStatement );
+		func.parmTotal		= ReadScriptCacheInt( cursor );
+		func.locals			= ReadScriptCacheInt( cursor );
+		func.filenum		= ReadScriptCacheInt( cursor, 0, Max( fileList.Num() - 1, 0 ) );
+
+		num = ReadScriptCacheInt( cursor, 0, cursor.length );
+		func.parmSize.SetGranularity( 1 );
+		for( j = 0; j < num && !cursor.error; j++ ) {
+			func.parmSize.Append( ReadScriptCacheInt( cursor ) );
+		}
+	}
+
+	for( i = 0; i < numStatements && !cursor.error; i++ ) {
+		statement_t &statement = statements[ i ];
+
+		statement.op			= ReadScriptCacheInt( cursor, 0, NUM_OPCODES - 1 );
+		statement.a				= CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+		statement.b				= CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+		statement.c				= CacheDef( ReadScriptCacheInt( cursor, -1 - NUM_SCRIPT_CACHE_BUILTINS, numDefs - 1 ) );
+		statement.linenumber	= ReadScriptCacheInt( cursor, 0, 0xffff );
+		statement.file			= ReadScriptCacheInt( cursor, 0, Max( fileList.Num() - 1, 0 ) );
+	}
+
+	const void *values = ReadScriptCacheData( cursor, numVariables, 1 );
+	if ( values ) {
+		memcpy( variables, values, numVariables );
+	}
+
+	if ( cursor.offset != cursor.length ) {
+		cursor.error = true;
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( cursor.error ) {
+		gameLocal.Warning( "%s is corrupt", cacheName );
+		BeginCompilation();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+================
+idProgram::CacheType
+
+Returns the type for a type number read from the cache, NULL for -1 or a number out of range.
+================
+*/
+idTypeDef *idProgram::CacheType( int num ) const {
+	if ( num >= 0 && num < types.Num() ) {
+		return types[ num ];
+	} else if ( num < -1 ) {
+		return scriptCacheTypes[ -2 - num ];
+	}
+	return NULL;
+}
+
+/*
+================
+idProgram::CacheDef
+
+Returns the def for a def number read from the cache, NULL for -1 or a number out of range.
+================
+*/
+idVarDef *idProgram::CacheDef( int num ) const {
+	if ( num >= 0 && num < varDefs.Num() ) {
+		return varDefs[ num ];
+	} else if ( num < -1 ) {
+		return scriptCacheDefs[ -2 - num ];
+	}
+	return NULL;
+}
+
 /*
 ================
 idProgram::Startup
@@ -1914,9 +2600,20 @@ void idProgram::Startup( const char *defaultScript ) {
 	// get ready for loading scripts
 	BeginCompilation();
 
-	// load the default script
+	// load the default script, from the compiled script cache if none of its files changed
 	if ( defaultScript && *defaultScript ) {
-		CompileFile( defaultScript );
+		idStr cacheName = defaultScript;
+		cacheName.SetFileExtension( SCRIPT_CACHE_EXTENSION );
+
+		if ( g_scriptCache.GetBool() && ReadCache( cacheName ) ) {
+			gameLocal.Printf( "Loaded compiled script from %s\n", cacheName.c_str() );
+			CompileStats();
+		} else {
+			CompileFile( defaultScript );
+			if ( g_scriptCache.GetBool() ) {
+				WriteCache( cacheName );
+			}
+		}
 	}
 
 	FinishCompilation();
@@ -2017,7 +2714,7 @@ int idProgram::CalculateChecksum( void ) const {
 
 	// Copy info into new list, using the variable numbers instead of a pointer to the variable
 	for( i = 0; i < statements.Num(); i++ ) {
-		statementList[i].op = statements[i].op;
+		statementList[i].op = BaseOpcode( statements[i].op );
 
 		if ( statements[i].a ) {
 			statementList[i].a = statements[i].a->num;
@@ -103,6 +103,8 @@ Contains type information for variables and functions.
 ***********************************************************************/
 
 class idTypeDef {
+	friend class idProgram;
+
 private:
 	etype_t						type;
 	idStr 						name;
@@ -448,6 +450,7 @@ single idProgram.
 class idProgram {
 private:
 	idStrList									fileList;
+	idStrList									sourceFiles;	// every file read by the parser, including define only includes
 	idStr 										filename;
 	int											filenum;
 
@@ -471,6 +474,13 @@ private:
 
 	void										CompileStats( void );
 
+	bool										ReadCache( const char *cacheName );
+	void										WriteCache( const char *cacheName ) const;
+	int											CacheTypeNum( const idTypeDef *type, const idHashIndex &typeHash ) const;
+	int											CacheDefNum( const idVarDef *def ) const;
+	idTypeDef									*CacheType( int num ) const;
+	idVarDef									*CacheDef( int num ) const;
+
 public:
 	idVarDef									*returnDef;
 	idVarDef									*returnStringDef;
@@ -493,10 +503,14 @@ public:
 	void										FinishCompilation( void );
 	void										DisassembleStatement( idFile *file, int instructionPointer ) const;
 	void										Disassemble( void ) const;
+	void										FuseStatements( int first, int num );
+	void										UnfuseStatements( int first, int num );
+	static int									BaseOpcode( int op );
 	void										FreeData( void );
 
 	const char									*GetFilename( int num );
 	int											GetFilenum( const char *name );
+	void										AddSourceFile( const char *name );
 	int											GetLineNumberForStatement( int index );
 	const char									*GetFilenameForStatement( int index );
 
@@ -523,6 +537,7 @@ public:
 	statement_t									*AllocStatement( void );
 	statement_t									&GetStatement( int index );
 	int											NumStatements( void ) { return statements.Num(); }
+	int											NumFunctions( void ) { return functions.Num(); }
 
 	int 										GetReturnedInteger( void );
 
@@ -607,6 +622,15 @@ ID_INLINE void idProgram::ReturnString( const char *string ) {
 	idStr::Copynz( returnStringDef->value.stringPtr, string, MAX_STRING_LEN );
 }
 
+/*
+================
+idProgram::AddSourceFile
+================
+*/
+ID_INLINE void idProgram::AddSourceFile( const char *name ) {
+	sourceFiles.AddUnique( name );
+}
+
 /*
 ================
 idProgram::GetFilename
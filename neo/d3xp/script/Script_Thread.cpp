@@ -217,8 +217,19 @@ END_CLASS
 idThread			*idThread::currentThread = NULL;
 int					idThread::threadIndex = 0;
 idList<idThread *>	idThread::threadList;
+idHashIndex			idThread::threadHash;
 trace_t				idThread::trace;
 
+idList<threadBucket_t *>				idThread::scheduleBuckets;
+idBlockAlloc<threadBucket_t, 64>		idThread::bucketAllocator;
+
+int					idThread::numThreadsRun = 0;
+int					idThread::numThreadsWoken = 0;
+int					idThread::numThreadsScheduled = 0;
+int					idThread::numThreadsWaiting = 0;
+int					idThread::lastFrameThreadsRun = 0;
+int					idThread::lastFrameThreadsWoken = 0;
+
 /*
 ================
 idThread::CurrentThread
@@ -346,19 +357,16 @@ idThread::~idThread
 */
 idThread::~idThread() {
 	idThread	*thread;
-	int			i;
-	int			n;
 
 	if ( g_debugScript.GetBool() ) {
 		gameLocal.Printf( "%d: end thread (%d) '%s'\n", gameLocal.time, threadNum, threadName.c_str() );
 	}
-	threadList.Remove( this );
-	n = threadList.Num();
-	for( i = 0; i < n; i++ ) {
-		thread = threadList[ i ];
-		if ( thread->WaitingOnThread() == this ) {
-			thread->ThreadCallback( this );
-		}
+	ClearWaitFor();
+	RemoveFromThreadList();
+
+	// the callback unlinks each waiter
+	while( ( thread = waiters.Next() ) != NULL ) {
+		thread->ThreadCallback( this );
 	}
 
 	if ( currentThread == this ) {
@@ -407,7 +415,21 @@ idThread::Restore
 ================
 */
 void idThread::Restore( idRestoreGame *savefile ) {
+	int i;
+	int oldThreadNum;
+
+	// Init gave the thread a new number, rekey it
+	oldThreadNum = threadNum;
 	savefile->ReadInt( threadNum );
+	if ( threadNum != oldThreadNum ) {
+		for( i = threadHash.First( oldThreadNum ); i != -1; i = threadHash.Next( i ) ) {
+			if ( threadList[ i ] == this ) {
+				threadHash.Remove( oldThreadNum, i );
+				threadHash.Add( threadNum, i );
+				break;
+			}
+		}
+	}
 
 	savefile->ReadObject( reinterpret_cast<idClass *&>( waitingForThread ) );
 	savefile->ReadInt( waitingFor );
@@ -422,6 +444,24 @@ void idThread::Restore( idRestoreGame *savefile ) {
 	savefile->ReadInt( creationTime );
 
 	savefile->ReadBool( manualControl );
+
+	// rebuild the wait links and the schedule, which are not saved
+	if ( waitingFor != ENTITYNUM_NONE ) {
+		numThreadsWaiting++;
+	}
+	if ( waitingForThread ) {
+		waitNode.AddToEnd( waitingForThread->waiters );
+		numThreadsWaiting++;
+	}
+	if ( !manualControl && ( waitingUntil > lastExecuteTime ) ) {
+		Schedule();
+	}
+
+	// savegames from before the schedule may still hold the execute event of a
+	// sleeping or waiting thread, the schedule or the wait wakes it up now
+	if ( scheduleNode.InList() || waitingForThread || ( waitingFor != ENTITYNUM_NONE ) ) {
+		CancelEvents( &EV_Thread_Execute );
+	}
 }
 
 /*
@@ -439,13 +479,18 @@ void idThread::Init( void ) {
 	} while( GetThread( threadIndex ) );
 
 	threadNum = threadIndex;
-	threadList.Append( this );
+	threadHash.Add( threadNum, threadList.Append( this ) );
 	
 	creationTime = gameLocal.time;
 	lastExecuteTime = 0;
 	manualControl = false;
 
-	ClearWaitFor();
+	scheduleNode.SetOwner( this );
+	waitNode.SetOwner( this );
+
+	waitingFor			= ENTITYNUM_NONE;
+	waitingForThread	= NULL;
+	waitingUntil		= 0;
 
 	interpreter.SetThread( this );
 }
@@ -456,21 +501,138 @@ idThread::GetThread
 ================
 */
 idThread *idThread::GetThread( int num ) {
-	int			i;
-	int			n;
-	idThread	*thread;
+	int i;
 
-	n = threadList.Num();
-	for( i = 0; i < n; i++ ) {
-		thread = threadList[ i ];
-		if ( thread->GetThreadNum() == num ) {
-			return thread;
+	for( i = threadHash.First( num ); i != -1; i = threadHash.Next( i ) ) {
+		if ( threadList[ i ]->threadNum == num ) {
+			return threadList[ i ];
 		}
 	}
 
 	return NULL;
 }
 
+/*
+================
+idThread::RemoveFromThreadList
+
+Moves the last thread into the freed slot so the hash only changes for two threads.
+================
+*/
+void idThread::RemoveFromThreadList( void ) {
+	int			i;
+	int			last;
+	idThread	*moved;
+
+	for( i = threadHash.First( threadNum ); i != -1; i = threadHash.Next( i ) ) {
+		if ( threadList[ i ] == this ) {
+			break;
+		}
+	}
+	if ( i == -1 ) {
+		return;
+	}
+
+	threadHash.Remove( threadNum, i );
+	last = threadList.Num() - 1;
+	if ( i != last ) {
+		moved = threadList[ last ];
+		threadHash.Remove( moved->threadNum, last );
+		threadList[ i ] = moved;
+		threadHash.Add( moved->threadNum, i );
+	}
+	threadList.RemoveIndex( last );
+}
+
+/*
+================
+idThread::Schedule
+
+Puts the thread to sleep until waitingUntil.
+================
+*/
+void idThread::Schedule( void ) {
+	threadBucket_t	*bucket;
+	int				low;
+	int				high;
+	int				mid;
+
+	Unschedule();
+
+	// find the first bucket that does not wake up later
+	low = 0;
+	high = scheduleBuckets.Num();
+	while( low < high ) {
+		mid = ( low + high ) >> 1;
+		if ( scheduleBuckets[ mid ]->time > waitingUntil ) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if ( low < scheduleBuckets.Num() && scheduleBuckets[ low ]->time == waitingUntil ) {
+		bucket = scheduleBuckets[ low ];
+	} else {
+		bucket = bucketAllocator.Alloc();
+		bucket->time = waitingUntil;
+		scheduleBuckets.Insert( bucket, low );
+	}
+
+	scheduleNode.AddToEnd( bucket->threads );
+	numThreadsScheduled++;
+}
+
+/*
+================
+idThread::Unschedule
+================
+*/
+void idThread::Unschedule( void ) {
+	if ( scheduleNode.InList() ) {
+		scheduleNode.Remove();
+		numThreadsScheduled--;
+	}
+}
+
+/*
+================
+idThread::RunScheduledThreads
+
+Runs the threads whose wait has expired, in order of wake up time.  Called once
+per game frame before the events are serviced, it also ends the frame for the
+scheduler counters.
+================
+*/
+void idThread::RunScheduledThreads( void ) {
+	threadBucket_t	*bucket;
+	idThread		*thread;
+
+	lastFrameThreadsRun = numThreadsRun;
+	lastFrameThreadsWoken = numThreadsWoken;
+	numThreadsRun = 0;
+	numThreadsWoken = 0;
+
+	while( scheduleBuckets.Num() ) {
+		bucket = scheduleBuckets[ scheduleBuckets.Num() - 1 ];
+		if ( bucket->time > gameLocal.time ) {
+			break;
+		}
+
+		while( ( thread = bucket->threads.Next() ) != NULL ) {
+			thread->Unschedule();
+			numThreadsWoken++;
+			thread->Execute();
+		}
+
+		// a thread may have restarted the scripts
+		if ( scheduleBuckets.Num() && scheduleBuckets[ scheduleBuckets.Num() - 1 ] == bucket ) {
+			scheduleBuckets.RemoveIndex( scheduleBuckets.Num() - 1 );
+			bucketAllocator.Free( bucket );
+		}
+	}
+}
+
 /*
 ================
 idThread::DisplayInfo
@@ -524,7 +686,8 @@ void idThread::ListThreads_f( const idCmdArgs &args ) {
 		//threadList[ i ]->DisplayInfo();
 		gameLocal.Printf( "%3i: %-20s : %s(%d)\n", threadList[ i ]->threadNum, threadList[ i ]->threadName.c_str(), threadList[ i ]->interpreter.CurrentFile(), threadList[ i ]->interpreter.CurrentLine() );
 	}
-	gameLocal.Printf( "%d active threads\n\n", n );
+	gameLocal.Printf( "%d active threads\n", n );
+	gameLocal.Printf( "%d sleeping, %d run and %d woken last frame\n\n", numThreadsScheduled + numThreadsWaiting, lastFrameThreadsRun, lastFrameThreadsWoken );
 }
 
 /*
@@ -545,6 +708,16 @@ void idThread::Restart( void ) {
 		delete threadList[ i ];
 	}
 	threadList.Clear();
+	threadHash.Clear();
+
+	for( i = 0; i < scheduleBuckets.Num(); i++ ) {
+		bucketAllocator.Free( scheduleBuckets[ i ] );
+	}
+	scheduleBuckets.Clear();
+	numThreadsScheduled = 0;
+	numThreadsWaiting = 0;
+
+	idInterpreter::ClearProfile();
 
 	memset( &trace, 0, sizeof( trace ) );
 	trace.c.entityNum = ENTITYNUM_NONE;
@@ -556,6 +729,10 @@ idThread::DelayedStart
 ================
 */
 void idThread::DelayedStart( int delay ) {
+	// the event starts the thread now, not the schedule
+	Unschedule();
+	waitingUntil = 0;
+
 	CancelEvents( &EV_Thread_Execute );
 	if ( gameLocal.time <= 0 ) {
 		delay++;
@@ -610,9 +787,20 @@ idThread::End
 ================
 */
 void idThread::End( void ) {
+	bool	sleeping;
+	int		wakeTime;
+
 	// Tell thread to die.  It will exit on its own.
+	sleeping = scheduleNode.InList();
+	wakeTime = waitingUntil;
 	Pause();
 	interpreter.threadDying	= true;
+
+	// a sleeping thread dies when it wakes up
+	if ( sleeping ) {
+		waitingUntil = wakeTime;
+		Schedule();
+	}
 }
 
 /*
@@ -673,6 +861,8 @@ bool idThread::Execute( void ) {
 		return false;
 	}
 
+	numThreadsRun++;
+
 	oldThread = currentThread;
 	currentThread = this;
 
@@ -686,7 +876,7 @@ bool idThread::Execute( void ) {
 		}
 	} else if ( !manualControl ) {
 		if ( waitingUntil > lastExecuteTime ) {
-			PostEventMS( &EV_Thread_Execute, waitingUntil - lastExecuteTime );
+			Schedule();
 		} else if ( interpreter.MultiFrameEventInProgress() ) {
 			PostEventMS( &EV_Thread_Execute, gameLocal.msec );
 		}
@@ -747,6 +937,15 @@ idThread::ClearWaitFor
 ================
 */
 void idThread::ClearWaitFor( void ) {
+	if ( waitingFor != ENTITYNUM_NONE ) {
+		numThreadsWaiting--;
+	}
+	if ( waitNode.InList() ) {
+		waitNode.Remove();
+		numThreadsWaiting--;
+	}
+	Unschedule();
+
 	waitingFor			= ENTITYNUM_NONE;
 	waitingForThread	= NULL;
 	waitingUntil		= 0;
@@ -772,6 +971,7 @@ void idThread::ObjectMoveDone( idEntity *obj ) {
 
 	if ( IsWaitingFor( obj ) ) {
 		ClearWaitFor();
+		numThreadsWoken++;
 		DelayedStart( 0 );
 	}
 }
@@ -782,12 +982,14 @@ idThread::ThreadCallback
 ================
 */
 void idThread::ThreadCallback( idThread *thread ) {
-	if ( interpreter.threadDying ) {
+	if ( thread != waitingForThread ) {
 		return;
 	}
 
-	if ( thread == waitingForThread ) {
-		ClearWaitFor();
+	// always unlink from the ending thread, even when dying ourselves
+	ClearWaitFor();
+	if ( !interpreter.threadDying ) {
+		numThreadsWoken++;
 		DelayedStart( 0 );
 	}
 }
@@ -886,6 +1088,11 @@ idThread::Event_Execute
 ================
 */
 void idThread::Event_Execute( void ) {
+	// sleeping threads are run by the scheduler and waiting threads by what
+	// they wait for, this can only be a stale event from a savegame
+	if ( scheduleNode.InList() || waitingForThread || ( waitingFor != ENTITYNUM_NONE ) ) {
+		return;
+	}
 	Execute();
 }
 
@@ -989,6 +1196,7 @@ void idThread::Event_WaitFor( idEntity *ent ) {
 		if ( gameLocal.program.GetReturnedInteger() ) {
 			Pause();
 			waitingFor = ent->entityNumber;
+			numThreadsWaiting++;
 		}
 	}
 }
@@ -1010,6 +1218,8 @@ void idThread::Event_WaitForThread( int num ) {
 	} else {
 		Pause();
 		waitingForThread = thread;
+		waitNode.AddToEnd( thread->waiters );
+		numThreadsWaiting++;
 	}
 }
 
@@ -2669,6 +2669,7 @@ void idCommonLocal::LoadGameDLL( void ) {
 	gameImport.declManager				= ::declManager;
 	gameImport.AASFileManager			= ::AASFileManager;
 	gameImport.collisionModelManager	= ::collisionModelManager;
+	gameImport.jobSystem				= ::jobSystem;
 
 	gameExport							= *GetGameAPI( &gameImport );
 
@@ -2825,6 +2826,9 @@ void idCommonLocal::Init( int argc, const char **argv, const char *cmdline ) {
 		// initialize processor specific SIMD implementation
 		InitSIMD();
 
+		// start the job worker threads
+		jobSystem->Init();
+
 		// init commands
 		InitCommands();
 
@@ -2883,6 +2887,9 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame( false );
 
+	// stop the job worker threads
+	jobSystem->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -3031,6 +3038,9 @@ void idCommonLocal::InitGame( void ) {
 
 	// load the game dll
 	LoadGameDLL();
+
+	// the game registered its decl folders
+	declManager->Init2();
 	
 	PrintLoadingMessage( common->GetLanguageDict()->GetString( "#str_04351" ) );
 
@@ -59,6 +59,15 @@ reloading over a decl name that was valid
 
 missing reload over a previously explicit definition
 
+The decl index
+
+Every time a decl file is parsed, the decls found in it are recorded with their type, name,
+offset and length in the file, and the checksum of their text.  The records of all the files
+are written to a decl index in the save path, with the length, timestamp and pak checksum of
+each file and a checksum of the whole index.  A file that has the same length, timestamp and pak
+checksum the next time it is loaded gets its decls from the index without being read, and the
+text of a decl is only read from the file when the decl is first parsed.
+
 */
 
 #define USE_COMPRESSED_DECLS
@@ -80,6 +89,40 @@ public:
 
 class idDeclFile;
 
+typedef struct declSpan_s {
+	int							type;					// declType_t
+	int							textOffset;				// offset in the file to the decl text
+	int							textLength;				// length of the decl text
+	int							nameOffset;				// offset in the file to the decl name
+	int							nameLength;
+	int							sourceLine;				// this is where the decl text starts
+	int							endLine;				// line after the decl text
+} declSpan_t;
+
+typedef struct declIndexEntry_s {
+	int							type;					// declType_t
+	int							nameOffset;				// offset in the names of the file
+	int							textOffset;
+	int							textLength;
+	int							sourceLine;
+	int							endLine;
+	int							checksum;				// checksum of the decl text, 0 if the decl was previously defined
+} declIndexEntry_t;
+
+class idDeclFileScan {
+public:
+	idDeclFile *				file;
+	char *						buffer;					// file text, read on the main thread
+	int							length;
+	declSpan_t *				spans;					// decls found in the file
+	int							maxSpans;
+	int							numSpans;
+	int							numLines;
+	int							checksum;
+	bool						fallback;				// the file has to be parsed with the lexer
+	double						scanTicks;				// clock ticks spent scanning the file
+};
+
 class idDeclLocal : public idDeclBase {
 	friend class idDeclFile;
 	friend class idDeclManagerLocal;
@@ -129,6 +172,9 @@ protected:
 								// Set textSource possible with compression.
 	void						SetTextLocal( const char *text, const int length );
 
+								// Reads the text of a decl that was added from the decl index.
+	void						LoadPendingText( void );
+
 private:
 	idDecl *					self;
 
@@ -141,6 +187,7 @@ private:
 	int							sourceTextLength;		// length of decl text in source file
 	int							sourceLine;				// this is where the actual declaration token starts
 	int							checksum;				// checksum of the decl text
+	bool						textPending;			// the text has not been read from the source file yet
 	declType_t					type;					// decl type
 	declState_t					declState;				// decl state
 	int							index;					// index in the per-type list
@@ -157,9 +204,16 @@ class idDeclFile {
 public:
 								idDeclFile();
 								idDeclFile( const char *fileName, declType_t defaultType );
+								~idDeclFile();
 
 	void						Reload( bool force );
 	int							LoadAndParse();
+								// Adds the decls in the buffer, from the scan if it has one, and frees the buffer.
+								// Without a buffer the decls are added from the index entries.
+	int							Parse( char *buffer, int length, const idDeclFileScan *scan );
+								// Returns the file text for decls that were added from the index.
+	const char *				GetPendingText( void );
+	void						FreePendingText( void );
 
 public:
 	idStr						fileName;
@@ -169,15 +223,40 @@ public:
 	int							checksum;
 	int							fileSize;
 	int							numLines;
+	int							pakChecksum;			// of the pak file the file was read from, 0 if not from a pak
 
 	idDeclLocal *				decls;
+
+								// decl index
+	bool						indexed;				// the index entries are valid for the file
+	int							typesChecksum;			// checksum of the decl types registered when the file was parsed
+	idList<declIndexEntry_t>	indexEntries;			// every decl found in the file, in order
+	char *						indexNames;
+	int							indexNamesLength;
+	char *						pendingText;			// file text while decls added from the index are parsed
+
+private:
+	idDeclLocal *				AddDecl( declType_t type, const char *name, const char *buffer, int textOffset, int textLength, int sourceLine, int warningLine, int textChecksum );
+	void						AddIndexEntry( declType_t type, const char *name, int textOffset, int textLength, int sourceLine, int endLine, const idDeclLocal *decl, idStrList &names );
 };
 
+typedef struct declLoadTime_s {
+	int							numFiles;				// files with this default type
+	int							numIndexed;				// files added from the decl index
+	int							fileLength;
+	double						readMsec;
+	double						scanMsec;
+	int							numDecls;				// decls of this type
+	double						addMsec;
+} declLoadTime_t;
+
 class idDeclManagerLocal : public idDeclManager {
 	friend class idDeclLocal;
+	friend class idDeclFile;
 
 public:
 	virtual void				Init( void );
+	virtual void				Init2( void );
 	virtual void				Shutdown( void );
 	virtual void				Reload( bool force );
 	virtual void				BeginLevelLoad();
@@ -220,6 +299,7 @@ public:
 
 	idDeclType *				GetDeclType( int type ) const { return declTypes[type]; }
 	const idDeclFile *			GetImplicitDeclFile( void ) const { return &implicitDecls; }
+	declLoadTime_t &			GetLoadTime( int type ) { return loadTimes[type]; }
 
 private:
 	idList<idDeclType *>		declTypes;
@@ -234,16 +314,54 @@ private:
 	int							checksum;		// checksum of all loaded decl text
 	int							indent;			// for MediaPrint
 	bool						insideLevelLoad;
+	declLoadTime_t				loadTimes[DECL_MAX_TYPES];
+	int							typesChecksum;	// checksum of the registered decl types
+
+	idList<idDeclFile *>		indexFiles;		// files in the decl index that have not been loaded
+	idHashIndex					indexFileHash;
+	bool						indexRead;
+	bool						indexDirty;		// the index has to be written again
+	bool						initDone;		// all the startup decl folders are registered
 
 	static idCVar				decl_show;
+	static idCVar				decl_parallelScan;
+	static idCVar				decl_useIndex;
 
 private:
+	void						LoadDeclFiles( idDeclFile **files, int numFiles );
+	void						ReadDeclIndex( void );
+	void						WriteDeclIndex( void );
+	void						FreeDeclIndex( void );
+	bool						LoadIndexedFile( idDeclFile *file );
+
 	static void					ListDecls_f( const idCmdArgs &args );
+	static void					ListDeclLoadTimes_f( const idCmdArgs &args );
 	static void					ReloadDecls_f( const idCmdArgs &args );
 	static void					TouchDecl_f( const idCmdArgs &args );
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar idDeclManagerLocal::decl_parallelScan( "decl_parallelScan", "1", CVAR_SYSTEM | CVAR_BOOL, "scan decl files for decls with the job system" );
+idCVar idDeclManagerLocal::decl_useIndex( "decl_useIndex", "1", CVAR_SYSTEM | CVAR_BOOL, "add the decls of unchanged files from the decl index and only read their text when they are parsed" );
+
+const char *	DECL_INDEX_FILE		= "decls.idx";
+const int		DECL_INDEX_IDENT	= ( 'X' << 24 ) + ( 'D' << 16 ) + ( 'I' << 8 ) + 'D';
+const int		DECL_INDEX_VERSION	= 1;
+
+typedef struct {
+	int							ident;
+	int							version;
+	int							entrySize;				// sizeof( declIndexEntry_t ), entries are stored as they are in memory
+	int							dataLength;				// length of everything after the header
+	int							dataChecksum;
+} declIndexHeader_t;
+
+typedef struct declIndexCursor_s {
+	const byte *				data;
+	int							length;
+	int							offset;
+	bool						error;					// set when anything would be read past the end
+} declIndexCursor_t;
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager *		declManager = &declManagerLocal;
@@ -530,6 +648,447 @@ void ListHuffmanFrequencies_f( const idCmdArgs &args ) {
 	common->Printf( "}\n" );
 }
 
+/*
+====================================================================================
+
+ decl file scanning
+
+ Decl files are read on the main thread and then scanned for decl boundaries and names
+ in parallel jobs.  The scanner follows the idLexer rules for DECL_LEXER_FLAGS, but only
+ keeps track of positions so it never touches the heap.  Anything the lexer would print
+ a warning or an error for makes the file fall back to the lexer on the main thread, so
+ the warnings and the resulting decls are exactly the same.
+
+====================================================================================
+*/
+
+typedef struct declToken_s {
+	const char *				text;
+	int							length;
+	int							type;					// TT_*
+	bool						concatenated;			// string with '\' concatenated parts, text is not contiguous
+} declToken_t;
+
+class idDeclScanner {
+public:
+	void						Scan( idDeclFileScan &scan );
+
+private:
+	const char *				script_p;
+	int							line;
+	bool						fallback;
+	bool						tokenAvailable;
+	declToken_t					unreadToken;
+
+	bool						ReadWhiteSpace( void );
+	bool						ReadString( declToken_t &token, int quote );
+	bool						ReadNumber( declToken_t &token );
+	void						ReadName( declToken_t &token );
+	bool						ReadToken( declToken_t &token );
+	bool						SkipBracedSection( bool parseFirstBrace );
+	declType_t					TypeFromToken( const declToken_t &token ) const;
+	static bool					IsBrace( const declToken_t &token, char brace ) { return token.length == 1 && token.text[0] == brace && !token.concatenated; }
+};
+
+/*
+================
+idDeclScanner::ReadWhiteSpace
+================
+*/
+bool idDeclScanner::ReadWhiteSpace( void ) {
+	while( 1 ) {
+		// skip white space
+		while( *script_p <= ' ' ) {
+			if ( !*script_p ) {
+				return false;
+			}
+			if ( *script_p == '\n' ) {
+				line++;
+			}
+			script_p++;
+		}
+		// skip comments
+		if ( *script_p == '/' ) {
+			if ( *(script_p+1) == '/' ) {
+				script_p++;
+				do {
+					script_p++;
+					if ( !*script_p ) {
+						return false;
+					}
+				} while( *script_p != '\n' );
+				line++;
+				script_p++;
+				if ( !*script_p ) {
+					return false;
+				}
+				continue;
+			} else if ( *(script_p+1) == '*' ) {
+				script_p++;
+				while( 1 ) {
+					script_p++;
+					if ( !*script_p ) {
+						return false;
+					}
+					if ( *script_p == '\n' ) {
+						line++;
+					} else if ( *script_p == '/' ) {
+						if ( *(script_p-1) == '*' ) {
+							break;
+						}
+						if ( *(script_p+1) == '*' ) {
+							fallback = true;	// nested comment warning
+						}
+					}
+				}
+				script_p++;
+				if ( !*script_p ) {
+					return false;
+				}
+				script_p++;
+				if ( !*script_p ) {
+					return false;
+				}
+				continue;
+			}
+		}
+		break;
+	}
+	return true;
+}
+
+/*
+================
+idDeclScanner::ReadString
+================
+*/
+bool idDeclScanner::ReadString( declToken_t &token, int quote ) {
+	const char *tmpscript_p;
+	int tmpline;
+
+	token.type = ( quote == '\"' ) ? TT_STRING : TT_LITERAL;
+	token.text = ++script_p;
+	token.concatenated = false;
+
+	while( 1 ) {
+		if ( *script_p == quote ) {
+			token.length = script_p - token.text;
+			script_p++;
+			// only double quoted strings can be continued after a '\'
+			if ( quote != '\"' ) {
+				break;
+			}
+			tmpscript_p = script_p;
+			tmpline = line;
+			if ( !ReadWhiteSpace() || *script_p != '\\' ) {
+				script_p = tmpscript_p;
+				line = tmpline;
+				break;
+			}
+			script_p++;
+			if ( !ReadWhiteSpace() || *script_p != quote ) {
+				fallback = true;
+				return false;
+			}
+			script_p++;
+			token.concatenated = true;
+		} else if ( *script_p == '\0' || *script_p == '\n' ) {
+			fallback = true;
+			return false;
+		} else {
+			script_p++;
+		}
+	}
+	return true;
+}
+
+/*
+================
+idDeclScanner::ReadNumber
+
+Only finds the end of the number the same way idLexer::ReadNumber does.
+================
+*/
+bool idDeclScanner::ReadNumber( declToken_t &token ) {
+	char c, c2;
+	int dot;
+	bool isFloat;
+
+	token.type = TT_NUMBER;
+	token.text = script_p;
+	token.concatenated = false;
+
+	c = *script_p;
+	c2 = *(script_p + 1);
+	isFloat = false;
+
+	if ( c == '0' && c2 != '.' ) {
+		if ( c2 == 'x' || c2 == 'X' ) {
+			script_p += 2;
+			while( ( *script_p >= '0' && *script_p <= '9' ) || ( *script_p >= 'a' && *script_p <= 'f' ) || ( *script_p >= 'A' && *script_p <= 'F' ) ) {
+				script_p++;
+			}
+		} else if ( c2 == 'b' || c2 == 'B' ) {
+			script_p += 2;
+			while( *script_p == '0' || *script_p == '1' ) {
+				script_p++;
+			}
+		} else {
+			script_p++;
+			while( *script_p >= '0' && *script_p <= '7' ) {
+				script_p++;
+			}
+		}
+	} else {
+		dot = 0;
+		while( ( *script_p >= '0' && *script_p <= '9' ) || *script_p == '.' ) {
+			if ( *script_p == '.' ) {
+				dot++;
+			}
+			script_p++;
+		}
+		c = *script_p;
+		if ( c == 'e' && dot == 0 ) {
+			dot++;
+		}
+		if ( dot == 1 ) {
+			isFloat = true;
+			if ( c == 'e' ) {
+				script_p++;
+				if ( *script_p == '-' || *script_p == '+' ) {
+					script_p++;
+				}
+				while( *script_p >= '0' && *script_p <= '9' ) {
+					script_p++;
+				}
+			} else if ( c == '#' ) {
+				// floating point exceptions are errors with the decl lexer flags
+				fallback = true;
+				return false;
+			}
+		} else if ( dot > 1 ) {
+			// ip addresses are errors with the decl lexer flags
+			fallback = true;
+			return false;
+		}
+	}
+
+	// the precision and type suffixes are skipped, but they are not part of the token text
+	token.length = script_p - token.text;
+	c = *script_p;
+	if ( isFloat ) {
+		if ( c == 'f' || c == 'F' || c == 'l' || c == 'L' ) {
+			script_p++;
+		}
+	} else {
+		for ( int i = 0; i < 2; i++ ) {
+			if ( c != 'l' && c != 'L' && c != 'u' && c != 'U' ) {
+				break;
+			}
+			c = *(++script_p);
+		}
+	}
+	return true;
+}
+
+/*
+================
+idDeclScanner::ReadName
+================
+*/
+void idDeclScanner::ReadName( declToken_t &token ) {
+	char c;
+
+	token.type = TT_NAME;
+	token.text = script_p;
+	token.concatenated = false;
+	do {
+		c = *(++script_p);
+	} while( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) || c == '_' ||
+				c == '/' || c == '\\' || c == ':' || c == '.' );
+	token.length = script_p - token.text;
+}
+
+/*
+================
+idDeclScanner::ReadToken
+================
+*/
+bool idDeclScanner::ReadToken( declToken_t &token ) {
+	char c;
+
+	if ( tokenAvailable ) {
+		tokenAvailable = false;
+		token = unreadToken;
+		return true;
+	}
+	if ( !ReadWhiteSpace() ) {
+		return false;
+	}
+
+	c = *script_p;
+	if ( ( c >= '0' && c <= '9' ) || ( c == '.' && *(script_p + 1) >= '0' && *(script_p + 1) <= '9' ) ) {
+		return ReadNumber( token );
+	} else if ( c == '\"' || c == '\'' ) {
+		return ReadString( token, c );
+	} else if ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '_' || c == '/' || c == '\\' || c == '.' ) {
+		ReadName( token );
+		return true;
+	} else if ( strchr( "!#$%&()*+,-./:;<=>?[\\]^{|}~", c ) != NULL ) {
+		// none of the longer punctuations continue with a brace, quote or comment, so one character is enough
+		token.type = TT_PUNCTUATION;
+		token.text = script_p++;
+		token.length = 1;
+		token.concatenated = false;
+		return true;
+	}
+	// unknown punctuation error
+	fallback = true;
+	return false;
+}
+
+/*
+================
+idDeclScanner::SkipBracedSection
+================
+*/
+bool idDeclScanner::SkipBracedSection( bool parseFirstBrace ) {
+	declToken_t token;
+	int depth;
+
+	depth = parseFirstBrace ? 0 : 1;
+	do {
+		if ( !ReadToken( token ) ) {
+			return false;
+		}
+		if ( token.type == TT_PUNCTUATION ) {
+			if ( token.text[0] == '{' ) {
+				depth++;
+			} else if ( token.text[0] == '}' ) {
+				depth--;
+			}
+		}
+	} while( depth );
+	return true;
+}
+
+/*
+================
+idDeclScanner::TypeFromToken
+================
+*/
+declType_t idDeclScanner::TypeFromToken( const declToken_t &token ) const {
+	int numTypes = declManagerLocal.GetNumDeclTypes();
+	for ( int i = 0; i < numTypes; i++ ) {
+		idDeclType *typeInfo = declManagerLocal.GetDeclType( i );
+		if ( typeInfo && typeInfo->typeName.Length() == token.length && idStr::Icmpn( typeInfo->typeName, token.text, token.length ) == 0 ) {
+			return typeInfo->type;
+		}
+	}
+	return DECL_MAX_TYPES;
+}
+
+/*
+================
+idDeclScanner::Scan
+
+Finds the decls the same way idDeclFile::Parse does with the lexer.
+================
+*/
+void idDeclScanner::Scan( idDeclFileScan &scan ) {
+	declToken_t token, name;
+	declType_t identifiedType;
+	int startMarker, sourceLine;
+
+	script_p = scan.buffer;
+	line = 1;
+	fallback = false;
+	tokenAvailable = false;
+	scan.numSpans = 0;
+
+	while( !fallback ) {
+
+		startMarker = script_p - scan.buffer;
+		sourceLine = line;
+
+		// parse the decl type name
+		if ( !ReadToken( token ) ) {
+			break;
+		}
+		if ( token.concatenated ) {
+			fallback = true;
+			break;
+		}
+
+		identifiedType = TypeFromToken( token );
+		if ( identifiedType == DECL_MAX_TYPES ) {
+			// missing decl name and missing type warnings
+			if ( IsBrace( token, '{' ) || scan.file->defaultType == DECL_MAX_TYPES ) {
+				fallback = true;
+				break;
+			}
+			unreadToken = token;
+			tokenAvailable = true;
+			identifiedType = scan.file->defaultType;
+		}
+
+		// now parse the name
+		if ( !ReadToken( name ) || name.concatenated || IsBrace( name, '{' ) ) {
+			fallback = true;
+			break;
+		}
+
+		// export decls are skipped
+		if ( identifiedType == DECL_MODELEXPORT ) {
+			SkipBracedSection( true );
+			continue;
+		}
+
+		// make sure there's a '{'
+		if ( !ReadToken( token ) || !IsBrace( token, '{' ) ) {
+			fallback = true;
+			break;
+		}
+		unreadToken = token;
+		tokenAvailable = true;
+
+		// now take everything until a matched closing brace
+		if ( !SkipBracedSection( true ) || scan.numSpans >= scan.maxSpans ) {
+			fallback = true;
+			break;
+		}
+
+		declSpan_t &span = scan.spans[scan.numSpans++];
+		span.type = identifiedType;
+		span.textOffset = startMarker;
+		span.textLength = ( script_p - scan.buffer ) - startMarker;
+		span.nameOffset = name.text - scan.buffer;
+		span.nameLength = name.length;
+		span.sourceLine = sourceLine;
+		span.endLine = line;
+	}
+
+	scan.numLines = line;
+	scan.fallback = fallback;
+}
+
+/*
+================
+DeclScanJob
+================
+*/
+static void DeclScanJob( void *data ) {
+	idDeclFileScan *scan = (idDeclFileScan *)data;
+	idDeclScanner scanner;
+
+	double ticks = Sys_GetClockTicks();
+
+	scan->checksum = MD5_BlockChecksum( scan->buffer, scan->length );
+	scanner.Scan( *scan );
+
+	scan->scanTicks = Sys_GetClockTicks() - ticks;
+}
+
 /*
 ====================================================================================
 
@@ -550,7 +1109,13 @@ idDeclFile::idDeclFile( const char *fileName, declType_t defaultType ) {
 	this->checksum = 0;
 	this->fileSize = 0;
 	this->numLines = 0;
+	this->pakChecksum = 0;
 	this->decls = NULL;
+	this->indexed = false;
+	this->typesChecksum = 0;
+	this->indexNames = NULL;
+	this->indexNamesLength = 0;
+	this->pendingText = NULL;
 }
 
 /*
@@ -565,7 +1130,23 @@ idDeclFile::idDeclFile() {
 	this->checksum = 0;
 	this->fileSize = 0;
 	this->numLines = 0;
+	this->pakChecksum = 0;
 	this->decls = NULL;
+	this->indexed = false;
+	this->typesChecksum = 0;
+	this->indexNames = NULL;
+	this->indexNamesLength = 0;
+	this->pendingText = NULL;
+}
+
+/*
+================
+idDeclFile::~idDeclFile
+================
+*/
+idDeclFile::~idDeclFile() {
+	Mem_Free( indexNames );
+	FreePendingText();
 }
 
 /*
@@ -600,169 +1181,370 @@ This is used during both the initial load, and any reloads
 int c_savedMemory = 0;
 
 int idDeclFile::LoadAndParse() {
-	int			i, numTypes;
-	idLexer		src;
-	idToken		token;
-	int			startMarker;
 	char *		buffer;
-	int			length, size;
-	int			sourceLine;
-	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
+	int			length;
 
 	// load the text
 	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+	fileSystem->GetFileStamp( fileName, NULL, &pakChecksum );
 	length = fileSystem->ReadFile( fileName, (void **)&buffer, &timestamp );
 	if ( length == -1 ) {
 		common->FatalError( "couldn't load %s", fileName.c_str() );
 		return 0;
 	}
 
-	if ( !src.LoadMemory( buffer, length, fileName ) ) {
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+	return Parse( buffer, length, NULL );
+}
+
+/*
+================
+idDeclFile::GetPendingText
+
+The file is read the first time one of the decls that were added from the index is parsed,
+and kept until the end of the level load.  If the file changed since it was indexed it is
+parsed again, which gives all its decls their text, and NULL is returned.
+================
+*/
+const char *idDeclFile::GetPendingText( void ) {
+	char *		buffer;
+	int			length;
+	ID_TIME_T	newTimestamp;
+
+	if ( pendingText ) {
+		return pendingText;
+	}
+
+	length = fileSystem->ReadFile( fileName, (void **)&buffer, &newTimestamp );
+	if ( length == -1 ) {
+		common->Warning( "couldn't load %s", fileName.c_str() );
+		return NULL;
+	}
+
+	if ( length != fileSize || newTimestamp != timestamp || (int)MD5_BlockChecksum( buffer, length ) != checksum ) {
+		common->Warning( "%s changed since the decl index was written", fileName.c_str() );
+		timestamp = newTimestamp;
+		fileSystem->GetFileStamp( fileName, NULL, &pakChecksum );
+		Parse( buffer, length, NULL );
+		return NULL;
+	}
+
+	pendingText = buffer;
+	return pendingText;
+}
+
+/*
+================
+idDeclFile::FreePendingText
+================
+*/
+void idDeclFile::FreePendingText( void ) {
+	if ( pendingText ) {
+		fileSystem->FreeFile( pendingText );
+		pendingText = NULL;
 	}
+}
+
+/*
+================
+idDeclFile::AddDecl
+
+Returns NULL if the decl was already defined somewhere else.
+Without a buffer the text is left in the file until the decl is parsed.
+================
+*/
+idDeclLocal *idDeclFile::AddDecl( declType_t type, const char *name, const char *buffer, int textOffset, int textLength, int sourceLine, int warningLine, int textChecksum ) {
+	idDeclLocal *newDecl;
+	bool		reparse;
+
+	// look it up, possibly getting a newly created default decl
+	reparse = false;
+	newDecl = declManagerLocal.FindTypeWithoutParsing( type, name, false );
+	if ( newDecl ) {
+		// update the existing copy
+		if ( newDecl->sourceFile != this || newDecl->redefinedInReload ) {
+			common->Warning( "file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), warningLine,
+							declManagerLocal.GetDeclNameFromType( type ), name, newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+			return NULL;
+		}
+		if ( newDecl->declState != DS_UNPARSED ) {
+			reparse = true;
+		}
+	} else {
+		// allow it to be created as a default, then add it to the per-file list
+		newDecl = declManagerLocal.FindTypeWithoutParsing( type, name, true );
+		newDecl->nextInFile = this->decls;
+		this->decls = newDecl;
+	}
+
+	newDecl->redefinedInReload = true;
+
+	if ( newDecl->textSource ) {
+		Mem_Free( newDecl->textSource );
+		newDecl->textSource = NULL;
+	}
+
+	newDecl->sourceFile = this;
+	newDecl->sourceTextOffset = textOffset;
+	newDecl->sourceTextLength = textLength;
+	newDecl->sourceLine = sourceLine;
+	newDecl->declState = DS_UNPARSED;
+
+	if ( buffer ) {
+		newDecl->SetTextLocal( buffer + textOffset, textLength );
+	} else {
+		newDecl->textLength = textLength;
+		newDecl->compressedLength = 0;
+		newDecl->checksum = textChecksum;
+		newDecl->textPending = true;
+	}
+
+	// if it is currently in use, reparse it immedaitely
+	if ( reparse ) {
+		newDecl->ParseLocal();
+	}
+
+	return newDecl;
+}
+
+/*
+================
+idDeclFile::AddIndexEntry
+================
+*/
+void idDeclFile::AddIndexEntry( declType_t type, const char *name, int textOffset, int textLength, int sourceLine, int endLine, const idDeclLocal *decl, idStrList &names ) {
+	declIndexEntry_t &entry = indexEntries.Alloc();
+
+	entry.type = type;
+	entry.nameOffset = indexNamesLength;
+	entry.textOffset = textOffset;
+	entry.textLength = textLength;
+	entry.sourceLine = sourceLine;
+	entry.endLine = endLine;
+	entry.checksum = ( decl != NULL ) ? decl->checksum : 0;
+
+	names.Append( name );
+	indexNamesLength += names[names.Num() - 1].Length() + 1;
+}
+
+/*
+================
+idDeclFile::Parse
+
+The decls are either added from the index entries, taken from a scan done by a job,
+or found with the lexer.  Decls found in the buffer are added to the index entries.
+================
+*/
+int idDeclFile::Parse( char *buffer, int length, const idDeclFileScan *scan ) {
+	int			i, numTypes;
+	idLexer		src;
+	idToken		token;
+	int			startMarker;
+	int			size;
+	int			sourceLine;
+	idStr		name;
+	idTimer		timer;
+	idStrList	names;
+	idDeclLocal *newDecl;
+	bool		addToIndex;
 
 	// mark all the defs that were from the last reload of this file
 	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
 		decl->redefinedInReload = false;
 	}
 
-	src.SetFlags( DECL_LEXER_FLAGS );
+	FreePendingText();
 
-	checksum = MD5_BlockChecksum( buffer, length );
+	addToIndex = false;
+	if ( buffer ) {
+		fileSize = length;
 
-	fileSize = length;
+		indexed = false;
+		indexEntries.Clear();
+		Mem_Free( indexNames );
+		indexNames = NULL;
+		indexNamesLength = 0;
+		addToIndex = declManagerLocal.decl_useIndex.GetBool();
+	}
 
-	// scan through, identifying each individual declaration
-	while( 1 ) {
+	if ( buffer == NULL ) {
 
-		startMarker = src.GetFileOffset();
-		sourceLine = src.GetLineNum();
+		for ( i = 0; i < indexEntries.Num(); i++ ) {
+			const declIndexEntry_t &entry = indexEntries[i];
 
-		// parse the decl type name
-		if ( !src.ReadToken( &token ) ) {
-			break;
+			timer.Clear();
+			timer.Start();
+
+			AddDecl( (declType_t)entry.type, indexNames + entry.nameOffset, NULL, entry.textOffset, entry.textLength, entry.sourceLine, entry.endLine, entry.checksum );
+
+			timer.Stop();
+			declManagerLocal.GetLoadTime( entry.type ).numDecls++;
+			declManagerLocal.GetLoadTime( entry.type ).addMsec += timer.Milliseconds();
 		}
 
-		declType_t identifiedType = DECL_MAX_TYPES;
+	} else if ( scan && !scan->fallback ) {
 
-		// get the decl type from the type name
-		numTypes = declManagerLocal.GetNumDeclTypes();
-		for ( i = 0; i < numTypes; i++ ) {
-			idDeclType *typeInfo = declManagerLocal.GetDeclType( i );
-			if ( typeInfo && typeInfo->typeName.Icmp( token ) == 0 ) {
-				identifiedType = (declType_t) typeInfo->type;
-				break;
+		checksum = scan->checksum;
+
+		if ( addToIndex ) {
+			indexEntries.Resize( scan->numSpans );
+			names.Resize( scan->numSpans );
+		}
+
+		for ( i = 0; i < scan->numSpans; i++ ) {
+			const declSpan_t &span = scan->spans[i];
+
+			timer.Clear();
+			timer.Start();
+
+			name.Clear();
+			name.Append( buffer + span.nameOffset, span.nameLength );
+			newDecl = AddDecl( (declType_t)span.type, name, buffer, span.textOffset, span.textLength, span.sourceLine, span.endLine, 0 );
+
+			if ( addToIndex ) {
+				AddIndexEntry( (declType_t)span.type, name, span.textOffset, span.textLength, span.sourceLine, span.endLine, newDecl, names );
 			}
+
+			timer.Stop();
+			declManagerLocal.GetLoadTime( span.type ).numDecls++;
+			declManagerLocal.GetLoadTime( span.type ).addMsec += timer.Milliseconds();
 		}
 
-		if ( i >= numTypes ) {
+		numLines = scan->numLines;
 
-			if ( token.Icmp( "{" ) == 0 ) {
+	} else {
 
-				// if we ever see an open brace, we somehow missed the [type] <name> prefix
-				src.Warning( "Missing decl name" );
-				src.SkipBracedSection( false );
-				continue;
+		if ( !src.LoadMemory( buffer, length, fileName ) ) {
+			common->Error( "Couldn't parse %s", fileName.c_str() );
+			Mem_Free( buffer );
+			return 0;
+		}
 
-			} else {
+		src.SetFlags( DECL_LEXER_FLAGS );
 
-				if ( defaultType == DECL_MAX_TYPES ) {
-					src.Warning( "No type" );
-					continue;
+		checksum = MD5_BlockChecksum( buffer, length );
+
+		indexEntries.SetGranularity( 256 );
+		names.SetGranularity( 256 );
+
+		// scan through, identifying each individual declaration
+		while( 1 ) {
+
+			timer.Clear();
+			timer.Start();
+
+			startMarker = src.GetFileOffset();
+			sourceLine = src.GetLineNum();
+
+			// parse the decl type name
+			if ( !src.ReadToken( &token ) ) {
+				break;
+			}
+
+			declType_t identifiedType = DECL_MAX_TYPES;
+
+			// get the decl type from the type name
+			numTypes = declManagerLocal.GetNumDeclTypes();
+			for ( i = 0; i < numTypes; i++ ) {
+				idDeclType *typeInfo = declManagerLocal.GetDeclType( i );
+				if ( typeInfo && typeInfo->typeName.Icmp( token ) == 0 ) {
+					identifiedType = (declType_t) typeInfo->type;
+					break;
 				}
-				src.UnreadToken( &token );
-				// use the default type
-				identifiedType = defaultType;
 			}
-		}
 
-		// now parse the name
-		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
-			break;
-		}
+			if ( i >= numTypes ) {
 
-		if ( !token.Icmp( "{" ) ) {
-			// if we ever see an open brace, we somehow missed the [type] <name> prefix
-			src.Warning( "Missing decl name" );
-			src.SkipBracedSection( false );
-			continue;
-		}
+				if ( token.Icmp( "{" ) == 0 ) {
 
-		// FIXME: export decls are only used by the model exporter, they are skipped here for now
-		if ( identifiedType == DECL_MODELEXPORT ) {
-			src.SkipBracedSection();
-			continue;
-		}
+					// if we ever see an open brace, we somehow missed the [type] <name> prefix
+					src.Warning( "Missing decl name" );
+					src.SkipBracedSection( false );
+					continue;
 
-		name = token;
+				} else {
 
-		// make sure there's a '{'
-		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
-			break;
-		}
-		if ( token != "{" ) {
-			src.Warning( "Expecting '{' but found '%s'", token.c_str() );
-			continue;
-		}
-		src.UnreadToken( &token );
+					if ( defaultType == DECL_MAX_TYPES ) {
+						src.Warning( "No type" );
+						continue;
+					}
+					src.UnreadToken( &token );
+					// use the default type
+					identifiedType = defaultType;
+				}
+			}
+
+			// now parse the name
+			if ( !src.ReadToken( &token ) ) {
+				src.Warning( "Type without definition at end of file" );
+				break;
+			}
+
+			if ( !token.Icmp( "{" ) ) {
+				// if we ever see an open brace, we somehow missed the [type] <name> prefix
+				src.Warning( "Missing decl name" );
+				src.SkipBracedSection( false );
+				continue;
+			}
 
-		// now take everything until a matched closing brace
-		src.SkipBracedSection();
-		size = src.GetFileOffset() - startMarker;
-
-		// look it up, possibly getting a newly created default decl
-		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
-		if ( newDecl ) {
-			// update the existing copy
-			if ( newDecl->sourceFile != this || newDecl->redefinedInReload ) {
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-								name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+			// FIXME: export decls are only used by the model exporter, they are skipped here for now
+			if ( identifiedType == DECL_MODELEXPORT ) {
+				src.SkipBracedSection();
 				continue;
 			}
-			if ( newDecl->declState != DS_UNPARSED ) {
-				reparse = true;
+
+			name = token;
+
+			// make sure there's a '{'
+			if ( !src.ReadToken( &token ) ) {
+				src.Warning( "Type without definition at end of file" );
+				break;
+			}
+			if ( token != "{" ) {
+				src.Warning( "Expecting '{' but found '%s'", token.c_str() );
+				continue;
 			}
-		} else {
-			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
-			newDecl->nextInFile = this->decls;
-			this->decls = newDecl;
-		}
+			src.UnreadToken( &token );
 
-		newDecl->redefinedInReload = true;
+			// now take everything until a matched closing brace
+			src.SkipBracedSection();
+			size = src.GetFileOffset() - startMarker;
 
-		if ( newDecl->textSource ) {
-			Mem_Free( newDecl->textSource );
-			newDecl->textSource = NULL;
-		}
+			newDecl = AddDecl( identifiedType, name, buffer, startMarker, size, sourceLine, src.GetLineNum(), 0 );
 
-		newDecl->SetTextLocal( buffer + startMarker, size );
-		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
-		newDecl->declState = DS_UNPARSED;
+			if ( addToIndex ) {
+				AddIndexEntry( identifiedType, name, startMarker, size, sourceLine, src.GetLineNum(), newDecl, names );
+			}
 
-		// if it is currently in use, reparse it immedaitely
-		if ( reparse ) {
-			newDecl->ParseLocal();
+			timer.Stop();
+			declManagerLocal.GetLoadTime( identifiedType ).numDecls++;
+			declManagerLocal.GetLoadTime( identifiedType ).addMsec += timer.Milliseconds();
 		}
+
+		numLines = src.GetLineNum();
 	}
 
-	numLines = src.GetLineNum();
+	if ( buffer ) {
+		Mem_Free( buffer );
+	}
 
-	Mem_Free( buffer );
+	// pack the names of the index entries
+	if ( addToIndex ) {
+		indexNames = (char *) Mem_Alloc( Max( indexNamesLength, 1 ) );
+		for ( i = 0; i < names.Num(); i++ ) {
+			memcpy( indexNames + indexEntries[i].nameOffset, names[i].c_str(), names[i].Length() + 1 );
+		}
+		indexed = true;
+		typesChecksum = declManagerLocal.typesChecksum;
+		declManagerLocal.indexDirty = true;
+	}
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for ( idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile ) {
 		if ( decl->redefinedInReload == false ) {
+			if ( decl->textPending ) {
+				decl->textPending = false;
+				decl->textLength = 0;
+			}
 			decl->MakeDefault();
 			decl->sourceTextOffset = decl->sourceFile->fileSize;
 			decl->sourceTextLength = 0;
@@ -793,6 +1575,11 @@ void idDeclManagerLocal::Init( void ) {
 	common->Printf( "----- Initializing Decls -----\n" );
 
 	checksum = 0;
+	memset( loadTimes, 0, sizeof( loadTimes ) );
+	typesChecksum = 0;
+	indexRead = false;
+	indexDirty = false;
+	initDone = false;
 
 #ifdef USE_COMPRESSED_DECLS
 	SetupHuffman();
@@ -859,10 +1646,25 @@ void idDeclManagerLocal::Init( void ) {
 	cmdSystem->AddCommand( "printAudio", idPrintDecls_f<DECL_AUDIO>, CMD_FL_SYSTEM, "prints an Video", idCmdSystem::ArgCompletion_Decl<DECL_AUDIO> );
 
 	cmdSystem->AddCommand( "listHuffmanFrequencies", ListHuffmanFrequencies_f, CMD_FL_SYSTEM, "lists decl text character frequencies" );
+	cmdSystem->AddCommand( "listDeclLoadTimes", ListDeclLoadTimes_f, CMD_FL_SYSTEM, "lists the time spent loading decls of each type" );
 
 	common->Printf( "------------------------------\n" );
 }
 
+/*
+===================
+idDeclManagerLocal::Init2
+
+The decl index is written once for all the folders registered at startup
+===================
+*/
+void idDeclManagerLocal::Init2( void ) {
+	initDone = true;
+	if ( indexDirty ) {
+		WriteDeclIndex();
+	}
+}
+
 /*
 ===================
 idDeclManagerLocal::Shutdown
@@ -892,6 +1694,9 @@ void idDeclManagerLocal::Shutdown( void ) {
 
 	// free decl files
 	loadedFiles.DeleteContents( true );
+	FreeDeclIndex();
+	indexRead = false;
+	initDone = false;
 
 	// free the decl types and folders
 	declTypes.DeleteContents( true );
@@ -911,6 +1716,9 @@ void idDeclManagerLocal::Reload( bool force ) {
 	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
 		loadedFiles[i]->Reload( force );
 	}
+	if ( indexDirty ) {
+		WriteDeclIndex();
+	}
 }
 
 /*
@@ -940,8 +1748,17 @@ idDeclManagerLocal::EndLevelLoad
 void idDeclManagerLocal::EndLevelLoad() {
 	insideLevelLoad = false;
 
-	// we don't need to do anything here, but the image manager, model manager,
-	// and sound sample manager will need to free media that was not referenced
+	// free the decl file text that was read for decls added from the decl index,
+	// decls that are still not parsed read it again when they are
+	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
+		loadedFiles[i]->FreePendingText();
+	}
+	if ( indexDirty ) {
+		WriteDeclIndex();
+	}
+
+	// the image manager, model manager, and sound sample manager
+	// will need to free media that was not referenced
 }
 
 /*
@@ -966,6 +1783,15 @@ void idDeclManagerLocal::RegisterDeclType( const char *typeName, declType_t type
 		declTypes.AssureSize( (int)type + 1, NULL );
 	}
 	declTypes[type] = declType;
+
+	// files that were parsed with other decl types can't be added from the decl index
+	idStr typeNames;
+	for ( int i = 0; i < declTypes.Num(); i++ ) {
+		if ( declTypes[i] ) {
+			typeNames += va( "%d %s\n", i, declTypes[i]->typeName.c_str() );
+		}
+	}
+	typesChecksum = MD5_BlockChecksum( typeNames.c_str(), typeNames.Length() );
 }
 
 /*
@@ -979,6 +1805,7 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	idDeclFolder *declFolder;
 	idFileList *fileList;
 	idDeclFile *df;
+	idList<idDeclFile *> files;
 
 	// check whether this folder / extension combination already exists
 	for ( i = 0; i < declFolders.Num(); i++ ) {
@@ -999,7 +1826,8 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	// scan for decl files
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
-	// load and parse decl files
+	// find the decl files
+	files.SetNum( fileList->GetNumFiles() );
 	for ( i = 0; i < fileList->GetNumFiles(); i++ ) {
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
 
@@ -1015,10 +1843,502 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 			df = new idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		files[i] = df;
 	}
 
 	fileSystem->FreeFileList( fileList );
+
+	// load and parse decl files
+	LoadDeclFiles( files.Ptr(), files.Num() );
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclFiles
+
+Files that haven't changed since they were indexed get their decls from the decl index.
+The other files are read on the main thread and scanned for decls in parallel.  The decls
+are added in file order, so the result is the same as parsing the files one by one.
+===================
+*/
+void idDeclManagerLocal::LoadDeclFiles( idDeclFile **files, int numFiles ) {
+	idList<idDeclFileScan> scans;
+	idList<bool> fromIndex;
+	idJobGroup *jobGroup;
+	idTimer readTimer, scanTimer, addTimer;
+	double readMsec, jobMsec;
+	int i, j, numBraces, numFallbacks, numIndexed;
+
+	if ( !numFiles ) {
+		return;
+	}
+
+	if ( decl_useIndex.GetBool() && !indexRead ) {
+		ReadDeclIndex();
+	}
+
+	readMsec = 0.0;
+
+	// find the files that can be added from the index
+	fromIndex.SetNum( numFiles );
+	numIndexed = 0;
+	for ( i = 0; i < numFiles; i++ ) {
+		readTimer.Clear();
+		readTimer.Start();
+		fromIndex[i] = decl_useIndex.GetBool() && LoadIndexedFile( files[i] );
+		readTimer.Stop();
+		readMsec += readTimer.Milliseconds();
+
+		if ( fromIndex[i] ) {
+			numIndexed++;
+		}
+		if ( files[i]->defaultType < DECL_MAX_TYPES ) {
+			declLoadTime_t &loadTime = loadTimes[files[i]->defaultType];
+			loadTime.readMsec += readTimer.Milliseconds();
+			if ( fromIndex[i] ) {
+				loadTime.numFiles++;
+				loadTime.numIndexed++;
+				loadTime.fileLength += files[i]->fileSize;
+			}
+		}
+	}
+
+	if ( !decl_parallelScan.GetBool() ) {
+		for ( i = 0; i < numFiles; i++ ) {
+			if ( fromIndex[i] ) {
+				files[i]->Parse( NULL, 0, NULL );
+				continue;
+			}
+			readTimer.Clear();
+			readTimer.Start();
+			files[i]->LoadAndParse();
+			readTimer.Stop();
+			if ( files[i]->defaultType < DECL_MAX_TYPES ) {
+				declLoadTime_t &loadTime = loadTimes[files[i]->defaultType];
+				loadTime.numFiles++;
+				loadTime.fileLength += files[i]->fileSize;
+				loadTime.readMsec += readTimer.Milliseconds();
+			}
+		}
+		if ( indexDirty && initDone ) {
+			WriteDeclIndex();
+		}
+		return;
+	}
+
+	// read the other files
+	scans.SetNum( numFiles );
+	for ( i = 0; i < numFiles; i++ ) {
+		idDeclFileScan &scan = scans[i];
+
+		scan.file = files[i];
+		scan.buffer = NULL;
+		scan.length = 0;
+		scan.spans = NULL;
+		scan.maxSpans = 0;
+		scan.numSpans = 0;
+		scan.numLines = 0;
+		scan.checksum = 0;
+		scan.fallback = true;
+		scan.scanTicks = 0;
+
+		if ( fromIndex[i] ) {
+			continue;
+		}
+
+		readTimer.Clear();
+		readTimer.Start();
+
+		common->DPrintf( "...loading '%s'\n", files[i]->fileName.c_str() );
+		scan.length = fileSystem->ReadFile( files[i]->fileName, (void **)&scan.buffer, &files[i]->timestamp );
+		if ( scan.length == -1 ) {
+			common->FatalError( "couldn't load %s", files[i]->fileName.c_str() );
+			return;
+		}
+
+		// every decl has an opening brace, so this is enough room for all of them
+		numBraces = 0;
+		for ( j = 0; j < scan.length; j++ ) {
+			numBraces += ( scan.buffer[j] == '{' );
+		}
+		scan.maxSpans = numBraces;
+		scan.spans = (declSpan_t *) Mem_Alloc( Max( numBraces, 1 ) * sizeof( declSpan_t ) );
+
+		readTimer.Stop();
+		readMsec += readTimer.Milliseconds();
+
+		if ( files[i]->defaultType < DECL_MAX_TYPES ) {
+			declLoadTime_t &loadTime = loadTimes[files[i]->defaultType];
+			loadTime.numFiles++;
+			loadTime.fileLength += scan.length;
+			loadTime.readMsec += readTimer.Milliseconds();
+		}
+	}
+
+	// scan them in parallel
+	scanTimer.Start();
+	jobGroup = jobSystem->AllocJobGroup( "declScan" );
+	for ( i = 0; i < numFiles; i++ ) {
+		if ( !fromIndex[i] ) {
+			jobGroup->AddJob( DeclScanJob, &scans[i] );
+		}
+	}
+	jobGroup->Run();
+	jobSystem->FreeJobGroup( jobGroup );
+	scanTimer.Stop();
+
+	// add the decls in file order
+	addTimer.Start();
+	numFallbacks = 0;
+	for ( i = 0; i < numFiles; i++ ) {
+		if ( fromIndex[i] ) {
+			files[i]->Parse( NULL, 0, NULL );
+			continue;
+		}
+		if ( scans[i].fallback ) {
+			numFallbacks++;
+		}
+		files[i]->Parse( scans[i].buffer, scans[i].length, &scans[i] );
+		Mem_Free( scans[i].spans );
+	}
+	addTimer.Stop();
+
+	jobMsec = 0.0;
+	for ( i = 0; i < numFiles; i++ ) {
+		double msec = scans[i].scanTicks * 1000.0 / Sys_ClockTicksPerSecond();
+		jobMsec += msec;
+		if ( files[i]->defaultType < DECL_MAX_TYPES ) {
+			loadTimes[files[i]->defaultType].scanMsec += msec;
+		}
+	}
+
+	common->DPrintf( "%d decl files, %d from the index: read %.1f ms, scanned %.1f ms in %.1f ms on %d threads, added %.1f ms, %d lexer fallbacks\n",
+						numFiles, numIndexed, readMsec, jobMsec, scanTimer.Milliseconds(), jobSystem->GetNumThreads(), addTimer.Milliseconds(), numFallbacks );
+
+	// during startup the index is written once by Init2
+	if ( indexDirty && initDone ) {
+		WriteDeclIndex();
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::LoadIndexedFile
+
+Takes the index entries of a file that has the same length, timestamp and pak checksum as
+when it was indexed, and was parsed with the same decl types.  The entries of a file that
+changed are dropped, because the file is parsed and indexed again.
+===================
+*/
+bool idDeclManagerLocal::LoadIndexedFile( idDeclFile *file ) {
+	idDeclFile *indexFile;
+	ID_TIME_T timestamp;
+	int i, hash, length, pakChecksum;
+
+	length = fileSystem->GetFileStamp( file->fileName, &timestamp, &pakChecksum );
+	if ( length == -1 ) {
+		return false;
+	}
+	file->pakChecksum = pakChecksum;
+
+	hash = indexFileHash.GenerateKey( file->fileName, false );
+	for ( i = indexFileHash.First( hash ); i >= 0; i = indexFileHash.Next( i ) ) {
+		if ( indexFiles[i] != NULL && indexFiles[i]->fileName.Icmp( file->fileName ) == 0 ) {
+			break;
+		}
+	}
+	if ( i < 0 ) {
+		return false;
+	}
+
+	indexFile = indexFiles[i];
+	indexFiles[i] = NULL;
+
+	if ( indexFile->defaultType != file->defaultType || indexFile->fileSize != length || indexFile->timestamp != (int)timestamp ||
+			indexFile->pakChecksum != pakChecksum || indexFile->typesChecksum != typesChecksum ) {
+		delete indexFile;
+		return false;
+	}
+
+	file->timestamp = timestamp;
+	file->fileSize = indexFile->fileSize;
+	file->checksum = indexFile->checksum;
+	file->numLines = indexFile->numLines;
+	file->typesChecksum = indexFile->typesChecksum;
+	file->indexEntries = indexFile->indexEntries;
+	Mem_Free( file->indexNames );
+	file->indexNames = indexFile->indexNames;
+	file->indexNamesLength = indexFile->indexNamesLength;
+	file->indexed = true;
+
+	indexFile->indexNames = NULL;
+	delete indexFile;
+
+	return true;
+}
+
+/*
+================
+ReadDeclIndexData
+
+Returns a pointer into the index data, or NULL and sets the error flag
+================
+*/
+static const void *ReadDeclIndexData( declIndexCursor_t &cursor, int count, int elementSize ) {
+	if ( cursor.error || count < 0 || count > ( cursor.length - cursor.offset ) / elementSize ) {
+		cursor.error = true;
+		return NULL;
+	}
+	const byte *data = cursor.data + cursor.offset;
+	cursor.offset += count * elementSize;
+	return data;
+}
+
+/*
+================
+ReadDeclIndexInt
+================
+*/
+static int ReadDeclIndexInt( declIndexCursor_t &cursor ) {
+	int value = 0;
+	const void *data = ReadDeclIndexData( cursor, 1, sizeof( value ) );
+	if ( data ) {
+		memcpy( &value, data, sizeof( value ) );
+	}
+	return value;
+}
+
+/*
+================
+ReadDeclIndexString
+================
+*/
+static const char *ReadDeclIndexString( declIndexCursor_t &cursor ) {
+	int length = ReadDeclIndexInt( cursor );
+	const char *string = (const char *)ReadDeclIndexData( cursor, length, 1 );
+	if ( string == NULL || length < 1 || string[length - 1] != '\0' ) {
+		cursor.error = true;
+		return "";
+	}
+	return string;
+}
+
+/*
+================
+WriteDeclIndexInt
+================
+*/
+static void WriteDeclIndexInt( idFile *f, int value ) {
+	f->Write( &value, sizeof( value ) );
+}
+
+/*
+================
+WriteDeclIndexString
+================
+*/
+static void WriteDeclIndexString( idFile *f, const char *string ) {
+	int length = strlen( string ) + 1;
+	WriteDeclIndexInt( f, length );
+	f->Write( string, length );
+}
+
+/*
+================
+WriteDeclIndexFile
+================
+*/
+static void WriteDeclIndexFile( idFile *f, const idDeclFile *file ) {
+	WriteDeclIndexString( f, file->fileName );
+	WriteDeclIndexInt( f, file->defaultType );
+	WriteDeclIndexInt( f, (int)file->timestamp );
+	WriteDeclIndexInt( f, file->fileSize );
+	WriteDeclIndexInt( f, file->pakChecksum );
+	WriteDeclIndexInt( f, file->checksum );
+	WriteDeclIndexInt( f, file->numLines );
+	WriteDeclIndexInt( f, file->typesChecksum );
+	WriteDeclIndexInt( f, file->indexEntries.Num() );
+	WriteDeclIndexInt( f, file->indexNamesLength );
+	f->Write( file->indexNames, file->indexNamesLength );
+	f->Write( file->indexEntries.Ptr(), file->indexEntries.Num() * sizeof( declIndexEntry_t ) );
+}
+
+/*
+===================
+idDeclManagerLocal::ReadDeclIndex
+
+The whole index is ignored if it was written by a different build or has a bad checksum.
+===================
+*/
+void idDeclManagerLocal::ReadDeclIndex( void ) {
+	declIndexCursor_t cursor;
+	const declIndexHeader_t *header;
+	const declIndexEntry_t *entries;
+	const char *names;
+	void *buffer;
+	int i, j, numFiles, numEntries;
+
+	indexRead = true;
+
+	cursor.length = fileSystem->ReadFile( DECL_INDEX_FILE, &buffer );
+	if ( cursor.length == -1 ) {
+		return;
+	}
+	cursor.data = (const byte *)buffer;
+	cursor.offset = 0;
+	cursor.error = false;
+
+	header = (const declIndexHeader_t *)ReadDeclIndexData( cursor, 1, sizeof( declIndexHeader_t ) );
+	if ( header == NULL || header->ident != DECL_INDEX_IDENT || header->version != DECL_INDEX_VERSION || header->entrySize != sizeof( declIndexEntry_t ) ||
+			header->dataLength != cursor.length - cursor.offset || (int)MD5_BlockChecksum( cursor.data + cursor.offset, header->dataLength ) != header->dataChecksum ) {
+		common->DPrintf( "ignoring %s: written by a different build or corrupt\n", DECL_INDEX_FILE );
+		fileSystem->FreeFile( buffer );
+		return;
+	}
+
+	numFiles = ReadDeclIndexInt( cursor );
+	for ( i = 0; i < numFiles && !cursor.error; i++ ) {
+		const char *fileName = ReadDeclIndexString( cursor );
+		int defaultType = ReadDeclIndexInt( cursor );
+
+		idDeclFile *file = new idDeclFile( fileName, (declType_t)defaultType );
+		file->timestamp = ReadDeclIndexInt( cursor );
+		file->fileSize = ReadDeclIndexInt( cursor );
+		file->pakChecksum = ReadDeclIndexInt( cursor );
+		file->checksum = ReadDeclIndexInt( cursor );
+		file->numLines = ReadDeclIndexInt( cursor );
+		file->typesChecksum = ReadDeclIndexInt( cursor );
+		numEntries = ReadDeclIndexInt( cursor );
+		file->indexNamesLength = ReadDeclIndexInt( cursor );
+		names = (const char *)ReadDeclIndexData( cursor, file->indexNamesLength, 1 );
+		entries = (const declIndexEntry_t *)ReadDeclIndexData( cursor, numEntries, sizeof( declIndexEntry_t ) );
+
+		if ( !cursor.error && file->indexNamesLength > 0 && names[file->indexNamesLength - 1] != '\0' ) {
+			cursor.error = true;
+		}
+		for ( j = 0; j < numEntries && !cursor.error; j++ ) {
+			const declIndexEntry_t &entry = entries[j];
+			if ( entry.type < 0 || entry.type >= DECL_MAX_TYPES || entry.nameOffset < 0 || entry.nameOffset >= file->indexNamesLength ||
+					entry.textOffset < 0 || entry.textLength < 0 || entry.textOffset > file->fileSize - entry.textLength ) {
+				cursor.error = true;
+			}
+		}
+		if ( cursor.error ) {
+			file->indexNamesLength = 0;
+			delete file;
+			break;
+		}
+
+		file->indexNames = (char *) Mem_Alloc( Max( file->indexNamesLength, 1 ) );
+		memcpy( file->indexNames, names, file->indexNamesLength );
+		file->indexEntries.SetNum( numEntries );
+		memcpy( file->indexEntries.Ptr(), entries, numEntries * sizeof( declIndexEntry_t ) );
+		file->indexed = true;
+
+		indexFileHash.Add( indexFileHash.GenerateKey( file->fileName, false ), indexFiles.Append( file ) );
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( cursor.error ) {
+		common->Warning( "%s is corrupt", DECL_INDEX_FILE );
+		FreeDeclIndex();
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::WriteDeclIndex
+
+Writes the index entries of the loaded files and of the files in the old index that have
+not been loaded yet, like the files of decl folders that are registered by the game.
+===================
+*/
+void idDeclManagerLocal::WriteDeclIndex( void ) {
+	idFile_Memory data( DECL_INDEX_FILE );
+	idFile_Memory f( DECL_INDEX_FILE );
+	declIndexHeader_t header;
+	int i, numFiles;
+
+	indexDirty = false;
+
+	numFiles = 0;
+	for ( i = 0; i < loadedFiles.Num(); i++ ) {
+		if ( loadedFiles[i]->indexed ) {
+			numFiles++;
+		}
+	}
+	for ( i = 0; i < indexFiles.Num(); i++ ) {
+		if ( indexFiles[i] != NULL ) {
+			numFiles++;
+		}
+	}
+
+	WriteDeclIndexInt( &data, numFiles );
+	for ( i = 0; i < loadedFiles.Num(); i++ ) {
+		if ( loadedFiles[i]->indexed ) {
+			WriteDeclIndexFile( &data, loadedFiles[i] );
+		}
+	}
+	for ( i = 0; i < indexFiles.Num(); i++ ) {
+		if ( indexFiles[i] != NULL ) {
+			WriteDeclIndexFile( &data, indexFiles[i] );
+		}
+	}
+
+	header.ident = DECL_INDEX_IDENT;
+	header.version = DECL_INDEX_VERSION;
+	header.entrySize = sizeof( declIndexEntry_t );
+	header.dataLength = data.Length();
+	header.dataChecksum = MD5_BlockChecksum( data.GetDataPtr(), data.Length() );
+
+	f.Write( &header, sizeof( header ) );
+	f.Write( data.GetDataPtr(), data.Length() );
+	fileSystem->WriteFile( DECL_INDEX_FILE, f.GetDataPtr(), f.Length() );
+}
+
+/*
+===================
+idDeclManagerLocal::FreeDeclIndex
+===================
+*/
+void idDeclManagerLocal::FreeDeclIndex( void ) {
+	indexFiles.DeleteContents( true );
+	indexFileHash.Free();
+}
+
+/*
+===================
+idDeclManagerLocal::ListDeclLoadTimes_f
+
+Files, read and scan times are counted for the default type of the folder the files are in,
+decls and the time to add them for the actual decl type.
+===================
+*/
+void idDeclManagerLocal::ListDeclLoadTimes_f( const idCmdArgs &args ) {
+	declLoadTime_t total;
+	int i;
+
+	memset( &total, 0, sizeof( total ) );
+
+	common->Printf( "type                 files indexed      KB   read ms   scan ms  decls    add ms\n" );
+	for ( i = 0; i < declManagerLocal.declTypes.Num(); i++ ) {
+		if ( declManagerLocal.declTypes[i] == NULL ) {
+			continue;
+		}
+		const declLoadTime_t &loadTime = declManagerLocal.loadTimes[i];
+		common->Printf( "%-20s %5d %7d %7d %9.1f %9.1f %6d %9.1f\n", declManagerLocal.declTypes[i]->typeName.c_str(),
+						loadTime.numFiles, loadTime.numIndexed, loadTime.fileLength >> 10, loadTime.readMsec, loadTime.scanMsec, loadTime.numDecls, loadTime.addMsec );
+		total.numFiles += loadTime.numFiles;
+		total.numIndexed += loadTime.numIndexed;
+		total.fileLength += loadTime.fileLength;
+		total.readMsec += loadTime.readMsec;
+		total.scanMsec += loadTime.scanMsec;
+		total.numDecls += loadTime.numDecls;
+		total.addMsec += loadTime.addMsec;
+	}
+	common->Printf( "%-20s %5d %7d %7d %9.1f %9.1f %6d %9.1f\n", "total",
+					total.numFiles, total.numIndexed, total.fileLength >> 10, total.readMsec, total.scanMsec, total.numDecls, total.addMsec );
 }
 
 /*
@@ -1168,6 +2488,9 @@ void idDeclManagerLocal::ReloadFile( const char* filename, bool force ) {
 			checksum ^= loadedFiles[i]->checksum;
 		}
 	}
+	if ( indexDirty ) {
+		WriteDeclIndex();
+	}
 }
 
 /*
@@ -1302,7 +2625,7 @@ void idDeclManagerLocal::PrintType( const idCmdArgs &args, declType_t type ) {
 	common->Printf( "%s %s:\n", declTypes[ type ]->typeName.c_str(), decl->name.c_str() );
 	common->Printf( "source: %s:%i\n", decl->sourceFile->fileName.c_str(), decl->sourceLine );
 	common->Printf( "----------\n" );
-	if ( decl->textSource != NULL ) {
+	if ( decl->textSource != NULL || decl->textPending ) {
 		char *declText = (char *)_alloca( decl->textLength + 1 );
 		decl->GetText( declText );
 		common->Printf( "%s\n", declText );
@@ -1760,6 +3083,7 @@ idDeclLocal::idDeclLocal( void ) {
 	sourceTextLength = 0;
 	sourceLine = 0;
 	checksum = 0;
+	textPending = false;
 	type = DECL_ENTITYDEF;
 	index = 0;
 	declState = DS_UNPARSED;
@@ -1877,6 +3201,9 @@ idDeclLocal::GetText
 =================
 */
 void idDeclLocal::GetText( char *text ) const {
+	if ( textPending ) {
+		const_cast<idDeclLocal *>( this )->LoadPendingText();
+	}
 #ifdef USE_COMPRESSED_DECLS
 	HuffmanDecompressText( text, textLength, (byte *)textSource, compressedLength );
 #else
@@ -1890,6 +3217,10 @@ idDeclLocal::GetTextLength
 =================
 */
 int idDeclLocal::GetTextLength( void ) const {
+	// the pending text may parse a changed file again, which changes the length
+	if ( textPending ) {
+		const_cast<idDeclLocal *>( this )->LoadPendingText();
+	}
 	return textLength;
 }
 
@@ -1932,6 +3263,28 @@ void idDeclLocal::SetTextLocal( const char *text, const int length ) {
 	textSource[length] = '\0';
 #endif
 	textLength = length;
+	textPending = false;
+}
+
+/*
+=================
+idDeclLocal::LoadPendingText
+=================
+*/
+void idDeclLocal::LoadPendingText( void ) {
+	const char *fileText = sourceFile->GetPendingText();
+
+	// the source file may have been parsed again, which set the text
+	if ( !textPending ) {
+		return;
+	}
+
+	if ( fileText ) {
+		SetTextLocal( fileText + sourceTextOffset, sourceTextLength );
+	} else {
+		textPending = false;
+		textLength = 0;
+	}
 }
 
 /*
@@ -1951,6 +3304,14 @@ bool idDeclLocal::ReplaceSourceFileText( void ) {
 		return false;
 	}
 
+	// the other decls in the file need their text before the file changes
+	for ( idDeclLocal *decl = sourceFile->decls; decl; decl = decl->nextInFile ) {
+		if ( decl->textPending ) {
+			decl->LoadPendingText();
+		}
+	}
+	sourceFile->FreePendingText();
+
 	// get length and allocate buffer to hold the file
 	oldFileLength = sourceFile->fileSize;
 	newFileLength = oldFileLength - sourceTextLength + textLength;
@@ -2003,6 +3364,9 @@ bool idDeclLocal::ReplaceSourceFileText( void ) {
 	sourceFile->checksum = MD5_BlockChecksum( buffer, newFileLength );
 	fileSystem->ReadFile( GetFileName(), NULL, &sourceFile->timestamp );
 
+	// the file has to be parsed again before it can be indexed
+	sourceFile->indexed = false;
+
 	// free buffer
 	Mem_Free( buffer );
 
@@ -2169,6 +3533,11 @@ void idDeclLocal::ParseLocal( void ) {
 
 	declManagerLocal.MediaPrint( "parsing %s %s\n", declManagerLocal.declTypes[type]->typeName.c_str(), name.c_str() );
 
+	// read the text of a decl that was added from the decl index
+	if ( textPending ) {
+		LoadPendingText();
+	}
+
 	// if no text source try to generate default text
 	if ( textSource == NULL ) {
 		generatedDefaultText = self->SetDefaultText();
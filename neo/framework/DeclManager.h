@@ -252,6 +252,8 @@ public:
 	virtual					~idDeclManager( void ) {}
 
 	virtual void			Init( void ) = 0;
+							// Called once the engine and the game have registered their decl folders.
+	virtual void			Init2( void ) = 0;
 	virtual void			Shutdown( void ) = 0;
 	virtual void			Reload( bool force ) = 0;
 
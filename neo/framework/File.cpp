@@ -1240,6 +1240,8 @@ idFile_InZip::idFile_InZip( void ) {
 	zipFilePos = 0;
 	fileSize = 0;
 	memset( &z, 0, sizeof( z ) );
+	mappedData = NULL;
+	mappedPos = 0;
 }
 
 /*
@@ -1248,8 +1250,10 @@ idFile_InZip::~idFile_InZip
 =================
 */
 idFile_InZip::~idFile_InZip( void ) {
-	unzCloseCurrentFile( z );
-	unzClose( z );
+	if ( z ) {
+		unzCloseCurrentFile( z );
+		unzClose( z );
+	}
 }
 
 /*
@@ -1260,7 +1264,20 @@ Properly handles partial reads
 =================
 */
 int idFile_InZip::Read( void *buffer, int len ) {
-	int l = unzReadCurrentFile( z, buffer, len );
+	int l;
+
+	if ( mappedData ) {
+		l = Min( len, fileSize - mappedPos );
+		if ( l <= 0 ) {
+			return 0;
+		}
+		memcpy( buffer, mappedData + mappedPos, l );
+		mappedPos += l;
+		fileSystem->AddToReadCount( l );
+		return l;
+	}
+
+	l = unzReadCurrentFile( z, buffer, len );
 	fileSystem->AddToReadCount( l );
 	return l;
 }
@@ -1299,6 +1316,9 @@ idFile_InZip::Tell
 =================
 */
 int idFile_InZip::Tell( void ) {
+	if ( mappedData ) {
+		return mappedPos;
+	}
 	return unztell( z );
 }
 
@@ -1333,6 +1353,31 @@ int idFile_InZip::Seek( long offset, fsOrigin_t origin ) {
 	int res, i;
 	char *buf;
 
+	if ( mappedData ) {
+		switch( origin ) {
+			case FS_SEEK_END: {
+				offset = fileSize - offset;
+				break;
+			}
+			case FS_SEEK_SET: {
+				break;
+			}
+			case FS_SEEK_CUR: {
+				offset += mappedPos;
+				break;
+			}
+			default: {
+				common->FatalError( "idFile_InZip::Seek: bad origin for %s\n", name.c_str() );
+				break;
+			}
+		}
+		if ( offset < 0 || offset > fileSize ) {
+			return -1;
+		}
+		mappedPos = offset;
+		return 0;
+	}
+
 	switch( origin ) {
 		case FS_SEEK_END: {
 			offset = fileSize - offset;
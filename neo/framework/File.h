@@ -238,6 +238,8 @@ private:
 	int						zipFilePos;		// zip file info position in pak
 	int						fileSize;		// size of the file
 	void *					z;				// unzip info
+	const byte *			mappedData;		// stored file data in a mapped pak, read without unzip
+	int						mappedPos;		// read position in the mapped data
 };
 
 #endif /* !__FILE_H__ */
@@ -253,12 +253,15 @@ public:
 static idInitExclusions	initExclusions;
 
 #define MAX_ZIPPED_FILE_NAME	2048
-#define FILE_HASH_SIZE			1024
 
 typedef struct fileInPack_s {
 	idStr				name;						// name of the file
 	unsigned long		pos;						// file info position in zip
-	struct fileInPack_s * next;						// next file in the hash
+	int					hash;						// HashFileName of the name
+	bool				stored;						// stored without compression
+	int					size;						// uncompressed size
+	int					localHeader;				// offset of the local file header in the pak
+	int					dataOffset;					// offset of the stored data in the pak, -1 until it's found
 } fileInPack_t;
 
 typedef enum {
@@ -292,8 +295,11 @@ typedef struct {
 	addonInfo_t			*addon_info;
 	pureStatus_t		pureStatus;
 	bool				isNew;						// for downloaded paks
-	fileInPack_t		*hashTable[FILE_HASH_SIZE];
+	int *				fileHash;					// open addressing hash of buildBuffer indexes, -1 for an empty slot
+	int					fileHashMask;
 	fileInPack_t		*buildBuffer;
+	byte *				mappedData;					// the whole pak when it is memory mapped, stored files are read from it
+	sysFileMapping_t	mapping;
 } pack_t;
 
 typedef struct {
@@ -307,6 +313,11 @@ typedef struct searchpath_s {
 	struct searchpath_s *next;
 } searchpath_t;
 
+typedef struct {
+	void *				buffer;						// returned by MapFile
+	sysFileMapping_t	mapping;
+} mappedFile_t;
+
 // search flags when opening a file
 #define FSFLAG_SEARCH_DIRS		( 1 << 0 )
 #define FSFLAG_SEARCH_PAKS		( 1 << 1 )
@@ -393,12 +404,16 @@ public:
 	virtual const idDict *	GetMapDecl( int i );
 	virtual void			FindMapScreenshot( const char *path, char *buf, int len );
 	virtual bool			FilenameCompare( const char *s1, const char *s2 ) const;
+	virtual int				MapFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
+	virtual void			UnmapFile( void *buffer );
+	virtual int				GetFileStamp( const char *relativePath, ID_TIME_T *timestamp, int *pakChecksum );
 
 	static void				Dir_f( const idCmdArgs &args );
 	static void				DirTree_f( const idCmdArgs &args );
 	static void				Path_f( const idCmdArgs &args );
 	static void				TouchFile_f( const idCmdArgs &args );
 	static void				TouchFileList_f( const idCmdArgs &args );
+	static void				BenchmarkPaks_f( const idCmdArgs &args );
 
 private:
 	friend dword 			BackgroundDownloadThread( void *parms );
@@ -424,6 +439,7 @@ private:
 	static idCVar			fs_game_base;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_mapPaks;
 
 	backgroundDownload_t *	backgroundDownloads;
 	backgroundDownload_t	defaultBackgroundDownload;
@@ -431,6 +447,7 @@ private:
 
 	idList<pack_t *>		serverPaks;
 	bool					loadedFileFromDir;		// set to true once a file was loaded from a directory - can't switch to pure anymore
+	bool					ignoreMappedPaks;		// read stored files through unzip even when the pak is mapped
 	idList<int>				restartChecksums;		// used during a restart to set things in right order
 	idList<int>				addonChecksums;			// list of checksums that should go to the search list directly ( for restarts )
 	int						restartGamePakChecksum;
@@ -445,9 +462,12 @@ private:
 
 	int						d3xp;	// 0: didn't check, -1: not installed, 1: installed
 
+	idList<mappedFile_t>	mappedFiles;			// buffers returned by MapFile that are actual file mappings
+
 private:
 	void					ReplaceSeparators( idStr &path, char sep = PATHSEPERATOR_CHAR );
-	long					HashFileName( const char *fname ) const;
+	int						HashFileName( const char *fname ) const;
+	fileInPack_t *			FindFileInPak( const pack_t *pak, const char *relativePath, int hash ) const;
 	int						ListOSFiles( const char *directory, const char *extension, idStrList &list );
 	FILE *					OpenOSFile( const char *name, const char *mode, idStr *caseSensitiveName = NULL );
 	FILE *					OpenOSFileCorrectName( idStr &path, const char *mode );
@@ -495,6 +515,8 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+// mapping all the pk4s takes up too much of the address space of a 32 bit build
+idCVar	idFileSystemLocal::fs_mapPaks( "fs_mapPaks", ( sizeof( void * ) > 4 ) ? "1" : "0", CVAR_SYSTEM | CVAR_INIT | CVAR_BOOL, "memory map pk4s and read stored files straight from the mapping" );
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem *		fileSystem = &fileSystemLocal;
@@ -513,6 +535,7 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 	dir_cache_count = 0;
 	d3xp = 0;
 	loadedFileFromDir = false;
+	ignoreMappedPaks = false;
 	restartGamePakChecksum = 0;
 	memset( &backgroundThread, 0, sizeof( backgroundThread ) );
 	addonPaks = NULL;
@@ -522,29 +545,45 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 ================
 idFileSystemLocal::HashFileName
 
-return a hash value for the filename
+return a hash value for the whole filename, names that are equal for FilenameCompare have the same hash
 ================
 */
-long idFileSystemLocal::HashFileName( const char *fname ) const {
-	int		i;
-	long	hash;
-	char	letter;
-
-	hash = 0;
-	i = 0;
-	while( fname[i] != '\0' ) {
-		letter = idStr::ToLower( fname[i] );
-		if ( letter == '.' ) {
-			break;				// don't include extension
+int idFileSystemLocal::HashFileName( const char *fname ) const {
+	unsigned int	hash;
+	int				c;
+
+	hash = 2166136261u;
+	for ( ; *fname != '\0'; fname++ ) {
+		c = *fname;
+		if ( c >= 'A' && c <= 'Z' ) {
+			c += ( 'a' - 'A' );
 		}
-		if ( letter == '\\' ) {
-			letter = '/';		// damn path names
+		if ( c == '\\' || c == ':' ) {
+			c = '/';			// damn path names
 		}
-		hash += (long)(letter) * (i+119);
-		i++;
+		hash = ( hash ^ (unsigned char)c ) * 16777619u;
 	}
-	hash &= (FILE_HASH_SIZE-1);
-	return hash;
+	return (int)hash;
+}
+
+/*
+================
+idFileSystemLocal::FindFileInPak
+
+Linear probing through the hash of the central directory of the pak.
+================
+*/
+fileInPack_t *idFileSystemLocal::FindFileInPak( const pack_t *pak, const char *relativePath, int hash ) const {
+	int i;
+
+	for ( i = hash & pak->fileHashMask; pak->fileHash[i] != -1; i = ( i + 1 ) & pak->fileHashMask ) {
+		fileInPack_t *pakFile = &pak->buildBuffer[pak->fileHash[i]];
+		// case and separator insensitive comparisons
+		if ( pakFile->hash == hash && !FilenameCompare( pakFile->name, relativePath ) ) {
+			return pakFile;
+		}
+	}
+	return NULL;
 }
 
 /*
@@ -972,9 +1011,7 @@ idFileSystemLocal::FileIsInPAK
 */
 bool idFileSystemLocal::FileIsInPAK( const char *relativePath ) {
 	searchpath_t	*search;
-	pack_t			*pak;
-	fileInPack_t	*pakFile;
-	long			hash;
+	int				hash;
 
 	if ( !searchPaths ) {
 		common->FatalError( "Filesystem call made without initialization\n" );
@@ -1004,7 +1041,7 @@ bool idFileSystemLocal::FileIsInPAK( const char *relativePath ) {
 
 	for ( search = searchPaths; search; search = search->next ) {
 		// is the element a pak file?
-		if ( search->pack && search->pack->hashTable[hash] ) {
+		if ( search->pack && FindFileInPak( search->pack, relativePath, hash ) ) {
 
 			// disregard if it doesn't match one of the allowed pure pak files - or is a localization file
 			if ( serverPaks.Num() ) {
@@ -1014,16 +1051,7 @@ bool idFileSystemLocal::FileIsInPAK( const char *relativePath ) {
 				}
 			}
 
-			// look through all the pak file elements
-			pak = search->pack;
-			pakFile = pak->hashTable[hash];
-			do {
-				// case and separator insensitive comparisons
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					return true;
-				}
-				pakFile = pakFile->next;
-			} while( pakFile != NULL );
+			return true;
 		}
 	}
 	return false;
@@ -1154,6 +1182,125 @@ void idFileSystemLocal::FreeFile( void *buffer ) {
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::MapFile
+
+Only files in the directory tree can be mapped, files in pak files are read into memory
+============
+*/
+int idFileSystemLocal::MapFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp ) {
+	idFile *	f;
+	pack_t *	pak;
+	int			len;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::MapFile with empty name\n" );
+	}
+
+	*buffer = NULL;
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	f = OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, &pak, false );
+	if ( f == NULL ) {
+		return -1;
+	}
+	len = f->Length();
+
+	if ( timestamp ) {
+		*timestamp = f->Timestamp();
+	}
+
+	loadCount++;
+	loadStack++;
+
+	if ( pak == NULL && len > 0 ) {
+		mappedFile_t mapped;
+
+		mapped.buffer = Sys_MapFile( static_cast<idFile_Permanent *>( f )->GetFilePtr(), 0, len, mapped.mapping );
+		if ( mapped.buffer != NULL ) {
+			mappedFiles.Append( mapped );
+			*buffer = mapped.buffer;
+			CloseFile( f );
+			return len;
+		}
+	}
+
+	byte *buf = (byte *)Mem_ClearedAlloc( len + 1 );
+	f->Read( buf, len );
+	*buffer = buf;
+	CloseFile( f );
+
+	return len;
+}
+
+/*
+============
+idFileSystemLocal::UnmapFile
+============
+*/
+void idFileSystemLocal::UnmapFile( void *buffer ) {
+	if ( !buffer ) {
+		common->FatalError( "idFileSystemLocal::UnmapFile( NULL )" );
+	}
+
+	for ( int i = 0; i < mappedFiles.Num(); i++ ) {
+		if ( mappedFiles[i].buffer == buffer ) {
+			Sys_UnmapFile( mappedFiles[i].mapping );
+			mappedFiles.RemoveIndex( i );
+			loadStack--;
+			return;
+		}
+	}
+
+	FreeFile( buffer );
+}
+
+/*
+============
+idFileSystemLocal::GetFileStamp
+============
+*/
+int idFileSystemLocal::GetFileStamp( const char *relativePath, ID_TIME_T *timestamp, int *pakChecksum ) {
+	idFile *	f;
+	pack_t *	pak;
+	int			len;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+	if ( pakChecksum ) {
+		*pakChecksum = 0;
+	}
+
+	f = OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, &pak, false );
+	if ( f == NULL ) {
+		return -1;
+	}
+	len = f->Length();
+
+	if ( timestamp ) {
+		*timestamp = f->Timestamp();
+	}
+	if ( pakChecksum && pak ) {
+		*pakChecksum = pak->checksum;
+	}
+
+	CloseFile( f );
+
+	return len;
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -1295,14 +1442,15 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	unz_global_info gi;
 	char			filename_inzip[MAX_ZIPPED_FILE_NAME];
 	unz_file_info	file_info;
-	int				i;
-	long			hash;
+	unz_s *			zs;
+	int				i, j;
 	int				fs_numHeaderLongs;
 	int *			fs_headerLongs;
 	FILE			*f;
 	int				len;
-	int				confHash;
 	fileInPack_t	*pakFile;
+	byte *			mappedData;
+	sysFileMapping_t mapping;
 
 	f = OpenOSFile( zipfile, "rb" );
 	if ( !f ) {
@@ -1310,6 +1458,10 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	}
 	fseek( f, 0, SEEK_END );
 	len = ftell( f );
+	mappedData = NULL;
+	if ( fs_mapPaks.GetBool() ) {
+		mappedData = (byte *)Sys_MapFile( f, 0, len, mapping );
+	}
 	fclose( f );
 
 	fs_numHeaderLongs = 0;
@@ -1318,14 +1470,14 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	err = unzGetGlobalInfo( uf, &gi );
 
 	if ( err != UNZ_OK ) {
+		if ( mappedData ) {
+			Sys_UnmapFile( mapping );
+		}
 		return NULL;
 	}
 
 	buildBuffer = new fileInPack_t[gi.number_entry];
 	pack = new pack_t;
-	for( i = 0; i < FILE_HASH_SIZE; i++ ) {
-		pack->hashTable[i] = NULL;
-	}
 
 	pack->pakFilename = zipfile;
 	pack->handle = uf;
@@ -1338,9 +1490,22 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	pack->addon_info = NULL;
 	pack->pureStatus = PURE_UNKNOWN;
 	pack->isNew = false;
+	pack->mappedData = mappedData;
+	if ( mappedData ) {
+		pack->mapping = mapping;
+	} else {
+		memset( &pack->mapping, 0, sizeof( pack->mapping ) );
+	}
 
 	pack->length = len;
 
+	// the hash is at most half full
+	for ( pack->fileHashMask = 15; pack->fileHashMask < (int)gi.number_entry * 2; pack->fileHashMask = pack->fileHashMask * 2 + 1 ) {
+	}
+	pack->fileHash = new int[pack->fileHashMask + 1];
+	memset( pack->fileHash, -1, ( pack->fileHashMask + 1 ) * sizeof( int ) );
+
+	zs = (unz_s *)uf;
 	unzGoToFirstFile(uf);
 	fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
 	for ( i = 0; i < (int)gi.number_entry; i++ ) {
@@ -1351,39 +1516,46 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 		if ( file_info.uncompressed_size > 0 ) {
 			fs_headerLongs[fs_numHeaderLongs++] = LittleLong( file_info.crc );
 		}
-		hash = HashFileName( filename_inzip );
 		buildBuffer[i].name = filename_inzip;
 		buildBuffer[i].name.ToLower();
 		buildBuffer[i].name.BackSlashesToSlashes();
+		buildBuffer[i].hash = HashFileName( buildBuffer[i].name );
 		// store the file position in the zip
 		unzGetCurrentFileInfoPosition( uf, &buildBuffer[i].pos );
-		// add the file to the hash
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
+		// stored files can be read straight from the mapped pak, once the data is found after the local header
+		buildBuffer[i].stored = ( file_info.compression_method == 0 && file_info.compressed_size == file_info.uncompressed_size && !( file_info.flag & 1 ) );
+		buildBuffer[i].size = file_info.uncompressed_size;
+		buildBuffer[i].localHeader = zs->cur_file_info_internal.offset_curfile + zs->byte_before_the_zipfile;
+		buildBuffer[i].dataOffset = -1;
+		// add the file to the hash, a later file with the same name replaces the earlier one
+		for ( j = buildBuffer[i].hash & pack->fileHashMask; pack->fileHash[j] != -1; j = ( j + 1 ) & pack->fileHashMask ) {
+			if ( buildBuffer[pack->fileHash[j]].hash == buildBuffer[i].hash && !FilenameCompare( buildBuffer[pack->fileHash[j]].name, buildBuffer[i].name ) ) {
+				break;
+			}
+		}
+		pack->fileHash[j] = i;
 		// go to the next file in the zip
 		unzGoToNextFile(uf);
 	}
+	pack->numfiles = i;
 
 	// check if this is an addon pak
 	pack->addon = false;
-	confHash = HashFileName( ADDON_CONFIG );
-	for ( pakFile = pack->hashTable[confHash]; pakFile; pakFile = pakFile->next ) {
-		if ( !FilenameCompare( pakFile->name, ADDON_CONFIG ) ) {			
-			pack->addon = true;			
-			idFile_InZip *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
-			// may be just an empty file if you don't bother about the mapDef
-			if ( file && file->Length() ) {
-				char *buf;
-				buf = new char[ file->Length() + 1 ];
-				file->Read( (void *)buf, file->Length() );
-				buf[ file->Length() ] = '\0';
-				pack->addon_info = ParseAddonDef( buf, file->Length() );
-				delete[] buf;
-			}
-			if ( file ) {
-				CloseFile( file );
-			}
-			break;
+	pakFile = FindFileInPak( pack, ADDON_CONFIG, HashFileName( ADDON_CONFIG ) );
+	if ( pakFile ) {
+		pack->addon = true;
+		idFile_InZip *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
+		// may be just an empty file if you don't bother about the mapDef
+		if ( file && file->Length() ) {
+			char *buf;
+			buf = new char[ file->Length() + 1 ];
+			file->Read( (void *)buf, file->Length() );
+			buf[ file->Length() ] = '\0';
+			pack->addon_info = ParseAddonDef( buf, file->Length() );
+			delete[] buf;
+		}
+		if ( file ) {
+			CloseFile( file );
 		}
 	}
 
@@ -2096,6 +2268,110 @@ void idFileSystemLocal::TouchFileList_f( const idCmdArgs &args ) {
 
 }
 
+/*
+============
+idFileSystemLocal::BenchmarkPaks_f
+
+Reads every file of the paks on the search path, once from the mapped paks and once through unzip.
+An optional game directory limits the benchmark to the paks in that directory.
+============
+*/
+void idFileSystemLocal::BenchmarkPaks_f( const idCmdArgs &args ) {
+	searchpath_t	*search;
+	pack_t			*pak;
+	idStr			gameDir;
+	int				i, pass, numPaks, numFiles, maxSize, start, end, len;
+	float			numMB;
+	byte			*buffer;
+
+	if ( args.Argc() > 2 ) {
+		common->Printf( "Usage: benchmarkPaks [game directory]\n" );
+		return;
+	}
+
+	// find the largest file to size the read buffer
+	numPaks = 0;
+	maxSize = 0;
+	for ( search = fileSystemLocal.searchPaths; search; search = search->next ) {
+		if ( !search->pack ) {
+			continue;
+		}
+		if ( args.Argc() == 2 ) {
+			gameDir = search->pack->pakFilename;
+			gameDir.StripFilename();
+			gameDir.ExtractFileName( gameDir );
+			if ( gameDir.Icmp( args.Argv( 1 ) ) ) {
+				continue;
+			}
+		}
+		for ( i = 0; i < search->pack->numfiles; i++ ) {
+			maxSize = Max( maxSize, search->pack->buildBuffer[i].size );
+		}
+		numPaks++;
+	}
+	if ( !numPaks ) {
+		common->Printf( "no paks to benchmark\n" );
+		return;
+	}
+	buffer = (byte *)Mem_Alloc( maxSize + 1 );
+
+	for ( pass = 0; pass < 2; pass++ ) {
+		fileSystemLocal.ignoreMappedPaks = ( pass == 1 );
+
+		numFiles = 0;
+		numMB = 0.0f;
+		start = Sys_Milliseconds();
+		for ( search = fileSystemLocal.searchPaths; search; search = search->next ) {
+			pak = search->pack;
+			if ( !pak ) {
+				continue;
+			}
+			if ( args.Argc() == 2 ) {
+				gameDir = pak->pakFilename;
+				gameDir.StripFilename();
+				gameDir.ExtractFileName( gameDir );
+				if ( gameDir.Icmp( args.Argv( 1 ) ) ) {
+					continue;
+				}
+			}
+			for ( i = 0; i < pak->numfiles; i++ ) {
+				idFile_InZip *file = fileSystemLocal.ReadFileFromZip( pak, &pak->buildBuffer[i], pak->buildBuffer[i].name );
+				len = file->Length();
+				if ( file->Read( buffer, len ) == len ) {
+					numMB += len / ( 1024.0f * 1024.0f );
+				}
+				delete file;
+				numFiles++;
+			}
+		}
+		end = Sys_Milliseconds();
+
+		common->Printf( "%-8s %5d files %7.2f MB %6d ms %8.2f MB/s\n", pass == 0 ? "mapped" : "unzip", numFiles,
+							numMB, end - start, ( end > start ) ? numMB / ( ( end - start ) * 0.001f ) : 0.0f );
+	}
+	fileSystemLocal.ignoreMappedPaks = false;
+
+	Mem_Free( buffer );
+
+	// time the central directory lookups
+	numFiles = 0;
+	start = Sys_Milliseconds();
+	for ( search = fileSystemLocal.searchPaths; search; search = search->next ) {
+		pak = search->pack;
+		if ( !pak ) {
+			continue;
+		}
+		for ( i = 0; i < pak->numfiles; i++ ) {
+			if ( fileSystemLocal.FindFileInPak( pak, pak->buildBuffer[i].name, fileSystemLocal.HashFileName( pak->buildBuffer[i].name ) ) ) {
+				numFiles++;
+			}
+		}
+	}
+	end = Sys_Milliseconds();
+	common->Printf( "%d lookups in %d ms\n", numFiles, end - start );
+	common->Printf( "%d paks, fs_mapPaks %d\n", numPaks, fs_mapPaks.GetInteger() );
+}
+
 
 /*
 ================
@@ -2396,6 +2672,7 @@ void idFileSystemLocal::Startup( void ) {
 	cmdSystem->AddCommand( "path", Path_f, CMD_FL_SYSTEM, "lists search paths" );
 	cmdSystem->AddCommand( "touchFile", TouchFile_f, CMD_FL_SYSTEM, "touches a file" );
 	cmdSystem->AddCommand( "touchFileList", TouchFileList_f, CMD_FL_SYSTEM, "touches a list of files" );
+	cmdSystem->AddCommand( "benchmarkPaks", BenchmarkPaks_f, CMD_FL_SYSTEM, "reads every file in the paks from the mapped paks and through unzip" );
 
 	// print the current search paths
 	Path_f( idCmdArgs() );
@@ -2489,29 +2766,28 @@ bool idFileSystemLocal::UpdateGamePakChecksums( void ) {
 			continue;
 		}
 		search->pack->binary = BINARY_NO;
-		for ( pakFile = search->pack->hashTable[confHash]; pakFile; pakFile = pakFile->next ) {
-			if ( !FilenameCompare( pakFile->name, BINARY_CONFIG ) ) {
-				search->pack->binary = BINARY_YES;
-				confFile = ReadFileFromZip( search->pack, pakFile, BINARY_CONFIG );
-				buf = new char[ confFile->Length() + 1 ];
-				confFile->Read( (void *)buf, confFile->Length() );
-				buf[ confFile->Length() ] = '\0';
-				lexConf = new idLexer( buf, confFile->Length(), confFile->GetFullPath() );
-				while ( lexConf->ReadToken( &token ) ) {
-					if ( token.IsNumeric() ) {
-						id = atoi( token );
-						if ( id < MAX_GAME_OS && !gamePakForOS[ id ] ) {
-							if ( fs_debug.GetBool() ) {
-								common->Printf( "Adding game pak checksum for OS %d: %s 0x%x\n", id, confFile->GetFullPath(), search->pack->checksum );
-							}
- 							gamePakForOS[ id ] = search->pack->checksum;
+		pakFile = FindFileInPak( search->pack, BINARY_CONFIG, confHash );
+		if ( pakFile ) {
+			search->pack->binary = BINARY_YES;
+			confFile = ReadFileFromZip( search->pack, pakFile, BINARY_CONFIG );
+			buf = new char[ confFile->Length() + 1 ];
+			confFile->Read( (void *)buf, confFile->Length() );
+			buf[ confFile->Length() ] = '\0';
+			lexConf = new idLexer( buf, confFile->Length(), confFile->GetFullPath() );
+			while ( lexConf->ReadToken( &token ) ) {
+				if ( token.IsNumeric() ) {
+					id = atoi( token );
+					if ( id < MAX_GAME_OS && !gamePakForOS[ id ] ) {
+						if ( fs_debug.GetBool() ) {
+							common->Printf( "Adding game pak checksum for OS %d: %s 0x%x\n", id, confFile->GetFullPath(), search->pack->checksum );
 						}
+						gamePakForOS[ id ] = search->pack->checksum;
 					}
 				}
-				CloseFile( confFile );
-				delete lexConf;
-				delete[] buf;
 			}
+			CloseFile( confFile );
+			delete lexConf;
+			delete[] buf;
 		}
 	}
 
@@ -2642,7 +2918,6 @@ fsPureReply_t idFileSystemLocal::SetPureServerChecksums( const int pureChecksums
 	bool			canPrepend = true;
 	char			dllName[MAX_OSPATH];
 	int				dllHash;
-	fileInPack_t *	pakFile;
 
 	sys->DLL_GetFileName( "game", dllName, MAX_OSPATH );
 	dllHash = HashFileName( dllName );
@@ -2754,13 +3029,9 @@ fsPureReply_t idFileSystemLocal::SetPureServerChecksums( const int pureChecksums
 			common->Printf( "server's game code pak candidate is '%s' ( 0x%x )\n", pack->pakFilename.c_str(), pack->checksum );
 		}
 		// make sure there is a valid DLL for us
-		if ( pack->hashTable[ dllHash ] ) {
-			for ( pakFile = pack->hashTable[ dllHash ]; pakFile; pakFile = pakFile->next ) {
-				if ( !FilenameCompare( pakFile->name, dllName ) ) {
-					gamePakChecksum = _gamePakChecksum;		// this will be used to extract the DLL in pure mode FindDLL
-					return PURE_RESTART;
-				}
-			}
+		if ( FindFileInPak( pack, dllName, dllHash ) ) {
+			gamePakChecksum = _gamePakChecksum;		// this will be used to extract the DLL in pure mode FindDLL
+			return PURE_RESTART;
 		}
 		common->Warning( "media is misconfigured. server claims pak '%s' ( 0x%x ) has media for us, but '%s' is not found\n", pack->pakFilename.c_str(), pack->checksum, dllName );
 		return PURE_NODLL;
@@ -2949,6 +3220,10 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 			if ( sp->pack ) {
 				unzClose( sp->pack->handle );
 				delete [] sp->pack->buildBuffer;
+				delete [] sp->pack->fileHash;
+				if ( sp->pack->mappedData ) {
+					Sys_UnmapFile( sp->pack->mapping );
+				}
 				if ( sp->pack->addon_info ) {
 					sp->pack->addon_info->mapDecls.DeleteContents( true );
 					delete sp->pack->addon_info;
@@ -2970,6 +3245,7 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	cmdSystem->RemoveCommand( "dir" );
 	cmdSystem->RemoveCommand( "dirtree" );
 	cmdSystem->RemoveCommand( "touchFile" );
+	cmdSystem->RemoveCommand( "benchmarkPaks" );
 
 	mapDict.Clear();
 }
@@ -3044,7 +3320,7 @@ idFileSystemLocal::GetPackStatus
 ===========
 */
 pureStatus_t idFileSystemLocal::GetPackStatus( pack_t *pak ) {
-	int				i, l, hashindex;
+	int				i, l;
 	fileInPack_t	*file;
 	bool			abrt;
 	idStr			name;
@@ -3054,28 +3330,18 @@ pureStatus_t idFileSystemLocal::GetPackStatus( pack_t *pak ) {
 	}
 
 	// check content for PURE_NEVER
-	i = 0;
-	file = pak->buildBuffer;
-	for ( hashindex = 0; hashindex < FILE_HASH_SIZE; hashindex++ ) {
-		abrt = false;
-		file = pak->hashTable[ hashindex ];
-		while ( file ) {
-			abrt = true;
-			l = file->name.Length();
-			for ( int j = 0; pureExclusions[j].func != NULL; j++ ) {
-				if ( pureExclusions[j].func( pureExclusions[j], l, file->name ) ) {
-					abrt = false;
-					break;
-				}
-			}
-			if ( abrt ) {
-				common->DPrintf( "pak '%s' candidate for pure: '%s'\n", pak->pakFilename.c_str(), file->name.c_str() );
+	for ( i = 0; i < pak->numfiles; i++ ) {
+		file = &pak->buildBuffer[ i ];
+		abrt = true;
+		l = file->name.Length();
+		for ( int j = 0; pureExclusions[j].func != NULL; j++ ) {
+			if ( pureExclusions[j].func( pureExclusions[j], l, file->name ) ) {
+				abrt = false;
 				break;
 			}
-			file = file->next;
-			i++;
 		}
 		if ( abrt ) {
+			common->DPrintf( "pak '%s' candidate for pure: '%s'\n", pak->pakFilename.c_str(), file->name.c_str() );
 			break;
 		}
 	}
@@ -3098,12 +3364,43 @@ pureStatus_t idFileSystemLocal::GetPackStatus( pack_t *pak ) {
 /*
 ===========
 idFileSystemLocal::ReadFileFromZip
+
+Stored files in a mapped pak are read straight from the mapping without reopening the pak.
 ===========
 */
 idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
 	unz_s *			zfi;
 	FILE *			fp;
-	idFile_InZip *file = new idFile_InZip();
+	idFile_InZip *file;
+
+	if ( pak->mappedData && pakFile->stored && !ignoreMappedPaks ) {
+		if ( pakFile->dataOffset < 0 ) {
+			// the data follows the local file header, which has its own name and extra field lengths
+			const byte *header = pak->mappedData + pakFile->localHeader;
+			if ( pakFile->localHeader >= 0 && pakFile->localHeader + 30 <= pak->length &&
+					( header[0] | ( header[1] << 8 ) | ( header[2] << 16 ) | ( header[3] << 24 ) ) == 0x04034b50 ) {
+				int dataOffset = pakFile->localHeader + 30 + ( header[26] | ( header[27] << 8 ) ) + ( header[28] | ( header[29] << 8 ) );
+				if ( dataOffset + pakFile->size <= pak->length ) {
+					pakFile->dataOffset = dataOffset;
+				}
+			}
+			if ( pakFile->dataOffset < 0 ) {
+				common->DWarning( "bad local header for '%s' in %s", relativePath, pak->pakFilename.c_str() );
+				pakFile->stored = false;
+			}
+		}
+		if ( pakFile->stored ) {
+			file = new idFile_InZip();
+			file->name = relativePath;
+			file->fullPath = pak->pakFilename + "/" + relativePath;
+			file->zipFilePos = pakFile->pos;
+			file->fileSize = pakFile->size;
+			file->mappedData = pak->mappedData + pakFile->dataOffset;
+			return file;
+		}
+	}
+
+	file = new idFile_InZip();
 
 	// open a new file on the pakfile
 	file->z = unzReOpen( pak->pakFilename, pak->handle );
@@ -3144,7 +3441,7 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 	pack_t *		pak;
 	fileInPack_t *	pakFile;
 	directory_t *	dir;
-	long			hash;
+	int				hash;
 	FILE *			fp;
 	
 	if ( !searchPaths ) {
@@ -3292,7 +3589,8 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			return file;
 		} else if ( search->pack && ( searchFlags & FSFLAG_SEARCH_PAKS ) ) {
 
-			if ( !search->pack->hashTable[hash] ) {
+			pakFile = FindFileInPak( search->pack, relativePath, hash );
+			if ( !pakFile ) {
 				continue;
 			}
 
@@ -3310,65 +3608,49 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			if ( searchFlags & FSFLAG_BINARY_ONLY ) {
 				// make sure this pak is tagged as a binary file
 				if ( pak->binary == BINARY_UNKNOWN ) {
-					int				confHash;
-					fileInPack_t	*pakFile;
-					confHash = HashFileName( BINARY_CONFIG );
-					pak->binary = BINARY_NO;
-					for ( pakFile = search->pack->hashTable[confHash]; pakFile; pakFile = pakFile->next ) {
-						if ( !FilenameCompare( pakFile->name, BINARY_CONFIG ) ) {
-							pak->binary = BINARY_YES;
-							break;
-						}
-					}
+					pak->binary = FindFileInPak( pak, BINARY_CONFIG, HashFileName( BINARY_CONFIG ) ) ? BINARY_YES : BINARY_NO;
 				}
 				if ( pak->binary == BINARY_NO ) {
 					continue; // not a binary pak, skip
 				}
 			}
 
-			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
-				// case and separator insensitive comparisons
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+			idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
 
-					if ( foundInPak ) {
-						*foundInPak = pak;
-					}
-
-					if ( !pak->referenced && !( searchFlags & FSFLAG_PURE_NOREF ) ) {
-						// mark this pak referenced
-						if ( fs_debug.GetInteger( ) ) {
-							common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
-						}
-						pak->referenced = true;
-					}
+			if ( foundInPak ) {
+				*foundInPak = pak;
+			}
 
-					if ( fs_debug.GetInteger( ) ) {
-						common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
-					}
-					return file;
+			if ( !pak->referenced && !( searchFlags & FSFLAG_PURE_NOREF ) ) {
+				// mark this pak referenced
+				if ( fs_debug.GetInteger( ) ) {
+					common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
 				}
+				pak->referenced = true;
 			}
+
+			if ( fs_debug.GetInteger( ) ) {
+				common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
+			}
+			return file;
 		}
 	}
 
 	if ( searchFlags & FSFLAG_SEARCH_ADDONS ) {
 		for ( search = addonPaks; search; search = search->next ) {
 			assert( search->pack );
-			fileInPack_t	*pakFile;
 			pak = search->pack;
-			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
-					if ( foundInPak ) {
-						*foundInPak = pak;
-					}
-					// we don't toggle pure on paks found in addons - they can't be used without a reloadEngine anyway
-					if ( fs_debug.GetInteger( ) ) {
-						common->Printf( "idFileSystem::OpenFileRead: %s (found in addon pk4 '%s')\n", relativePath, search->pack->pakFilename.c_str() );
-					}
-					return file;
+			pakFile = FindFileInPak( pak, relativePath, hash );
+			if ( pakFile ) {
+				idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+				if ( foundInPak ) {
+					*foundInPak = pak;
 				}
+				// we don't toggle pure on paks found in addons - they can't be used without a reloadEngine anyway
+				if ( fs_debug.GetInteger( ) ) {
+					common->Printf( "idFileSystem::OpenFileRead: %s (found in addon pk4 '%s')\n", relativePath, search->pack->pakFilename.c_str() );
+				}
+				return file;
 			}
 		}
 	}
@@ -3806,26 +4088,25 @@ pack_t *idFileSystemLocal::FindPakForFileChecksum( const char *relativePath, int
 	assert( !serverPaks.Num() );
 	hash = HashFileName( relativePath );
 	for ( search = searchPaths; search; search = search->next ) {
-		if ( search->pack && search->pack->hashTable[ hash ] ) {
+		if ( search->pack ) {
 			pak = search->pack;
-			for ( pakFile = pak->hashTable[ hash ]; pakFile; pakFile = pakFile->next ) {
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
-					if ( findChecksum == GetFileChecksum( file ) ) {
-						if ( fs_debug.GetBool() ) {
-							common->Printf( "found '%s' with checksum 0x%x in pak '%s'\n", relativePath, findChecksum, pak->pakFilename.c_str() );
-						}
-						if ( bReference ) {
-							pak->referenced = true;
-							// FIXME: use dependencies for pak references
-						}
-						CloseFile( file );
-						return pak;
-					} else if ( fs_debug.GetBool() ) {
-						common->Printf( "'%s' in pak '%s' has != checksum %x\n", relativePath, pak->pakFilename.c_str(), GetFileChecksum( file ) );
+			pakFile = FindFileInPak( pak, relativePath, hash );
+			if ( pakFile ) {
+				idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+				if ( findChecksum == GetFileChecksum( file ) ) {
+					if ( fs_debug.GetBool() ) {
+						common->Printf( "found '%s' with checksum 0x%x in pak '%s'\n", relativePath, findChecksum, pak->pakFilename.c_str() );
+					}
+					if ( bReference ) {
+						pak->referenced = true;
+						// FIXME: use dependencies for pak references
 					}
 					CloseFile( file );
+					return pak;
+				} else if ( fs_debug.GetBool() ) {
+					common->Printf( "'%s' in pak '%s' has != checksum %x\n", relativePath, pak->pakFilename.c_str(), GetFileChecksum( file ) );
 				}
+				CloseFile( file );
 			}
 		}
 	}
@@ -3925,21 +4206,20 @@ void idFileSystemLocal::FindDLL( const char *name, char _dllPath[ MAX_OSPATH ],
 				common->Warning( "FindDLL in pure mode: game pak not found ( 0x%x )\n", gamePakChecksum );
 			} else {
 				// extract and copy
-				for ( pakFile = pak->hashTable[dllHash]; pakFile; pakFile = pakFile->next ) {
-					if ( !FilenameCompare( pakFile->name, dllName ) ) {
-						dllFile = ReadFileFromZip( pak, pakFile, dllName );
-						common->Printf( "found DLL in game pak file: %s\n", pak->pakFilename.c_str() );
-						dllPath = RelativePathToOSPath( dllName, "fs_savepath" );
-						CopyFile( dllFile, dllPath );
-						CloseFile( dllFile );
-						dllFile = OpenFileReadFlags( dllName, FSFLAG_SEARCH_DIRS );
-						if ( !dllFile ) {
-							common->Error( "DLL extraction to fs_savepath failed\n" );
-						} else {
-							gameDLLChecksum = GetFileChecksum( dllFile );
-							updateChecksum = false;	// don't try again below
-						}						
-					}
+				pakFile = FindFileInPak( pak, dllName, dllHash );
+				if ( pakFile ) {
+					dllFile = ReadFileFromZip( pak, pakFile, dllName );
+					common->Printf( "found DLL in game pak file: %s\n", pak->pakFilename.c_str() );
+					dllPath = RelativePathToOSPath( dllName, "fs_savepath" );
+					CopyFile( dllFile, dllPath );
+					CloseFile( dllFile );
+					dllFile = OpenFileReadFlags( dllName, FSFLAG_SEARCH_DIRS );
+					if ( !dllFile ) {
+						common->Error( "DLL extraction to fs_savepath failed\n" );
+					} else {
+						gameDLLChecksum = GetFileChecksum( dllFile );
+						updateChecksum = false;	// don't try again below
+					}						
 				}
 			}
 		}
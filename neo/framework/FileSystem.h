@@ -282,6 +282,18 @@ public:
 
 							// ignore case and seperator char distinctions
 	virtual bool			FilenameCompare( const char *s1, const char *s2 ) const = 0;
+
+							// Memory maps a complete file, or reads it into memory when it can't be mapped.
+							// Returns the length of the file, or -1 on failure.
+							// The mapping is copy-on-write, so the buffer may be modified without changing the file,
+							// but unlike ReadFile there is no trailing 0.
+	virtual int				MapFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Unmaps or frees the buffer returned by MapFile.
+	virtual void			UnmapFile( void *buffer ) = 0;
+							// Returns the length and timestamp of a file without reading it, or -1 if it isn't found.
+							// pakChecksum is set to the checksum of the pak file it would be read from, or 0 for
+							// a file in the directory tree, whose timestamp is only valid then.
+	virtual int				GetFileStamp( const char *relativePath, ID_TIME_T *timestamp, int *pakChecksum ) = 0;
 };
 
 extern idFileSystem *		fileSystem;
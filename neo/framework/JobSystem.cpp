@@ -0,0 +1,1022 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+/*
+===============================================================================
+
+	Job system with work stealing worker threads.
+
+===============================================================================
+*/
+
+idCVar com_jobThreads( "com_jobThreads", "-1", CVAR_INTEGER | CVAR_SYSTEM | CVAR_INIT, "number of job worker threads, -1 = one per logical processor minus one, 0 = execute jobs on the waiting thread" );
+
+const int MAX_JOB_THREADS			= 64;		// worker threads
+const int MAX_JOB_DEQUES			= MAX_JOB_THREADS + 1;	// the main thread has a deque as well
+const int JOB_DEQUE_SIZE			= 4096;		// must be a power of two
+const int MAX_JOBGROUP_DEPENDENTS	= 32;		// number of groups that can wait for a single group
+const int JOB_SPIN_COUNT			= 1000;		// number of tries to find a job before a worker goes to sleep
+
+class idJobGroupLocal;
+
+typedef struct job_s {
+	jobRun_t				function;
+	void *					data;
+	idJobGroupLocal *		group;
+} job_t;
+
+/*
+===============================================================================
+
+	idJobDeque
+
+	The owner pushes and pops at the bottom, other threads steal from the top.
+	Every operation is a few instructions so a spin lock is good enough.
+
+===============================================================================
+*/
+
+class idJobDeque {
+public:
+							idJobDeque( void ) : top( 0 ), bottom( 0 ) {}
+
+	bool					Push( const job_t &job );
+	bool					Pop( job_t &job );
+	bool					Steal( job_t &job );
+	int						Num( void ) const { return bottom - top; }
+
+private:
+	idSysSpinLock			lock;
+	volatile int			top;
+	volatile int			bottom;
+	job_t					jobs[JOB_DEQUE_SIZE];
+};
+
+/*
+================
+idJobDeque::Push
+================
+*/
+bool idJobDeque::Push( const job_t &job ) {
+	lock.Lock();
+	if ( bottom - top >= JOB_DEQUE_SIZE ) {
+		lock.Unlock();
+		return false;
+	}
+	jobs[bottom & ( JOB_DEQUE_SIZE - 1 )] = job;
+	bottom++;
+	lock.Unlock();
+	return true;
+}
+
+/*
+================
+idJobDeque::Pop
+================
+*/
+bool idJobDeque::Pop( job_t &job ) {
+	if ( bottom == top ) {
+		return false;
+	}
+	lock.Lock();
+	if ( bottom == top ) {
+		lock.Unlock();
+		return false;
+	}
+	bottom--;
+	job = jobs[bottom & ( JOB_DEQUE_SIZE - 1 )];
+	if ( bottom == top ) {
+		// keep the indexes small
+		top = bottom = 0;
+	}
+	lock.Unlock();
+	return true;
+}
+
+/*
+================
+idJobDeque::Steal
+================
+*/
+bool idJobDeque::Steal( job_t &job ) {
+	if ( bottom == top ) {
+		return false;
+	}
+	if ( !lock.TryLock() ) {
+		// somebody else is busy with this deque, try another one
+		return false;
+	}
+	if ( bottom == top ) {
+		lock.Unlock();
+		return false;
+	}
+	job = jobs[top & ( JOB_DEQUE_SIZE - 1 )];
+	top++;
+	lock.Unlock();
+	return true;
+}
+
+/*
+===============================================================================
+
+	idJobGroupLocal
+
+===============================================================================
+*/
+
+typedef enum {
+	JOBGROUP_IDLE,
+	JOBGROUP_SUBMITTED,
+	JOBGROUP_DONE
+} jobGroupState_t;
+
+class idJobGroupLocal : public idJobGroup {
+public:
+							idJobGroupLocal( const char *name );
+	virtual					~idJobGroupLocal( void );
+
+	virtual const char *	GetName( void ) const { return name.c_str(); }
+	virtual void			AddJob( jobRun_t function, void *data );
+	virtual int				GetNumJobs( void ) const { return jobs.Num(); }
+	virtual void			ReserveJobs( int numJobs );
+	virtual void			AddDependency( idJobGroup *group );
+	virtual void			Submit( void );
+	virtual bool			IsDone( void ) const { return state == JOBGROUP_IDLE || completed != 0; }
+	virtual void			Wait( void );
+	virtual void			Run( void );
+
+							// called when a job of this group finished
+	void					FinishJob( void );
+
+private:
+	idStr					name;
+	idList<job_t>			jobs;
+	idList<idJobGroupLocal *> dependencies;
+
+	volatile int			state;
+	volatile int			completed;			// set after the last access to the group by the job that completed it
+	volatile int			numPendingJobs;
+	volatile int			numPendingDependencies;
+
+	// groups that are waiting for this one, guarded by dependentsLock
+	idSysSpinLock			dependentsLock;
+	idStaticList<idJobGroupLocal *, MAX_JOBGROUP_DEPENDENTS> dependents;
+
+	void					BeginBatch( void );
+	void					Start( void );
+	void					Complete( void );
+	void					DependencyDone( void );
+};
+
+/*
+===============================================================================
+
+	idJobSystemLocal
+
+===============================================================================
+*/
+
+typedef struct jobWorker_s {
+	int						index;
+	char					name[16];
+	xthreadInfo				threadInfo;
+	// statistics, only written by the owning thread
+	int						numJobsExecuted;
+	int						numJobsStolen;
+} jobWorker_t;
+
+class idJobSystemLocal : public idJobSystem {
+public:
+							idJobSystemLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+	virtual int				GetNumWorkers( void ) const { return numWorkers; }
+	virtual int				GetNumThreads( void ) const { return numWorkers + 1; }
+	virtual int				GetThreadIndex( void ) const { return threadIndex; }
+	virtual idJobGroup *	AllocJobGroup( const char *name );
+	virtual void			FreeJobGroup( idJobGroup *group );
+
+	void					AddJobs( const job_t *jobs, int numJobs );
+	void					WaitForGroup( const idJobGroupLocal *group );
+
+	void					PrintStats( void ) const;
+	void					ClearStats( void );
+
+	static void				TestJobs_f( const idCmdArgs &args );
+	static void				TestJobsStress_f( const idCmdArgs &args );
+
+private:
+	bool					initialized;
+	int						numWorkers;
+	volatile bool			quit;
+	volatile int			numRunningWorkers;
+	volatile int			numIdleWorkers;
+	volatile int			nextDeque;			// round robin over the workers for jobs from non-worker threads
+	xsemaphoreHandle_t		wakeSemaphore;
+	idList<idJobGroupLocal *> jobGroups;
+
+	idJobDeque *			deques;				// index 0 is owned by the main thread
+	jobWorker_t				workers[MAX_JOB_DEQUES];	// index 0 is the main thread
+
+	static ID_THREAD_LOCAL int	threadIndex;
+
+	bool					FindJob( int index, job_t &job );
+	void					RunJob( int index, const job_t &job );
+
+	static unsigned int		WorkerThread( void *parm );
+};
+
+ID_THREAD_LOCAL int	idJobSystemLocal::threadIndex = -1;
+
+idJobSystemLocal		jobSystemLocal;
+idJobSystem *			jobSystem = &jobSystemLocal;
+
+/*
+================
+idJobGroupLocal::idJobGroupLocal
+================
+*/
+idJobGroupLocal::idJobGroupLocal( const char *name ) {
+	this->name = name;
+	state = JOBGROUP_IDLE;
+	completed = 0;
+	numPendingJobs = 0;
+	numPendingDependencies = 0;
+}
+
+/*
+================
+idJobGroupLocal::~idJobGroupLocal
+================
+*/
+idJobGroupLocal::~idJobGroupLocal( void ) {
+	if ( !IsDone() ) {
+		common->Warning( "job group '%s' freed while running", name.c_str() );
+		Wait();
+	}
+}
+
+/*
+================
+idJobGroupLocal::BeginBatch
+
+the jobs and dependencies of a group that is done have been consumed
+================
+*/
+void idJobGroupLocal::BeginBatch( void ) {
+	if ( state == JOBGROUP_DONE ) {
+		jobs.SetNum( 0, false );
+		dependencies.SetNum( 0, false );
+		state = JOBGROUP_IDLE;
+	}
+}
+
+/*
+================
+idJobGroupLocal::AddJob
+================
+*/
+void idJobGroupLocal::AddJob( jobRun_t function, void *data ) {
+	assert( IsDone() );
+	BeginBatch();
+	if ( jobs.Num() >= jobs.NumAllocated() ) {
+		// groups can get large, don't grow them linearly, jobs can't allocate so
+		// a group that gets jobs from inside a job needs ReserveJobs
+		assert( jobSystemLocal.GetThreadIndex() <= 0 );
+		jobs.Resize( Max( 64, jobs.NumAllocated() * 2 ) );
+	}
+	job_t &job = jobs.Alloc();
+	job.function = function;
+	job.data = data;
+	job.group = this;
+}
+
+/*
+================
+idJobGroupLocal::ReserveJobs
+================
+*/
+void idJobGroupLocal::ReserveJobs( int numJobs ) {
+	assert( IsDone() );
+	BeginBatch();
+	if ( jobs.NumAllocated() < numJobs ) {
+		jobs.Resize( numJobs );
+	}
+}
+
+/*
+================
+idJobGroupLocal::AddDependency
+================
+*/
+void idJobGroupLocal::AddDependency( idJobGroup *group ) {
+	assert( IsDone() );
+	assert( group != this );
+	BeginBatch();
+	dependencies.AddUnique( static_cast<idJobGroupLocal *>( group ) );
+}
+
+/*
+================
+idJobGroupLocal::Submit
+================
+*/
+void idJobGroupLocal::Submit( void ) {
+	assert( IsDone() );
+	BeginBatch();
+
+	// the extra count keeps the group from starting or completing while it is being submitted
+	numPendingJobs = jobs.Num() + 1;
+	numPendingDependencies = 1;
+	completed = 0;
+	Sys_InterlockedExchange( state, JOBGROUP_SUBMITTED );
+
+	for ( int i = 0; i < dependencies.Num(); i++ ) {
+		idJobGroupLocal *dependency = dependencies[i];
+		dependency->dependentsLock.Lock();
+		if ( dependency->state == JOBGROUP_SUBMITTED ) {
+			if ( dependency->dependents.Num() >= MAX_JOBGROUP_DEPENDENTS ) {
+				dependency->dependentsLock.Unlock();
+				common->FatalError( "job group '%s' has more than %d dependents", dependency->GetName(), MAX_JOBGROUP_DEPENDENTS );
+			}
+			dependency->dependents.Append( this );
+			Sys_InterlockedIncrement( numPendingDependencies );
+		}
+		dependency->dependentsLock.Unlock();
+	}
+
+	DependencyDone();
+}
+
+/*
+================
+idJobGroupLocal::DependencyDone
+================
+*/
+void idJobGroupLocal::DependencyDone( void ) {
+	if ( Sys_InterlockedDecrement( numPendingDependencies ) == 0 ) {
+		Start();
+	}
+}
+
+/*
+================
+idJobGroupLocal::Start
+================
+*/
+void idJobGroupLocal::Start( void ) {
+	jobSystemLocal.AddJobs( jobs.Ptr(), jobs.Num() );
+	// release the submit count
+	FinishJob();
+}
+
+/*
+================
+idJobGroupLocal::FinishJob
+================
+*/
+void idJobGroupLocal::FinishJob( void ) {
+	if ( Sys_InterlockedDecrement( numPendingJobs ) == 0 ) {
+		Complete();
+	}
+}
+
+/*
+================
+idJobGroupLocal::Complete
+================
+*/
+void idJobGroupLocal::Complete( void ) {
+	idStaticList<idJobGroupLocal *, MAX_JOBGROUP_DEPENDENTS> waiting;
+
+	// groups submitted from now on don't have to wait for this one
+	dependentsLock.Lock();
+	waiting = dependents;
+	dependents.Clear();
+	Sys_InterlockedExchange( state, JOBGROUP_DONE );
+	dependentsLock.Unlock();
+
+	// NOTE: the group may be reused or freed by a waiting thread from here on
+	Sys_InterlockedExchange( completed, 1 );
+
+	for ( int i = 0; i < waiting.Num(); i++ ) {
+		waiting[i]->DependencyDone();
+	}
+}
+
+/*
+================
+idJobGroupLocal::Wait
+================
+*/
+void idJobGroupLocal::Wait( void ) {
+	jobSystemLocal.WaitForGroup( this );
+}
+
+/*
+================
+idJobGroupLocal::Run
+================
+*/
+void idJobGroupLocal::Run( void ) {
+	Submit();
+	Wait();
+}
+
+/*
+================
+idJobSystemLocal::idJobSystemLocal
+================
+*/
+idJobSystemLocal::idJobSystemLocal( void ) {
+	initialized = false;
+	numWorkers = 0;
+	quit = false;
+	numRunningWorkers = 0;
+	numIdleWorkers = 0;
+	nextDeque = 0;
+	wakeSemaphore = NULL;
+	deques = NULL;
+	memset( workers, 0, sizeof( workers ) );
+}
+
+/*
+================
+idJobSystemLocal::Init
+================
+*/
+void idJobSystemLocal::Init( void ) {
+	if ( initialized ) {
+		return;
+	}
+
+	cmdSystem->AddCommand( "testJobs", TestJobs_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "measures job system throughput and scaling" );
+	cmdSystem->AddCommand( "testJobsStress", TestJobsStress_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "runs random job group graphs and verifies the results" );
+
+	numWorkers = com_jobThreads.GetInteger();
+	if ( numWorkers < 0 ) {
+		numWorkers = Sys_GetProcessorCount() - 1;
+	}
+	numWorkers = idMath::ClampInt( 0, MAX_JOB_THREADS, numWorkers );
+
+	threadIndex = 0;
+	quit = false;
+	numIdleWorkers = 0;
+	numRunningWorkers = numWorkers;
+	nextDeque = 0;
+
+	deques = new idJobDeque[numWorkers + 1];
+	wakeSemaphore = Sys_CreateSemaphore( 0 );
+
+	memset( workers, 0, sizeof( workers ) );
+	idStr::Copynz( workers[0].name, "main", sizeof( workers[0].name ) );
+
+	for ( int i = 1; i <= numWorkers; i++ ) {
+		jobWorker_t &worker = workers[i];
+		worker.index = i;
+		idStr::snPrintf( worker.name, sizeof( worker.name ), "Job%d", i );
+
+		// the workers are not registered in g_threads, that table only has room for a few debug entries
+		xthreadInfo *registered[MAX_THREADS];
+		int numRegistered = 0;
+		Sys_CreateThread( (xthread_t)WorkerThread, &worker, THREAD_NORMAL, worker.threadInfo, worker.name, registered, &numRegistered );
+	}
+
+	initialized = true;
+
+	common->Printf( "job system: %d worker threads, %d logical processors\n", numWorkers, Sys_GetProcessorCount() );
+}
+
+/*
+================
+idJobSystemLocal::Shutdown
+================
+*/
+void idJobSystemLocal::Shutdown( void ) {
+	if ( !initialized ) {
+		return;
+	}
+
+	for ( int i = 0; i < jobGroups.Num(); i++ ) {
+		if ( !jobGroups[i]->IsDone() ) {
+			common->Warning( "job group '%s' still running at job system shutdown", jobGroups[i]->GetName() );
+			jobGroups[i]->Wait();
+		}
+	}
+
+	// wake up all the workers and let them return on their own
+	quit = true;
+	if ( numWorkers > 0 ) {
+		Sys_PostSemaphore( wakeSemaphore, numWorkers );
+	}
+	while ( numRunningWorkers > 0 ) {
+		Sys_Yield();
+	}
+	for ( int i = 1; i <= numWorkers; i++ ) {
+		Sys_DestroyThread( workers[i].threadInfo );
+	}
+
+	Sys_DestroySemaphore( wakeSemaphore );
+	wakeSemaphore = NULL;
+
+	delete[] deques;
+	deques = NULL;
+
+	jobGroups.DeleteContents( true );
+
+	numWorkers = 0;
+	initialized = false;
+}
+
+/*
+================
+idJobSystemLocal::AllocJobGroup
+================
+*/
+idJobGroup *idJobSystemLocal::AllocJobGroup( const char *name ) {
+	assert( threadIndex == 0 || !initialized );
+	idJobGroupLocal *group = new idJobGroupLocal( name );
+	jobGroups.Append( group );
+	return group;
+}
+
+/*
+================
+idJobSystemLocal::FreeJobGroup
+================
+*/
+void idJobSystemLocal::FreeJobGroup( idJobGroup *group ) {
+	if ( group == NULL ) {
+		return;
+	}
+	assert( threadIndex == 0 || !initialized );
+	jobGroups.Remove( static_cast<idJobGroupLocal *>( group ) );
+	delete group;
+}
+
+/*
+================
+idJobSystemLocal::AddJobs
+================
+*/
+void idJobSystemLocal::AddJobs( const job_t *jobs, int numJobs ) {
+	int index = threadIndex;
+
+	for ( int i = 0; i < numJobs; i++ ) {
+		bool pushed;
+		if ( !initialized || numWorkers == 0 ) {
+			pushed = false;
+		} else if ( index > 0 ) {
+			// workers keep their own jobs close, the others will steal them if they are idle
+			pushed = deques[index].Push( jobs[i] );
+		} else {
+			// spread the jobs from other threads over the workers, any thread
+			// that isn't a worker can get here so the counter is interlocked
+			int deque = ( (unsigned int)Sys_InterlockedIncrement( nextDeque ) % numWorkers ) + 1;
+			pushed = deques[deque].Push( jobs[i] );
+		}
+		if ( !pushed ) {
+			// no workers or the deque is full, execute it right away
+			RunJob( index, jobs[i] );
+		}
+	}
+
+	int numWake = Min( numJobs, numIdleWorkers );
+	if ( numWake > 0 ) {
+		Sys_PostSemaphore( wakeSemaphore, numWake );
+	}
+}
+
+/*
+================
+idJobSystemLocal::FindJob
+================
+*/
+bool idJobSystemLocal::FindJob( int index, job_t &job ) {
+	if ( deques == NULL ) {
+		return false;
+	}
+	if ( deques[index].Pop( job ) ) {
+		return true;
+	}
+	for ( int i = 1; i <= numWorkers; i++ ) {
+		int victim = ( index + i ) % ( numWorkers + 1 );
+		if ( deques[victim].Steal( job ) ) {
+			workers[index].numJobsStolen++;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+================
+idJobSystemLocal::RunJob
+================
+*/
+void idJobSystemLocal::RunJob( int index, const job_t &job ) {
+	job.function( job.data );
+	if ( index >= 0 ) {
+		workers[index].numJobsExecuted++;
+	}
+	job.group->FinishJob();
+}
+
+/*
+================
+idJobSystemLocal::WaitForGroup
+================
+*/
+void idJobSystemLocal::WaitForGroup( const idJobGroupLocal *group ) {
+	int index = threadIndex;
+	int spins = 0;
+
+	while ( !group->IsDone() ) {
+		job_t job;
+		// only the main thread and the workers help out, any other thread just waits
+		if ( index >= 0 && FindJob( index, job ) ) {
+			RunJob( index, job );
+			spins = 0;
+			continue;
+		}
+		if ( ++spins < JOB_SPIN_COUNT ) {
+			Sys_CPUPause();
+		} else {
+			Sys_Yield();
+		}
+	}
+}
+
+/*
+================
+idJobSystemLocal::WorkerThread
+================
+*/
+unsigned int idJobSystemLocal::WorkerThread( void *parm ) {
+	jobWorker_t *worker = (jobWorker_t *)parm;
+	idJobSystemLocal &js = jobSystemLocal;
+	job_t job;
+
+	threadIndex = worker->index;
+
+	while ( !js.quit ) {
+		bool found = false;
+		for ( int i = 0; i < JOB_SPIN_COUNT && !js.quit; i++ ) {
+			if ( js.FindJob( worker->index, job ) ) {
+				found = true;
+				break;
+			}
+			Sys_CPUPause();
+		}
+		if ( found ) {
+			js.RunJob( worker->index, job );
+			continue;
+		}
+
+		// announce we're going to sleep and check once more, any job added after
+		// this point is guaranteed to see us as idle and post the semaphore
+		Sys_InterlockedIncrement( js.numIdleWorkers );
+		if ( js.FindJob( worker->index, job ) ) {
+			Sys_InterlockedDecrement( js.numIdleWorkers );
+			js.RunJob( worker->index, job );
+			continue;
+		}
+		if ( !js.quit ) {
+			Sys_WaitSemaphore( js.wakeSemaphore );
+		}
+		Sys_InterlockedDecrement( js.numIdleWorkers );
+	}
+
+	Sys_InterlockedDecrement( js.numRunningWorkers );
+	return 0;
+}
+
+/*
+================
+idJobSystemLocal::PrintStats
+================
+*/
+void idJobSystemLocal::PrintStats( void ) const {
+	for ( int i = 0; i <= numWorkers; i++ ) {
+		common->Printf( "%-8s %8d jobs, %8d stolen\n", workers[i].name, workers[i].numJobsExecuted, workers[i].numJobsStolen );
+	}
+}
+
+/*
+================
+idJobSystemLocal::ClearStats
+================
+*/
+void idJobSystemLocal::ClearStats( void ) {
+	for ( int i = 0; i <= numWorkers; i++ ) {
+		workers[i].numJobsExecuted = 0;
+		workers[i].numJobsStolen = 0;
+	}
+}
+
+/*
+===============================================================================
+
+	Job system tests, these run without a renderer so they can be used on
+	dedicated servers as well.
+
+===============================================================================
+*/
+
+typedef struct testJobParms_s {
+	int						iterations;
+	float					result;
+} testJobParms_t;
+
+/*
+================
+TestJob_Work
+================
+*/
+static void TestJob_Work( void *data ) {
+	testJobParms_t *parms = (testJobParms_t *)data;
+	float x = 0.0f;
+	for ( int i = 0; i < parms->iterations; i++ ) {
+		x = x * 0.999f + idMath::Sqrt( (float)i );
+	}
+	parms->result = x;
+}
+
+/*
+================
+idJobSystemLocal::TestJobs_f
+================
+*/
+void idJobSystemLocal::TestJobs_f( const idCmdArgs &args ) {
+	int numJobs = 4096;
+	int iterations = 1000;
+
+	if ( args.Argc() > 1 ) {
+		numJobs = Max( 1, atoi( args.Argv( 1 ) ) );
+	}
+	if ( args.Argc() > 2 ) {
+		iterations = Max( 0, atoi( args.Argv( 2 ) ) );
+	}
+
+	testJobParms_t *parms = new testJobParms_t[numJobs];
+	for ( int i = 0; i < numJobs; i++ ) {
+		parms[i].iterations = iterations;
+		parms[i].result = 0.0f;
+	}
+
+	common->Printf( "testJobs: %d jobs of %d iterations on %d threads\n", numJobs, iterations, jobSystemLocal.GetNumThreads() );
+
+	// serial reference
+	double start = Sys_GetClockTicks();
+	for ( int i = 0; i < numJobs; i++ ) {
+		TestJob_Work( &parms[i] );
+	}
+	double serialTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	float reference = parms[0].result;
+
+	idJobGroup *group = jobSystemLocal.AllocJobGroup( "testJobs" );
+	jobSystemLocal.ClearStats();
+
+	// parallel
+	start = Sys_GetClockTicks();
+	for ( int i = 0; i < numJobs; i++ ) {
+		group->AddJob( TestJob_Work, &parms[i] );
+	}
+	group->Run();
+	double parallelTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	int numErrors = 0;
+	for ( int i = 0; i < numJobs; i++ ) {
+		if ( parms[i].result != reference ) {
+			numErrors++;
+		}
+	}
+
+	// pure scheduling overhead with empty jobs
+	for ( int i = 0; i < numJobs; i++ ) {
+		parms[i].iterations = 0;
+	}
+	start = Sys_GetClockTicks();
+	for ( int i = 0; i < numJobs; i++ ) {
+		group->AddJob( TestJob_Work, &parms[i] );
+	}
+	group->Run();
+	double overheadTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	common->Printf( "serial:   %8.3f msec\n", serialTime * 1000.0 );
+	common->Printf( "parallel: %8.3f msec, %.2fx speedup\n", parallelTime * 1000.0, parallelTime > 0.0 ? serialTime / parallelTime : 0.0 );
+	common->Printf( "overhead: %8.3f usec per empty job, %.0f jobs per second\n", overheadTime * 1e6 / numJobs, overheadTime > 0.0 ? numJobs / overheadTime : 0.0 );
+	jobSystemLocal.PrintStats();
+	if ( numErrors ) {
+		common->Warning( "testJobs: %d jobs computed a wrong result", numErrors );
+	}
+
+	jobSystemLocal.FreeJobGroup( group );
+	delete[] parms;
+}
+
+/*
+===============================================================================
+
+	Stress test, builds chains of groups with random job counts where every
+	group depends on one or two earlier groups. Each job checks all jobs of its
+	dependencies already ran and some jobs submit and wait for a nested group.
+
+===============================================================================
+*/
+
+const int STRESS_MAX_GROUPS			= 32;
+const int STRESS_MAX_JOBS			= 256;
+const int STRESS_MAX_DEPENDENCIES	= 2;
+
+typedef struct stressGroup_s	stressGroup_t;
+
+typedef struct stressJob_s {
+	stressGroup_t *			group;
+	volatile int			numRuns;
+} stressJob_t;
+
+struct stressGroup_s {
+	idJobGroup *			group;
+	idJobGroup *			nested;				// submitted from inside the first job
+	int						numJobs;
+	int						numNestedJobs;
+	stressJob_t				jobs[STRESS_MAX_JOBS];
+	stressJob_t				nestedJobs[STRESS_MAX_JOBS];
+	int						numDependencies;
+	stressGroup_t *			dependencies[STRESS_MAX_DEPENDENCIES];
+	volatile int			numFinished;
+	volatile int			numErrors;
+};
+
+/*
+================
+StressJob_Nested
+================
+*/
+static void StressJob_Nested( void *data ) {
+	stressJob_t *job = (stressJob_t *)data;
+	Sys_InterlockedIncrement( job->numRuns );
+}
+
+/*
+================
+StressJob_Run
+================
+*/
+static void StressJob_Run( void *data ) {
+	stressJob_t *job = (stressJob_t *)data;
+	stressGroup_t *group = job->group;
+
+	for ( int i = 0; i < group->numDependencies; i++ ) {
+		if ( group->dependencies[i]->numFinished != group->dependencies[i]->numJobs ) {
+			Sys_InterlockedIncrement( group->numErrors );
+		}
+	}
+
+	if ( job == &group->jobs[0] && group->numNestedJobs > 0 ) {
+		for ( int i = 0; i < group->numNestedJobs; i++ ) {
+			group->nested->AddJob( StressJob_Nested, &group->nestedJobs[i] );
+		}
+		group->nested->Run();
+		for ( int i = 0; i < group->numNestedJobs; i++ ) {
+			if ( group->nestedJobs[i].numRuns != 1 ) {
+				Sys_InterlockedIncrement( group->numErrors );
+			}
+		}
+	}
+
+	Sys_InterlockedIncrement( job->numRuns );
+	Sys_InterlockedIncrement( group->numFinished );
+}
+
+/*
+================
+idJobSystemLocal::TestJobsStress_f
+================
+*/
+void idJobSystemLocal::TestJobsStress_f( const idCmdArgs &args ) {
+	int numIterations = 100;
+	if ( args.Argc() > 1 ) {
+		numIterations = Max( 1, atoi( args.Argv( 1 ) ) );
+	}
+
+	idRandom random( 0x7f3a );
+	stressGroup_t *groups = new stressGroup_t[STRESS_MAX_GROUPS];
+	for ( int i = 0; i < STRESS_MAX_GROUPS; i++ ) {
+		groups[i].group = jobSystemLocal.AllocJobGroup( "stress" );
+		groups[i].nested = jobSystemLocal.AllocJobGroup( "stressNested" );
+		// the nested jobs are added from inside a job, which can't allocate
+		groups[i].nested->ReserveJobs( STRESS_MAX_JOBS );
+	}
+
+	common->Printf( "testJobsStress: %d iterations on %d threads\n", numIterations, jobSystemLocal.GetNumThreads() );
+
+	jobSystemLocal.ClearStats();
+	int start = Sys_Milliseconds();
+	int totalJobs = 0;
+	int totalErrors = 0;
+
+	for ( int iteration = 0; iteration < numIterations; iteration++ ) {
+		int numGroups = 1 + random.RandomInt( STRESS_MAX_GROUPS );
+
+		for ( int i = 0; i < numGroups; i++ ) {
+			stressGroup_t &g = groups[i];
+			g.numJobs = random.RandomInt( STRESS_MAX_JOBS + 1 );
+			g.numNestedJobs = ( g.numJobs > 0 && random.RandomInt( 4 ) == 0 ) ? random.RandomInt( STRESS_MAX_JOBS + 1 ) : 0;
+			g.numFinished = 0;
+			g.numErrors = 0;
+			g.numDependencies = 0;
+			if ( i > 0 ) {
+				g.numDependencies = 1 + random.RandomInt( Min( i, STRESS_MAX_DEPENDENCIES ) );
+				for ( int j = 0; j < g.numDependencies; j++ ) {
+					g.dependencies[j] = &groups[random.RandomInt( i )];
+				}
+			}
+			for ( int j = 0; j < g.numJobs; j++ ) {
+				g.jobs[j].group = &g;
+				g.jobs[j].numRuns = 0;
+				g.group->AddJob( StressJob_Run, &g.jobs[j] );
+			}
+			for ( int j = 0; j < g.numNestedJobs; j++ ) {
+				g.nestedJobs[j].group = &g;
+				g.nestedJobs[j].numRuns = 0;
+			}
+			for ( int j = 0; j < g.numDependencies; j++ ) {
+				g.group->AddDependency( g.dependencies[j]->group );
+			}
+			g.group->Submit();
+			totalJobs += g.numJobs + g.numNestedJobs;
+		}
+
+		// wait in random order, waiting on a group also runs the jobs of other groups
+		for ( int i = 0; i < numGroups; i++ ) {
+			groups[random.RandomInt( numGroups )].group->Wait();
+		}
+		for ( int i = 0; i < numGroups; i++ ) {
+			groups[i].group->Wait();
+		}
+
+		for ( int i = 0; i < numGroups; i++ ) {
+			stressGroup_t &g = groups[i];
+			int numErrors = g.numErrors;
+			for ( int j = 0; j < g.numJobs; j++ ) {
+				if ( g.jobs[j].numRuns != 1 ) {
+					numErrors++;
+				}
+			}
+			if ( g.numFinished != g.numJobs ) {
+				numErrors++;
+			}
+			if ( numErrors ) {
+				common->Printf( "iteration %d group %d: %d errors\n", iteration, i, numErrors );
+			}
+			totalErrors += numErrors;
+		}
+	}
+
+	int time = Sys_Milliseconds() - start;
+
+	for ( int i = 0; i < STRESS_MAX_GROUPS; i++ ) {
+		jobSystemLocal.FreeJobGroup( groups[i].group );
+		jobSystemLocal.FreeJobGroup( groups[i].nested );
+	}
+	delete[] groups;
+
+	jobSystemLocal.PrintStats();
+	if ( totalErrors ) {
+		common->Warning( "testJobsStress: %d errors in %d jobs", totalErrors, totalJobs );
+	} else {
+		common->Printf( "testJobsStress: %d jobs in %d msec, no errors\n", totalJobs, time );
+	}
+}
@@ -0,0 +1,116 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+/*
+===============================================================================
+
+	Job system.
+
+	A pool of worker threads, by default one per logical processor minus the
+	main thread, executes small functions ( jobs ) in parallel. Every worker
+	owns a job deque, it pops jobs from the bottom of its own deque and steals
+	from the top of the other deques once it runs dry.
+
+	Jobs are collected in job groups. A group can depend on other groups and
+	won't start before all of them are done. Waiting for a group makes the
+	waiting thread execute pending jobs until the group is done, so a job can
+	safely wait for a group it submitted itself.
+
+	Jobs must not allocate from the engine heap ( Mem_Alloc and friends are
+	not thread safe ), they should only use memory that was set up before the
+	group was submitted. Job groups can only be allocated and freed from the
+	main thread.
+
+===============================================================================
+*/
+
+typedef void (*jobRun_t)( void *data );
+
+class idJobGroup {
+public:
+	virtual					~idJobGroup( void ) {}
+
+	virtual const char *	GetName( void ) const = 0;
+
+							// Adds a job to the group. Once a submitted group is done its
+							// jobs and dependencies are consumed, the next AddJob, AddDependency
+							// or Submit starts a new empty batch.
+	virtual void			AddJob( jobRun_t function, void *data ) = 0;
+	virtual int				GetNumJobs( void ) const = 0;
+
+							// Makes room for the given number of jobs on the calling thread. Jobs that
+							// add jobs to a nested group need this since they can't allocate.
+	virtual void			ReserveJobs( int numJobs ) = 0;
+
+							// The group won't start before the given group is done.
+							// Dependencies have to be submitted before this group.
+	virtual void			AddDependency( idJobGroup *group ) = 0;
+
+							// Starts executing the jobs as soon as the dependencies are done.
+	virtual void			Submit( void ) = 0;
+
+							// Returns true if the group is not submitted or all its jobs are done.
+	virtual bool			IsDone( void ) const = 0;
+
+							// Executes pending jobs on the calling thread until the group is done.
+	virtual void			Wait( void ) = 0;
+
+							// Submit followed by Wait.
+	virtual void			Run( void ) = 0;
+};
+
+class idJobSystem {
+public:
+	virtual					~idJobSystem( void ) {}
+
+							// Starts the worker threads.
+	virtual void			Init( void ) = 0;
+
+							// Stops the worker threads, all job groups should be done.
+	virtual void			Shutdown( void ) = 0;
+
+							// Number of worker threads, if zero all jobs execute on the waiting thread.
+	virtual int				GetNumWorkers( void ) const = 0;
+
+							// Number of threads that execute jobs, the workers and the main thread.
+	virtual int				GetNumThreads( void ) const = 0;
+
+							// Index of the calling thread, 0 for the main thread, 1 to GetNumThreads() - 1
+							// for the workers and -1 for any other thread.
+	virtual int				GetThreadIndex( void ) const = 0;
+
+	virtual idJobGroup *	AllocJobGroup( const char *name ) = 0;
+	virtual void			FreeJobGroup( idJobGroup *group ) = 0;
+};
+
+extern idJobSystem *		jobSystem;
+
+#endif /* !__JOBSYSTEM_H__ */
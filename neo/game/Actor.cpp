@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Game_local.h"
 
+static const int MAX_CANSEE_BATCH = 32;
 
 /***********************************************************************
 
@@ -1478,6 +1479,68 @@ bool idActor::CanSee( idEntity *ent, bool useFov ) const {
 	return false;
 }
 
+/*
+=====================
+idActor::CanSeeBatch
+
+Same as CanSee for each entity, the sight traces all start at the eye
+so they are done as a single point trace batch. Returns the number of
+entities that are visible.
+=====================
+*/
+int idActor::CanSeeBatch( idEntity * const *ents, int numEnts, bool useFOV, bool *visible ) const {
+	idVec3		eye;
+	idVec3		start[ MAX_CANSEE_BATCH ];
+	idVec3		end[ MAX_CANSEE_BATCH ];
+	trace_t		tr[ MAX_CANSEE_BATCH ];
+	int			index[ MAX_CANSEE_BATCH ];
+	int			i, j, numTraces, numVisible;
+
+	eye = GetEyePosition();
+
+	numVisible = 0;
+	for ( i = 0; i < numEnts; ) {
+		numTraces = 0;
+		for ( ; i < numEnts && numTraces < MAX_CANSEE_BATCH; i++ ) {
+			idEntity *ent = ents[ i ];
+
+			visible[ i ] = false;
+
+			if ( ent->IsHidden() ) {
+				continue;
+			}
+
+			if ( ent->IsType( idActor::Type ) ) {
+				end[ numTraces ] = ( ( idActor * )ent )->GetEyePosition();
+			} else {
+				end[ numTraces ] = ent->GetPhysics()->GetOrigin();
+			}
+
+			if ( useFOV && !CheckFOV( end[ numTraces ] ) ) {
+				continue;
+			}
+
+			start[ numTraces ] = eye;
+			index[ numTraces ] = i;
+			numTraces++;
+		}
+
+		if ( !numTraces ) {
+			continue;
+		}
+
+		gameLocal.clip.TracePointBatch( tr, start, end, numTraces, MASK_OPAQUE, this );
+		for ( j = 0; j < numTraces; j++ ) {
+			if ( tr[ j ].fraction >= 1.0f || ( gameLocal.GetTraceEntity( tr[ j ] ) == ents[ index[ j ] ] ) ) {
+				visible[ index[ j ] ] = true;
+				numVisible++;
+			}
+		}
+	}
+
+	return numVisible;
+}
+
 /*
 =====================
 idActor::PointVisible
@@ -4921,6 +4921,9 @@ unarchives object from save game file
 void idAnimatedEntity::Restore( idRestoreGame *savefile ) {
 	animator.Restore( savefile );
 
+	// the LOD settings aren't saved, so get them from the spawnArgs again
+	SetupAnimationLOD();
+
 	// check if the entity has an MD5 model
 	if ( animator.ModelHandle() ) {
 		// set the callback to update the joints
@@ -4973,6 +4976,8 @@ void idAnimatedEntity::UpdateAnimation( void ) {
 		return;
 	}
 
+	UpdateAnimationLOD();
+
 	// call any frame commands that have happened in the past frame
 	if ( !fl.hidden ) {
 		animator.ServiceAnims( gameLocal.previousTime, gameLocal.time );
@@ -5024,6 +5029,8 @@ void idAnimatedEntity::SetModel( const char *modelname ) {
 		renderEntity.customSkin = animator.ModelDef()->GetDefaultSkin();
 	}
 
+	SetupAnimationLOD();
+
 	// set the callback to update the joints
 	renderEntity.callback = idEntity::ModelCallback;
 	animator.GetJoints( &renderEntity.numJoints, &renderEntity.joints );
@@ -5032,6 +5039,84 @@ void idAnimatedEntity::SetModel( const char *modelname ) {
 	UpdateVisuals();
 }
 
+/*
+================
+idAnimatedEntity::SetupAnimationLOD
+
+Far away actors update their skeleton every "anim_lod_interval" msec and
+interpolate in between, actors outside the player PVS every
+"anim_lod_hidden_interval" msec.  The joints in "anim_lod_joints" and their
+parents are always updated so attacks and attachments stay exact.  The joints
+game code reads every frame are added as well, otherwise each read would force
+a full skeleton update.
+================
+*/
+void idAnimatedEntity::SetupAnimationLOD( void ) {
+	int			i;
+	float		distance;
+	idStr		jointNames;
+	const char *jointName;
+
+	static const char *queriedJointKeys[] = { "bone_orientation", "bone_focus", NULL };
+	static const char *queriedJoints[] = { "flash", "muzzle", "barrel", "eject", NULL };
+
+	if ( spawnArgs.GetBool( "anim_lod", "1" ) ) {
+		distance = spawnArgs.GetFloat( "anim_lod_distance", "1024" );
+	} else {
+		distance = 0.0f;
+	}
+
+	jointNames = spawnArgs.GetString( "anim_lod_joints" );
+	for( i = 0; queriedJointKeys[ i ]; i++ ) {
+		jointName = spawnArgs.GetString( queriedJointKeys[ i ] );
+		if ( *jointName && ( animator.GetJointHandle( jointName ) != INVALID_JOINT ) ) {
+			jointNames += va( " %s", jointName );
+		}
+	}
+	for( i = 0; queriedJoints[ i ]; i++ ) {
+		if ( animator.GetJointHandle( queriedJoints[ i ] ) != INVALID_JOINT ) {
+			jointNames += va( " %s", queriedJoints[ i ] );
+		}
+	}
+
+	animator.SetLODParms( distance, spawnArgs.GetInt( "anim_lod_interval", "100" ), spawnArgs.GetInt( "anim_lod_hidden_interval", "500" ), jointNames );
+}
+
+/*
+================
+idAnimatedEntity::UpdateAnimationLOD
+================
+*/
+void idAnimatedEntity::UpdateAnimationLOD( void ) {
+	int			i;
+	float		distance;
+	idEntity *	ent;
+
+	distance = animator.GetLODDistance();
+	if ( !g_animLOD.GetBool() || ( distance <= 0.0f ) || gameLocal.inCinematic ) {
+		animator.SetLODLevel( ANIM_LOD_FULL );
+		return;
+	}
+
+	if ( !gameLocal.isClient && !gameLocal.InPlayerPVS( this ) ) {
+		animator.SetLODLevel( ANIM_LOD_HIDDEN );
+		return;
+	}
+
+	for( i = 0; i < gameLocal.numClients; i++ ) {
+		ent = gameLocal.entities[ i ];
+		if ( !ent || !ent->IsType( idPlayer::Type ) ) {
+			continue;
+		}
+		if ( ( ent->GetPhysics()->GetOrigin() - GetPhysics()->GetOrigin() ).LengthSqr() < Square( distance ) ) {
+			animator.SetLODLevel( ANIM_LOD_FULL );
+			return;
+		}
+	}
+
+	animator.SetLODLevel( ANIM_LOD_FAR );
+}
+
 /*
 =====================
 idAnimatedEntity::GetJointWorldTransform
@@ -492,6 +492,9 @@ public:
 	virtual idAnimator *	GetAnimator( void );
 	virtual void			SetModel( const char *modelname );
 
+	void					SetupAnimationLOD( void );
+	void					UpdateAnimationLOD( void );
+
 	bool					GetJointWorldTransform( jointHandle_t jointHandle, int currentTime, idVec3 &offset, idMat3 &axis );
 	bool					GetJointTransformForAnim( jointHandle_t jointHandle, int animNum, int currentTime, idVec3 &offset, idMat3 &axis ) const;
 
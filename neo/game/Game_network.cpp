@@ -1488,6 +1488,9 @@ gameReturn_t idGameLocal::ClientPrediction( int clientNum, const usercmd_t *clie
 	previousTime = time;
 	time += msec;
 
+	// anim poses are only shared within a game frame
+	animationLib.ClearPoseCache();
+
 	// update the real client time and the new frame flag
 	if ( time > realClientTime ) {
 		realClientTime = time;
@@ -1505,6 +1508,9 @@ gameReturn_t idGameLocal::ClientPrediction( int clientNum, const usercmd_t *clie
 		ent->ClientPredictionThink();
 	}
 
+	// run the script threads whose wait is over
+	idThread::RunScheduledThreads();
+
 	// service any pending events
 	idEvent::ServiceEvents();
 
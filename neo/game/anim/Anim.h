@@ -97,6 +97,15 @@ typedef struct {
 	jointModTransform_t		transform_axis;
 } jointMod_t;
 
+//
+// animation level of detail
+//
+typedef enum {
+	ANIM_LOD_FULL,				// the whole skeleton is evaluated every frame
+	ANIM_LOD_FAR,				// the skeleton is evaluated at a reduced rate and interpolated in between
+	ANIM_LOD_HIDDEN				// outside all player PVSs, the last evaluated skeleton is reused in between
+} animLOD_t;
+
 #define	ANIM_TX				BIT( 0 )
 #define	ANIM_TY				BIT( 1 )
 #define	ANIM_TZ				BIT( 2 )
@@ -224,14 +233,30 @@ private:
 	int						animLength;
 	int						numJoints;
 	int						numAnimatedComponents;
+	int						numTranslations;		// joints with animated translation components
+	int						numRotations;			// joints with animated rotation components
+	int						frameSize;				// components per frame, lanes padded to JOINT_SOA_LANES
 	idList<idBounds>		bounds;
 	idList<jointAnimInfo_t>	jointInfo;
 	idList<idJointQuat>		baseFrame;
-	idList<float>			componentFrames;
+	idList<int>				componentJoints;		// joint of each translation and rotation lane
+	idList<float>			componentScale;
+	idList<float>			componentBias;
+	idList<unsigned short>	componentFrames;		// quantized components in structure of arrays layout
+	idList<int>				jointLanes;				// translation and rotation lane of each joint, -1 when not animated
 	idStr					name;
 	idVec3					totaldelta;
 	mutable int				ref_count;
 
+	void					QuantizeFrames( const float *frames );
+	void					SetupJointLanes( void );
+	void					DecompressFrame( int framenum, idJointQuat *joints ) const;
+	void					DecompressJoints( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const;
+	void					GetRootTranslation( int framenum, idVec3 &translation ) const;
+	void					GetRootRotation( int framenum, idQuat &rotation ) const;
+	bool					LoadBinaryAnim( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength );
+	void					WriteBinaryAnim( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) const;
+
 public:
 							idMD5Anim();
 							~idMD5Anim();
@@ -249,6 +274,8 @@ public:
 	void					CheckModelHierarchy( const idRenderModel *model ) const;
 	void					GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) const;
 	void					GetSingleFrame( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const;
+	void					GetInterpolatedJoints( frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) const;
+	void					GetSingleJoints( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const;
 	int						Length( void ) const;
 	int						NumFrames( void ) const;
 	int						NumJoints( void ) const;
@@ -402,7 +429,7 @@ private:
 	void						SetFrame( const idDeclModelDef *modelDef, int animnum, int frame, int currenttime, int blendtime );
 	void						CycleAnim( const idDeclModelDef *modelDef, int animnum, int currenttime, int blendtime );
 	void						PlayAnim( const idDeclModelDef *modelDef, int animnum, int currenttime, int blendtime );
-	bool						BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOrigin, bool overrideBlend, bool printInfo ) const;
+	bool						BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOrigin, bool overrideBlend, bool printInfo, const int *index = NULL, int numIndexes = 0 ) const;
 	void						BlendOrigin( int currentTime, idVec3 &blendPos, float &blendWeight, bool removeOriginOffset ) const;
 	void						BlendDelta( int fromtime, int totime, idVec3 &blendDelta, float &blendWeight ) const;
 	void						BlendDeltaRotation( int fromtime, int totime, idQuat &blendDelta, float &blendWeight ) const;
@@ -559,9 +586,19 @@ public:
 	int							AnimLength( int animnum ) const;
 	const idVec3				&TotalMovementDelta( int animnum ) const;
 
+								// Far away or hidden skeletons are only evaluated every interval msec, the LOD joints
+								// and their parents are still evaluated exactly every frame.
+	void						SetLODParms( float distance, int farInterval, int hiddenInterval, const char *jointNames );
+	void						SetLODLevel( animLOD_t level );
+	animLOD_t					GetLODLevel( void ) const;
+	float						GetLODDistance( void ) const;
+	static void					ClearLODStats( void );
+
 private:
 	void						FreeData( void );
 	void						PushAnims( int channel, int currentTime, int blendTime );
+	void						SetupLODJoints( void );
+	bool						BlendChannels( int currentTime, idJointQuat *jointFrame, bool lodJointsOnly, bool skipEyelids, bool debugInfo ) const;
 
 private:
 	const idDeclModelDef *		modelDef;
@@ -585,6 +622,27 @@ private:
 	idList<idJointQuat>			AFPoseJointFrame;
 	idBounds					AFPoseBounds;
 	int							AFPoseTime;
+
+	animLOD_t					lodLevel;
+	float						lodDistance;
+	int							lodFarInterval;
+	int							lodHiddenInterval;
+	idStr						lodJointNames;
+	idList<int>					lodJoints;				// joints that are always exact, parents before children
+	idList<int>					lodChannelJoints[ ANIM_NumAnimChannels ];
+	idList<int>					lodOtherJoints;			// joints that are interpolated or held between updates
+	idList<bool>				lodJointMask;
+	idList<idJointQuat>			lodFrames[ 2 ];			// the last two evaluated skeletons
+	int							lodFrameTimes[ 2 ];
+	int							lodCurrent;
+	bool						lodHasAnim;
+	bool						lodApproximate;			// joints outside lodJoints are not exact for lastTransformTime
+
+	static int					lodJointsEvaluated;
+	static int					lodJointsInterpolated;
+	static int					lodJointsHeld;
+	static idTimer				lodFullTimer;			// time spent in full skeleton updates
+	static idTimer				lodPartialTimer;		// time spent in updates of only the LOD joints
 };
 
 /*
@@ -612,10 +670,39 @@ public:
 	void						ClearAnimsInUse( void );
 	void						FlushUnusedAnims( void );
 
+								// Get a frame through the pose cache, entities playing the same anim frame
+								// share the decompressed joints. The cache is cleared at the start of every game frame.
+	void						GetInterpolatedFrame( const idMD5Anim *anim, frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes );
+	void						GetSingleFrame( const idMD5Anim *anim, int framenum, idJointQuat *joints, const int *index, int numIndexes );
+	void						ClearPoseCache( void );
+	int							GetPoseCacheHits( void ) const { return poseCacheHits; }
+	int							GetPoseCacheMisses( void ) const { return poseCacheMisses; }
+
 private:
+	typedef struct animPose_s {
+		const idMD5Anim *		anim;
+		const int *				index;					// joints of the channel the pose was created for
+		int						numIndexes;
+		int						cycleCount;				// moves the origin of interpolated frames
+		int						frame1;
+		int						frame2;
+		float					frontlerp;
+		float					backlerp;				// negative for a single frame
+		int						firstJoint;				// first joint in poseJoints
+	} animPose_t;
+
 	idHashTable<idMD5Anim *>	animations;
 	idStrList					jointnames;
 	idHashIndex					jointnamesHash;
+
+	idList<animPose_t>			poses;
+	idList<idJointQuat>			poseJoints;
+	idHashIndex					poseHash;
+	int							poseCacheHits;			// frames found in the pose cache since the last clear
+	int							poseCacheMisses;		// frames calculated since the last clear
+
+	const idJointQuat *			FindPose( const idMD5Anim *anim, const frameBlend_t &frame, const int *index, int numIndexes, int &hash ) const;
+	void						AddPose( int hash, const idMD5Anim *anim, const frameBlend_t &frame, const int *index, int numIndexes, const idJointQuat *joints );
 };
 
 #endif /* !__ANIM_H__ */
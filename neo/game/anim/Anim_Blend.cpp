@@ -1720,7 +1720,7 @@ void idAnimBlend::CallFrameCommands( idEntity *ent, int fromtime, int totime ) c
 idAnimBlend::BlendAnim
 =====================
 */
-bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOriginOffset, bool overrideBlend, bool printInfo ) const {
+bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOriginOffset, bool overrideBlend, bool printInfo, const int *index, int numIndexes ) const {
 	int				i;
 	float			lerp;
 	float			mixWeight;
@@ -1750,7 +1750,17 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 		}
 	}
 
-	if ( ( channel == ANIMCHANNEL_ALL ) && !blendWeight ) {
+	// frames for all joints on the channel are shared through the pose cache, a partial index list
+	// from the level of detail only decompresses its own joints and bypasses the cache
+	const int *channelJoints = modelDef->GetChannelJoints( channel );
+	const int numChannelJoints = modelDef->NumJointsOnChannel( channel );
+	if ( !index ) {
+		index = channelJoints;
+		numIndexes = numChannelJoints;
+	}
+	const bool partial = ( index != channelJoints );
+
+	if ( ( channel == ANIMCHANNEL_ALL ) && !blendWeight && !partial ) {
 		// we don't need a temporary buffer, so just store it directly in the blend frame
 		jointFrame = blendFrame;
 	} else {
@@ -1764,10 +1774,18 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 	if ( numAnims == 1 ) {
 		md5anim = anim->MD5Anim( 0 );
 		if ( frame ) {
-			md5anim->GetSingleFrame( frame - 1, jointFrame, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+			if ( partial ) {
+				md5anim->GetSingleJoints( frame - 1, jointFrame, index, numIndexes );
+			} else {
+				animationLib.GetSingleFrame( md5anim, frame - 1, jointFrame, channelJoints, numChannelJoints );
+			}
 		} else {
 			md5anim->ConvertTimeToFrame( time, cycle, frametime );
-			md5anim->GetInterpolatedFrame( frametime, jointFrame, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+			if ( partial ) {
+				md5anim->GetInterpolatedJoints( frametime, jointFrame, index, numIndexes );
+			} else {
+				animationLib.GetInterpolatedFrame( md5anim, frametime, jointFrame, channelJoints, numChannelJoints );
+			}
 		}
 	} else {
 		//
@@ -1787,15 +1805,21 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 				mixWeight += animWeights[ i ];
 				lerp = animWeights[ i ] / mixWeight;
 				md5anim = anim->MD5Anim( i );
-				if ( frame ) {
-					md5anim->GetSingleFrame( frame - 1, ptr, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+				if ( partial ) {
+					if ( frame ) {
+						md5anim->GetSingleJoints( frame - 1, ptr, index, numIndexes );
+					} else {
+						md5anim->GetInterpolatedJoints( frametime, ptr, index, numIndexes );
+					}
+				} else if ( frame ) {
+					animationLib.GetSingleFrame( md5anim, frame - 1, ptr, channelJoints, numChannelJoints );
 				} else {
-					md5anim->GetInterpolatedFrame( frametime, ptr, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+					animationLib.GetInterpolatedFrame( md5anim, frametime, ptr, channelJoints, numChannelJoints );
 				}
 
 				// only blend after the first anim is mixed in
 				if ( ptr != jointFrame ) {
-					SIMDProcessor->BlendJoints( jointFrame, ptr, lerp, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+					SIMDProcessor->BlendJoints( jointFrame, ptr, lerp, index, numIndexes );
 				}
 
 				ptr = mixFrame;
@@ -1823,10 +1847,8 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 
 	if ( !blendWeight ) {
 		blendWeight = weight;
-		if ( channel != ANIMCHANNEL_ALL ) {
-			const int *index = modelDef->GetChannelJoints( channel );
-			const int num = modelDef->NumJointsOnChannel( channel );
-			for( i = 0; i < num; i++ ) {
+		if ( jointFrame != blendFrame ) {
+			for( i = 0; i < numIndexes; i++ ) {
 				int j = index[i];
 				blendFrame[j].t = jointFrame[j].t;
 				blendFrame[j].q = jointFrame[j].q;
@@ -1835,7 +1857,7 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
     } else {
 		blendWeight += weight;
 		lerp = weight / blendWeight;
-		SIMDProcessor->BlendJoints( blendFrame, jointFrame, lerp, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+		SIMDProcessor->BlendJoints( blendFrame, jointFrame, lerp, index, numIndexes );
 	}
 
 	if ( printInfo ) {
@@ -2993,6 +3015,12 @@ const idVec3 &idDeclModelDef::GetVisualOffset( void ) const {
 
 ***********************************************************************/
 
+int idAnimator::lodJointsEvaluated = 0;
+int idAnimator::lodJointsInterpolated = 0;
+int idAnimator::lodJointsHeld = 0;
+idTimer idAnimator::lodFullTimer;
+idTimer idAnimator::lodPartialTimer;
+
 /*
 =====================
 idAnimator::idAnimator
@@ -3012,6 +3040,16 @@ idAnimator::idAnimator() {
 
 	frameBounds.Clear();
 
+	lodLevel				= ANIM_LOD_FULL;
+	lodDistance				= 0.0f;
+	lodFarInterval			= 0;
+	lodHiddenInterval		= 0;
+	lodFrameTimes[ 0 ]		= -1;
+	lodFrameTimes[ 1 ]		= -1;
+	lodCurrent				= 0;
+	lodHasAnim				= false;
+	lodApproximate			= false;
+
 	AFPoseJoints.SetGranularity( 1 );
 	AFPoseJointMods.SetGranularity( 1 );
 	AFPoseJointFrame.SetGranularity( 1 );
@@ -3225,6 +3263,8 @@ void idAnimator::FreeData( void ) {
 
 	modelDef = NULL;
 
+	SetupLODJoints();
+
 	ForceUpdate();
 }
 
@@ -3290,6 +3330,8 @@ idRenderModel *idAnimator::SetModel( const char *modelname ) {
 		}
 	}
 
+	SetupLODJoints();
+
 	return modelDef->ModelHandle();
 }
 
@@ -4170,11 +4212,14 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 	int					i, j;
 	int					numJoints;
 	int					parentNum;
+	int					interval;
+	int					latest;
+	int					previous;
 	bool				hasAnim;
 	bool				debugInfo;
-	float				baseBlend;
-	float				blendWeight;
-	const idAnimBlend *	blend;
+	bool				lodActive;
+	bool				fullUpdate;
+	float				lerp;
 	const int *			jointParent;
 	const jointMod_t *	jointMod;
 	const idJointQuat *	defaultPose;
@@ -4224,69 +4269,87 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 
 	numJoints = modelDef->Joints().Num();
 	idJointQuat *jointFrame = ( idJointQuat * )_alloca16( numJoints * sizeof( jointFrame[0] ) );
-	SIMDProcessor->Memcpy( jointFrame, defaultPose, numJoints * sizeof( jointFrame[0] ) );
+
+	// the level of detail only applies to regular updates without an articulated figure pose
+	lodActive = !force && ( lodLevel != ANIM_LOD_FULL ) && !AFPoseJoints.Num() && ( lodJointMask.Num() == numJoints ) && g_animLOD.GetBool();
+	interval = ( lodLevel == ANIM_LOD_HIDDEN ) ? lodHiddenInterval : lodFarInterval;
+	latest = lodFrameTimes[ lodCurrent ];
+	fullUpdate = !lodActive || ( latest < 0 ) || ( currentTime < latest ) || ( currentTime - latest >= interval );
 
 	hasAnim = false;
 
-	// blend the all channel
-	baseBlend = 0.0f;
-	blend = channels[ ANIMCHANNEL_ALL ];
-	for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-		if ( blend->BlendAnim( currentTime, ANIMCHANNEL_ALL, numJoints, jointFrame, baseBlend, removeOriginOffset, false, debugInfo ) ) {
+	idTimer &lodTimer = fullUpdate ? lodFullTimer : lodPartialTimer;
+	lodTimer.Start();
+
+	if ( fullUpdate ) {
+		SIMDProcessor->Memcpy( jointFrame, defaultPose, numJoints * sizeof( jointFrame[0] ) );
+
+		hasAnim = BlendChannels( currentTime, jointFrame, false, lodActive, debugInfo );
+
+		// blend the articulated figure pose
+		if ( BlendAFPose( jointFrame ) ) {
 			hasAnim = true;
-			if ( baseBlend >= 1.0f ) {
-				break;
-			}
 		}
-	}
 
-	// only blend other channels if there's enough space to blend into
-	if ( baseBlend < 1.0f ) {
-		for( i = ANIMCHANNEL_ALL + 1; i < ANIM_NumAnimChannels; i++ ) {
-			if ( !modelDef->NumJointsOnChannel( i ) ) {
-				continue;
-			}
-			if ( i == ANIMCHANNEL_EYELIDS ) {
-				// eyelids blend over any previous anims, so skip it and blend it later
-				continue;
-			}
-			blendWeight = baseBlend;
-			blend = channels[ i ];
-			for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-				if ( blend->BlendAnim( currentTime, i, numJoints, jointFrame, blendWeight, removeOriginOffset, false, debugInfo ) ) {
-					hasAnim = true;
-					if ( blendWeight >= 1.0f ) {
-						// fully blended
-						break;
-					}
-				}
-			}
+		lodJointsEvaluated += numJoints;
+		lodApproximate = false;
 
-			if ( debugInfo && !AFPoseJoints.Num() && !blendWeight ) {
-				gameLocal.Printf( "%d: %s using default pose in model '%s'\n", gameLocal.time, channelNames[ i ], modelDef->GetModelName() );
-			}
+		if ( lodActive ) {
+			lodCurrent ^= 1;
+			lodFrames[ lodCurrent ].SetNum( numJoints, false );
+			SIMDProcessor->Memcpy( lodFrames[ lodCurrent ].Ptr(), jointFrame, numJoints * sizeof( jointFrame[0] ) );
+			lodFrameTimes[ lodCurrent ] = currentTime;
+			lodHasAnim = hasAnim;
 		}
 	}
 
-	// blend in the eyelids
-	if ( modelDef->NumJointsOnChannel( ANIMCHANNEL_EYELIDS ) ) {
-		blend = channels[ ANIMCHANNEL_EYELIDS ];
-		blendWeight = baseBlend;
-		for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-			if ( blend->BlendAnim( currentTime, ANIMCHANNEL_EYELIDS, numJoints, jointFrame, blendWeight, removeOriginOffset, true, debugInfo ) ) {
-				hasAnim = true;
-				if ( blendWeight >= 1.0f ) {
-					// fully blended
-					break;
+	if ( lodActive ) {
+		const idJointQuat *latestFrame = lodFrames[ lodCurrent ].Ptr();
+		const idJointQuat *previousFrame = lodFrames[ lodCurrent ^ 1 ].Ptr();
+		latest = lodFrameTimes[ lodCurrent ];
+		previous = lodFrameTimes[ lodCurrent ^ 1 ];
+
+		if ( ( lodLevel == ANIM_LOD_FAR ) && ( previous >= 0 ) && ( previous < latest ) && ( lodFrames[ lodCurrent ^ 1 ].Num() == numJoints ) ) {
+			// interpolate between the last two evaluated skeletons, one update interval behind,
+			// the LOD joints are overwritten below so they are left out of the blend
+			SIMDProcessor->Memcpy( jointFrame, previousFrame, numJoints * sizeof( jointFrame[0] ) );
+			lerp = ( float )( currentTime - latest ) / ( float )( latest - previous );
+			if ( lerp > 0.0f ) {
+				SIMDProcessor->BlendJoints( jointFrame, latestFrame, Min( lerp, 1.0f ), lodOtherJoints.Ptr(), lodOtherJoints.Num() );
+				if ( !fullUpdate ) {
+					lodJointsInterpolated += lodOtherJoints.Num();
 				}
+			} else if ( !fullUpdate ) {
+				lodJointsHeld += lodOtherJoints.Num();
+			}
+			lodApproximate = true;
+		} else if ( !fullUpdate ) {
+			SIMDProcessor->Memcpy( jointFrame, latestFrame, numJoints * sizeof( jointFrame[0] ) );
+			lodJointsHeld += lodOtherJoints.Num();
+			lodApproximate = true;
+		}
+
+		if ( lodApproximate ) {
+			// the LOD joints are always exact for the current time
+			if ( fullUpdate ) {
+				for ( i = 0; i < lodJoints.Num(); i++ ) {
+					j = lodJoints[ i ];
+					jointFrame[ j ] = latestFrame[ j ];
+				}
+			} else {
+				for ( i = 0; i < lodJoints.Num(); i++ ) {
+					j = lodJoints[ i ];
+					jointFrame[ j ] = defaultPose[ j ];
+				}
+				hasAnim = BlendChannels( currentTime, jointFrame, true, false, debugInfo );
+				hasAnim |= lodHasAnim;
+
+				lodJointsEvaluated += lodJoints.Num();
 			}
 		}
 	}
 
-	// blend the articulated figure pose
-	if ( BlendAFPose( jointFrame ) ) {
-		hasAnim = true;
-	}
+	lodTimer.Stop();
 
 	if ( !hasAnim && !jointMods.Num() ) {
 		// no animations were updated
@@ -4406,6 +4469,97 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 	return true;
 }
 
+/*
+=====================
+idAnimator::BlendChannels
+
+  Blends the anims of all channels into the joint frame.  With lodJointsOnly
+  set only the LOD joints are blended and the other joints are left alone.
+=====================
+*/
+bool idAnimator::BlendChannels( int currentTime, idJointQuat *jointFrame, bool lodJointsOnly, bool skipEyelids, bool debugInfo ) const {
+	int					i, j;
+	bool				hasAnim;
+	float				baseBlend;
+	float				blendWeight;
+	const idAnimBlend *	blend;
+	const int *			index[ ANIM_NumAnimChannels ];
+	int					num[ ANIM_NumAnimChannels ];
+
+	for( i = ANIMCHANNEL_ALL; i < ANIM_NumAnimChannels; i++ ) {
+		if ( lodJointsOnly ) {
+			index[ i ] = lodChannelJoints[ i ].Ptr();
+			num[ i ] = lodChannelJoints[ i ].Num();
+		} else if ( skipEyelids && ( i == ANIMCHANNEL_EYELIDS ) && !lodChannelJoints[ i ].Num() ) {
+			// nobody can see blinking from far away
+			index[ i ] = NULL;
+			num[ i ] = 0;
+		} else {
+			index[ i ] = modelDef->GetChannelJoints( i );
+			num[ i ] = modelDef->NumJointsOnChannel( i );
+		}
+	}
+
+	hasAnim = false;
+
+	// blend the all channel
+	baseBlend = 0.0f;
+	blend = channels[ ANIMCHANNEL_ALL ];
+	for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
+		if ( blend->BlendAnim( currentTime, ANIMCHANNEL_ALL, numJoints, jointFrame, baseBlend, removeOriginOffset, false, debugInfo, index[ ANIMCHANNEL_ALL ], num[ ANIMCHANNEL_ALL ] ) ) {
+			hasAnim = true;
+			if ( baseBlend >= 1.0f ) {
+				break;
+			}
+		}
+	}
+
+	// only blend other channels if there's enough space to blend into
+	if ( baseBlend < 1.0f ) {
+		for( i = ANIMCHANNEL_ALL + 1; i < ANIM_NumAnimChannels; i++ ) {
+			if ( !num[ i ] ) {
+				continue;
+			}
+			if ( i == ANIMCHANNEL_EYELIDS ) {
+				// eyelids blend over any previous anims, so skip it and blend it later
+				continue;
+			}
+			blendWeight = baseBlend;
+			blend = channels[ i ];
+			for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
+				if ( blend->BlendAnim( currentTime, i, numJoints, jointFrame, blendWeight, removeOriginOffset, false, debugInfo, index[ i ], num[ i ] ) ) {
+					hasAnim = true;
+					if ( blendWeight >= 1.0f ) {
+						// fully blended
+						break;
+					}
+				}
+			}
+
+			if ( debugInfo && !AFPoseJoints.Num() && !blendWeight ) {
+				gameLocal.Printf( "%d: %s using default pose in model '%s'\n", gameLocal.time, channelNames[ i ], modelDef->GetModelName() );
+			}
+		}
+	}
+
+	// blend in the eyelids
+	if ( num[ ANIMCHANNEL_EYELIDS ] ) {
+		blend = channels[ ANIMCHANNEL_EYELIDS ];
+		blendWeight = baseBlend;
+		for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
+			if ( blend->BlendAnim( currentTime, ANIMCHANNEL_EYELIDS, numJoints, jointFrame, blendWeight, removeOriginOffset, true, debugInfo, index[ ANIMCHANNEL_EYELIDS ], num[ ANIMCHANNEL_EYELIDS ] ) ) {
+				hasAnim = true;
+				if ( blendWeight >= 1.0f ) {
+					// fully blended
+					break;
+				}
+			}
+		}
+	}
+
+	return hasAnim;
+}
+
 /*
 =====================
 idAnimator::ForceUpdate
@@ -4416,6 +4570,122 @@ void idAnimator::ForceUpdate( void ) {
 	forceUpdate = true;
 }
 
+/*
+=====================
+idAnimator::SetLODParms
+=====================
+*/
+void idAnimator::SetLODParms( float distance, int farInterval, int hiddenInterval, const char *jointNames ) {
+	lodDistance = distance;
+	lodFarInterval = farInterval;
+	lodHiddenInterval = hiddenInterval;
+	lodJointNames = jointNames;
+	SetupLODJoints();
+}
+
+/*
+=====================
+idAnimator::SetLODLevel
+=====================
+*/
+void idAnimator::SetLODLevel( animLOD_t level ) {
+	lodLevel = level;
+}
+
+/*
+=====================
+idAnimator::GetLODLevel
+=====================
+*/
+animLOD_t idAnimator::GetLODLevel( void ) const {
+	return lodLevel;
+}
+
+/*
+=====================
+idAnimator::GetLODDistance
+=====================
+*/
+float idAnimator::GetLODDistance( void ) const {
+	return lodDistance;
+}
+
+/*
+=====================
+idAnimator::SetupLODJoints
+
+  The origin and the named LOD joints are kept exact together with all their
+  parents so their model space transforms are exact as well.
+=====================
+*/
+void idAnimator::SetupLODJoints( void ) {
+	int i, j, channel;
+	idList<jointHandle_t> jointList;
+	const int *jointParent;
+
+	lodJoints.Clear();
+	lodOtherJoints.Clear();
+	lodJointMask.Clear();
+	for( i = ANIMCHANNEL_ALL; i < ANIM_NumAnimChannels; i++ ) {
+		lodChannelJoints[ i ].Clear();
+	}
+	lodFrames[ 0 ].Clear();
+	lodFrames[ 1 ].Clear();
+	lodFrameTimes[ 0 ] = -1;
+	lodFrameTimes[ 1 ] = -1;
+	lodApproximate = false;
+
+	if ( !modelDef || !numJoints || ( !lodFarInterval && !lodHiddenInterval ) ) {
+		return;
+	}
+
+	lodJointMask.AssureSize( numJoints, false );
+	lodJointMask[ 0 ] = true;
+
+	GetJointList( lodJointNames, jointList );
+	jointParent = modelDef->JointParents();
+	for( i = 0; i < jointList.Num(); i++ ) {
+		for( j = jointList[ i ]; j > 0 && !lodJointMask[ j ]; j = jointParent[ j ] ) {
+			lodJointMask[ j ] = true;
+		}
+	}
+
+	for( i = 0; i < numJoints; i++ ) {
+		if ( lodJointMask[ i ] ) {
+			lodJoints.Append( i );
+		} else {
+			lodOtherJoints.Append( i );
+		}
+	}
+
+	for( channel = ANIMCHANNEL_ALL; channel < ANIM_NumAnimChannels; channel++ ) {
+		const int *index = modelDef->GetChannelJoints( channel );
+		const int num = modelDef->NumJointsOnChannel( channel );
+		for( i = 0; i < num; i++ ) {
+			if ( lodJointMask[ index[ i ] ] ) {
+				lodChannelJoints[ channel ].Append( index[ i ] );
+			}
+		}
+	}
+}
+
+/*
+=====================
+idAnimator::ClearLODStats
+=====================
+*/
+void idAnimator::ClearLODStats( void ) {
+	if ( g_showAnimLOD.GetBool() && lodJointsEvaluated ) {
+		gameLocal.Printf( "anim LOD: %5d joints evaluated %5d interpolated %5d held, %6.3f ms full updates %6.3f ms LOD updates\n",
+							lodJointsEvaluated, lodJointsInterpolated, lodJointsHeld, lodFullTimer.Milliseconds(), lodPartialTimer.Milliseconds() );
+	}
+	lodJointsEvaluated = 0;
+	lodJointsInterpolated = 0;
+	lodJointsHeld = 0;
+	lodFullTimer.Clear();
+	lodPartialTimer.Clear();
+}
+
 /*
 =====================
 idAnimator::ClearForceUpdate
@@ -4438,6 +4708,11 @@ bool idAnimator::GetJointTransform( jointHandle_t jointHandle, int currentTime,
 
 	CreateFrame( currentTime, false );
 
+	// joints outside the LOD joints may be interpolated, game code always gets exact joints
+	if ( lodApproximate && !lodJointMask[ jointHandle ] ) {
+		CreateFrame( currentTime, true );
+	}
+
 	offset = joints[ jointHandle ].ToVec3();
 	axis = joints[ jointHandle ].ToMat3();
 
@@ -4463,6 +4738,10 @@ bool idAnimator::GetJointLocalTransform( jointHandle_t jointHandle, int currentT
 	// FIXME: overkill
 	CreateFrame( currentTime, false );
 
+	if ( lodApproximate && !lodJointMask[ jointHandle ] ) {
+		CreateFrame( currentTime, true );
+	}
+
 	if ( jointHandle > 0 ) {
 		idJointMat m = joints[ jointHandle ];
 		m /= joints[ modelJoints[ jointHandle ].parentNum ];
@@ -213,10 +213,190 @@ const idEventDef *idEventDef::FindEvent( const char *name ) {
 
 ***********************************************************************/
 
+/*
+==============================================================================
+
+  idEventHeap
+
+  Binary min-heap of scheduled events ordered by time and then by the order
+  in which they were scheduled, so events fire in the same order as the old
+  sorted list. Scheduled events are also hashed on their object for cancelling.
+
+==============================================================================
+*/
+
+class idEventHeap {
+public:
+	void						Clear( void ) { num = 0; }
+	int							Num( void ) const { return num; }
+	idEvent *					First( void ) const { return num ? events[1] : NULL; }
+	void						Add( idEvent *event );
+	void						Remove( idEvent *event );
+	void						GetSorted( idList<idEvent *> &list ) const;
+
+private:
+	int							num;
+	idEvent *					events[ MAX_EVENTS + 1 ];		// one based
+
+	static bool					Before( const idEvent *a, const idEvent *b );
+	static int					SortCompare( idEvent * const *a, idEvent * const *b );
+	void						Set( int index, idEvent *event );
+	void						MoveUp( int index );
+	void						MoveDown( int index );
+};
+
 static idLinkList<idEvent> FreeEvents;
-static idLinkList<idEvent> EventQueue;
+static idEventHeap EventQueue;
+static idHashIndex EventObjectHash( 1024, MAX_EVENTS );
+static unsigned int EventSequence;
 static idEvent EventPool[ MAX_EVENTS ];
 
+/*
+================
+EventObjectKey
+================
+*/
+static ID_INLINE int EventObjectKey( const idClass *obj ) {
+	return (int)( ( (size_t)obj >> 4 ) ^ ( (size_t)obj >> 14 ) );
+}
+
+/*
+================
+idEventHeap::Before
+================
+*/
+ID_INLINE bool idEventHeap::Before( const idEvent *a, const idEvent *b ) {
+	if ( a->time != b->time ) {
+		return a->time < b->time;
+	}
+	return (int)( a->sequence - b->sequence ) < 0;
+}
+
+/*
+================
+idEventHeap::SortCompare
+================
+*/
+int idEventHeap::SortCompare( idEvent * const *a, idEvent * const *b ) {
+	return Before( *a, *b ) ? -1 : 1;
+}
+
+/*
+================
+idEventHeap::Set
+================
+*/
+ID_INLINE void idEventHeap::Set( int index, idEvent *event ) {
+	events[index] = event;
+	event->heapIndex = index;
+}
+
+/*
+================
+idEventHeap::MoveUp
+================
+*/
+void idEventHeap::MoveUp( int index ) {
+	idEvent *event = events[index];
+
+	while( index > 1 && Before( event, events[index >> 1] ) ) {
+		Set( index, events[index >> 1] );
+		index >>= 1;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::MoveDown
+================
+*/
+void idEventHeap::MoveDown( int index ) {
+	idEvent *event = events[index];
+	int child;
+
+	while( ( child = index << 1 ) <= num ) {
+		if ( child < num && Before( events[child + 1], events[child] ) ) {
+			child++;
+		}
+		if ( !Before( events[child], event ) ) {
+			break;
+		}
+		Set( index, events[child] );
+		index = child;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::Add
+================
+*/
+void idEventHeap::Add( idEvent *event ) {
+	assert( event->heap == NULL );
+	assert( num < MAX_EVENTS );
+
+	event->heap = this;
+	event->sequence = EventSequence++;
+	num++;
+	Set( num, event );
+	MoveUp( num );
+
+	EventObjectHash.Add( EventObjectKey( event->object ), event - EventPool );
+}
+
+/*
+================
+idEventHeap::Remove
+================
+*/
+void idEventHeap::Remove( idEvent *event ) {
+	int index = event->heapIndex;
+
+	assert( event->heap == this && events[index] == event );
+
+	EventObjectHash.Remove( EventObjectKey( event->object ), event - EventPool );
+
+	event->heap = NULL;
+	event->heapIndex = 0;
+
+	if ( index != num ) {
+		Set( index, events[num] );
+		num--;
+		if ( index > 1 && Before( events[index], events[index >> 1] ) ) {
+			MoveUp( index );
+		} else {
+			MoveDown( index );
+		}
+	} else {
+		num--;
+	}
+}
+
+/*
+================
+idEventHeap::GetSorted
+
+Gets the events in the order they will fire.
+================
+*/
+void idEventHeap::GetSorted( idList<idEvent *> &list ) const {
+	list.SetNum( num, false );
+	for ( int i = 0; i < num; i++ ) {
+		list[i] = events[i + 1];
+	}
+	list.Sort( SortCompare );
+}
+
+/*
+==============================================================================
+
+  idEvent
+
+==============================================================================
+*/
+
 bool idEvent::initialized = false;
 
 idDynamicBlockAlloc<byte, 16 * 1024, 256>	idEvent::eventDataAllocator;
@@ -365,6 +545,10 @@ void idEvent::Free( void ) {
 		data = NULL;
 	}
 
+	if ( heap ) {
+		heap->Remove( this );
+	}
+
 	eventdef	= NULL;
 	time		= 0;
 	object		= NULL;
@@ -380,13 +564,15 @@ idEvent::Schedule
 ================
 */
 void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
-	idEvent *event;
-
 	assert( initialized );
 	if ( !initialized ) {
 		return;
 	}
 
+	if ( heap ) {
+		heap->Remove( this );
+	}
+
 	object = obj;
 	typeinfo = type;
 
@@ -395,16 +581,7 @@ void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
 
 	eventNode.Remove();
 
-	event = EventQueue.Next();
-	while( ( event != NULL ) && ( this->time >= event->time ) ) {
-		event = event->eventNode.Next();
-	}
-
-	if ( event ) {
-		eventNode.InsertBefore( event->eventNode );
-	} else {
-		eventNode.AddToEnd( EventQueue );
-	}
+	EventQueue.Add( this );
 }
 
 /*
@@ -414,14 +591,16 @@ idEvent::CancelEvents
 */
 void idEvent::CancelEvents( const idClass *obj, const idEventDef *evdef ) {
 	idEvent *event;
-	idEvent *next;
+	int i, next;
 
 	if ( !initialized ) {
 		return;
 	}
 
-	for( event = EventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
+	// only the events scheduled on objects with the same hash key are visited
+	for( i = EventObjectHash.First( EventObjectKey( obj ) ); i != -1; i = next ) {
+		next = EventObjectHash.Next( i );
+		event = &EventPool[ i ];
 		if ( event->object == obj ) {
 			if ( !evdef || ( evdef == event->eventdef ) ) {
 				event->Free();
@@ -443,11 +622,15 @@ void idEvent::ClearEventList( void ) {
 	//
 	FreeEvents.Clear();
 	EventQueue.Clear();
+	EventObjectHash.Clear();
+	EventSequence = 0;
    
 	// 
 	// add the events to the free list
 	//
 	for( i = 0; i < MAX_EVENTS; i++ ) {
+		EventPool[ i ].heap = NULL;
+		EventPool[ i ].heapIndex = 0;
 		EventPool[ i ].Free();
 	}
 }
@@ -471,8 +654,8 @@ void idEvent::ServiceEvents( void ) {
 	const char  *materialName;
 
 	num = 0;
-	while( !EventQueue.IsListEmpty() ) {
-		event = EventQueue.Next();
+	while( EventQueue.Num() ) {
+		event = EventQueue.First();
 		assert( event );
 
 		if ( event->time > gameLocal.time ) {
@@ -525,9 +708,9 @@ void idEvent::ServiceEvents( void ) {
 			}
 		}
 
-		// the event is removed from its list so that if then object
+		// the event is removed from the queue so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		EventQueue.Remove( event );
 		assert( event->object );
 		event->object->ProcessEventArgPtr( ev, args );
 
@@ -599,6 +782,7 @@ void idEvent::Shutdown( void ) {
 	}
 
 	ClearEventList();
+	EventObjectHash.Free();
 	
 	eventDataAllocator.Shutdown();
 
@@ -618,11 +802,15 @@ void idEvent::Save( idSaveGame *savefile ) {
 	byte *dataPtr;
 	bool validTrace;
 	const char	*format;
+	idList<idEvent *> events;
+
+	// events are saved in the order they fire
+	EventQueue.GetSorted( events );
 
-	savefile->WriteInt( EventQueue.Num() );
+	savefile->WriteInt( events.Num() );
 
-	event = EventQueue.Next();
-	while( event != NULL ) {
+	for ( int e = 0; e < events.Num(); e++ ) {
+		event = events[ e ];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
@@ -666,7 +854,6 @@ void idEvent::Save( idSaveGame *savefile ) {
 			}
 		}
 		assert( size == event->eventdef->GetArgSize() );
-		event = event->eventNode.Next();
 	}
 }
 
@@ -692,7 +879,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( EventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -760,6 +946,10 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 		} else {
 			event->data = NULL;
 		}
+
+		// the events were saved in firing order, so scheduling them in the
+		// same order keeps it
+		EventQueue.Add( event );
 	}
 }
 
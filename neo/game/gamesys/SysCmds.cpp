@@ -133,6 +133,88 @@ void Cmd_ListSpawnArgs_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+===================
+Cmd_ScriptBenchmark_f
+
+Runs a small script loop with and without the superinstructions and prints the statement rate.
+===================
+*/
+void Cmd_ScriptBenchmark_f( const idCmdArgs &args ) {
+	idStr			text;
+	idStr			funcname;
+	static int		funccount = 0;
+	const function_t *func;
+	idThread *		thread;
+	idTimer			timer;
+	int				i, pass, runs, count, statements;
+
+	if ( !gameLocal.CheatsOk() ) {
+		return;
+	}
+
+	runs = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 10;
+	if ( runs < 1 ) {
+		runs = 1;
+	}
+
+	sprintf( funcname, "ScriptBenchmark_%d", funccount++ );
+	sprintf( text,	"void %s() {\n"
+					"	float i, j, sum;\n"
+					"	for( i = 0; i < 20000; i++ ) {\n"
+					"		j = i % 16;\n"
+					"		if ( j < 8 ) {\n"
+					"			sum = sum + j;\n"
+					"		}\n"
+					"		if ( j == 3 ) {\n"
+					"			sum = sum - 1;\n"
+					"		} else if ( j >= 12 ) {\n"
+					"			sum = sum * 0.5;\n"
+					"		}\n"
+					"	}\n"
+					"}\n", funcname.c_str() );
+	if ( !gameLocal.program.CompileText( "console", text, true ) ) {
+		return;
+	}
+	func = gameLocal.program.FindFunction( funcname );
+	if ( !func ) {
+		return;
+	}
+
+	for ( pass = 0; pass < 2; pass++ ) {
+		if ( pass == 0 ) {
+			gameLocal.program.UnfuseStatements( func->firstStatement, func->numStatements );
+		} else {
+			gameLocal.program.FuseStatements( func->firstStatement, func->numStatements );
+		}
+
+		count = idInterpreter::statementCount;
+		timer.Clear();
+		timer.Start();
+		for ( i = 0; i < runs; i++ ) {
+			thread = new idThread( func );
+			thread->ManualDelete();
+			thread->ManualControl();
+			thread->Execute();
+			delete thread;
+		}
+		timer.Stop();
+		count = idInterpreter::statementCount - count;
+		if ( pass == 0 ) {
+			// superinstructions dispatch fewer times for the same statements
+			statements = count;
+		}
+
+		gameLocal.Printf( "%-18s %9d dispatches %8.2f ms %8.2f M statements/sec\n", pass == 0 ? "plain" : "superinstructions",
+							count, timer.Milliseconds(), timer.Milliseconds() > 0.0 ? statements / ( timer.Milliseconds() * 1000.0 ) : 0.0 );
+	}
+#if defined( __GNUC__ ) && !defined( ID_SCRIPT_SWITCH_DISPATCH )
+	gameLocal.Printf( "threaded dispatch\n" );
+#else
+	gameLocal.Printf( "switch dispatch\n" );
+#endif
+}
+
 /*
 ===================
 Cmd_ReloadScript_f
@@ -1463,6 +1545,43 @@ static void Cmd_AASStats_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==================
+Cmd_TestAASRouting_f
+
+  runs random route queries on all job threads, either on the loaded aas_test AAS or on the given AAS file
+==================
+*/
+static void Cmd_TestAASRouting_f( const idCmdArgs &args ) {
+	int aasNum, numQueries;
+	idAAS *aas;
+
+	numQueries = 10000;
+	if ( args.Argc() > 1 ) {
+		numQueries = Max( 1, atoi( args.Argv( 1 ) ) );
+	}
+
+	if ( args.Argc() > 2 ) {
+		// the map file CRC is not checked
+		aas = idAAS::Alloc();
+		if ( aas->Init( args.Argv( 2 ), 0 ) ) {
+			aas->TestConcurrentRouting( numQueries );
+		} else {
+			gameLocal.Printf( "Couldn't load AAS file '%s'\n", args.Argv( 2 ) );
+		}
+		delete aas;
+		return;
+	}
+
+	aasNum = aas_test.GetInteger();
+	aas = gameLocal.GetAAS( aasNum );
+	if ( !aas ) {
+		gameLocal.Printf( "No aas #%d loaded\n", aasNum );
+	} else {
+		aas->TestConcurrentRouting( numQueries );
+	}
+}
+
 /*
 ==================
 Cmd_TestDamage_f
@@ -2298,6 +2417,9 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "game_memory",			idClass::DisplayInfo_f,		CMD_FL_GAME,				"displays game class info" );
 	cmdSystem->AddCommand( "listClasses",			idClass::ListClasses_f,		CMD_FL_GAME,				"lists game classes" );
 	cmdSystem->AddCommand( "listThreads",			idThread::ListThreads_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"lists script threads" );
+	cmdSystem->AddCommand( "scriptProfile",			idInterpreter::Profile_f,	CMD_FL_GAME,				"prints the script profile sorted by self, inclusive, calls or instructions, or writes its trace with trace <file>" );
+	cmdSystem->AddCommand( "clipRecord",			idClip::Record_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"records clip model links and queries to a file, run again without arguments to stop" );
+	cmdSystem->AddCommand( "clipBenchmark",			idClip::Benchmark_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"replays recorded clip model links and queries against the clip sectors and the clip tree" );
 	cmdSystem->AddCommand( "listEntities",			Cmd_EntityList_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"lists game entities" );
 	cmdSystem->AddCommand( "listActiveEntities",	Cmd_ActiveEntityList_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"lists active game entities" );
 	cmdSystem->AddCommand( "listMonsters",			idAI::List_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"lists monsters" );
@@ -2349,12 +2471,14 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "testBlend",				idTestModel::TestBlend_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests animation blending" );
 	cmdSystem->AddCommand( "reloadScript",			Cmd_ReloadScript_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads scripts" );
 	cmdSystem->AddCommand( "script",				Cmd_Script_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"executes a line of script" );
+	cmdSystem->AddCommand( "scriptBenchmark",		Cmd_ScriptBenchmark_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"times the script interpreter with and without superinstructions" );
 	cmdSystem->AddCommand( "listCollisionModels",	Cmd_ListCollisionModels_f,	CMD_FL_GAME,				"lists collision models" );
 	cmdSystem->AddCommand( "collisionModelInfo",	Cmd_CollisionModelInfo_f,	CMD_FL_GAME,				"shows collision model info" );
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
 	cmdSystem->AddCommand( "reloadanims",			Cmd_ReloadAnims_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads animations" );
 	cmdSystem->AddCommand( "listAnims",				Cmd_ListAnims_f,			CMD_FL_GAME,				"lists all animations" );
 	cmdSystem->AddCommand( "aasStats",				Cmd_AASStats_f,				CMD_FL_GAME,				"shows AAS stats" );
+	cmdSystem->AddCommand( "testAASRouting",		Cmd_TestAASRouting_f,		CMD_FL_GAME,				"compares random route queries on all job threads with single threaded routing" );
 	cmdSystem->AddCommand( "testDamage",			Cmd_TestDamage_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a damage def", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
 	cmdSystem->AddCommand( "weaponSplat",			Cmd_WeaponSplat_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"projects a blood splat on the player weapon" );
 	cmdSystem->AddCommand( "saveSelected",			Cmd_SaveSelected_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"saves the selected entity to the .map file" );
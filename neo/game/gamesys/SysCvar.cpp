@@ -108,6 +108,15 @@ idCVar g_skipFX(					"g_skipFX",					"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_skipParticles(				"g_skipParticles",			"0",			CVAR_GAME | CVAR_BOOL, "" );
 
 idCVar g_disasm(					"g_disasm",					"0",			CVAR_GAME | CVAR_BOOL, "disassemble script into base/script/disasm.txt on the local drive when script is compiled" );
+idCVar g_scriptCache(				"g_scriptCache",			"1",			CVAR_GAME | CVAR_BOOL, "load the compiled default script from a cache in the save path when none of its source files changed" );
+idCVar g_scriptProfile(				"g_scriptProfile",			"0",			CVAR_GAME | CVAR_INTEGER, "1 = count calls, statements and time of script functions and events, 2 = also trace every call, see scriptProfile" );
+idCVar g_clipTree(					"g_clipTree",				"1",			CVAR_GAME | CVAR_BOOL, "link clip models into a dynamic bounding volume tree instead of the fixed clip sectors, takes effect on map load" );
+idCVar g_animPoseCache(			"g_animPoseCache",			"1",			CVAR_GAME | CVAR_BOOL, "share the joints of an anim frame between all entities playing it in the same game frame" );
+idCVar g_animPoseCacheSize(			"g_animPoseCacheSize",		"1024",			CVAR_GAME | CVAR_INTEGER, "size of the anim pose cache in KB" );
+idCVar g_binaryAnims(				"g_binaryAnims",			"1",			CVAR_GAME | CVAR_BOOL, "load anims from binary .bmd5anim files that are written the first time a .md5anim file is parsed" );
+idCVar g_animLOD(					"g_animLOD",				"1",			CVAR_GAME | CVAR_BOOL, "update the skeletons of far away and hidden actors at a lower rate" );
+idCVar g_showAnimLOD(				"g_showAnimLOD",			"0",			CVAR_GAME | CVAR_BOOL, "print the number of joints evaluated and interpolated each game frame" );
+idCVar g_showAnimPoseCache(			"g_showAnimPoseCache",		"0",			CVAR_GAME | CVAR_BOOL, "print the anim pose cache hits and misses of every game frame" );
 idCVar g_debugBounds(				"g_debugBounds",			"0",			CVAR_GAME | CVAR_BOOL, "checks for models with bounds > 2048" );
 idCVar g_debugAnim(					"g_debugAnim",				"-1",			CVAR_GAME | CVAR_INTEGER, "displays information on which animations are playing on the specified entity number.  set to -1 to disable." );
 idCVar g_debugMove(					"g_debugMove",				"0",			CVAR_GAME | CVAR_BOOL, "" );
@@ -304,6 +313,7 @@ idCVar aas_pullPlayer(				"aas_pullPlayer",			"0",			CVAR_GAME | CVAR_INTEGER, "
 idCVar aas_randomPullPlayer(		"aas_randomPullPlayer",		"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar aas_goalArea(				"aas_goalArea",				"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_showPushIntoArea(		"aas_showPushIntoArea",		"0",			CVAR_GAME | CVAR_BOOL, "" );
+idCVar aas_portalTables(			"aas_portalTables",			"1",			CVAR_GAME | CVAR_BOOL, "precompute the portal to portal travel times and store them next to the AAS file" );
 
 idCVar g_password(					"g_password",				"",				CVAR_GAME | CVAR_ARCHIVE, "game password" );
 idCVar password(					"password",					"",				CVAR_GAME | CVAR_NOCHEAT, "client password used when connecting" );
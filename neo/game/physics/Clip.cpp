@@ -33,6 +33,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #define	MAX_SECTOR_DEPTH				12
 #define MAX_SECTORS						((1<<(MAX_SECTOR_DEPTH+1))-1)
+#define MAX_TRACE_BATCH					32
 
 typedef struct clipSector_s {
 	int						axis;		// -1 = leaf node
@@ -62,6 +63,90 @@ idVec3 vec3_boxEpsilon( CM_BOX_EPSILON, CM_BOX_EPSILON, CM_BOX_EPSILON );
 idBlockAlloc<clipLink_t, 1024>	clipLinkAllocator;
 
 
+/*
+===============================================================
+
+	Recording and replaying clip model links and queries
+
+===============================================================
+*/
+
+#define CLIP_RECORD_IDENT				( ( 'C' << 24 ) | ( 'L' << 16 ) | ( 'R' << 8 ) | 'C' )
+#define CLIP_RECORD_VERSION				1
+#define CLIP_RECORD_MAX_MODELS			( 1 << 20 )
+
+typedef enum {
+	CLIP_RECORD_END,
+	CLIP_RECORD_LINK,				// clip model number, absolute bounds, contents
+	CLIP_RECORD_MOVE,				// clip model number, unlinked to move
+	CLIP_RECORD_UNLINK,				// clip model number
+	CLIP_RECORD_QUERY				// bounds, content mask
+} clipRecordOp_t;
+
+typedef struct clipRecord_s {
+	clipRecordOp_t			op;
+	int						num;
+	int						contents;
+	idBounds				bounds;
+} clipRecord_t;
+
+static idFile *						clipRecordFile = NULL;
+static idList<const idClipModel *>	clipRecordModels;
+static idHashIndex					clipRecordHash;
+
+/*
+================
+ClipRecordModelNum
+================
+*/
+static int ClipRecordModelNum( const idClipModel *clipModel ) {
+	int i, key;
+
+	key = (int)( ( (size_t)clipModel >> 4 ) ^ ( (size_t)clipModel >> 14 ) );
+	for ( i = clipRecordHash.First( key ); i != -1; i = clipRecordHash.Next( i ) ) {
+		if ( clipRecordModels[i] == clipModel ) {
+			return i;
+		}
+	}
+	i = clipRecordModels.Append( clipModel );
+	clipRecordHash.Add( key, i );
+	return i;
+}
+
+/*
+================
+ClipRecord
+================
+*/
+static void ClipRecord( clipRecordOp_t op, const idClipModel *clipModel, const idBounds &bounds, int contents ) {
+	clipRecordFile->WriteUnsignedChar( op );
+	if ( op != CLIP_RECORD_QUERY ) {
+		clipRecordFile->WriteInt( ClipRecordModelNum( clipModel ) );
+	}
+	if ( op == CLIP_RECORD_LINK || op == CLIP_RECORD_QUERY ) {
+		clipRecordFile->WriteVec3( bounds[0] );
+		clipRecordFile->WriteVec3( bounds[1] );
+		clipRecordFile->WriteInt( contents );
+	}
+}
+
+/*
+================
+ClipStopRecording
+================
+*/
+static void ClipStopRecording( void ) {
+	if ( !clipRecordFile ) {
+		return;
+	}
+	clipRecordFile->WriteUnsignedChar( CLIP_RECORD_END );
+	gameLocal.Printf( "recorded %d clip models to %s\n", clipRecordModels.Num(), clipRecordFile->GetName() );
+	fileSystem->CloseFile( clipRecordFile );
+	clipRecordFile = NULL;
+	clipRecordModels.Clear();
+	clipRecordHash.Clear();
+}
+
 /*
 ===============================================================
 
@@ -285,6 +370,9 @@ void idClipModel::Init( void ) {
 	traceModelIndex = -1;
 	clipLinks = NULL;
 	touchCount = -1;
+	linked = false;
+	clipTree = NULL;
+	clipProxy = -1;
 }
 
 /*
@@ -351,6 +439,9 @@ idClipModel::idClipModel( const idClipModel *model ) {
 	renderModelHandle = model->renderModelHandle;
 	clipLinks = NULL;
 	touchCount = -1;
+	linked = false;
+	clipTree = NULL;
+	clipProxy = -1;
 }
 
 /*
@@ -389,7 +480,7 @@ void idClipModel::Save( idSaveGame *savefile ) const {
 	}
 	savefile->WriteInt( traceModelIndex );
 	savefile->WriteInt( renderModelHandle );
-	savefile->WriteBool( clipLinks != NULL );
+	savefile->WriteBool( linked );
 	savefile->WriteInt( touchCount );
 }
 
@@ -430,6 +521,9 @@ void idClipModel::Restore( idRestoreGame *savefile ) {
 	renderModelHandle = -1;
 	clipLinks = NULL;
 	touchCount = -1;
+	this->linked = false;
+	clipTree = NULL;
+	clipProxy = -1;
 
 	if ( linked ) {
 		Link( gameLocal.clip, entity, id, origin, axis, renderModelHandle );
@@ -442,9 +536,7 @@ idClipModel::SetPosition
 ================
 */
 void idClipModel::SetPosition( const idVec3 &newOrigin, const idMat3 &newAxis ) {
-	if ( clipLinks ) {
-		Unlink();	// unlink from old position
-	}
+	UnlinkForMove();	// unlink from old position
 	origin = newOrigin;
 	axis = newAxis;
 }
@@ -491,6 +583,18 @@ idClipModel::Unlink
 void idClipModel::Unlink( void ) {
 	clipLink_t *link;
 
+	if ( clipRecordFile && ( linked || clipTree ) ) {
+		ClipRecord( CLIP_RECORD_UNLINK, this, absBounds, contents );
+	}
+
+	linked = false;
+
+	if ( clipTree ) {
+		clipTree->DestroyProxy( clipProxy );
+		clipTree = NULL;
+		clipProxy = -1;
+	}
+
 	for ( link = clipLinks; link; link = clipLinks ) {
 		clipLinks = link->nextLink;
 		if ( link->prevInSector ) {
@@ -505,6 +609,24 @@ void idClipModel::Unlink( void ) {
 	}
 }
 
+/*
+===============
+idClipModel::UnlinkForMove
+===============
+*/
+void idClipModel::UnlinkForMove( void ) {
+	if ( !clipTree ) {
+		Unlink();
+		return;
+	}
+
+	// the leaf stays in the clip tree, linking close to the old position leaves the tree as is
+	if ( clipRecordFile && linked ) {
+		ClipRecord( CLIP_RECORD_MOVE, this, absBounds, contents );
+	}
+	linked = false;
+}
+
 /*
 ===============
 idClipModel::Link_r
@@ -549,11 +671,8 @@ void idClipModel::Link( idClip &clp ) {
 		return;
 	}
 
-	if ( clipLinks ) {
-		Unlink();	// unlink from old position
-	}
-
 	if ( bounds.IsCleared() ) {
+		Unlink();
 		return;
 	}
 
@@ -572,7 +691,7 @@ void idClipModel::Link( idClip &clp ) {
 	absBounds[0] -= vec3_boxEpsilon;
 	absBounds[1] += vec3_boxEpsilon;
 
-	Link_r( clp.clipSectors );
+	clp.LinkClipModel( this );
 }
 
 /*
@@ -606,6 +725,452 @@ cmHandle_t idClipModel::CheckModel( const char *name ) {
 }
 
 
+/*
+===============================================================
+
+	idClipTree
+
+===============================================================
+*/
+
+#define CLIP_TREE_MARGIN				4.0f		// leaf bounds are enlarged with this on all sides
+#define CLIP_TREE_DISPLACEMENT			2.0f		// and moved ahead this many times the last move
+#define CLIP_TREE_MAX_DISPLACEMENT		128.0f		// unless the clip model jumped
+#define CLIP_TREE_STACK_SIZE			256
+
+/*
+================
+ClipTreeBoundsCost
+
+  Surface area of the bounds.
+================
+*/
+static ID_INLINE float ClipTreeBoundsCost( const idBounds &bounds ) {
+	idVec3 size = bounds[1] - bounds[0];
+	return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+/*
+================
+idClipTree::idClipTree
+================
+*/
+idClipTree::idClipTree( void ) {
+	root = -1;
+	freeNode = -1;
+	numProxies = 0;
+}
+
+/*
+================
+idClipTree::Clear
+================
+*/
+void idClipTree::Clear( void ) {
+	nodes.Clear();
+	nodes.SetGranularity( 1024 );
+	root = -1;
+	freeNode = -1;
+	numProxies = 0;
+}
+
+/*
+================
+idClipTree::AllocNode
+================
+*/
+int idClipTree::AllocNode( void ) {
+	int node;
+
+	if ( freeNode != -1 ) {
+		node = freeNode;
+		freeNode = nodes[node].parent;
+	} else {
+		clipTreeNode_t newNode;
+		memset( &newNode, 0, sizeof( newNode ) );
+		node = nodes.Append( newNode );
+	}
+
+	clipTreeNode_t &n = nodes[node];
+	n.parent = -1;
+	n.children[0] = n.children[1] = -1;
+	n.height = 0;
+	n.clipModel = NULL;
+	return node;
+}
+
+/*
+================
+idClipTree::FreeNode
+================
+*/
+void idClipTree::FreeNode( int node ) {
+	nodes[node].parent = freeNode;
+	nodes[node].height = -1;
+	nodes[node].clipModel = NULL;
+	freeNode = node;
+}
+
+/*
+================
+idClipTree::CreateProxy
+================
+*/
+int idClipTree::CreateProxy( idClipModel *clipModel, const idBounds &bounds ) {
+	int proxy;
+
+	proxy = AllocNode();
+	nodes[proxy].bounds = bounds.Expand( CLIP_TREE_MARGIN );
+	nodes[proxy].clipModel = clipModel;
+	InsertLeaf( proxy );
+	numProxies++;
+
+	return proxy;
+}
+
+/*
+================
+idClipTree::DestroyProxy
+================
+*/
+void idClipTree::DestroyProxy( int proxy ) {
+	assert( proxy >= 0 && proxy < nodes.Num() && nodes[proxy].height == 0 );
+
+	RemoveLeaf( proxy );
+	FreeNode( proxy );
+	numProxies--;
+}
+
+/*
+================
+idClipTree::MoveProxy
+================
+*/
+bool idClipTree::MoveProxy( int proxy, const idBounds &bounds ) {
+	idBounds fatBounds;
+	idVec3 displacement;
+	int i;
+
+	assert( proxy >= 0 && proxy < nodes.Num() && nodes[proxy].height == 0 );
+
+	const idBounds &leafBounds = nodes[proxy].bounds;
+	if (	bounds[0][0] >= leafBounds[0][0] && bounds[1][0] <= leafBounds[1][0] &&
+			bounds[0][1] >= leafBounds[0][1] && bounds[1][1] <= leafBounds[1][1] &&
+			bounds[0][2] >= leafBounds[0][2] && bounds[1][2] <= leafBounds[1][2] ) {
+		return false;
+	}
+
+	displacement = bounds.GetCenter() - leafBounds.GetCenter();
+
+	RemoveLeaf( proxy );
+
+	// enlarge the bounds in the direction of movement
+	fatBounds = bounds.Expand( CLIP_TREE_MARGIN );
+	if ( displacement.LengthSqr() < Square( CLIP_TREE_MAX_DISPLACEMENT ) ) {
+		for ( i = 0; i < 3; i++ ) {
+			if ( displacement[i] < 0.0f ) {
+				fatBounds[0][i] += CLIP_TREE_DISPLACEMENT * displacement[i];
+			} else {
+				fatBounds[1][i] += CLIP_TREE_DISPLACEMENT * displacement[i];
+			}
+		}
+	}
+	nodes[proxy].bounds = fatBounds;
+
+	InsertLeaf( proxy );
+
+	return true;
+}
+
+/*
+================
+idClipTree::InsertLeaf
+
+  Walks down to the sibling for which the new parent adds the least surface area.
+================
+*/
+void idClipTree::InsertLeaf( int leaf ) {
+	int node, sibling, oldParent, newParent, child, i;
+	float cost, inheritCost, childCost[2];
+	idBounds leafBounds, combined;
+
+	if ( root == -1 ) {
+		root = leaf;
+		nodes[leaf].parent = -1;
+		return;
+	}
+
+	leafBounds = nodes[leaf].bounds;
+
+	node = root;
+	while( nodes[node].children[0] != -1 ) {
+		const clipTreeNode_t &n = nodes[node];
+
+		combined = n.bounds;
+		combined.AddBounds( leafBounds );
+
+		// cost of a new parent for this node and the leaf
+		cost = 2.0f * ClipTreeBoundsCost( combined );
+
+		// cost of pushing the leaf further down
+		inheritCost = 2.0f * ( ClipTreeBoundsCost( combined ) - ClipTreeBoundsCost( n.bounds ) );
+
+		for ( i = 0; i < 2; i++ ) {
+			child = n.children[i];
+			combined = nodes[child].bounds;
+			combined.AddBounds( leafBounds );
+			if ( nodes[child].children[0] == -1 ) {
+				childCost[i] = ClipTreeBoundsCost( combined ) + inheritCost;
+			} else {
+				childCost[i] = ClipTreeBoundsCost( combined ) - ClipTreeBoundsCost( nodes[child].bounds ) + inheritCost;
+			}
+		}
+
+		if ( cost < childCost[0] && cost < childCost[1] ) {
+			break;
+		}
+
+		node = ( childCost[0] < childCost[1] ) ? n.children[0] : n.children[1];
+	}
+
+	sibling = node;
+
+	// create a new parent for the sibling and the leaf
+	newParent = AllocNode();
+	oldParent = nodes[sibling].parent;
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].bounds = leafBounds;
+	nodes[newParent].bounds.AddBounds( nodes[sibling].bounds );
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].children[0] = sibling;
+	nodes[newParent].children[1] = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if ( oldParent != -1 ) {
+		if ( nodes[oldParent].children[0] == sibling ) {
+			nodes[oldParent].children[0] = newParent;
+		} else {
+			nodes[oldParent].children[1] = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+
+	// refit and balance the ancestors
+	for ( node = nodes[leaf].parent; node != -1; node = nodes[node].parent ) {
+		node = Balance( node );
+
+		clipTreeNode_t &n = nodes[node];
+		n.height = 1 + Max( nodes[n.children[0]].height, nodes[n.children[1]].height );
+		n.bounds = nodes[n.children[0]].bounds;
+		n.bounds.AddBounds( nodes[n.children[1]].bounds );
+	}
+}
+
+/*
+================
+idClipTree::RemoveLeaf
+================
+*/
+void idClipTree::RemoveLeaf( int leaf ) {
+	int parent, grandParent, sibling, node;
+
+	if ( leaf == root ) {
+		root = -1;
+		return;
+	}
+
+	parent = nodes[leaf].parent;
+	grandParent = nodes[parent].parent;
+	sibling = ( nodes[parent].children[0] == leaf ) ? nodes[parent].children[1] : nodes[parent].children[0];
+
+	FreeNode( parent );
+
+	if ( grandParent == -1 ) {
+		root = sibling;
+		nodes[sibling].parent = -1;
+		return;
+	}
+
+	// the sibling takes the place of the parent
+	if ( nodes[grandParent].children[0] == parent ) {
+		nodes[grandParent].children[0] = sibling;
+	} else {
+		nodes[grandParent].children[1] = sibling;
+	}
+	nodes[sibling].parent = grandParent;
+
+	for ( node = grandParent; node != -1; node = nodes[node].parent ) {
+		node = Balance( node );
+
+		clipTreeNode_t &n = nodes[node];
+		n.height = 1 + Max( nodes[n.children[0]].height, nodes[n.children[1]].height );
+		n.bounds = nodes[n.children[0]].bounds;
+		n.bounds.AddBounds( nodes[n.children[1]].bounds );
+	}
+}
+
+/*
+================
+idClipTree::Balance
+
+  Rotates the higher child up if the heights of the children differ by more than one.
+  Returns the node that took the place of the given node.
+================
+*/
+int idClipTree::Balance( int a ) {
+	int b, c, up, down, keep, parent, high, low, side;
+
+	if ( nodes[a].children[0] == -1 || nodes[a].height < 2 ) {
+		return a;
+	}
+
+	b = nodes[a].children[0];
+	c = nodes[a].children[1];
+
+	if ( nodes[c].height - nodes[b].height > 1 ) {
+		up = c;
+		keep = b;
+		side = 1;
+	} else if ( nodes[b].height - nodes[c].height > 1 ) {
+		up = b;
+		keep = c;
+		side = 0;
+	} else {
+		return a;
+	}
+
+	// the higher child of the child moving up stays with it, the other one moves down to a
+	if ( nodes[nodes[up].children[0]].height > nodes[nodes[up].children[1]].height ) {
+		high = nodes[up].children[0];
+		low = nodes[up].children[1];
+	} else {
+		high = nodes[up].children[1];
+		low = nodes[up].children[0];
+	}
+
+	parent = nodes[a].parent;
+	nodes[up].parent = parent;
+	nodes[a].parent = up;
+	if ( parent != -1 ) {
+		if ( nodes[parent].children[0] == a ) {
+			nodes[parent].children[0] = up;
+		} else {
+			nodes[parent].children[1] = up;
+		}
+	} else {
+		root = up;
+	}
+
+	down = low;
+	nodes[up].children[0] = a;
+	nodes[up].children[1] = high;
+	nodes[a].children[side] = down;
+	nodes[down].parent = a;
+
+	nodes[a].bounds = nodes[keep].bounds;
+	nodes[a].bounds.AddBounds( nodes[down].bounds );
+	nodes[a].height = 1 + Max( nodes[keep].height, nodes[down].height );
+
+	nodes[up].bounds = nodes[a].bounds;
+	nodes[up].bounds.AddBounds( nodes[high].bounds );
+	nodes[up].height = 1 + Max( nodes[a].height, nodes[high].height );
+
+	return up;
+}
+
+/*
+================
+idClipTree::ClipModelsTouchingBounds
+
+  Lists the clip models in depth first order with the first child first, so a query with
+  bounds inside the bounds of another query lists its clip models in the same order.
+================
+*/
+int idClipTree::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const {
+	int stack[CLIP_TREE_STACK_SIZE];
+	int stackDepth, count;
+	idClipModel *check;
+
+	if ( root == -1 ) {
+		return 0;
+	}
+
+	count = 0;
+	stack[0] = root;
+	stackDepth = 1;
+
+	while( stackDepth > 0 ) {
+		const clipTreeNode_t &n = nodes[stack[--stackDepth]];
+
+		if (	n.bounds[0][0] > bounds[1][0] ||
+				n.bounds[1][0] < bounds[0][0] ||
+				n.bounds[0][1] > bounds[1][1] ||
+				n.bounds[1][1] < bounds[0][1] ||
+				n.bounds[0][2] > bounds[1][2] ||
+				n.bounds[1][2] < bounds[0][2] ) {
+			continue;
+		}
+
+		if ( n.children[0] != -1 ) {
+			assert( stackDepth + 2 <= CLIP_TREE_STACK_SIZE );
+			stack[stackDepth++] = n.children[1];
+			stack[stackDepth++] = n.children[0];
+			continue;
+		}
+
+		check = n.clipModel;
+
+		// if the clip model is linked and enabled
+		if ( !check->linked || !check->enabled ) {
+			continue;
+		}
+
+		// if the clip model does not have any contents we are looking for
+		if ( !( check->contents & contentMask ) ) {
+			continue;
+		}
+
+		// if the bounds really do overlap
+		if (	check->absBounds[0][0] > bounds[1][0] ||
+				check->absBounds[1][0] < bounds[0][0] ||
+				check->absBounds[0][1] > bounds[1][1] ||
+				check->absBounds[1][1] < bounds[0][1] ||
+				check->absBounds[0][2] > bounds[1][2] ||
+				check->absBounds[1][2] < bounds[0][2] ) {
+			continue;
+		}
+
+		if ( count >= maxCount ) {
+			gameLocal.Warning( "idClipTree::ClipModelsTouchingBounds: max count" );
+			break;
+		}
+
+		clipModelList[count++] = check;
+	}
+
+	return count;
+}
+
+/*
+================
+idClipTree::LinkedClipModels
+================
+*/
+int idClipTree::LinkedClipModels( idClipModel **clipModelList, int maxCount ) const {
+	int i, count;
+
+	count = 0;
+	for ( i = 0; i < nodes.Num() && count < maxCount; i++ ) {
+		if ( nodes[i].height == 0 && nodes[i].clipModel->linked ) {
+			clipModelList[count++] = nodes[i].clipModel;
+		}
+	}
+	return count;
+}
+
+
 /*
 ===============================================================
 
@@ -620,10 +1185,11 @@ idClip::idClip
 ===============
 */
 idClip::idClip( void ) {
+	useClipTree = false;
 	numClipSectors = 0;
 	clipSectors = NULL;
 	worldBounds.Zero();
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeMoves = 0;
 }
 
 /*
@@ -683,38 +1249,133 @@ idClip::Init
 */
 void idClip::Init( void ) {
 	cmHandle_t h;
-	idVec3 size, maxSector = vec3_origin;
+	idVec3 size;
 
-	// clear clip sectors
-	clipSectors = new clipSector_t[MAX_SECTORS];
-	memset( clipSectors, 0, MAX_SECTORS * sizeof( clipSector_t ) );
-	numClipSectors = 0;
-	touchCount = -1;
 	// get world map bounds
 	h = collisionModelManager->LoadModel( "worldMap", false );
 	collisionModelManager->GetModelBounds( h, worldBounds );
-	// create world sectors
-	CreateClipSectors_r( 0, worldBounds, maxSector );
+	// create world sectors or the clip tree
+	InitBroadphase( worldBounds, g_clipTree.GetBool() );
 
 	size = worldBounds[1] - worldBounds[0];
 	gameLocal.Printf( "map bounds are (%1.1f, %1.1f, %1.1f)\n", size[0], size[1], size[2] );
-	gameLocal.Printf( "max clip sector is (%1.1f, %1.1f, %1.1f)\n", maxSector[0], maxSector[1], maxSector[2] );
 
 	// initialize a default clip model
 	defaultClipModel.LoadModel( idTraceModel( idBounds( idVec3( 0, 0, 0 ) ).Expand( 8 ) ) );
 
 	// set counters to zero
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeMoves = 0;
 }
 
 /*
 ===============
-idClip::Shutdown
+idClip::InitBroadphase
 ===============
 */
-void idClip::Shutdown( void ) {
+void idClip::InitBroadphase( const idBounds &bounds, bool tree ) {
+	idVec3 maxSector = vec3_origin;
+
+	useClipTree = tree;
+	touchCount = -1;
+	numClipSectors = 0;
+	clipSectors = NULL;
+	clipTree.Clear();
+
+	if ( useClipTree ) {
+		return;
+	}
+
+	// clear clip sectors
+	clipSectors = new clipSector_t[MAX_SECTORS];
+	memset( clipSectors, 0, MAX_SECTORS * sizeof( clipSector_t ) );
+	// create world sectors
+	CreateClipSectors_r( 0, bounds, maxSector );
+
+	if ( this == &gameLocal.clip ) {
+		gameLocal.Printf( "max clip sector is (%1.1f, %1.1f, %1.1f)\n", maxSector[0], maxSector[1], maxSector[2] );
+	}
+}
+
+/*
+===============
+idClip::ShutdownBroadphase
+===============
+*/
+void idClip::ShutdownBroadphase( void ) {
 	delete[] clipSectors;
 	clipSectors = NULL;
+	numClipSectors = 0;
+	clipTree.Clear();
+	useClipTree = false;
+}
+
+/*
+===============
+idClip::LinkClipModel
+
+  Links a clip model with up to date absolute bounds.
+===============
+*/
+void idClip::LinkClipModel( idClipModel *clipModel ) {
+	if ( useClipTree ) {
+		if ( clipModel->clipTree == &clipTree ) {
+			if ( clipTree.MoveProxy( clipModel->clipProxy, clipModel->absBounds ) ) {
+				numTreeMoves++;
+			}
+		} else {
+			clipModel->Unlink();
+			clipModel->clipProxy = clipTree.CreateProxy( clipModel, clipModel->absBounds );
+			clipModel->clipTree = &clipTree;
+		}
+	} else {
+		clipModel->Unlink();
+		clipModel->Link_r( clipSectors );
+	}
+	clipModel->linked = true;
+
+	if ( clipRecordFile ) {
+		ClipRecord( CLIP_RECORD_LINK, clipModel, clipModel->absBounds, clipModel->contents );
+	}
+}
+
+/*
+===============
+idClip::LinkedClipModels
+===============
+*/
+int idClip::LinkedClipModels( idClipModel **clipModelList, int maxCount ) const {
+	int i, count;
+	clipLink_t *link;
+
+	if ( useClipTree ) {
+		return clipTree.LinkedClipModels( clipModelList, maxCount );
+	}
+
+	count = 0;
+	touchCount++;
+	for ( i = 0; i < numClipSectors; i++ ) {
+		for ( link = clipSectors[i].clipLinks; link; link = link->nextInSector ) {
+			if ( link->clipModel->touchCount == touchCount ) {
+				continue;
+			}
+			if ( count >= maxCount ) {
+				return count;
+			}
+			link->clipModel->touchCount = touchCount;
+			clipModelList[count++] = link->clipModel;
+		}
+	}
+	return count;
+}
+
+/*
+===============
+idClip::Shutdown
+===============
+*/
+void idClip::Shutdown( void ) {
+	ClipStopRecording();
+	ShutdownBroadphase();
 
 	// free the trace model used for the temporaryClipModel
 	if ( temporaryClipModel.traceModelIndex != -1 ) {
@@ -812,8 +1473,17 @@ int idClip::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, i
 		return 0;
 	}
 
+	if ( clipRecordFile ) {
+		ClipRecord( CLIP_RECORD_QUERY, NULL, bounds, contentMask );
+	}
+
 	parms.bounds[0] = bounds[0] - vec3_boxEpsilon;
 	parms.bounds[1] = bounds[1] + vec3_boxEpsilon;
+
+	if ( useClipTree ) {
+		return clipTree.ClipModelsTouchingBounds( parms.bounds, contentMask, clipModelList, maxCount );
+	}
+
 	parms.contentMask = contentMask;
 	parms.list = clipModelList;
 	parms.count = 0;
@@ -1050,11 +1720,9 @@ idClip::Translation
 */
 bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &end,
 						const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity ) {
-	int i, num;
-	idClipModel *touch, *clipModelList[MAX_GENTITIES];
+	int num;
+	idClipModel *clipModelList[MAX_GENTITIES];
 	idBounds traceBounds;
-	float radius;
-	trace_t trace;
 	const idTraceModel *trm;
 
 	if ( TestHugeTranslation( results, mdl, start, end, trmAxis ) ) {
@@ -1080,14 +1748,33 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 
 	if ( !trm ) {
 		traceBounds.FromPointTranslation( start, results.endpos - start );
-		radius = 0.0f;
 	} else {
 		traceBounds.FromBoundsTranslation( trm->bounds, start, trmAxis, results.endpos - start );
-		radius = trm->bounds.GetRadius();
 	}
 
 	num = GetTraceClipModels( traceBounds, contentMask, passEntity, clipModelList );
 
+	TranslationClipModels( results, start, end, trm, trmAxis, contentMask, clipModelList, num, NULL );
+
+	return ( results.fraction < 1.0f );
+}
+
+/*
+============
+idClip::TranslationClipModels
+
+  Translation versus the listed clip models. If touchBounds is set only the clip models touching it are tested.
+============
+*/
+void idClip::TranslationClipModels( trace_t &results, const idVec3 &start, const idVec3 &end, const idTraceModel *trm, const idMat3 &trmAxis,
+								int contentMask, idClipModel **clipModelList, int num, const idBounds *touchBounds ) {
+	int i;
+	idClipModel *touch;
+	float radius;
+	trace_t trace;
+
+	radius = ( trm != NULL ) ? trm->bounds.GetRadius() : 0.0f;
+
 	for ( i = 0; i < num; i++ ) {
 		touch = clipModelList[i];
 
@@ -1095,6 +1782,10 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 			continue;
 		}
 
+		if ( touchBounds && !touch->absBounds.IntersectsBounds( *touchBounds ) ) {
+			continue;
+		}
+
 		if ( touch->renderModelHandle != -1 ) {
 			idClip::numRenderModelTraces++;
 			TraceRenderModel( trace, start, end, radius, trmAxis, touch );
@@ -1113,8 +1804,101 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 			}
 		}
 	}
+}
 
-	return ( results.fraction < 1.0f );
+/*
+============
+idClip::TranslationBatch
+
+  Translations sharing the clip model, content mask and pass entity, returns the number of
+  translations that hit something. With the clip tree the clip models are listed once for
+  the whole batch. The tree lists the clip models touching the bounds of a single translation
+  in the same order as those of the batch, so the results are exactly those of separate
+  Translation calls.
+============
+*/
+int idClip::TranslationBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces,
+						const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity ) {
+	int i, num, numHits;
+	idClipModel *clipModelList[MAX_GENTITIES];
+	idBounds traceBounds[MAX_TRACE_BATCH], batchBounds, touchBounds;
+	bool testEntities[MAX_TRACE_BATCH];
+	const idTraceModel *trm;
+
+	numHits = 0;
+	while ( numTraces > MAX_TRACE_BATCH ) {
+		numHits += TranslationBatch( results, start, end, MAX_TRACE_BATCH, mdl, trmAxis, contentMask, passEntity );
+		results += MAX_TRACE_BATCH;
+		start += MAX_TRACE_BATCH;
+		end += MAX_TRACE_BATCH;
+		numTraces -= MAX_TRACE_BATCH;
+	}
+
+	trm = TraceModelForClipModel( mdl );
+
+	// trace the world for every translation and get the bounds of what is left
+	batchBounds.Clear();
+	for ( i = 0; i < numTraces; i++ ) {
+		testEntities[i] = false;
+
+		if ( TestHugeTranslation( results[i], mdl, start[i], end[i], trmAxis ) ) {
+			continue;
+		}
+
+		if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
+			idClip::numTranslations++;
+			collisionModelManager->Translation( &results[i], start[i], end[i], trm, trmAxis, contentMask, 0, vec3_origin, mat3_default );
+			results[i].c.entityNum = results[i].fraction != 1.0f ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+			if ( results[i].fraction == 0.0f ) {
+				continue;		// blocked immediately by the world
+			}
+		} else {
+			memset( &results[i], 0, sizeof( results[i] ) );
+			results[i].fraction = 1.0f;
+			results[i].endpos = end[i];
+			results[i].endAxis = trmAxis;
+		}
+
+		if ( !trm ) {
+			traceBounds[i].FromPointTranslation( start[i], results[i].endpos - start[i] );
+		} else {
+			traceBounds[i].FromBoundsTranslation( trm->bounds, start[i], trmAxis, results[i].endpos - start[i] );
+		}
+		batchBounds.AddBounds( traceBounds[i] );
+		testEntities[i] = true;
+	}
+
+	num = -1;
+	if ( useClipTree && !batchBounds.IsCleared() ) {
+		num = GetTraceClipModels( batchBounds, contentMask, passEntity, clipModelList );
+		if ( num >= MAX_GENTITIES ) {
+			num = -1;		// the list may not hold everything a single translation touches
+		}
+	}
+
+	for ( i = 0; i < numTraces; i++ ) {
+		if ( !testEntities[i] ) {
+			continue;
+		}
+
+		if ( num >= 0 ) {
+			// ClipModelsTouchingBounds expands the bounds with the same epsilon
+			touchBounds[0] = traceBounds[i][0] - vec3_boxEpsilon;
+			touchBounds[1] = traceBounds[i][1] + vec3_boxEpsilon;
+			TranslationClipModels( results[i], start[i], end[i], trm, trmAxis, contentMask, clipModelList, num, &touchBounds );
+		} else {
+			TranslationClipModels( results[i], start[i], end[i], trm, trmAxis, contentMask, clipModelList,
+									GetTraceClipModels( traceBounds[i], contentMask, passEntity, clipModelList ), NULL );
+		}
+	}
+
+	for ( i = 0; i < numTraces; i++ ) {
+		if ( results[i].fraction < 1.0f ) {
+			numHits++;
+		}
+	}
+
+	return numHits;
 }
 
 /*
@@ -1601,7 +2385,10 @@ idClip::PrintStatistics
 void idClip::PrintStatistics( void ) {
 	gameLocal.Printf( "t = %-3d, r = %-3d, m = %-3d, render = %-3d, contents = %-3d, contacts = %-3d\n",
 					numTranslations, numRotations, numMotions, numRenderModelTraces, numContents, numContacts );
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	if ( useClipTree ) {
+		gameLocal.Printf( "clip tree: %d leafs, height %d, %d moves\n", clipTree.GetNumProxies(), clipTree.GetHeight(), numTreeMoves );
+	}
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeMoves = 0;
 }
 
 /*
@@ -1664,3 +2451,193 @@ bool idClip::DrawModelContactFeature( const contactInfo_t &contact, const idClip
 
 	return true;
 }
+
+/*
+================
+idClip::Record_f
+
+  Records clip model links and queries until stopped, starting with all linked clip models.
+================
+*/
+void idClip::Record_f( const idCmdArgs &args ) {
+	idClipModel *clipModelList[MAX_GENTITIES];
+	idStr fileName;
+	int i, num;
+
+	if ( clipRecordFile ) {
+		ClipStopRecording();
+		return;
+	}
+
+	if ( args.Argc() < 2 ) {
+		gameLocal.Printf( "usage: clipRecord <file>\nrun again without arguments to stop recording\n" );
+		return;
+	}
+
+	if ( !gameLocal.clip.clipSectors && !gameLocal.clip.useClipTree ) {
+		gameLocal.Printf( "no map loaded\n" );
+		return;
+	}
+
+	fileName = args.Argv( 1 );
+	fileName.DefaultFileExtension( ".clip" );
+	clipRecordFile = fileSystem->OpenFileWrite( fileName );
+	if ( !clipRecordFile ) {
+		gameLocal.Printf( "couldn't open %s\n", fileName.c_str() );
+		return;
+	}
+
+	clipRecordFile->WriteInt( CLIP_RECORD_IDENT );
+	clipRecordFile->WriteInt( CLIP_RECORD_VERSION );
+	clipRecordFile->WriteVec3( gameLocal.clip.worldBounds[0] );
+	clipRecordFile->WriteVec3( gameLocal.clip.worldBounds[1] );
+
+	num = gameLocal.clip.LinkedClipModels( clipModelList, MAX_GENTITIES );
+	for ( i = 0; i < num; i++ ) {
+		ClipRecord( CLIP_RECORD_LINK, clipModelList[i], clipModelList[i]->absBounds, clipModelList[i]->contents );
+	}
+
+	gameLocal.Printf( "recording clip models to %s\n", fileName.c_str() );
+}
+
+/*
+================
+idClip::Benchmark_f
+
+  Replays recorded clip model links and queries against the clip sectors and the clip tree.
+================
+*/
+void idClip::Benchmark_f( const idCmdArgs &args ) {
+	idFile *file;
+	idStr fileName;
+	idList<clipRecord_t> records;
+	clipRecord_t record;
+	idBounds bounds;
+	idClipModel *clipModels;
+	idClipModel *clipModelList[MAX_GENTITIES];
+	idClip *clip;
+	idTimer timer;
+	int i, pass, ident, version, numClipModels, numLinks, numMoves, numUnlinks, numQueries, numListed;
+	unsigned char op;
+	bool ended;
+
+	if ( args.Argc() < 2 ) {
+		gameLocal.Printf( "usage: clipBenchmark <file>\n" );
+		return;
+	}
+
+	if ( clipRecordFile ) {
+		gameLocal.Printf( "stop recording first\n" );
+		return;
+	}
+
+	fileName = args.Argv( 1 );
+	fileName.DefaultFileExtension( ".clip" );
+	file = fileSystem->OpenFileRead( fileName );
+	if ( !file ) {
+		gameLocal.Printf( "couldn't open %s\n", fileName.c_str() );
+		return;
+	}
+
+	file->ReadInt( ident );
+	file->ReadInt( version );
+	if ( ident != CLIP_RECORD_IDENT || version != CLIP_RECORD_VERSION ) {
+		gameLocal.Printf( "%s is not a version %d clip recording\n", fileName.c_str(), CLIP_RECORD_VERSION );
+		fileSystem->CloseFile( file );
+		return;
+	}
+	file->ReadVec3( bounds[0] );
+	file->ReadVec3( bounds[1] );
+
+	// read everything first so the replay only measures the clip code
+	numClipModels = 0;
+	ended = false;
+	records.SetGranularity( 4096 );
+	while( file->ReadUnsignedChar( op ) == 1 && op <= CLIP_RECORD_QUERY ) {
+		if ( op == CLIP_RECORD_END ) {
+			ended = true;
+			break;
+		}
+		record.op = (clipRecordOp_t) op;
+		record.num = 0;
+		record.contents = 0;
+		if ( op != CLIP_RECORD_QUERY ) {
+			file->ReadInt( record.num );
+			if ( record.num < 0 || record.num >= CLIP_RECORD_MAX_MODELS ) {
+				break;
+			}
+			numClipModels = Max( numClipModels, record.num + 1 );
+		}
+		if ( op == CLIP_RECORD_LINK || op == CLIP_RECORD_QUERY ) {
+			file->ReadVec3( record.bounds[0] );
+			file->ReadVec3( record.bounds[1] );
+			file->ReadInt( record.contents );
+		}
+		records.Append( record );
+	}
+	fileSystem->CloseFile( file );
+
+	if ( !ended ) {
+		gameLocal.Printf( "%s is truncated or corrupt\n", fileName.c_str() );
+		return;
+	}
+
+	clipModels = new idClipModel[numClipModels];
+
+	for ( pass = 0; pass < 2; pass++ ) {
+		clip = new idClip;
+		clip->InitBroadphase( bounds, pass == 1 );
+
+		numLinks = numMoves = numUnlinks = numQueries = numListed = 0;
+
+		timer.Clear();
+		timer.Start();
+		for ( i = 0; i < records.Num(); i++ ) {
+			const clipRecord_t &r = records[i];
+			idClipModel *clipModel = &clipModels[r.num];
+
+			switch( r.op ) {
+				case CLIP_RECORD_LINK: {
+					clipModel->absBounds = r.bounds;
+					clipModel->contents = r.contents;
+					clip->LinkClipModel( clipModel );
+					numLinks++;
+					break;
+				}
+				case CLIP_RECORD_MOVE: {
+					clipModel->UnlinkForMove();
+					numMoves++;
+					break;
+				}
+				case CLIP_RECORD_UNLINK: {
+					clipModel->Unlink();
+					numUnlinks++;
+					break;
+				}
+				case CLIP_RECORD_QUERY: {
+					numListed += clip->ClipModelsTouchingBounds( r.bounds, r.contents, clipModelList, MAX_GENTITIES );
+					numQueries++;
+					break;
+				}
+				default: {
+					break;
+				}
+			}
+		}
+		timer.Stop();
+
+		gameLocal.Printf( "%s: %1.2f ms for %d links, %d moves, %d unlinks and %d queries listing %d clip models\n",
+							( pass == 0 ) ? "clip sectors" : "clip tree", timer.Milliseconds(), numLinks, numMoves, numUnlinks, numQueries, numListed );
+		if ( pass == 1 ) {
+			gameLocal.Printf( "clip tree: %d leafs, height %d, %d moves in the tree\n", clip->clipTree.GetNumProxies(), clip->clipTree.GetHeight(), clip->numTreeMoves );
+		}
+
+		for ( i = 0; i < numClipModels; i++ ) {
+			clipModels[i].Unlink();
+		}
+		clip->ShutdownBroadphase();
+		delete clip;
+	}
+
+	delete[] clipModels;
+}
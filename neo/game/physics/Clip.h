@@ -54,6 +54,7 @@ class idEntity;
 class idClipModel {
 
 	friend class idClip;
+	friend class idClipTree;
 
 public:
 							idClipModel( void );
@@ -72,7 +73,7 @@ public:
 
 	void					Link( idClip &clp );				// must have been linked with an entity and id before
 	void					Link( idClip &clp, idEntity *ent, int newId, const idVec3 &newOrigin, const idMat3 &newAxis, int renderModelHandle = -1 );
-	void					Unlink( void );						// unlink from sectors
+	void					Unlink( void );						// unlink from sectors or the clip tree
 	void					SetPosition( const idVec3 &newOrigin, const idMat3 &newAxis );	// unlinks the clip model
 	void					Translate( const idVec3 &translation );							// unlinks the clip model
 	void					Rotate( const idRotation &rotation );							// unlinks the clip model
@@ -125,9 +126,13 @@ private:
 
 	struct clipLink_s *		clipLinks;				// links into sectors
 	int						touchCount;
+	bool					linked;					// true if linked for clipping
+	class idClipTree *		clipTree;				// clip tree with a leaf for this clip model
+	int						clipProxy;				// leaf in the clip tree
 
 	void					Init( void );			// initialize
 	void					Link_r( struct clipSector_s *node );
+	void					UnlinkForMove( void );	// unlink but keep the clip tree leaf for the next link
 
 	static int				AllocTraceModel( const idTraceModel &trm );
 	static void				FreeTraceModel( int traceModelIndex );
@@ -137,12 +142,12 @@ private:
 
 
 ID_INLINE void idClipModel::Translate( const idVec3 &translation ) {
-	Unlink();
+	UnlinkForMove();
 	origin += translation;
 }
 
 ID_INLINE void idClipModel::Rotate( const idRotation &rotation ) {
-	Unlink();
+	UnlinkForMove();
 	origin *= rotation;
 	axis *= rotation.ToMat3();
 }
@@ -220,7 +225,7 @@ ID_INLINE bool idClipModel::IsTraceModel( void ) const {
 }
 
 ID_INLINE bool idClipModel::IsLinked( void ) const {
-	return ( clipLinks != NULL );
+	return linked;
 }
 
 ID_INLINE bool idClipModel::IsEnabled( void ) const {
@@ -239,6 +244,56 @@ ID_INLINE const idTraceModel *idClipModel::GetTraceModel( void ) const {
 }
 
 
+//===============================================================
+//
+//	idClipTree
+//
+//	Dynamic bounding volume tree with a leaf for every clip model.
+//	The leaf bounds are enlarged so clip models can move around
+//	without changing the tree, and the tree is kept balanced with
+//	rotations as leafs are inserted and removed.
+//
+//===============================================================
+
+typedef struct clipTreeNode_s {
+	idBounds				bounds;				// enlarged clip model bounds for leafs
+	int						parent;				// next free node for free nodes
+	int						children[2];		// -1 for leafs
+	int						height;				// 0 for leafs, -1 for free nodes
+	idClipModel *			clipModel;			// clip model of a leaf
+} clipTreeNode_t;
+
+class idClipTree {
+public:
+							idClipTree( void );
+
+	void					Clear( void );
+
+	int						CreateProxy( idClipModel *clipModel, const idBounds &bounds );
+	void					DestroyProxy( int proxy );
+							// returns true if the leaf had to be moved in the tree
+	bool					MoveProxy( int proxy, const idBounds &bounds );
+
+	int						ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const;
+	int						LinkedClipModels( idClipModel **clipModelList, int maxCount ) const;
+
+	int						GetNumProxies( void ) const { return numProxies; }
+	int						GetHeight( void ) const { return ( root != -1 ) ? nodes[root].height : 0; }
+
+private:
+	idList<clipTreeNode_t>	nodes;
+	int						root;
+	int						freeNode;
+	int						numProxies;
+
+	int						AllocNode( void );
+	void					FreeNode( int node );
+	void					InsertLeaf( int leaf );
+	void					RemoveLeaf( int leaf );
+	int						Balance( int node );
+};
+
+
 //===============================================================
 //
 //	idClip
@@ -273,6 +328,14 @@ public:
 	bool					TraceBounds( trace_t &results, const idVec3 &start, const idVec3 &end, const idBounds &bounds,
 								int contentMask, const idEntity *passEntity );
 
+	// batched translations versus the rest of the world, returns the number of translations that hit something
+	int						TranslationBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces,
+								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity );
+	int						TracePointBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces,
+								int contentMask, const idEntity *passEntity );
+	int						TraceBoundsBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces, const idBounds &bounds,
+								int contentMask, const idEntity *passEntity );
+
 	// clip versus a specific model
 	void					TranslationModel( trace_t &results, const idVec3 &start, const idVec3 &end,
 								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask,
@@ -306,7 +369,13 @@ public:
 	void					DrawClipModels( const idVec3 &eye, const float radius, const idEntity *passEntity );
 	bool					DrawModelContactFeature( const contactInfo_t &contact, const idClipModel *clipModel, int lifetime ) const;
 
+							// record clip model links and queries and replay them against the clip sectors and the clip tree
+	static void				Record_f( const idCmdArgs &args );
+	static void				Benchmark_f( const idCmdArgs &args );
+
 private:
+	bool					useClipTree;
+	idClipTree				clipTree;
 	int						numClipSectors;
 	struct clipSector_s *	clipSectors;
 	idBounds				worldBounds;
@@ -320,13 +389,20 @@ private:
 	int						numRenderModelTraces;
 	int						numContents;
 	int						numContacts;
+	int						numTreeMoves;
 
 private:
+	void					InitBroadphase( const idBounds &bounds, bool tree );
+	void					ShutdownBroadphase( void );
+	void					LinkClipModel( idClipModel *clipModel );
+	int						LinkedClipModels( idClipModel **clipModelList, int maxCount ) const;
 	struct clipSector_s *	CreateClipSectors_r( const int depth, const idBounds &bounds, idVec3 &maxSector );
 	void					ClipModelsTouchingBounds_r( const struct clipSector_s *node, struct listParms_s &parms ) const;
 	const idTraceModel *	TraceModelForClipModel( const idClipModel *mdl ) const;
 	int						GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const;
 	void					TraceRenderModel( trace_t &trace, const idVec3 &start, const idVec3 &end, const float radius, const idMat3 &axis, idClipModel *touch ) const;
+	void					TranslationClipModels( trace_t &results, const idVec3 &start, const idVec3 &end, const idTraceModel *trm, const idMat3 &trmAxis,
+								int contentMask, idClipModel **clipModelList, int num, const idBounds *touchBounds );
 };
 
 
@@ -341,6 +417,15 @@ ID_INLINE bool idClip::TraceBounds( trace_t &results, const idVec3 &start, const
 	return ( results.fraction < 1.0f );
 }
 
+ID_INLINE int idClip::TracePointBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces, int contentMask, const idEntity *passEntity ) {
+	return TranslationBatch( results, start, end, numTraces, NULL, mat3_identity, contentMask, passEntity );
+}
+
+ID_INLINE int idClip::TraceBoundsBatch( trace_t *results, const idVec3 *start, const idVec3 *end, int numTraces, const idBounds &bounds, int contentMask, const idEntity *passEntity ) {
+	temporaryClipModel.LoadModel( idTraceModel( bounds ) );
+	return TranslationBatch( results, start, end, numTraces, &temporaryClipModel, mat3_identity, contentMask, passEntity );
+}
+
 ID_INLINE const idBounds & idClip::GetWorldBounds( void ) const {
 	return worldBounds;
 }
@@ -195,6 +195,15 @@ opcode_t idCompiler::opcodes[] = {
 	{ "&", "BITAND", 3, false, &def_float, &def_float, &def_float },
 	{ "|", "BITOR", 3, false, &def_float, &def_float, &def_float },
 
+	{ "<EQ_F_IFNOT>", "EQ_F_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<NE_F_IFNOT>", "NE_F_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<LE_IFNOT>", "LE_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<GE_IFNOT>", "GE_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<LT_IFNOT>", "LT_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<GT_IFNOT>", "GT_IFNOT", -1, false, &def_float, &def_float, &def_float },
+	{ "<INDIRECT_F_EQ_F>", "INDIRECT_F_EQ_F", -1, false, &def_object, &def_field, &def_float },
+	{ "<INDIRECT_F_NE_F>", "INDIRECT_F_NE_F", -1, false, &def_object, &def_field, &def_float },
+
 	{ "<BREAK>", "BREAK", -1, false, &def_float, &def_void, &def_void },
 	{ "<CONTINUE>", "CONTINUE", -1, false, &def_float, &def_void, &def_void },
 
@@ -2252,6 +2261,8 @@ void idCompiler::ParseFunctionDef( idTypeDef *returnType, const char *name ) {
 	// record the number of statements in the function
 	func->numStatements = gameLocal.program.NumStatements() - func->firstStatement;
 
+	gameLocal.program.FuseStatements( func->firstStatement, func->numStatements );
+
 	scope = oldscope;
 }
 
@@ -2574,6 +2585,7 @@ compiles the 0 terminated text, adding definitions to the program structure
 void idCompiler::CompileFile( const char *text, const char *filename, bool toConsole ) {
 	idTimer compile_time;
 	bool error;
+	int i;
 
 	compile_time.Start();
 
@@ -2640,6 +2652,12 @@ void idCompiler::CompileFile( const char *text, const char *filename, bool toCon
 		throw idCompileError( error );
 	}
 
+	// the script cache has to notice changes to includes that only hold defines as well
+	const idList<idStr> &includedFiles = parser.GetIncludedFiles();
+	for( i = 0; i < includedFiles.Num(); i++ ) {
+		gameLocal.program.AddSourceFile( includedFiles[ i ] );
+	}
+
 	parser.FreeSource();
 
 	compile_time.Stop();
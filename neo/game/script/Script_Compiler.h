@@ -188,6 +188,17 @@ enum {
 	OP_BITAND,
 	OP_BITOR,
 
+	// superinstructions, only created by idProgram::FuseStatements.  each executes its own
+	// statement and the one following it, which is left in place for jumps that target it.
+	OP_EQ_F_IFNOT,
+	OP_NE_F_IFNOT,
+	OP_LE_IFNOT,
+	OP_GE_IFNOT,
+	OP_LT_IFNOT,
+	OP_GT_IFNOT,
+	OP_INDIRECT_F_EQ_F,
+	OP_INDIRECT_F_NE_F,
+
 	OP_BREAK,			// placeholder op.  not used in final code
 	OP_CONTINUE,		// placeholder op.  not used in final code
 
@@ -89,6 +89,8 @@ Contains type information for variables and functions.
 ***********************************************************************/
 
 class idTypeDef {
+	friend class idProgram;
+
 private:
 	etype_t						type;
 	idStr 						name;
@@ -434,6 +436,7 @@ single idProgram.
 class idProgram {
 private:
 	idStrList									fileList;
+	idStrList									sourceFiles;	// every file read by the parser, including define only includes
 	idStr 										filename;
 	int											filenum;
 
@@ -457,6 +460,13 @@ private:
 
 	void										CompileStats( void );
 
+	bool										ReadCache( const char *cacheName );
+	void										WriteCache( const char *cacheName ) const;
+	int											CacheTypeNum( const idTypeDef *type, const idHashIndex &typeHash ) const;
+	int											CacheDefNum( const idVarDef *def ) const;
+	idTypeDef									*CacheType( int num ) const;
+	idVarDef									*CacheDef( int num ) const;
+
 public:
 	idVarDef									*returnDef;
 	idVarDef									*returnStringDef;
@@ -479,10 +489,14 @@ public:
 	void										FinishCompilation( void );
 	void										DisassembleStatement( idFile *file, int instructionPointer ) const;
 	void										Disassemble( void ) const;
+	void										FuseStatements( int first, int num );
+	void										UnfuseStatements( int first, int num );
+	static int									BaseOpcode( int op );
 	void										FreeData( void );
 
 	const char									*GetFilename( int num );
 	int											GetFilenum( const char *name );
+	void										AddSourceFile( const char *name );
 	int											GetLineNumberForStatement( int index );
 	const char									*GetFilenameForStatement( int index );
 
@@ -509,6 +523,7 @@ public:
 	statement_t									*AllocStatement( void );
 	statement_t									&GetStatement( int index );
 	int											NumStatements( void ) { return statements.Num(); }
+	int											NumFunctions( void ) { return functions.Num(); }
 
 	int 										GetReturnedInteger( void );
 
@@ -593,6 +608,15 @@ ID_INLINE void idProgram::ReturnString( const char *string ) {
 	idStr::Copynz( returnStringDef->value.stringPtr, string, MAX_STRING_LEN );
 }
 
+/*
+================
+idProgram::AddSourceFile
+================
+*/
+ID_INLINE void idProgram::AddSourceFile( const char *name ) {
+	sourceFiles.AddUnique( name );
+}
+
 /*
 ================
 idProgram::GetFilename
@@ -74,6 +74,14 @@ extern const idEventDef EV_Thread_FadeOut;
 extern const idEventDef EV_Thread_FadeTo;
 extern const idEventDef EV_Thread_Restart;
 
+class idThread;
+
+// threads sleeping until the same game time
+typedef struct threadBucket_s {
+	int							time;
+	idLinkList<idThread>		threads;
+} threadBucket_t;
+
 class idThread : public idClass {
 private:
 	static idThread				*currentThread;
@@ -93,13 +101,31 @@ private:
 
 	bool						manualControl;
 
+	idLinkList<idThread>		scheduleNode;		// in the bucket of waitingUntil while sleeping
+	idLinkList<idThread>		waitNode;			// in the waiters of waitingForThread
+	idLinkList<idThread>		waiters;			// threads waiting for this thread to end
+
 	static int					threadIndex;
 	static idList<idThread *>	threadList;
+	static idHashIndex			threadHash;			// threadNum to threadList index
+
+	static idList<threadBucket_t *>	scheduleBuckets;	// sorted on time, latest first
+	static idBlockAlloc<threadBucket_t, 64>	bucketAllocator;
+
+	static int					numThreadsRun;
+	static int					numThreadsWoken;
+	static int					numThreadsScheduled;
+	static int					numThreadsWaiting;
+	static int					lastFrameThreadsRun;
+	static int					lastFrameThreadsWoken;
 
 	static trace_t				trace;
 
 	void						Init( void );
 	void						Pause( void );
+	void						Schedule( void );
+	void						Unschedule( void );
+	void						RemoveFromThreadList( void );
 
 	void						Event_Execute( void );
 	void						Event_SetThreadName( const char *name );
@@ -220,6 +246,7 @@ public:
 	static void					ListThreads_f( const idCmdArgs &args );
 	static void					Restart( void );
 	static void					ObjectMoveDone( int threadnum, idEntity *obj );
+	static void					RunScheduledThreads( void );
 								
 	static idList<idThread*>&	GetThreads ( void );
 	
@@ -230,7 +257,7 @@ public:
 	static void					KillThread( const char *name );
 	static void					KillThread( int num );
 	bool						Execute( void );
-	void						ManualControl( void ) { manualControl = true; CancelEvents( &EV_Thread_Execute ); };
+	void						ManualControl( void ) { manualControl = true; CancelEvents( &EV_Thread_Execute ); Unschedule(); };
 	void						DoneProcessing( void ) { interpreter.doneProcessing = true; };
 	void						ContinueProcessing( void ) { interpreter.doneProcessing = false; };
 	bool						ThreadDying( void ) { return interpreter.threadDying; };
@@ -1004,6 +1004,7 @@ int idParser::Directive_include( void ) {
 	}
 	script->SetFlags( idParser::flags );
 	script->SetPunctuations( idParser::punctuations );
+	idParser::includedFiles.AddUnique( script->GetFileName() );
 	idParser::PushScript( script );
 	return true;
 }
@@ -3027,6 +3028,7 @@ int idParser::LoadFile( const char *filename, bool OSPath ) {
 	script->next = NULL;
 	idParser::OSPath = OSPath;
 	idParser::filename = filename;
+	idParser::includedFiles.Clear();
 	idParser::scriptstack = script;
 	idParser::tokens = NULL;
 	idParser::indentstack = NULL;
@@ -3063,6 +3065,7 @@ int idParser::LoadMemory(const char *ptr, int length, const char *name ) {
 	script->next = NULL;
 	idParser::filename = name;
 	idParser::scriptstack = script;
+	idParser::includedFiles.Clear();
 	idParser::tokens = NULL;
 	idParser::indentstack = NULL;
 	idParser::skip = 0;
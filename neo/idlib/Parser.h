@@ -158,6 +158,8 @@ public:
 	int				GetFlags( void ) const;
 					// returns the current filename
 	const char *	GetFileName( void ) const;
+					// returns the files included since the source was loaded
+	const idList<idStr> &GetIncludedFiles( void ) const;
 					// get current offset in current script
 	const int		GetFileOffset( void ) const;
 					// get file time for current script
@@ -182,6 +184,7 @@ private:
 	int				loaded;						// set when a source file is loaded from file or memory
 	idStr			filename;					// file name of the script
 	idStr			includepath;				// path to include files
+	idList<idStr>	includedFiles;				// files included with #include
 	bool			OSPath;						// true if the file was loaded from an OS path
 	const punctuation_t *punctuations;			// punctuations to use
 	int				flags;						// flags used for script parsing
@@ -253,6 +256,10 @@ ID_INLINE const char *idParser::GetFileName( void ) const {
 	}
 }
 
+ID_INLINE const idList<idStr> &idParser::GetIncludedFiles( void ) const {
+	return idParser::includedFiles;
+}
+
 ID_INLINE const int idParser::GetFileOffset( void ) const {
 	if ( idParser::scriptstack ) {
 		return idParser::scriptstack->GetFileOffset();
@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "Simd_SSE.h"
 #include "Simd_SSE2.h"
 #include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
 #include "Simd_AltiVec.h"
 
 
@@ -75,6 +76,10 @@ void idSIMD::InitProcessor( const char *module, bool forceGeneric ) {
 		if ( !processor ) {
 			if ( ( cpuid & CPUID_ALTIVEC ) ) {
 				processor = new idSIMD_AltiVec;
+#if defined(ID_AVX2_INTRINSICS)
+			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) && ( cpuid & CPUID_AVX2 ) && ( cpuid & CPUID_FMA3 ) ) {
+				processor = new idSIMD_AVX2;
+#endif
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) ) {
 				processor = new idSIMD_SSE3;
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) ) {
@@ -2354,6 +2359,69 @@ void TestBlendJoints( void ) {
 	PrintClocks( va( "   simd->BlendJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestDecompressJoints
+============
+*/
+void TestDecompressJoints( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idJointQuat joints1[COUNT] );
+	ALIGN16( idJointQuat joints2[COUNT] );
+	ALIGN16( unsigned short components[6 * COUNT] );
+	ALIGN16( float scale[6 * COUNT] );
+	ALIGN16( float bias[6 * COUNT] );
+	ALIGN16( int jointIndex[2 * COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	// the joints of the translation and rotation lanes overlap like they do in an anim
+	for ( i = 0; i < COUNT; i++ ) {
+		jointIndex[i] = i;
+		jointIndex[COUNT + i] = COUNT - 1 - i;
+		for ( j = 0; j < 6; j++ ) {
+			components[j * COUNT + i] = srnd.RandomInt( 65536 );
+			if ( j < 3 ) {
+				scale[j * COUNT + i] = srnd.RandomFloat() * 10.0f / 65535.0f;
+				bias[j * COUNT + i] = srnd.CRandomFloat() * 10.0f;
+			} else {
+				scale[j * COUNT + i] = srnd.RandomFloat() * 0.5f / 65535.0f;
+				bias[j * COUNT + i] = srnd.RandomFloat() * -0.5f;
+			}
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->DecompressJoints( joints1, components, scale, bias, jointIndex, COUNT, COUNT - 3 );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DecompressJoints()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->DecompressJoints( joints2, components, scale, bias, jointIndex, COUNT, COUNT - 3 );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( !joints1[i].t.Compare( joints2[i].t, 1e-5f ) ) {
+			break;
+		}
+		if ( i >= 3 && !joints1[i].q.Compare( joints2[i].q, 1e-5f ) ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->DecompressJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestConvertJointQuatsToJointMats
@@ -2833,6 +2901,65 @@ void TestOverlayPointCull( void ) {
 	PrintClocks( va( "   simd->OverlayPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestCullBoxes
+============
+*/
+void TestCullBoxes( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( float boxes[BOX_SOA_COMPONENTS * COUNT] );
+	ALIGN16( byte cullBits1[COUNT] );
+	ALIGN16( byte cullBits2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < 6; i++ ) {
+		idVec3 normal( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() );
+		normal.Normalize();
+		planes[i].SetNormal( normal );
+		planes[i][3] = srnd.CRandomFloat() * 5.0f;
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		idMat3 axis = idAngles( srnd.RandomFloat() * 360.0f, srnd.RandomFloat() * 360.0f, srnd.RandomFloat() * 360.0f ).ToMat3();
+		for ( j = 0; j < 3; j++ ) {
+			boxes[j * COUNT + i] = srnd.CRandomFloat() * 10.0f;
+		}
+		for ( j = 0; j < 9; j++ ) {
+			boxes[( 3 + j ) * COUNT + i] = axis[j / 3][j % 3] * srnd.RandomFloat() * 2.0f;
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->CullBoxes( cullBits1, planes, 6, boxes, COUNT, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->CullBoxes()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->CullBoxes( cullBits2, planes, 6, boxes, COUNT, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( cullBits1[i] != cullBits2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->CullBoxes() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestDeriveTriPlanes
@@ -4144,6 +4271,14 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 				return;
 			}
 			p_simd = new idSIMD_SSE3();
+#if defined(ID_AVX2_INTRINSICS)
+		} else if ( idStr::Icmp( argString, "AVX2" ) == 0 ) {
+			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) || !( cpuid & CPUID_SSE2 ) || !( cpuid & CPUID_SSE3 ) || !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+				common->Printf( "CPU does not support MMX & SSE & SSE2 & SSE3 & AVX2 & FMA3\n" );
+				return;
+			}
+			p_simd = new idSIMD_AVX2();
+#endif
 		} else if ( idStr::Icmp( argString, "AltiVec" ) == 0 ) {
 			if ( !( cpuid & CPUID_ALTIVEC ) ) {
 				common->Printf( "CPU does not support AltiVec\n" );
@@ -4151,7 +4286,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 			}
 			p_simd = new idSIMD_AltiVec();
 		} else {
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AVX2, AltiVec\n" );
 			return;
 		}
 	}
@@ -4190,6 +4325,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	idLib::common->Printf("====================================\n" );
 
 	TestBlendJoints();
+	TestDecompressJoints();
 	TestConvertJointQuatsToJointMats();
 	TestConvertJointMatsToJointQuats();
 	TestTransformJoints();
@@ -4198,6 +4334,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	TestTracePointCull();
 	TestDecalPointCull();
 	TestOverlayPointCull();
+	TestCullBoxes();
 	TestDeriveTriPlanes();
 	TestDeriveTangents();
 	TestDeriveUnsmoothedTangents();
@@ -83,6 +83,14 @@ struct dominantTri_s;
 
 const int MIXBUFFER_SAMPLES = 4096;
 
+// CullBoxes takes oriented boxes in structure of arrays layout, the components
+// are the box center followed by the three box axes scaled by the half extents
+const int BOX_SOA_COMPONENTS = 12;
+
+// DecompressJoints takes 16 bit joint components in structure of arrays layout, the
+// translation and rotation lanes are each padded to a multiple of JOINT_SOA_LANES
+const int JOINT_SOA_LANES = 8;
+
 typedef enum {
 	SPEAKER_LEFT = 0,
 	SPEAKER_RIGHT,
@@ -171,6 +179,9 @@ public:
 
 	// rendering
 	virtual void VPCALL BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) = 0;
+	// components are tx, ty, tz for the translation lanes followed by qx, qy, qz for the rotation lanes, each value
+	// is bias + scale * component, the joint of each lane is jointIndex[lane] and the quaternion w is derived from x, y, z
+	virtual void VPCALL DecompressJoints( idJointQuat *joints, const unsigned short *components, const float *scale, const float *bias, const int *jointIndex, const int numTranslations, const int numRotations ) = 0;
 	virtual void VPCALL ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) = 0;
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat *jointQuats, const idJointMat *jointMats, const int numJoints ) = 0;
 	virtual void VPCALL TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) = 0;
@@ -179,6 +190,9 @@ public:
 	virtual void VPCALL TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL OverlayPointCull( byte *cullBits, idVec2 *texCoords, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
+	// cullBits[i] = box i is completely on the front side of one of the planes, component j of
+	// box i is boxes[j * stride + i], the stride is a multiple of 4 and boxes is 16 byte aligned
+	virtual void VPCALL CullBoxes( byte *cullBits, const idPlane *planes, const int numPlanes, const float *boxes, const int stride, const int numBoxes ) = 0;
 	virtual void VPCALL DeriveTriPlanes( idPlane *planes, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts ) = 0;
@@ -0,0 +1,1117 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../precompiled.h"
+#pragma hdrstop
+
+#include "Simd_Generic.h"
+#include "Simd_MMX.h"
+#include "Simd_SSE.h"
+#include "Simd_SSE2.h"
+#include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
+
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//===============================================================
+
+#if defined(ID_AVX2_INTRINSICS)
+
+#include <immintrin.h>
+
+// gcc and clang only allow the AVX2 & FMA intrinsics in functions compiled for them
+#if defined(_MSC_VER)
+#define ID_AVX2_TARGET
+#else
+#define ID_AVX2_TARGET					__attribute__ ((target("avx2,fma")))
+#endif
+
+// a window into this table gives the mask for the first 0 to 8 lanes
+static const int avx2LaneMask[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/*
+============
+AVX2_LaneMask
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256i AVX2_LaneMask( const int count ) {
+	assert( count >= 0 && count <= 8 );
+	return _mm256_loadu_si256( (const __m256i *) ( avx2LaneMask + 8 - count ) );
+}
+
+/*
+============
+AVX2_HorizontalSum
+============
+*/
+ID_AVX2_TARGET static ID_INLINE float AVX2_HorizontalSum( const __m256 v ) {
+	__m128 s = _mm_add_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+	s = _mm_add_ss( s, _mm_shuffle_ps( s, s, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( s );
+}
+
+/*
+============
+AVX2_Dot
+
+  returns src0[0] * src1[0] + src0[1] * src1[1] + ... + src0[count-1] * src1[count-1]
+============
+*/
+ID_AVX2_TARGET static ID_INLINE float AVX2_Dot( const float *src0, const float *src1, const int count ) {
+	__m256 s0 = _mm256_setzero_ps();
+	__m256 s1 = _mm256_setzero_ps();
+	int i;
+
+	for ( i = 0; i + 16 <= count; i += 16 ) {
+		s0 = _mm256_fmadd_ps( _mm256_loadu_ps( src0 + i + 0 ), _mm256_loadu_ps( src1 + i + 0 ), s0 );
+		s1 = _mm256_fmadd_ps( _mm256_loadu_ps( src0 + i + 8 ), _mm256_loadu_ps( src1 + i + 8 ), s1 );
+	}
+	if ( i + 8 <= count ) {
+		s0 = _mm256_fmadd_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ), s0 );
+		i += 8;
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		s1 = _mm256_fmadd_ps( _mm256_maskload_ps( src0 + i, mask ), _mm256_maskload_ps( src1 + i, mask ), s1 );
+	}
+	return AVX2_HorizontalSum( _mm256_add_ps( s0, s1 ) );
+}
+
+/*
+============
+AVX2_InvSqrt
+
+  one Newton-Raphson step on the 12 bit estimate, same precision as idMath::RSqrt
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 AVX2_InvSqrt( const __m256 x ) {
+	__m256 r = _mm256_rsqrt_ps( x );
+	return _mm256_mul_ps( _mm256_mul_ps( _mm256_set1_ps( 0.5f ), r ), _mm256_fnmadd_ps( _mm256_mul_ps( x, r ), r, _mm256_set1_ps( 3.0f ) ) );
+}
+
+/*
+============
+AVX2_SinZeroHalfPI
+
+  the same polynomial as idMath::Sin16 for angles in the range [0, PI/2]
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 AVX2_SinZeroHalfPI( const __m256 a ) {
+	__m256 s, t;
+
+	s = _mm256_mul_ps( a, a );
+	t = _mm256_fmadd_ps( _mm256_set1_ps( -2.39e-08f ), s, _mm256_set1_ps( 2.7526e-06f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( -1.98409e-04f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 8.3333315e-03f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( -1.666666664e-01f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 1.0f ) );
+	return _mm256_mul_ps( a, t );
+}
+
+/*
+============
+AVX2_ATanPositive
+
+  the same polynomial as idMath::ATan16( y, x ) for y >= 0 and x >= 0
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 AVX2_ATanPositive( const __m256 y, const __m256 x ) {
+	__m256 a, s, t, swap;
+
+	swap = _mm256_cmp_ps( y, x, _CMP_GT_OQ );
+	a = _mm256_div_ps( _mm256_min_ps( y, x ), _mm256_max_ps( y, x ) );
+	s = _mm256_mul_ps( a, a );
+	t = _mm256_fmadd_ps( _mm256_set1_ps( 0.0028662257f ), s, _mm256_set1_ps( -0.0161657367f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 0.0429096138f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( -0.0752896400f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 0.1065626393f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( -0.1420889944f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 0.1999355085f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( -0.3333314528f ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 1.0f ) );
+	t = _mm256_mul_ps( t, a );
+	return _mm256_blendv_ps( t, _mm256_sub_ps( _mm256_set1_ps( idMath::HALF_PI ), t ), swap );
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char * idSIMD_AVX2::GetName( void ) const {
+	return "MMX & SSE & SSE2 & SSE3 & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::Mul
+
+  dst[i] = constant * src[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::Mul( float *dst, const float constant, const float *src, const int count ) {
+	const __m256 c = _mm256_set1_ps( constant );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_mul_ps( c, _mm256_loadu_ps( src + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_mul_ps( c, _mm256_maskload_ps( src + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::Mul
+
+  dst[i] = src0[i] * src1[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::Mul( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_mul_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_mul_ps( _mm256_maskload_ps( src0 + i, mask ), _mm256_maskload_ps( src1 + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MulAdd
+
+  dst[i] += constant * src[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MulAdd( float *dst, const float constant, const float *src, const int count ) {
+	const __m256 c = _mm256_set1_ps( constant );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fmadd_ps( c, _mm256_loadu_ps( src + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_fmadd_ps( c, _mm256_maskload_ps( src + i, mask ), _mm256_maskload_ps( dst + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MulAdd
+
+  dst[i] += src0[i] * src1[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MulAdd( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fmadd_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_fmadd_ps( _mm256_maskload_ps( src0 + i, mask ), _mm256_maskload_ps( src1 + i, mask ), _mm256_maskload_ps( dst + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MulSub
+
+  dst[i] -= constant * src[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MulSub( float *dst, const float constant, const float *src, const int count ) {
+	const __m256 c = _mm256_set1_ps( constant );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fnmadd_ps( c, _mm256_loadu_ps( src + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_fnmadd_ps( c, _mm256_maskload_ps( src + i, mask ), _mm256_maskload_ps( dst + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MulSub
+
+  dst[i] -= src0[i] * src1[i];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MulSub( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fnmadd_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	if ( i < count ) {
+		__m256i mask = AVX2_LaneMask( count - i );
+		_mm256_maskstore_ps( dst + i, mask, _mm256_fnmadd_ps( _mm256_maskload_ps( src0 + i, mask ), _mm256_maskload_ps( src1 + i, mask ), _mm256_maskload_ps( dst + i, mask ) ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dot = src1[0] * src2[0] + src1[1] * src2[1] + src1[2] * src2[2] + ...
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float &dot, const float *src1, const float *src2, const int count ) {
+	dot = AVX2_Dot( src1, src2, count );
+	_mm256_zeroupper();
+}
+
+/*
+============
+AVX2_MultiplyVecX
+
+  dst[i] = mat[i] * vec, added to or subtracted from dst[i] when op is positive or negative
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void AVX2_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec, const int op ) {
+	int i, numRows, numColumns;
+	const float *mPtr, *vPtr;
+	float *dstPtr;
+
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+
+	mPtr = mat.ToFloatPtr();
+	vPtr = vec.ToFloatPtr();
+	dstPtr = dst.ToFloatPtr();
+	numRows = mat.GetNumRows();
+	numColumns = mat.GetNumColumns();
+
+	for ( i = 0; i < numRows; i++ ) {
+		float sum = AVX2_Dot( mPtr, vPtr, numColumns );
+		if ( op > 0 ) {
+			dstPtr[i] += sum;
+		} else if ( op < 0 ) {
+			dstPtr[i] -= sum;
+		} else {
+			dstPtr[i] = sum;
+		}
+		mPtr += numColumns;
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+AVX2_TransposeMultiplyVecX
+
+  dst = mat.Transpose() * vec, added to or subtracted from dst when op is positive or negative,
+  eight columns are accumulated over all rows at a time
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void AVX2_TransposeMultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec, const int op ) {
+	int i, j, numRows, numColumns;
+	const float *mPtr, *vPtr;
+	float *dstPtr;
+
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+
+	vPtr = vec.ToFloatPtr();
+	dstPtr = dst.ToFloatPtr();
+	numRows = mat.GetNumRows();
+	numColumns = mat.GetNumColumns();
+
+	for ( j = 0; j < numColumns; j += 8 ) {
+		__m256i mask = AVX2_LaneMask( Min( numColumns - j, 8 ) );
+		__m256 sum = _mm256_setzero_ps();
+
+		mPtr = mat.ToFloatPtr() + j;
+		for ( i = 0; i < numRows; i++ ) {
+			sum = _mm256_fmadd_ps( _mm256_maskload_ps( mPtr, mask ), _mm256_broadcast_ss( vPtr + i ), sum );
+			mPtr += numColumns;
+		}
+		if ( op > 0 ) {
+			sum = _mm256_add_ps( _mm256_maskload_ps( dstPtr + j, mask ), sum );
+		} else if ( op < 0 ) {
+			sum = _mm256_sub_ps( _mm256_maskload_ps( dstPtr + j, mask ), sum );
+		}
+		_mm256_maskstore_ps( dstPtr + j, mask, sum );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplyVecX
+
+	dst = mat * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_MultiplyVecX( dst, mat, vec, 0 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplyAddVecX
+
+	dst += mat * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_MultiplyVecX( dst, mat, vec, 1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplySubVecX
+
+	dst -= mat * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_MultiplyVecX( dst, mat, vec, -1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplyVecX
+
+	dst = mat.Transpose() * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_TransposeMultiplyVecX( dst, mat, vec, 0 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplyAddVecX
+
+	dst += mat.Transpose() * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_TransposeMultiplyVecX( dst, mat, vec, 1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplySubVecX
+
+	dst -= mat.Transpose() * vec
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	AVX2_TransposeMultiplyVecX( dst, mat, vec, -1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LowerTriangularSolve
+
+  solves x in Lx = b for the n * n sub-matrix of L
+  if skip > 0 the first skip elements of x are assumed to be valid already
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_LowerTriangularSolve( const idMatX &L, float *x, const float *b, const int n, int skip ) {
+	int i, nc;
+	const float *lptr;
+
+	if ( skip >= n ) {
+		return;
+	}
+
+	nc = L.GetNumColumns();
+	lptr = L.ToFloatPtr() + skip * nc;
+
+	for ( i = skip; i < n; i++ ) {
+		x[i] = b[i] - AVX2_Dot( lptr, x, i );
+		lptr += nc;
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LowerTriangularSolveTranspose
+
+  solves x in L'x = b for the n * n sub-matrix of L
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+
+  Every solved x[j] is subtracted from the elements above it with the contiguous
+  row j of L instead of walking the columns of L.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_LowerTriangularSolveTranspose( const idMatX &L, float *x, const float *b, const int n ) {
+	int i, j, nc;
+	const float *lptr;
+
+	if ( x != b ) {
+		memcpy( x, b, n * sizeof( float ) );
+	}
+
+	nc = L.GetNumColumns();
+
+	for ( j = n - 1; j > 0; j-- ) {
+		const __m256 xj = _mm256_broadcast_ss( x + j );
+
+		lptr = L.ToFloatPtr() + j * nc;
+		for ( i = 0; i + 8 <= j; i += 8 ) {
+			_mm256_storeu_ps( x + i, _mm256_fnmadd_ps( _mm256_loadu_ps( lptr + i ), xj, _mm256_loadu_ps( x + i ) ) );
+		}
+		if ( i < j ) {
+			__m256i mask = AVX2_LaneMask( j - i );
+			_mm256_maskstore_ps( x + i, mask, _mm256_fnmadd_ps( _mm256_maskload_ps( lptr + i, mask ), xj, _mm256_maskload_ps( x + i, mask ) ) );
+		}
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LDLTFactor
+
+  in-place factorization LDL' of the n * n sub-matrix of mat
+  the reciprocal of the diagonal elements are stored in invDiag
+============
+*/
+ID_AVX2_TARGET bool VPCALL idSIMD_AVX2::MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) {
+	int i, j, k, nc;
+	float *v, *diag, *mptr;
+	float sum, d;
+
+	v = (float *) _alloca16( n * sizeof( float ) );
+	diag = (float *) _alloca16( n * sizeof( float ) );
+
+	nc = mat.GetNumColumns();
+
+	for ( i = 0; i < n; i++ ) {
+
+		mptr = mat.ToFloatPtr() + i * nc;
+
+		// v[k] = diag[k] * mptr[k], sum = v * mptr
+		__m256 s = _mm256_setzero_ps();
+		for ( k = 0; k + 8 <= i; k += 8 ) {
+			__m256 m = _mm256_loadu_ps( mptr + k );
+			__m256 t = _mm256_mul_ps( _mm256_loadu_ps( diag + k ), m );
+			_mm256_storeu_ps( v + k, t );
+			s = _mm256_fmadd_ps( t, m, s );
+		}
+		if ( k < i ) {
+			__m256i mask = AVX2_LaneMask( i - k );
+			__m256 m = _mm256_maskload_ps( mptr + k, mask );
+			__m256 t = _mm256_mul_ps( _mm256_maskload_ps( diag + k, mask ), m );
+			_mm256_maskstore_ps( v + k, mask, t );
+			s = _mm256_fmadd_ps( t, m, s );
+		}
+		sum = mptr[i] - AVX2_HorizontalSum( s );
+
+		if ( sum == 0.0f ) {
+			_mm256_zeroupper();
+			return false;
+		}
+
+		mptr[i] = sum;
+		diag[i] = sum;
+		invDiag[i] = d = 1.0f / sum;
+
+		// column i of the rows below
+		for ( j = i + 1; j < n; j++ ) {
+			mptr = mat.ToFloatPtr() + j * nc;
+			mptr[i] = ( mptr[i] - AVX2_Dot( mptr, v, i ) ) * d;
+		}
+	}
+	_mm256_zeroupper();
+	return true;
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+
+  Slerps eight joints at a time with the math of idQuat::Slerp,
+  the joints are gathered through the index list and scattered back per lane.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	int i, j, n;
+	int lanes[8];
+	float out[7][8];
+
+	if ( lerp <= 0.0f ) {
+		return;
+	} else if ( lerp >= 1.0f ) {
+		for ( i = 0; i < numJoints; i++ ) {
+			joints[index[i]] = blendJoints[index[i]];
+		}
+		return;
+	}
+
+	const float *src0 = joints[0].q.ToFloatPtr();
+	const float *src1 = blendJoints[0].q.ToFloatPtr();
+	const __m256i stride = _mm256_set1_epi32( sizeof( idJointQuat ) / sizeof( float ) );
+	const __m256 signBit = _mm256_set1_ps( -0.0f );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 epsilon = _mm256_set1_ps( 1e-6f );
+	const __m256 scale1 = _mm256_set1_ps( lerp );
+	const __m256 scale0 = _mm256_set1_ps( 1.0f - lerp );
+
+	for ( i = 0; i < numJoints; i += 8 ) {
+		// the last batch repeats its last joint in the unused lanes
+		n = Min( numJoints - i, 8 );
+		for ( j = 0; j < 8; j++ ) {
+			lanes[j] = index[i + Min( j, n - 1 )];
+		}
+		__m256i offset = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) lanes ), stride );
+
+		__m256 qx0 = _mm256_i32gather_ps( src0 + 0, offset, 4 );
+		__m256 qy0 = _mm256_i32gather_ps( src0 + 1, offset, 4 );
+		__m256 qz0 = _mm256_i32gather_ps( src0 + 2, offset, 4 );
+		__m256 qw0 = _mm256_i32gather_ps( src0 + 3, offset, 4 );
+		__m256 tx0 = _mm256_i32gather_ps( src0 + 4, offset, 4 );
+		__m256 ty0 = _mm256_i32gather_ps( src0 + 5, offset, 4 );
+		__m256 tz0 = _mm256_i32gather_ps( src0 + 6, offset, 4 );
+
+		__m256 qx1 = _mm256_i32gather_ps( src1 + 0, offset, 4 );
+		__m256 qy1 = _mm256_i32gather_ps( src1 + 1, offset, 4 );
+		__m256 qz1 = _mm256_i32gather_ps( src1 + 2, offset, 4 );
+		__m256 qw1 = _mm256_i32gather_ps( src1 + 3, offset, 4 );
+		__m256 tx1 = _mm256_i32gather_ps( src1 + 4, offset, 4 );
+		__m256 ty1 = _mm256_i32gather_ps( src1 + 5, offset, 4 );
+		__m256 tz1 = _mm256_i32gather_ps( src1 + 6, offset, 4 );
+
+		// take the shortest path by negating the blend quaternion when cosom < 0
+		__m256 cosom = _mm256_mul_ps( qx0, qx1 );
+		cosom = _mm256_fmadd_ps( qy0, qy1, cosom );
+		cosom = _mm256_fmadd_ps( qz0, qz1, cosom );
+		cosom = _mm256_fmadd_ps( qw0, qw1, cosom );
+		__m256 sign = _mm256_and_ps( cosom, signBit );
+		cosom = _mm256_xor_ps( cosom, sign );
+		qx1 = _mm256_xor_ps( qx1, sign );
+		qy1 = _mm256_xor_ps( qy1, sign );
+		qz1 = _mm256_xor_ps( qz1, sign );
+		qw1 = _mm256_xor_ps( qw1, sign );
+
+		// the lanes that are too close together for the sine to be stable are lerped
+		__m256 sinSqr = _mm256_fnmadd_ps( cosom, cosom, one );
+		__m256 sinom = AVX2_InvSqrt( sinSqr );
+		__m256 omega = AVX2_ATanPositive( _mm256_mul_ps( sinSqr, sinom ), cosom );
+		__m256 s0 = _mm256_mul_ps( AVX2_SinZeroHalfPI( _mm256_mul_ps( scale0, omega ) ), sinom );
+		__m256 s1 = _mm256_mul_ps( AVX2_SinZeroHalfPI( _mm256_mul_ps( scale1, omega ) ), sinom );
+		__m256 slerp = _mm256_cmp_ps( _mm256_sub_ps( one, cosom ), epsilon, _CMP_GT_OQ );
+		s0 = _mm256_blendv_ps( scale0, s0, slerp );
+		s1 = _mm256_blendv_ps( scale1, s1, slerp );
+
+		_mm256_storeu_ps( out[0], _mm256_fmadd_ps( s0, qx0, _mm256_mul_ps( s1, qx1 ) ) );
+		_mm256_storeu_ps( out[1], _mm256_fmadd_ps( s0, qy0, _mm256_mul_ps( s1, qy1 ) ) );
+		_mm256_storeu_ps( out[2], _mm256_fmadd_ps( s0, qz0, _mm256_mul_ps( s1, qz1 ) ) );
+		_mm256_storeu_ps( out[3], _mm256_fmadd_ps( s0, qw0, _mm256_mul_ps( s1, qw1 ) ) );
+		_mm256_storeu_ps( out[4], _mm256_fmadd_ps( scale1, _mm256_sub_ps( tx1, tx0 ), tx0 ) );
+		_mm256_storeu_ps( out[5], _mm256_fmadd_ps( scale1, _mm256_sub_ps( ty1, ty0 ), ty0 ) );
+		_mm256_storeu_ps( out[6], _mm256_fmadd_ps( scale1, _mm256_sub_ps( tz1, tz0 ), tz0 ) );
+
+		for ( j = 0; j < n; j++ ) {
+			idJointQuat &joint = joints[lanes[j]];
+			joint.q.x = out[0][j];
+			joint.q.y = out[1][j];
+			joint.q.z = out[2][j];
+			joint.q.w = out[3][j];
+			joint.t.x = out[4][j];
+			joint.t.y = out[5][j];
+			joint.t.z = out[6][j];
+		}
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::TransformVerts
+
+  The first two rows of each joint matrix are accumulated in one 256 bit register,
+  the weighted rows are summed horizontally once per vertex.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	int i, j;
+	const byte *jointsPtr = (byte *)joints;
+
+	for( j = i = 0; i < numVerts; i++ ) {
+		const float *m = (const float *) ( jointsPtr + index[j*2+0] );
+		__m256 w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+		__m256 r01 = _mm256_mul_ps( _mm256_loadu_ps( m + 0 ), w );
+		__m128 r2 = _mm_mul_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ) );
+
+		while( index[j*2+1] == 0 ) {
+			j++;
+			m = (const float *) ( jointsPtr + index[j*2+0] );
+			w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+			r01 = _mm256_fmadd_ps( _mm256_loadu_ps( m + 0 ), w, r01 );
+			r2 = _mm_fmadd_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ), r2 );
+		}
+		j++;
+
+		__m128 xy = _mm_hadd_ps( _mm256_castps256_ps128( r01 ), _mm256_extractf128_ps( r01, 1 ) );
+		__m128 zz = _mm_hadd_ps( r2, r2 );
+		__m128 v = _mm_hadd_ps( xy, zz );
+
+		// only store three floats, the texture coordinates follow
+		float *dst = verts[i].xyz.ToFloatPtr();
+		_mm_storel_pi( (__m64 *) dst, v );
+		_mm_store_ss( dst + 2, _mm_movehl_ps( v, v ) );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::CullBoxes
+
+  Tests eight boxes at a time, the boxes left over are tested by the SSE version.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::CullBoxes( byte *cullBits, const idPlane *planes, const int numPlanes, const float *boxes, const int stride, const int numBoxes ) {
+	const __m256 signBit = _mm256_set1_ps( -0.0f );
+	const __m256 zero = _mm256_setzero_ps();
+	int i, j;
+
+	for ( i = 0; i + 8 <= numBoxes; i += 8 ) {
+		const float *b = boxes + i;
+		__m256 cx = _mm256_loadu_ps( b + 0 * stride );
+		__m256 cy = _mm256_loadu_ps( b + 1 * stride );
+		__m256 cz = _mm256_loadu_ps( b + 2 * stride );
+		__m256 ax = _mm256_loadu_ps( b + 3 * stride );
+		__m256 ay = _mm256_loadu_ps( b + 4 * stride );
+		__m256 az = _mm256_loadu_ps( b + 5 * stride );
+		__m256 bx = _mm256_loadu_ps( b + 6 * stride );
+		__m256 by = _mm256_loadu_ps( b + 7 * stride );
+		__m256 bz = _mm256_loadu_ps( b + 8 * stride );
+		__m256 dx = _mm256_loadu_ps( b + 9 * stride );
+		__m256 dy = _mm256_loadu_ps( b + 10 * stride );
+		__m256 dz = _mm256_loadu_ps( b + 11 * stride );
+		__m256 culled = zero;
+
+		for ( j = 0; j < numPlanes; j++ ) {
+			const float *p = planes[j].ToFloatPtr();
+			__m256 px = _mm256_broadcast_ss( p + 0 );
+			__m256 py = _mm256_broadcast_ss( p + 1 );
+			__m256 pz = _mm256_broadcast_ss( p + 2 );
+			__m256 pd = _mm256_broadcast_ss( p + 3 );
+
+			__m256 d = _mm256_fmadd_ps( pz, cz, _mm256_fmadd_ps( py, cy, _mm256_fmadd_ps( px, cx, pd ) ) );
+			__m256 e0 = _mm256_fmadd_ps( pz, az, _mm256_fmadd_ps( py, ay, _mm256_mul_ps( px, ax ) ) );
+			__m256 e1 = _mm256_fmadd_ps( pz, bz, _mm256_fmadd_ps( py, by, _mm256_mul_ps( px, bx ) ) );
+			__m256 e2 = _mm256_fmadd_ps( pz, dz, _mm256_fmadd_ps( py, dy, _mm256_mul_ps( px, dx ) ) );
+
+			d = _mm256_sub_ps( d, _mm256_andnot_ps( signBit, e0 ) );
+			d = _mm256_sub_ps( d, _mm256_andnot_ps( signBit, e1 ) );
+			d = _mm256_sub_ps( d, _mm256_andnot_ps( signBit, e2 ) );
+			culled = _mm256_or_ps( culled, _mm256_cmp_ps( d, zero, _CMP_GE_OQ ) );
+		}
+
+		int mask = _mm256_movemask_ps( culled );
+		for ( j = 0; j < 8; j++ ) {
+			cullBits[i+j] = ( mask >> j ) & 1;
+		}
+	}
+	_mm256_zeroupper();
+
+	if ( i < numBoxes ) {
+		idSIMD_SSE::CullBoxes( cullBits + i, planes, numPlanes, boxes + i, stride, numBoxes - i );
+	}
+}
+
+/*
+============
+AVX2_AddTangents
+============
+*/
+static ID_INLINE void AVX2_AddTangents( idDrawVert *v, bool &used, const idVec3 &n, const idVec3 &t0, const idVec3 &t1 ) {
+	if ( used ) {
+		v->normal += n;
+		v->tangents[0] += t0;
+		v->tangents[1] += t1;
+	} else {
+		v->normal = n;
+		v->tangents[0] = t0;
+		v->tangents[1] = t1;
+		used = true;
+	}
+}
+
+/*
+============
+idSIMD_AVX2::DeriveTangents
+
+	Derives the planes, normals and tangents of eight triangles at a time,
+	they are summed into the vertices in the same order as the generic version.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	int i, j, n, numTris;
+	int v0[8], v1[8], v2[8];
+	float out[10][8];
+
+	bool *used = (bool *)_alloca16( numVerts * sizeof( used[0] ) );
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+
+	const float *xyz = verts[0].xyz.ToFloatPtr();
+	const float *st = verts[0].st.ToFloatPtr();
+	const __m256i stride = _mm256_set1_epi32( sizeof( idDrawVert ) / sizeof( float ) );
+	const __m256 signBit = _mm256_set1_ps( -0.0f );
+	// keeps the reciprocal square root of degenerate triangles finite like idMath::RSqrt
+	const __m256 smallest = _mm256_set1_ps( 1e-30f );
+
+	numTris = numIndexes / 3;
+
+	for ( i = 0; i < numTris; i += 8 ) {
+		// the last batch repeats its last triangle in the unused lanes
+		n = Min( numTris - i, 8 );
+		for ( j = 0; j < 8; j++ ) {
+			const int *tri = indexes + ( i + Min( j, n - 1 ) ) * 3;
+			v0[j] = tri[0];
+			v1[j] = tri[1];
+			v2[j] = tri[2];
+		}
+		__m256i o0 = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) v0 ), stride );
+		__m256i o1 = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) v1 ), stride );
+		__m256i o2 = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) v2 ), stride );
+
+		__m256 ax = _mm256_i32gather_ps( xyz + 0, o0, 4 );
+		__m256 ay = _mm256_i32gather_ps( xyz + 1, o0, 4 );
+		__m256 az = _mm256_i32gather_ps( xyz + 2, o0, 4 );
+		__m256 as = _mm256_i32gather_ps( st + 0, o0, 4 );
+		__m256 at = _mm256_i32gather_ps( st + 1, o0, 4 );
+
+		__m256 d0x = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 0, o1, 4 ), ax );
+		__m256 d0y = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 1, o1, 4 ), ay );
+		__m256 d0z = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 2, o1, 4 ), az );
+		__m256 d0s = _mm256_sub_ps( _mm256_i32gather_ps( st + 0, o1, 4 ), as );
+		__m256 d0t = _mm256_sub_ps( _mm256_i32gather_ps( st + 1, o1, 4 ), at );
+
+		__m256 d1x = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 0, o2, 4 ), ax );
+		__m256 d1y = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 1, o2, 4 ), ay );
+		__m256 d1z = _mm256_sub_ps( _mm256_i32gather_ps( xyz + 2, o2, 4 ), az );
+		__m256 d1s = _mm256_sub_ps( _mm256_i32gather_ps( st + 0, o2, 4 ), as );
+		__m256 d1t = _mm256_sub_ps( _mm256_i32gather_ps( st + 1, o2, 4 ), at );
+
+		// normal
+		__m256 nx = _mm256_fmsub_ps( d1y, d0z, _mm256_mul_ps( d1z, d0y ) );
+		__m256 ny = _mm256_fmsub_ps( d1z, d0x, _mm256_mul_ps( d1x, d0z ) );
+		__m256 nz = _mm256_fmsub_ps( d1x, d0y, _mm256_mul_ps( d1y, d0x ) );
+		__m256 f = _mm256_fmadd_ps( nz, nz, _mm256_fmadd_ps( ny, ny, _mm256_mul_ps( nx, nx ) ) );
+		f = AVX2_InvSqrt( _mm256_max_ps( f, smallest ) );
+		nx = _mm256_mul_ps( nx, f );
+		ny = _mm256_mul_ps( ny, f );
+		nz = _mm256_mul_ps( nz, f );
+
+		_mm256_storeu_ps( out[0], nx );
+		_mm256_storeu_ps( out[1], ny );
+		_mm256_storeu_ps( out[2], nz );
+		_mm256_storeu_ps( out[3], _mm256_fmadd_ps( nz, az, _mm256_fmadd_ps( ny, ay, _mm256_mul_ps( nx, ax ) ) ) );
+
+		// area sign bit
+		__m256 area = _mm256_fmsub_ps( d0s, d1t, _mm256_mul_ps( d0t, d1s ) );
+		__m256 sign = _mm256_and_ps( area, signBit );
+
+		// first tangent
+		__m256 tx = _mm256_fmsub_ps( d0x, d1t, _mm256_mul_ps( d0t, d1x ) );
+		__m256 ty = _mm256_fmsub_ps( d0y, d1t, _mm256_mul_ps( d0t, d1y ) );
+		__m256 tz = _mm256_fmsub_ps( d0z, d1t, _mm256_mul_ps( d0t, d1z ) );
+		f = _mm256_fmadd_ps( tz, tz, _mm256_fmadd_ps( ty, ty, _mm256_mul_ps( tx, tx ) ) );
+		f = _mm256_xor_ps( AVX2_InvSqrt( _mm256_max_ps( f, smallest ) ), sign );
+
+		_mm256_storeu_ps( out[4], _mm256_mul_ps( tx, f ) );
+		_mm256_storeu_ps( out[5], _mm256_mul_ps( ty, f ) );
+		_mm256_storeu_ps( out[6], _mm256_mul_ps( tz, f ) );
+
+		// second tangent
+		tx = _mm256_fmsub_ps( d0s, d1x, _mm256_mul_ps( d0x, d1s ) );
+		ty = _mm256_fmsub_ps( d0s, d1y, _mm256_mul_ps( d0y, d1s ) );
+		tz = _mm256_fmsub_ps( d0s, d1z, _mm256_mul_ps( d0z, d1s ) );
+		f = _mm256_fmadd_ps( tz, tz, _mm256_fmadd_ps( ty, ty, _mm256_mul_ps( tx, tx ) ) );
+		f = _mm256_xor_ps( AVX2_InvSqrt( _mm256_max_ps( f, smallest ) ), sign );
+
+		_mm256_storeu_ps( out[7], _mm256_mul_ps( tx, f ) );
+		_mm256_storeu_ps( out[8], _mm256_mul_ps( ty, f ) );
+		_mm256_storeu_ps( out[9], _mm256_mul_ps( tz, f ) );
+
+		for ( j = 0; j < n; j++ ) {
+			idVec3 normal( out[0][j], out[1][j], out[2][j] );
+			idVec3 t0( out[4][j], out[5][j], out[6][j] );
+			idVec3 t1( out[7][j], out[8][j], out[9][j] );
+
+			planes[i+j].SetNormal( normal );
+			planes[i+j].SetDist( out[3][j] );
+
+			AVX2_AddTangents( verts + v0[j], used[v0[j]], normal, t0, t1 );
+			AVX2_AddTangents( verts + v1[j], used[v1[j]], normal, t0, t1 );
+			AVX2_AddTangents( verts + v2[j], used[v2[j]], normal, t0, t1 );
+		}
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::CreateShadowCache
+
+  Eight entries of vertRemap are tested at a time so runs of vertices
+  that are already cached are skipped quickly.
+============
+*/
+ID_AVX2_TARGET int VPCALL idSIMD_AVX2::CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	const __m128 light = _mm_setr_ps( lightOrigin[0], lightOrigin[1], lightOrigin[2], 0.0f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	int i, j, n, outVerts = 0;
+
+	for ( i = 0; i < numVerts; i += 8 ) {
+		n = Min( numVerts - i, 8 );
+		__m256i remap = _mm256_maskload_epi32( vertRemap + i, AVX2_LaneMask( n ) );
+		int mask = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( remap, _mm256_setzero_si256() ) ) ) & ( ( 1 << n ) - 1 );
+
+		for ( j = 0; mask != 0; j++, mask >>= 1 ) {
+			if ( !( mask & 1 ) ) {
+				continue;
+			}
+			// the fourth float read is the first texture coordinate which is replaced
+			__m128 v = _mm_loadu_ps( verts[i+j].xyz.ToFloatPtr() );
+			__m128 v0 = _mm_blend_ps( v, one, 8 );
+			__m128 v1 = _mm_blend_ps( _mm_sub_ps( v, light ), zero, 8 );
+			_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), _mm256_insertf128_ps( _mm256_castps128_ps256( v0 ), v1, 1 ) );
+			vertRemap[i+j] = outVerts;
+			outVerts += 2;
+		}
+	}
+	_mm256_zeroupper();
+	return outVerts;
+}
+
+/*
+============
+idSIMD_AVX2::CreateVertexProgramShadowCache
+============
+*/
+ID_AVX2_TARGET int VPCALL idSIMD_AVX2::CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) {
+	const __m256 w = _mm256_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f );
+
+	for ( int i = 0; i < numVerts; i++ ) {
+		// the fourth float read is the first texture coordinate which is replaced
+		__m256 v = _mm256_broadcast_ps( (const __m128 *) verts[i].xyz.ToFloatPtr() );
+		_mm256_storeu_ps( vertexCache[i*2].ToFloatPtr(), _mm256_blend_ps( v, w, 0x88 ) );
+	}
+	_mm256_zeroupper();
+	return numVerts * 2;
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerMono
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	// four samples for the left and right speaker at a time
+	const __m256 inc = _mm256_setr_ps( incL, incR, incL, incR, incL, incR, incL, incR );
+	const __m256 step = _mm256_mul_ps( inc, _mm256_set1_ps( 4.0f ) );
+	__m256 scale = _mm256_setr_ps( lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1] );
+	scale = _mm256_fmadd_ps( _mm256_setr_ps( 0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f ), inc, scale );
+
+	for( int j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		__m128 s = _mm_loadu_ps( samples + j );
+		__m256 s2 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_unpacklo_ps( s, s ) ), _mm_unpackhi_ps( s, s ), 1 );
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( s2, scale, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		scale = _mm256_add_ps( scale, step );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerStereo
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	// four samples for the left and right speaker at a time
+	const __m256 inc = _mm256_setr_ps( incL, incR, incL, incR, incL, incR, incL, incR );
+	const __m256 step = _mm256_mul_ps( inc, _mm256_set1_ps( 4.0f ) );
+	__m256 scale = _mm256_setr_ps( lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1] );
+	scale = _mm256_fmadd_ps( _mm256_setr_ps( 0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f ), inc, scale );
+
+	for( int j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( _mm256_loadu_ps( samples + j*2 ), scale, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		scale = _mm256_add_ps( scale, step );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+AVX2_MixSoundSixSpeaker
+
+  mixes four samples into the six speakers at a time, the 24 floats are spread over
+  three registers and permute selects the sample that goes with every speaker
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void AVX2_MixSoundSixSpeaker( float *mixBuffer, const float *samples, const int sampleStride, const float lastV[6], const float currentV[6], const int permute[3][8] ) {
+	float inc[6], scale[24], step[24];
+	int i, j;
+
+	for ( i = 0; i < 6; i++ ) {
+		inc[i] = ( currentV[i] - lastV[i] ) / MIXBUFFER_SAMPLES;
+	}
+	for ( i = 0; i < 24; i++ ) {
+		scale[i] = lastV[i % 6] + ( i / 6 ) * inc[i % 6];
+		step[i] = 4.0f * inc[i % 6];
+	}
+
+	const __m256i p0 = _mm256_loadu_si256( (const __m256i *) permute[0] );
+	const __m256i p1 = _mm256_loadu_si256( (const __m256i *) permute[1] );
+	const __m256i p2 = _mm256_loadu_si256( (const __m256i *) permute[2] );
+	const __m256 step0 = _mm256_loadu_ps( step + 0 );
+	const __m256 step1 = _mm256_loadu_ps( step + 8 );
+	const __m256 step2 = _mm256_loadu_ps( step + 16 );
+	__m256 scale0 = _mm256_loadu_ps( scale + 0 );
+	__m256 scale1 = _mm256_loadu_ps( scale + 8 );
+	__m256 scale2 = _mm256_loadu_ps( scale + 16 );
+
+	for ( j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		__m256 s;
+		if ( sampleStride == 1 ) {
+			s = _mm256_castps128_ps256( _mm_loadu_ps( samples + j ) );
+		} else {
+			s = _mm256_loadu_ps( samples + j*2 );
+		}
+		float *mix = mixBuffer + j*6;
+		_mm256_storeu_ps( mix + 0, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, p0 ), scale0, _mm256_loadu_ps( mix + 0 ) ) );
+		_mm256_storeu_ps( mix + 8, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, p1 ), scale1, _mm256_loadu_ps( mix + 8 ) ) );
+		_mm256_storeu_ps( mix + 16, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, p2 ), scale2, _mm256_loadu_ps( mix + 16 ) ) );
+		scale0 = _mm256_add_ps( scale0, step0 );
+		scale1 = _mm256_add_ps( scale1, step1 );
+		scale2 = _mm256_add_ps( scale2, step2 );
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerMono
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundSixSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	static const int permute[3][8] = {
+		{ 0, 0, 0, 0, 0, 0, 1, 1 },
+		{ 1, 1, 1, 1, 2, 2, 2, 2 },
+		{ 2, 2, 3, 3, 3, 3, 3, 3 }
+	};
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, 1, lastV, currentV, permute );
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerStereo
+
+  the left sample goes to speakers 0, 2, 3 and 4, the right sample to speakers 1 and 5
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundSixSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	static const int permute[3][8] = {
+		{ 0, 1, 0, 0, 0, 1, 2, 3 },
+		{ 2, 2, 2, 3, 4, 5, 4, 4 },
+		{ 4, 5, 6, 7, 6, 6, 6, 7 }
+	};
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, 2, lastV, currentV, permute );
+}
+
+/*
+============
+idSIMD_AVX2::MixedSoundToSamples
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples ) {
+	const __m256 minSample = _mm256_set1_ps( -32768.0f );
+	const __m256 maxSample = _mm256_set1_ps( 32767.0f );
+	int i;
+
+	for ( i = 0; i + 16 <= numSamples; i += 16 ) {
+		__m256 m0 = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( mixBuffer + i + 0 ), minSample ), maxSample );
+		__m256 m1 = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( mixBuffer + i + 8 ), minSample ), maxSample );
+		// the pack works per 128 bit lane so the quadwords are put back in order
+		__m256i s = _mm256_packs_epi32( _mm256_cvttps_epi32( m0 ), _mm256_cvttps_epi32( m1 ) );
+		_mm256_storeu_si256( (__m256i *) ( samples + i ), _mm256_permute4x64_epi64( s, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+	}
+	_mm256_zeroupper();
+
+	for ( ; i < numSamples; i++ ) {
+		if ( mixBuffer[i] <= -32768.0f ) {
+			samples[i] = -32768;
+		} else if ( mixBuffer[i] >= 32767.0f ) {
+			samples[i] = 32767;
+		} else {
+			samples[i] = (short) mixBuffer[i];
+		}
+	}
+}
+
+#endif /* ID_AVX2_INTRINSICS */
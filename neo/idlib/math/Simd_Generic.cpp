@@ -2253,6 +2253,38 @@ void VPCALL idSIMD_Generic::BlendJoints( idJointQuat *joints, const idJointQuat
 	}
 }
 
+/*
+============
+idSIMD_Generic::DecompressJoints
+============
+*/
+void VPCALL idSIMD_Generic::DecompressJoints( idJointQuat *joints, const unsigned short *components, const float *scale, const float *bias, const int *jointIndex, const int numTranslations, const int numRotations ) {
+	int i, t, r;
+
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	r = ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+
+	for ( i = 0; i < numTranslations; i++ ) {
+		idVec3 &v = joints[jointIndex[i]].t;
+		v.x = bias[0 * t + i] + scale[0 * t + i] * (float) components[0 * t + i];
+		v.y = bias[1 * t + i] + scale[1 * t + i] * (float) components[1 * t + i];
+		v.z = bias[2 * t + i] + scale[2 * t + i] * (float) components[2 * t + i];
+	}
+
+	jointIndex += t;
+	components += 3 * t;
+	scale += 3 * t;
+	bias += 3 * t;
+
+	for ( i = 0; i < numRotations; i++ ) {
+		idQuat &q = joints[jointIndex[i]].q;
+		q.x = bias[0 * r + i] + scale[0 * r + i] * (float) components[0 * r + i];
+		q.y = bias[1 * r + i] + scale[1 * r + i] * (float) components[1 * r + i];
+		q.z = bias[2 * r + i] + scale[2 * r + i] * (float) components[2 * r + i];
+		q.w = q.CalcW();
+	}
+}
+
 /*
 ============
 idSIMD_Generic::ConvertJointQuatsToJointMats
@@ -2437,6 +2469,46 @@ void VPCALL idSIMD_Generic::OverlayPointCull( byte *cullBits, idVec2 *texCoords,
 	}
 }
 
+/*
+============
+idSIMD_Generic::CullBoxes
+
+  A box is culled by a plane if the distance of the center minus the
+  projected half extents is still positive, which is the same as all
+  eight corners being on the front side.
+============
+*/
+void VPCALL idSIMD_Generic::CullBoxes( byte *cullBits, const idPlane *planes, const int numPlanes, const float *boxes, const int stride, const int numBoxes ) {
+	int i, j;
+
+	const float *cx = boxes + 0 * stride;
+	const float *cy = boxes + 1 * stride;
+	const float *cz = boxes + 2 * stride;
+	const float *ax = boxes + 3 * stride;
+	const float *ay = boxes + 4 * stride;
+	const float *az = boxes + 5 * stride;
+	const float *bx = boxes + 6 * stride;
+	const float *by = boxes + 7 * stride;
+	const float *bz = boxes + 8 * stride;
+	const float *dx = boxes + 9 * stride;
+	const float *dy = boxes + 10 * stride;
+	const float *dz = boxes + 11 * stride;
+
+	for ( i = 0; i < numBoxes; i++ ) {
+		byte culled = 0;
+		for ( j = 0; j < numPlanes; j++ ) {
+			const idPlane &p = planes[j];
+			float d = p[0] * cx[i] + p[1] * cy[i] + p[2] * cz[i] + p[3];
+			float e0 = p[0] * ax[i] + p[1] * ay[i] + p[2] * az[i];
+			float e1 = p[0] * bx[i] + p[1] * by[i] + p[2] * bz[i];
+			float e2 = p[0] * dx[i] + p[1] * dy[i] + p[2] * dz[i];
+			d = d - idMath::Fabs( e0 ) - idMath::Fabs( e1 ) - idMath::Fabs( e2 );
+			culled |= ( d >= 0.0f );
+		}
+		cullBits[i] = culled;
+	}
+}
+
 /*
 ============
 idSIMD_Generic::DeriveTriPlanes
@@ -18085,3 +18085,72 @@ void VPCALL idSIMD_SSE::MixedSoundToSamples( short *samples, const float *mixBuf
 }
 
 #endif /* _WIN32 */
+
+#if defined(ID_SSE_INTRINSICS)
+
+#include <xmmintrin.h>
+
+/*
+============
+idSIMD_SSE::CullBoxes
+
+  Tests four boxes at a time, same operation order as the generic version.
+============
+*/
+void VPCALL idSIMD_SSE::CullBoxes( byte *cullBits, const idPlane *planes, const int numPlanes, const float *boxes, const int stride, const int numBoxes ) {
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 zero = _mm_setzero_ps();
+
+	assert( ( stride & 3 ) == 0 );
+	assert( ( ((size_t)boxes) & 15 ) == 0 );
+
+	for ( int i = 0; i < numBoxes; i += 4 ) {
+		const float *b = boxes + i;
+		__m128 cx = _mm_load_ps( b + 0 * stride );
+		__m128 cy = _mm_load_ps( b + 1 * stride );
+		__m128 cz = _mm_load_ps( b + 2 * stride );
+		__m128 ax = _mm_load_ps( b + 3 * stride );
+		__m128 ay = _mm_load_ps( b + 4 * stride );
+		__m128 az = _mm_load_ps( b + 5 * stride );
+		__m128 bx = _mm_load_ps( b + 6 * stride );
+		__m128 by = _mm_load_ps( b + 7 * stride );
+		__m128 bz = _mm_load_ps( b + 8 * stride );
+		__m128 dx = _mm_load_ps( b + 9 * stride );
+		__m128 dy = _mm_load_ps( b + 10 * stride );
+		__m128 dz = _mm_load_ps( b + 11 * stride );
+		__m128 culled = zero;
+
+		for ( int j = 0; j < numPlanes; j++ ) {
+			const float *p = planes[j].ToFloatPtr();
+			__m128 px = _mm_load1_ps( p + 0 );
+			__m128 py = _mm_load1_ps( p + 1 );
+			__m128 pz = _mm_load1_ps( p + 2 );
+			__m128 pd = _mm_load1_ps( p + 3 );
+
+			__m128 d = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, cx ), _mm_mul_ps( py, cy ) ), _mm_mul_ps( pz, cz ) ), pd );
+			__m128 e0 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, ax ), _mm_mul_ps( py, ay ) ), _mm_mul_ps( pz, az ) );
+			__m128 e1 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, bx ), _mm_mul_ps( py, by ) ), _mm_mul_ps( pz, bz ) );
+			__m128 e2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, dx ), _mm_mul_ps( py, dy ) ), _mm_mul_ps( pz, dz ) );
+
+			d = _mm_sub_ps( d, _mm_andnot_ps( signBit, e0 ) );
+			d = _mm_sub_ps( d, _mm_andnot_ps( signBit, e1 ) );
+			d = _mm_sub_ps( d, _mm_andnot_ps( signBit, e2 ) );
+			culled = _mm_or_ps( culled, _mm_cmpge_ps( d, zero ) );
+		}
+
+		int mask = _mm_movemask_ps( culled );
+		int n = numBoxes - i;
+		cullBits[i+0] = ( mask >> 0 ) & 1;
+		if ( n > 1 ) {
+			cullBits[i+1] = ( mask >> 1 ) & 1;
+		}
+		if ( n > 2 ) {
+			cullBits[i+2] = ( mask >> 2 ) & 1;
+		}
+		if ( n > 3 ) {
+			cullBits[i+3] = ( mask >> 3 ) & 1;
+		}
+	}
+}
+
+#endif /* ID_SSE_INTRINSICS */
@@ -29,6 +29,11 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __MATH_SIMD_SSE_H__
 #define __MATH_SIMD_SSE_H__
 
+// routines written with compiler intrinsics instead of inline assembly
+#if defined(_MSC_VER) || defined(__SSE__)
+#define ID_SSE_INTRINSICS
+#endif
+
 /*
 ===============================================================================
 
@@ -138,6 +143,10 @@ public:
 	virtual void VPCALL MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples );
 
 #endif
+
+#if defined(ID_SSE_INTRINSICS)
+	virtual void VPCALL CullBoxes( byte *cullBits, const idPlane *planes, const int numPlanes, const float *boxes, const int stride, const int numBoxes );
+#endif
 };
 
 #endif /* !__MATH_SIMD_SSE_H__ */
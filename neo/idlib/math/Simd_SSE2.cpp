@@ -875,3 +875,75 @@ void VPCALL idSIMD_SSE2::MixedSoundToSamples( short *samples, const float *mixBu
 }
 
 #endif /* _WIN32 */
+
+#if defined(ID_SSE2_INTRINSICS)
+
+#include <emmintrin.h>
+
+/*
+============
+SSE2_Dequantize4
+============
+*/
+static ID_INLINE __m128 SSE2_Dequantize4( const unsigned short *components, const float *scale, const float *bias ) {
+	__m128i c = _mm_unpacklo_epi16( _mm_loadl_epi64( (const __m128i *) components ), _mm_setzero_si128() );
+	return _mm_add_ps( _mm_loadu_ps( bias ), _mm_mul_ps( _mm_loadu_ps( scale ), _mm_cvtepi32_ps( c ) ) );
+}
+
+/*
+============
+idSIMD_SSE2::DecompressJoints
+
+  Dequantizes four lanes at a time and transposes them into the joints,
+  same operation order as the generic version.
+============
+*/
+void VPCALL idSIMD_SSE2::DecompressJoints( idJointQuat *joints, const unsigned short *components, const float *scale, const float *bias, const int *jointIndex, const int numTranslations, const int numRotations ) {
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	int i, j, n, t, r;
+
+	t = ( numTranslations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+	r = ( numRotations + JOINT_SOA_LANES - 1 ) & ~( JOINT_SOA_LANES - 1 );
+
+	for ( i = 0; i < numTranslations; i += 4 ) {
+		__m128 x = SSE2_Dequantize4( components + 0 * t + i, scale + 0 * t + i, bias + 0 * t + i );
+		__m128 y = SSE2_Dequantize4( components + 1 * t + i, scale + 1 * t + i, bias + 1 * t + i );
+		__m128 z = SSE2_Dequantize4( components + 2 * t + i, scale + 2 * t + i, bias + 2 * t + i );
+		__m128 w = _mm_setzero_ps();
+
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+
+		__m128 v[4] = { x, y, z, w };
+		n = Min( numTranslations - i, 4 );
+		for ( j = 0; j < n; j++ ) {
+			// idVec3 is followed by the next joint so only store three floats
+			float *dst = joints[jointIndex[i + j]].t.ToFloatPtr();
+			_mm_storel_pi( (__m64 *) dst, v[j] );
+			_mm_store_ss( dst + 2, _mm_movehl_ps( v[j], v[j] ) );
+		}
+	}
+
+	jointIndex += t;
+	components += 3 * t;
+	scale += 3 * t;
+	bias += 3 * t;
+
+	for ( i = 0; i < numRotations; i += 4 ) {
+		__m128 x = SSE2_Dequantize4( components + 0 * r + i, scale + 0 * r + i, bias + 0 * r + i );
+		__m128 y = SSE2_Dequantize4( components + 1 * r + i, scale + 1 * r + i, bias + 1 * r + i );
+		__m128 z = SSE2_Dequantize4( components + 2 * r + i, scale + 2 * r + i, bias + 2 * r + i );
+		__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+		__m128 w = _mm_sqrt_ps( _mm_andnot_ps( signBit, _mm_sub_ps( one, d ) ) );
+
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+
+		__m128 v[4] = { x, y, z, w };
+		n = Min( numRotations - i, 4 );
+		for ( j = 0; j < n; j++ ) {
+			_mm_storeu_ps( joints[jointIndex[i + j]].q.ToFloatPtr(), v[j] );
+		}
+	}
+}
+
+#endif /* ID_SSE2_INTRINSICS */
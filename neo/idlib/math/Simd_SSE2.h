@@ -29,6 +29,11 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __MATH_SIMD_SSE2_H__
 #define __MATH_SIMD_SSE2_H__
 
+// routines written with compiler intrinsics instead of inline assembly
+#if defined(_MSC_VER) || defined(__SSE2__)
+#define ID_SSE2_INTRINSICS
+#endif
+
 /*
 ===============================================================================
 
@@ -52,6 +57,10 @@ public:
 	virtual void VPCALL MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples );
 
 #endif
+
+#if defined(ID_SSE2_INTRINSICS)
+	virtual void VPCALL DecompressJoints( idJointQuat *joints, const unsigned short *components, const float *scale, const float *bias, const int *jointIndex, const int numTranslations, const int numRotations );
+#endif
 };
 
 #endif /* !__MATH_SIMD_SSE2_H__ */
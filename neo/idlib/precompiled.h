@@ -103,6 +103,7 @@ If you have questions concerning this license or the applicable additional terms
 #include <typeinfo>
 #include <errno.h>
 #include <math.h>
+#include <stdint.h>
 #include <SDL/SDL.h>
 
 //-----------------------------------------------------
@@ -123,6 +124,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "../framework/File.h"
 #include "../framework/FileSystem.h"
 #include "../framework/UsercmdGen.h"
+#include "../framework/JobSystem.h"
 
 // decls
 #include "../framework/DeclManager.h"
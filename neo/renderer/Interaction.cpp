@@ -449,6 +449,7 @@ idInteraction::idInteraction( void ) {
 	dynamicModelFrameCount	= 0;
 	frustumState			= FRUSTUM_UNINITIALIZED;
 	frustumAreas			= NULL;
+	shadowScissorViewCount	= -1;
 }
 
 /*
@@ -477,6 +478,8 @@ idInteraction *idInteraction::AllocAndLink( idRenderEntityLocal *edef, idRenderL
 	interaction->frustumState = idInteraction::FRUSTUM_UNINITIALIZED;
 	interaction->frustumAreas = NULL;
 
+	interaction->shadowScissorViewCount = -1;
+
 	// link at the start of the entity's list
 	interaction->lightNext = ldef->firstInteraction;
 	interaction->lightPrev = NULL;
@@ -519,6 +522,11 @@ will be regenerated automatically
 */
 void idInteraction::FreeSurfaces( void ) {
 	if ( this->surfaces ) {
+		// the shadow cache may take over the shadow volumes
+		if ( this->entityDef ) {
+			R_StoreCachedShadows( this );
+		}
+
 		for ( int i = 0 ; i < this->numSurfaces ; i++ ) {
 			surfaceInteraction_t *sint = &this->surfaces[i];
 
@@ -836,6 +844,9 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 		return;
 	}
 
+	// shadow volumes from a previous interaction of the same light and entity
+	shadowCacheEntry_s *cachedShadows = R_FindCachedShadows( this );
+
 	// use the turbo shadow path
 	shadowGen_t shadowGen = SG_DYNAMIC;
 
@@ -910,8 +921,11 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 			// if the light has an optimized shadow volume, don't create shadows for any models that are part of the base areas
 			if ( lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool() ) {
 
-				// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
-				sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
+				sint->shadowTris = R_TakeCachedShadow( cachedShadows, c, tri );
+				if ( !sint->shadowTris ) {
+					// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
+					sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
+				}
 				if ( sint->shadowTris ) {
 					if ( shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
 						// if any surface is a shadow-casting perforated or translucent surface, or the
@@ -931,6 +945,8 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 		}
 	}
 
+	R_ReleaseCachedShadows( cachedShadows );
+
 	// if none of the surfaces generated anything, don't even bother checking?
 	if ( !interactionGenerated ) {
 		MakeEmpty();
@@ -1010,6 +1026,62 @@ static bool R_PotentiallyInsideInfiniteShadow( const srfTriangles_t *occluder,
 	return false;
 }
 
+/*
+==================
+idInteraction::CalcShadowScissorRectangle
+
+Returns an empty rectangle if the interaction is culled
+==================
+*/
+idScreenRect idInteraction::CalcShadowScissorRectangle( void ) {
+	idScreenRect	rect;
+
+	// try to cull the interaction
+	// this will also cull the case where the light origin is inside the
+	// view frustum and the entity bounds are outside the view frustum
+	if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
+		rect.Clear();
+		return rect;
+	}
+
+	// calculate the shadow scissor rectangle
+	return CalcInteractionScissorRectangle( tr.viewDef->viewFrustum );
+}
+
+/*
+==================
+idInteraction::PrepareShadowScissor
+
+Does the view frustum culling of AddActiveInteraction up front, so
+it can be spread over the light jobs. Interactions without shadows
+and static world models use the entity or light scissor rectangle,
+which are cheap and may still change before the interaction is added.
+
+The areas touched by the interaction frustum are flooded only once,
+through the area reference block allocator, which grows from the engine
+heap. An interaction still without areas is left to AddActiveInteraction
+on the main thread.
+==================
+*/
+void idInteraction::PrepareShadowScissor( void ) {
+	if ( !HasShadows() || entityDef->parms.hModel->IsStaticWorldModel() ) {
+		return;
+	}
+
+	if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
+		viewShadowScissor.Clear();
+		shadowScissorViewCount = tr.viewCount;
+		return;
+	}
+
+	if ( r_useInteractionScissors.GetInteger() > 1 && frustumState == idInteraction::FRUSTUM_VALID ) {
+		return;
+	}
+
+	viewShadowScissor = CalcInteractionScissorRectangle( tr.viewDef->viewFrustum );
+	shadowScissorViewCount = tr.viewCount;
+}
+
 /*
 ==================
 idInteraction::AddActiveInteraction
@@ -1044,17 +1116,14 @@ void idInteraction::AddActiveInteraction( void ) {
 		// use the light scissor rectangle
 		shadowScissor = vLight->scissorRect;
 
-	} else {
+	// the light jobs may already have culled the interaction for this view
+	} else if ( shadowScissorViewCount == tr.viewCount ) {
 
-		// try to cull the interaction
-		// this will also cull the case where the light origin is inside the
-		// view frustum and the entity bounds are outside the view frustum
-		if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
-			return;
-		}
+		shadowScissor = viewShadowScissor;
+
+	} else {
 
-		// calculate the shadow scissor rectangle
-		shadowScissor = CalcInteractionScissorRectangle( tr.viewDef->viewFrustum );
+		shadowScissor = CalcShadowScissorRectangle();
 	}
 
 	// get out before making the dynamic model if the shadow scissor rectangle is empty
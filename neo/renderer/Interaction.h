@@ -146,6 +146,11 @@ public:
 	// calls R_LinkLightSurf() for each one
 	void					AddActiveInteraction( void );
 
+	// culls the interaction against the view frustum and calculates the shadow scissor
+	// rectangle ahead of AddActiveInteraction, this may run in a job as long as no other
+	// thread touches the same interaction
+	void					PrepareShadowScissor( void );
+
 private:
 	enum {
 		FRUSTUM_UNINITIALIZED,
@@ -158,6 +163,9 @@ private:
 
 	int						dynamicModelFrameCount;	// so we can tell if a callback model animated
 
+	int						shadowScissorViewCount;	// tr.viewCount when viewShadowScissor was calculated
+	idScreenRect			viewShadowScissor;		// empty if the interaction is culled
+
 private:
 	// actually create the interaction
 	void					CreateInteraction( const idRenderModel *model );
@@ -172,6 +180,9 @@ private:
 	// determine the minimum scissor rect that will include the interaction shadows
 	// projected to the bounds of the light
 	idScreenRect			CalcInteractionScissorRectangle( const idFrustum &viewFrustum );
+
+	// culls and calculates the shadow scissor rectangle for the current view
+	idScreenRect			CalcShadowScissorRectangle( void );
 };
 
 
@@ -143,7 +143,10 @@ public:
 								~idMD5Mesh();
 
  	void						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints );
-	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf );
+	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, const idMaterial *surfaceShader, modelSurface_t *surf );
+								// transforms the vertexes of a surface set up by UpdateSurface, this does not
+								// allocate or touch any shared data so it can run in a job
+	void						SkinSurface( srfTriangles_t *tri, const idJointMat *joints, float skinScale, bool deriveTangents, idVec4 *scratchWeights ) const;
 	idBounds					CalcBounds( const idJointMat *joints );
 	int							NearestJoint( int a, int b, int c ) const;
 	int							NumVerts( void ) const;
@@ -160,8 +163,9 @@ private:
 	struct deformInfo_s *		deformInfo;			// used to create srfTriangles_t from base frames and new vertexes
 	int							surfaceNum;			// number of the static surface created for this mesh
 
-	void						TransformVerts( idDrawVert *verts, const idJointMat *joints );
-	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale );
+	srfTriangles_t *			SetupSurface( modelSurface_t *surf, bool allocFacePlanes );
+	void						TransformVerts( idDrawVert *verts, const idJointMat *joints ) const;
+	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale, idVec4 *scratchWeights ) const;
 };
 
 class idRenderModelMD5 : public idRenderModelStatic {
@@ -34,6 +34,26 @@ If you have questions concerning this license or the applicable additional terms
 
 static const char *MD5_SnapshotName = "_MD5_Snapshot_";
 
+// surfaces queued for the skinning jobs between R_BeginDeferredSkinning and R_EndDeferredSkinning
+typedef struct {
+	const idMD5Mesh *		mesh;
+	const idJointMat *		joints;
+	srfTriangles_t *		tri;
+	float					skinScale;
+	bool					deriveTangents;
+} md5SkinSurface_t;
+
+// the model bounds can only be calculated once the surfaces are skinned
+typedef struct {
+	idRenderModelStatic *	model;
+	int						firstSurface;
+	int						numSurfaces;
+} md5SkinModel_t;
+
+static bool							md5DeferSkinning = false;
+static idList<md5SkinSurface_t>		md5SkinSurfaces;
+static idList<md5SkinModel_t>		md5SkinModels;
+
 
 /***********************************************************************
 
@@ -250,7 +270,7 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 idMD5Mesh::TransformVerts
 ====================
 */
-void idMD5Mesh::TransformVerts( idDrawVert *verts, const idJointMat *entJoints ) {
+void idMD5Mesh::TransformVerts( idDrawVert *verts, const idJointMat *entJoints ) const {
 	SIMDProcessor->TransformVerts( verts, texCoords.Num(), entJoints, scaledWeights, weightIndex, numWeights );
 }
 
@@ -259,21 +279,26 @@ void idMD5Mesh::TransformVerts( idDrawVert *verts, const idJointMat *entJoints )
 idMD5Mesh::TransformScaledVerts
 
 Special transform to make the mesh seem fat or skinny.  May be used for zombie deaths
+scratchWeights must hold numWeights weights.
 ====================
 */
-void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJoints, float scale ) {
-	idVec4 *scaledWeights = (idVec4 *) _alloca16( numWeights * sizeof( scaledWeights[0] ) );
-	SIMDProcessor->Mul( scaledWeights[0].ToFloatPtr(), scale, scaledWeights[0].ToFloatPtr(), numWeights * 4 );
-	SIMDProcessor->TransformVerts( verts, texCoords.Num(), entJoints, scaledWeights, weightIndex, numWeights );
+void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJoints, float scale, idVec4 *scratchWeights ) const {
+	SIMDProcessor->Mul( scratchWeights[0].ToFloatPtr(), scale, scaledWeights[0].ToFloatPtr(), numWeights * 4 );
+	SIMDProcessor->TransformVerts( verts, texCoords.Num(), entJoints, scratchWeights, weightIndex, numWeights );
 }
 
 /*
 ====================
-idMD5Mesh::UpdateSurface
+idMD5Mesh::SetupSurface
+
+Allocates the triangle surface for the deformed mesh.  The static
+tri surf allocators are not thread safe, so this always runs on the
+main thread, the face planes are allocated up front when the tangents
+will be derived in a job.
 ====================
 */
-void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf ) {
-	int i, base;
+srfTriangles_t *idMD5Mesh::SetupSurface( modelSurface_t *surf, bool allocFacePlanes ) {
+	int i;
 	srfTriangles_t *tri;
 
 	tr.pc.c_deformedSurfaces++;
@@ -322,8 +347,23 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 		}
 	}
 
-	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
-		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
+	if ( allocFacePlanes && tri->dominantTris == NULL && tri->facePlanes == NULL ) {
+		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
+	}
+
+	return tri;
+}
+
+/*
+====================
+idMD5Mesh::SkinSurface
+====================
+*/
+void idMD5Mesh::SkinSurface( srfTriangles_t *tri, const idJointMat *entJoints, float skinScale, bool deriveTangents, idVec4 *scratchWeights ) const {
+	int i, base;
+
+	if ( skinScale != 0.0f ) {
+		TransformScaledVerts( tri->verts, entJoints, skinScale, scratchWeights );
 	} else {
 		TransformVerts( tri->verts, entJoints );
 	}
@@ -336,14 +376,56 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 
 	R_BoundTriSurf( tri );
 
+	if ( deriveTangents ) {
+		// set face planes, vertex normals, tangents
+		R_DeriveTangents( tri, false );
+	}
+}
+
+/*
+====================
+idMD5Mesh::UpdateSurface
+====================
+*/
+void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, const idMaterial *surfaceShader, modelSurface_t *surf ) {
+	srfTriangles_t *tri;
+	bool deriveTangents;
+	float skinScale;
+
+	skinScale = ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ];
+
 	// If a surface is going to be have a lighting interaction generated, it will also have to call
 	// R_DeriveTangents() to get normals, tangents, and face planes.  If it only
 	// needs shadows generated, it will only have to generate face planes.  If it only
 	// has ambient drawing, or is culled, no additional work will be necessary
-	if ( !r_useDeferredTangents.GetBool() ) {
-		// set face planes, vertex normals, tangents
-		R_DeriveTangents( tri );
+	deriveTangents = !r_useDeferredTangents.GetBool();
+
+	if ( md5DeferSkinning ) {
+		// the interactions aren't known yet, so derive the tangents in the job
+		// for every visible surface with a lit material after skin remapping,
+		// even if no light ends up reaching it
+		if ( surfaceShader->ReceivesLighting() ) {
+			deriveTangents = true;
+		}
+
+		tri = SetupSurface( surf, deriveTangents );
+
+		md5SkinSurface_t &skin = md5SkinSurfaces.Alloc();
+		skin.mesh = this;
+		skin.joints = entJoints;
+		skin.tri = tri;
+		skin.skinScale = skinScale;
+		skin.deriveTangents = deriveTangents;
+		return;
+	}
+
+	tri = SetupSurface( surf, deriveTangents );
+
+	idVec4 *scratchWeights = NULL;
+	if ( skinScale != 0.0f ) {
+		scratchWeights = (idVec4 *) _alloca16( numWeights * sizeof( scratchWeights[0] ) );
 	}
+	SkinSurface( tri, entJoints, skinScale, deriveTangents, scratchWeights );
 }
 
 /*
@@ -757,6 +839,13 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 
 	staticModel->bounds.Clear();
 
+	if ( md5DeferSkinning ) {
+		md5SkinModel_t &skinModel = md5SkinModels.Alloc();
+		skinModel.model = staticModel;
+		skinModel.firstSurface = md5SkinSurfaces.Num();
+		skinModel.numSurfaces = 0;
+	}
+
 	if ( r_showSkel.GetInteger() ) {
 		if ( ( view != NULL ) && ( !r_skipSuppress.GetBool() || !ent->suppressSurfaceInViewID || ( ent->suppressSurfaceInViewID != view->renderView.viewID ) ) ) {
 			// only draw the skeleton
@@ -801,7 +890,13 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 			surf->id = i;
 		}
 
-		mesh->UpdateSurface( ent, ent->joints, surf );
+		mesh->UpdateSurface( ent, ent->joints, shader, surf );
+
+		if ( md5DeferSkinning ) {
+			// the bounds are added once the surface is skinned
+			md5SkinModels[md5SkinModels.Num() - 1].numSurfaces++;
+			continue;
+		}
 
 		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
 		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
@@ -960,3 +1055,305 @@ int	idRenderModelMD5::Memory() const {
 	}
 	return total;
 }
+
+/***********************************************************************
+
+	Skinning jobs
+
+***********************************************************************/
+
+typedef struct {
+	const md5SkinSurface_t *	surfaces;
+	int							numSurfaces;
+	int							firstSurface;
+	int							stride;
+} md5SkinJob_t;
+
+static idJobGroup *			skinJobGroup;
+
+/*
+====================
+R_SkinSurfacesJob
+====================
+*/
+static void R_SkinSurfacesJob( void *data ) {
+	const md5SkinJob_t *job = (const md5SkinJob_t *)data;
+
+	for ( int i = job->firstSurface; i < job->numSurfaces; i += job->stride ) {
+		const md5SkinSurface_t *skin = &job->surfaces[i];
+
+		// scratch memory comes from the frame arena of the job thread
+		idVec4 *scratchWeights = NULL;
+		if ( skin->skinScale != 0.0f ) {
+			scratchWeights = (idVec4 *)R_FrameAlloc( skin->mesh->NumWeights() * sizeof( scratchWeights[0] ) );
+		}
+		skin->mesh->SkinSurface( skin->tri, skin->joints, skin->skinScale, skin->deriveTangents, scratchWeights );
+	}
+}
+
+/*
+====================
+R_InitSkinningJobs
+====================
+*/
+void R_InitSkinningJobs( void ) {
+	skinJobGroup = jobSystem->AllocJobGroup( "md5Skinning" );
+}
+
+/*
+====================
+R_ShutdownSkinningJobs
+====================
+*/
+void R_ShutdownSkinningJobs( void ) {
+	if ( skinJobGroup ) {
+		jobSystem->FreeJobGroup( skinJobGroup );
+		skinJobGroup = NULL;
+	}
+	md5SkinSurfaces.Clear();
+	md5SkinModels.Clear();
+}
+
+/*
+====================
+R_BeginDeferredSkinning
+
+MD5 models instantiated after this only get their surfaces allocated,
+the vertexes are skinned by R_EndDeferredSkinning.  Returns false if
+the skinning jobs are disabled.
+====================
+*/
+bool R_BeginDeferredSkinning( void ) {
+	if ( r_skinningJobs.GetInteger() == 0 || skinJobGroup == NULL ) {
+		return false;
+	}
+
+	assert( !md5DeferSkinning );
+	md5DeferSkinning = true;
+	md5SkinSurfaces.SetNum( 0, false );
+	md5SkinModels.SetNum( 0, false );
+	return true;
+}
+
+/*
+====================
+R_EndDeferredSkinning
+
+Skins all surfaces queued since R_BeginDeferredSkinning in parallel
+jobs and adds them to the bounds of their models in the original order,
+so the models come out exactly as if they were skinned one by one.
+====================
+*/
+void R_EndDeferredSkinning( void ) {
+	int i, j, numJobs, numSurfaces;
+
+	if ( !md5DeferSkinning ) {
+		return;
+	}
+	md5DeferSkinning = false;
+
+	numSurfaces = md5SkinSurfaces.Num();
+	if ( numSurfaces > 0 ) {
+		numJobs = r_skinningJobs.GetInteger();
+		if ( numJobs < 0 ) {
+			numJobs = jobSystem->GetNumThreads();
+		}
+		numJobs = idMath::ClampInt( 1, numSurfaces, numJobs );
+
+		// interleave the surfaces over the jobs so the meshes of a single
+		// model don't end up in the same job
+		md5SkinJob_t *jobs = (md5SkinJob_t *)R_FrameAlloc( numJobs * sizeof( jobs[0] ) );
+		for ( i = 0; i < numJobs; i++ ) {
+			jobs[i].surfaces = md5SkinSurfaces.Ptr();
+			jobs[i].numSurfaces = numSurfaces;
+			jobs[i].firstSurface = i;
+			jobs[i].stride = numJobs;
+			skinJobGroup->AddJob( R_SkinSurfacesJob, &jobs[i] );
+		}
+		skinJobGroup->Run();
+	}
+
+	for ( i = 0; i < md5SkinModels.Num(); i++ ) {
+		const md5SkinModel_t &skinModel = md5SkinModels[i];
+		for ( j = 0; j < skinModel.numSurfaces; j++ ) {
+			const srfTriangles_t *tri = md5SkinSurfaces[skinModel.firstSurface + j].tri;
+			skinModel.model->bounds.AddPoint( tri->bounds[0] );
+			skinModel.model->bounds.AddPoint( tri->bounds[1] );
+		}
+	}
+
+	md5SkinSurfaces.SetNum( 0, false );
+	md5SkinModels.SetNum( 0, false );
+}
+
+/*
+====================
+R_DeriveLitTangents
+
+Derives the tangents of the surfaces that are lit, like the interactions
+would for a serially skinned model.
+====================
+*/
+static void R_DeriveLitTangents( idRenderModel *model, const renderEntity_t *ent ) {
+	for ( int i = 0; i < model->NumSurfaces(); i++ ) {
+		const modelSurface_t *surf = model->Surface( i );
+		const idMaterial *shader = R_RemapShaderBySkin( surf->shader, ent->customSkin, ent->customShader );
+		if ( shader->ReceivesLighting() ) {
+			R_DeriveTangents( surf->geometry );
+		}
+	}
+}
+
+/*
+====================
+R_CompareSkinnedModels
+====================
+*/
+static bool R_CompareSkinnedModels( const idRenderModel *a, const idRenderModel *b ) {
+	if ( a->NumSurfaces() != b->NumSurfaces() || a->Bounds() != b->Bounds() ) {
+		return false;
+	}
+	for ( int i = 0; i < a->NumSurfaces(); i++ ) {
+		const srfTriangles_t *triA = a->Surface( i )->geometry;
+		const srfTriangles_t *triB = b->Surface( i )->geometry;
+		if ( triA->numVerts != triB->numVerts || triA->bounds != triB->bounds ) {
+			return false;
+		}
+		if ( memcmp( triA->verts, triB->verts, triA->numVerts * sizeof( triA->verts[0] ) ) != 0 ) {
+			return false;
+		}
+		if ( triA->tangentsCalculated && triB->tangentsCalculated && triA->facePlanes && triB->facePlanes ) {
+			if ( memcmp( triA->facePlanes, triB->facePlanes, ( triA->numIndexes / 3 ) * sizeof( triA->facePlanes[0] ) ) != 0 ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+====================
+R_TestSkinning_f
+
+Instantiates a number of posed copies of an MD5 model one by one and through
+the skinning jobs, compares the results and prints the timings.  This doesn't
+need a view, so it also works with a null renderer.
+====================
+*/
+void R_TestSkinning_f( const idCmdArgs &args ) {
+	int i, j, iter;
+
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: testSkinning <md5mesh> [instances] [iterations]\n" );
+		return;
+	}
+
+	idRenderModel *model = renderModelManager->FindModel( args.Argv( 1 ) );
+	if ( model == NULL || model->IsDefaultModel() || model->NumJoints() <= 0 ) {
+		common->Printf( "testSkinning: '%s' is not an md5 mesh\n", args.Argv( 1 ) );
+		return;
+	}
+
+	int numInstances = ( args.Argc() > 2 ) ? idMath::ClampInt( 1, 4096, atoi( args.Argv( 2 ) ) ) : 64;
+	int iterations = ( args.Argc() > 3 ) ? idMath::ClampInt( 1, 1000, atoi( args.Argv( 3 ) ) ) : 10;
+	int numJoints = model->NumJoints();
+	const idMD5Joint *md5Joints = model->GetJoints();
+	const idJointQuat *defaultPose = model->GetDefaultPose();
+
+	int *parents = (int *)_alloca16( numJoints * sizeof( parents[0] ) );
+	for ( i = 0; i < numJoints; i++ ) {
+		parents[i] = md5Joints[i].parent ? (int)( md5Joints[i].parent - md5Joints ) : -1;
+	}
+
+	// give every instance a slightly different pose
+	idJointQuat *pose = (idJointQuat *)_alloca16( numJoints * sizeof( pose[0] ) );
+	renderEntity_t *ents = new renderEntity_t[numInstances];
+	idRenderModel **serialModels = new idRenderModel *[numInstances];
+	idRenderModel **jobModels = new idRenderModel *[numInstances];
+	for ( i = 0; i < numInstances; i++ ) {
+		memset( &ents[i], 0, sizeof( ents[i] ) );
+		ents[i].hModel = model;
+		ents[i].numJoints = numJoints;
+		ents[i].joints = (idJointMat *)Mem_Alloc16( numJoints * sizeof( ents[i].joints[0] ) );
+
+		idQuat twist = idAngles( 0.0f, 0.0f, ( i & 15 ) * 2.0f ).ToQuat();
+		for ( j = 0; j < numJoints; j++ ) {
+			pose[j].q = ( j > 0 ) ? defaultPose[j].q * twist : defaultPose[j].q;
+			pose[j].t = defaultPose[j].t;
+		}
+		SIMDProcessor->ConvertJointQuatsToJointMats( ents[i].joints, pose, numJoints );
+		SIMDProcessor->TransformJoints( ents[i].joints, parents, 1, numJoints - 1 );
+
+		serialModels[i] = NULL;
+		jobModels[i] = NULL;
+	}
+
+	// first pass allocates the surfaces
+	for ( i = 0; i < numInstances; i++ ) {
+		serialModels[i] = model->InstantiateDynamicModel( &ents[i], NULL, serialModels[i] );
+	}
+
+	double start = Sys_GetClockTicks();
+	for ( iter = 0; iter < iterations; iter++ ) {
+		for ( i = 0; i < numInstances; i++ ) {
+			serialModels[i] = model->InstantiateDynamicModel( &ents[i], NULL, serialModels[i] );
+			if ( serialModels[i] != NULL ) {
+				R_DeriveLitTangents( serialModels[i], &ents[i] );
+			}
+		}
+	}
+	double serialTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	bool jobs = R_BeginDeferredSkinning();
+	for ( i = 0; i < numInstances; i++ ) {
+		jobModels[i] = model->InstantiateDynamicModel( &ents[i], NULL, jobModels[i] );
+	}
+	R_EndDeferredSkinning();
+
+	start = Sys_GetClockTicks();
+	for ( iter = 0; iter < iterations; iter++ ) {
+		R_BeginDeferredSkinning();
+		for ( i = 0; i < numInstances; i++ ) {
+			jobModels[i] = model->InstantiateDynamicModel( &ents[i], NULL, jobModels[i] );
+		}
+		R_EndDeferredSkinning();
+	}
+	double jobTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	int numVerts = 0;
+	int numMismatches = 0;
+	for ( i = 0; i < numInstances; i++ ) {
+		if ( serialModels[i] == NULL || jobModels[i] == NULL ) {
+			continue;
+		}
+		for ( j = 0; j < serialModels[i]->NumSurfaces(); j++ ) {
+			numVerts += serialModels[i]->Surface( j )->geometry->numVerts;
+		}
+		if ( !R_CompareSkinnedModels( serialModels[i], jobModels[i] ) ) {
+			numMismatches++;
+		}
+	}
+
+	common->Printf( "testSkinning: %i instances of '%s', %i verts, %i iterations\n", numInstances, model->Name(), numVerts, iterations );
+	common->Printf( "serial:  %7.2f msec per iteration\n", serialTime * 1000.0 / iterations );
+	if ( jobs ) {
+		common->Printf( "jobs:    %7.2f msec per iteration on %i threads (%.2fx)\n", jobTime * 1000.0 / iterations,
+			jobSystem->GetNumThreads(), ( jobTime > 0.0 ) ? serialTime / jobTime : 0.0 );
+	} else {
+		common->Printf( "jobs:    disabled by r_skinningJobs\n" );
+	}
+	if ( numMismatches ) {
+		common->Printf( S_COLOR_RED "%i instances differ from the serial skinning\n", numMismatches );
+	} else {
+		common->Printf( "all instances identical\n" );
+	}
+
+	for ( i = 0; i < numInstances; i++ ) {
+		delete serialModels[i];
+		delete jobModels[i];
+		Mem_Free16( ents[i].joints );
+	}
+	delete[] jobModels;
+	delete[] serialModels;
+	delete[] ents;
+}
@@ -52,6 +52,7 @@ idRenderEntityLocal::idRenderEntityLocal() {
 	firstInteraction		= NULL;
 	lastInteraction			= NULL;
 	needsPortalSky			= false;
+	skipShadowCache			= false;
 }
 
 void idRenderEntityLocal::FreeRenderEntity() {
@@ -86,6 +87,7 @@ idRenderLightLocal::idRenderLightLocal() {
 	memset( frustumWindings, 0, sizeof( frustumWindings ) );
 
 	lightHasMoved			= false;
+	skipShadowCache			= false;
 	world					= NULL;
 	index					= 0;
 	areaNum					= 0;
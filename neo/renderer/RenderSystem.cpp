@@ -108,6 +108,12 @@ static void R_PerformanceCounters( void ) {
 	if ( r_showMemory.GetBool() ) {
 		int	m1 = frameData ? frameData->memoryHighwater : 0;
 		common->Printf( "frameData: %i (%i)\n", R_CountFrameData(), m1 );
+		for ( int i = 1; frameData && i < frameData->numArenas; i++ ) {
+			const frameArena_t *arena = &frameData->arenas[i];
+			if ( arena->highwater ) {
+				common->Printf( "  job thread %i: %i (%i) in %i allocs\n", i, arena->frameBytes, arena->highwater, arena->numAllocs );
+			}
+		}
 	}
 	if ( r_showLightScale.GetBool() ) {
 		common->Printf( "lightScale: %f\n", backEnd.pc.maxLightValue );
@@ -70,6 +70,7 @@ idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "us
 idCVar r_useTwoSidedStencil( "r_useTwoSidedStencil", "1", CVAR_RENDERER | CVAR_BOOL, "do stencil shadows in one pass with different ops on each side" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
+idCVar r_useBinaryProc( "r_useBinaryProc", "1", CVAR_RENDERER | CVAR_BOOL, "load the world from a precompiled .bproc file, written on the first load of a map" );
 
 idCVar r_useVertexBuffers( "r_useVertexBuffers", "1", CVAR_RENDERER | CVAR_INTEGER, "use ARB_vertex_buffer_object for vertexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
 idCVar r_useIndexBuffers( "r_useIndexBuffers", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "use ARB_vertex_buffer_object for indexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
@@ -122,8 +123,11 @@ idCVar r_useLightScissors( "r_useLightScissors", "1", CVAR_RENDERER | CVAR_BOOL,
 idCVar r_useClippedLightScissors( "r_useClippedLightScissors", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar r_useEntityCulling( "r_useEntityCulling", "1", CVAR_RENDERER | CVAR_BOOL, "0 = none, 1 = box" );
 idCVar r_useEntityScissors( "r_useEntityScissors", "0", CVAR_RENDERER | CVAR_BOOL, "1 = use custom scissor rectangle for each entity" );
+idCVar r_useBatchedCulling( "r_useBatchedCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull all entities and lights of an area at once with SIMD" );
 idCVar r_useInteractionCulling( "r_useInteractionCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull interactions" );
 idCVar r_useInteractionScissors( "r_useInteractionScissors", "2", CVAR_RENDERER | CVAR_INTEGER, "1 = use a custom scissor rectangle for each shadow interaction, 2 = also crop using portal scissors", -2, 2, idCmdSystem::ArgCompletion_Integer<-2,2> );
+idCVar r_interactionJobs( "r_interactionJobs", "-1", CVAR_RENDERER | CVAR_INTEGER, "number of jobs the light interactions are culled in, 0 = serial, -1 = one per job thread", -1, 64 );
+idCVar r_skinningJobs( "r_skinningJobs", "-1", CVAR_RENDERER | CVAR_INTEGER, "number of jobs the visible md5 meshes are skinned in, 0 = serial, -1 = one per job thread", -1, 64 );
 idCVar r_useShadowCulling( "r_useShadowCulling", "1", CVAR_RENDERER | CVAR_BOOL, "try to cull shadows from partially visible lights" );
 idCVar r_useFrustumFarDistance( "r_useFrustumFarDistance", "0", CVAR_RENDERER | CVAR_FLOAT, "if != 0 force the view frustum far distance to this distance" );
 idCVar r_logFile( "r_logFile", "0", CVAR_RENDERER | CVAR_INTEGER, "number of frames to emit GL logs" );
@@ -2313,7 +2317,11 @@ void R_InitCommands( void ) {
 	cmdSystem->AddCommand( "reportImageDuplication", R_ReportImageDuplication_f, CMD_FL_RENDERER, "checks all referenced images for duplications" );
 	cmdSystem->AddCommand( "regenerateWorld", R_RegenerateWorld_f, CMD_FL_RENDERER, "regenerates all interactions" );
 	cmdSystem->AddCommand( "showInteractionMemory", R_ShowInteractionMemory_f, CMD_FL_RENDERER, "shows memory used by interactions" );
+	cmdSystem->AddCommand( "shadowCacheStats", R_ShadowCacheStats_f, CMD_FL_RENDERER, "shows the shadow cache statistics, optionally purges or resets them" );
 	cmdSystem->AddCommand( "showTriSurfMemory", R_ShowTriSurfMemory_f, CMD_FL_RENDERER, "shows memory used by triangle surfaces" );
+	cmdSystem->AddCommand( "recordFrameAllocs", R_RecordFrameAllocs_f, CMD_FL_RENDERER, "records the frame memory allocations of the next frame for testFrameAlloc" );
+	cmdSystem->AddCommand( "testFrameAlloc", R_TestFrameAlloc_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "benchmarks the frame memory allocator with a replay of a recorded frame" );
+	cmdSystem->AddCommand( "testSkinning", R_TestSkinning_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "benchmarks serial against parallel skinning of an md5 mesh" );
 	cmdSystem->AddCommand( "vid_restart", R_VidRestart_f, CMD_FL_RENDERER, "restarts renderSystem" );
 	cmdSystem->AddCommand( "listRenderEntityDefs", R_ListRenderEntityDefs_f, CMD_FL_RENDERER, "lists the entity defs" );
 	cmdSystem->AddCommand( "listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs" );
@@ -2403,6 +2411,12 @@ void idRenderSystemLocal::Init( void ) {
 
 	R_InitTriSurfData();
 
+	R_InitLightJobs();
+
+	R_InitSkinningJobs();
+
+	R_InitShadowCache();
+
 	globalImages->Init();
 
 	idCinematic::InitCinematic( );
@@ -2460,6 +2474,12 @@ void idRenderSystemLocal::Shutdown( void ) {
 	// free frame memory
 	R_ShutdownFrameData();
 
+	R_ShutdownLightJobs();
+
+	R_ShutdownSkinningJobs();
+
+	R_ShutdownShadowCache();
+
 	// free the vertex cache, which should have nothing allocated now
 	vertexCache.Shutdown();
 
@@ -128,6 +128,8 @@ idRenderWorldLocal::idRenderWorldLocal() {
 	mapName.Clear();
 	mapTimeStamp = FILE_NOT_FOUND_TIMESTAMP;
 
+	binaryProc = NULL;
+
 	generateAllInteractionsCalled = false;
 
 	areaNodes = NULL;
@@ -253,12 +255,17 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 			}
 		}
 
+		// the shadow volumes can only be reused if the entity keeps its shape
+		def->skipShadowCache = !R_EntityShadowShapeMatches( &def->parms, re );
+
 		// save any decals if the model is the same, allowing marks to move with entities
 		if ( def->parms.hModel == re->hModel ) {
 			R_FreeEntityDefDerivedData( def, true, true );
 		} else {
 			R_FreeEntityDefDerivedData( def, false, false );
 		}
+
+		def->skipShadowCache = false;
 	} else {
 		// creating a new one
 		def = new idRenderEntityLocal;
@@ -411,7 +418,9 @@ void idRenderWorldLocal::UpdateLightDef( qhandle_t lightHandle, const renderLigh
 		} else {
 			// if we are updating shadows, the prelight model is no longer valid
 			light->lightHasMoved = true;
+			light->skipShadowCache = true;
 			R_FreeLightDefDerivedData( light );
+			light->skipShadowCache = false;
 		}
 	} else {
 		// create a new one
@@ -40,6 +40,9 @@ If you have questions concerning this license or the applicable additional terms
 #define PROC_FILE_EXT				"proc"
 #define	PROC_FILE_ID				"mapProcFile003"
 
+// precompiled binary version of the proc file, written on the first load of a map
+#define BPROC_FILE_EXT				"bproc"
+
 // shader parms
 const int MAX_GLOBAL_SHADER_PARMS	= 12;
 
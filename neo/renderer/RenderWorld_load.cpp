@@ -31,6 +31,140 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "tr_local.h"
 
+/*
+
+Precompiled binary proc files
+
+The first time a map is loaded from the text .proc file, everything that is parsed is
+also written to a .bproc file in the save path.  Later loads memory map the .bproc file
+if it was written from a text file with the same timestamp and length, and point the
+indexes of the world surfaces and the shadow models straight into the mapping.  The world
+surface vertexes are copied, because FinishSurfaces adds tangents and mirrored vertexes.
+
+Everything is stored in the native byte order and structure layout, the header makes
+sure a file written by a different build is written again instead of being used.
+
+*/
+
+const int BPROC_IDENT				= ( 'C' << 24 ) + ( 'R' << 16 ) + ( 'P' << 8 ) + 'B';
+const int BPROC_VERSION				= 1;
+
+typedef enum {
+	BPROC_END,
+	BPROC_MODEL,
+	BPROC_SHADOW_MODEL,
+	BPROC_INTER_AREA_PORTALS,
+	BPROC_NODES
+} bprocChunk_t;
+
+typedef struct {
+	int						ident;
+	int						version;
+	int						drawVertSize;		// sizeof( idDrawVert ), vertexes are stored as they are in memory
+	int						indexSize;			// sizeof( glIndex_t )
+	int						sourceTimeStamp;	// of the text file it was written from
+	int						sourceLength;
+} bprocHeader_t;
+
+typedef struct bprocCursor_s {
+	byte *					data;
+	int						length;
+	int						offset;
+	bool					error;				// set when anything would be read past the end
+} bprocCursor_t;
+
+/*
+================
+R_AlignBinaryProc
+================
+*/
+static void R_AlignBinaryProc( idFile *f, int alignment ) {
+	static const byte pad[16] = { 0 };
+	int remainder = f->Length() & ( alignment - 1 );
+	if ( remainder ) {
+		f->Write( pad, alignment - remainder );
+	}
+}
+
+/*
+================
+R_WriteBinaryProcInt
+================
+*/
+static void R_WriteBinaryProcInt( idFile *f, int value ) {
+	f->Write( &value, sizeof( value ) );
+}
+
+/*
+================
+R_WriteBinaryProcString
+================
+*/
+static void R_WriteBinaryProcString( idFile *f, const char *string ) {
+	int length = strlen( string ) + 1;
+	R_WriteBinaryProcInt( f, length );
+	f->Write( string, length );
+	R_AlignBinaryProc( f, 4 );
+}
+
+/*
+================
+R_WriteBinaryProcArray
+================
+*/
+static void R_WriteBinaryProcArray( idFile *f, const void *data, int count, int elementSize, int alignment ) {
+	R_AlignBinaryProc( f, alignment );
+	f->Write( data, count * elementSize );
+	R_AlignBinaryProc( f, 4 );
+}
+
+/*
+================
+R_ReadBinaryProcArray
+
+Returns a pointer into the file data, or NULL and sets the error flag
+================
+*/
+static void *R_ReadBinaryProcArray( bprocCursor_t &cursor, int count, int elementSize, int alignment ) {
+	if ( cursor.error || count < 0 || count > ( cursor.length - cursor.offset ) / elementSize ) {
+		cursor.error = true;
+		return NULL;
+	}
+	int offset = ( cursor.offset + alignment - 1 ) & ~( alignment - 1 );
+	int size = count * elementSize;
+	if ( offset + size > cursor.length ) {
+		cursor.error = true;
+		return NULL;
+	}
+	cursor.offset = ( offset + size + 3 ) & ~3;
+	return cursor.data + offset;
+}
+
+/*
+================
+R_ReadBinaryProcInt
+================
+*/
+static int R_ReadBinaryProcInt( bprocCursor_t &cursor ) {
+	int *value = (int *)R_ReadBinaryProcArray( cursor, 1, sizeof( int ), 4 );
+	return value ? *value : 0;
+}
+
+/*
+================
+R_ReadBinaryProcString
+================
+*/
+static const char *R_ReadBinaryProcString( bprocCursor_t &cursor ) {
+	int length = R_ReadBinaryProcInt( cursor );
+	const char *string = (const char *)R_ReadBinaryProcArray( cursor, length, 1, 4 );
+	if ( string == NULL || length < 1 || string[length - 1] != '\0' ) {
+		cursor.error = true;
+		return "";
+	}
+	return string;
+}
+
 
 /*
 ================
@@ -90,6 +224,12 @@ void idRenderWorldLocal::FreeWorld() {
 	}
 	localModels.Clear();
 
+	// the surfaces that pointed into the binary proc file are gone
+	if ( binaryProc ) {
+		fileSystem->UnmapFile( binaryProc );
+		binaryProc = NULL;
+	}
+
 	areaReferenceAllocator.Shutdown();
 	interactionAllocator.Shutdown();
 	areaNumRefAllocator.Shutdown();
@@ -115,7 +255,7 @@ void idRenderWorldLocal::TouchWorldModels( void ) {
 idRenderWorldLocal::ParseModel
 ================
 */
-idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
+idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src, idFile *bproc ) {
 	idRenderModel	*model;
 	idToken			token;
 	int				i, j;
@@ -135,6 +275,12 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		src->Error( "R_ParseModel: bad numSurfaces" );
 	}
 
+	if ( bproc ) {
+		R_WriteBinaryProcInt( bproc, BPROC_MODEL );
+		R_WriteBinaryProcString( bproc, token );
+		R_WriteBinaryProcInt( bproc, numSurfaces );
+	}
+
 	for ( i = 0 ; i < numSurfaces ; i++ ) {
 		src->ExpectTokenString( "{" );
 
@@ -156,6 +302,7 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 
 			src->Parse1DMatrix( 8, vec );
 
+			tri->verts[j].Clear();
 			tri->verts[j].xyz[0] = vec[0];
 			tri->verts[j].xyz[1] = vec[1];
 			tri->verts[j].xyz[2] = vec[2];
@@ -172,6 +319,14 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		}
 		src->ExpectTokenString( "}" );
 
+		if ( bproc ) {
+			R_WriteBinaryProcString( bproc, token );
+			R_WriteBinaryProcInt( bproc, tri->numVerts );
+			R_WriteBinaryProcInt( bproc, tri->numIndexes );
+			R_WriteBinaryProcArray( bproc, tri->verts, tri->numVerts, sizeof( tri->verts[0] ), 16 );
+			R_WriteBinaryProcArray( bproc, tri->indexes, tri->numIndexes, sizeof( tri->indexes[0] ), 4 );
+		}
+
 		// add the completed surface to the model
 		model->AddSurface( surf );
 	}
@@ -188,7 +343,7 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 idRenderWorldLocal::ParseShadowModel
 ================
 */
-idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
+idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src, idFile *bproc ) {
 	idRenderModel	*model;
 	idToken			token;
 	int				j;
@@ -233,6 +388,19 @@ idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
 		tri->indexes[j] = src->ParseInt();
 	}
 
+	if ( bproc ) {
+		R_WriteBinaryProcInt( bproc, BPROC_SHADOW_MODEL );
+		R_WriteBinaryProcString( bproc, model->Name() );
+		R_WriteBinaryProcInt( bproc, tri->numVerts );
+		R_WriteBinaryProcInt( bproc, tri->numShadowIndexesNoCaps );
+		R_WriteBinaryProcInt( bproc, tri->numShadowIndexesNoFrontCaps );
+		R_WriteBinaryProcInt( bproc, tri->numIndexes );
+		R_WriteBinaryProcInt( bproc, tri->shadowCapPlaneBits );
+		R_WriteBinaryProcArray( bproc, &tri->bounds, 1, sizeof( tri->bounds ), 4 );
+		R_WriteBinaryProcArray( bproc, tri->shadowVertexes, tri->numVerts, sizeof( tri->shadowVertexes[0] ), 16 );
+		R_WriteBinaryProcArray( bproc, tri->indexes, tri->numIndexes, sizeof( tri->indexes[0] ), 4 );
+	}
+
 	// add the completed surface to the model
 	model->AddSurface( surf );
 
@@ -269,7 +437,7 @@ void idRenderWorldLocal::SetupAreaRefs() {
 idRenderWorldLocal::ParseInterAreaPortals
 ================
 */
-void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
+void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src, idFile *bproc ) {
 	int i, j;
 
 	src->ExpectTokenString( "{" );
@@ -294,6 +462,12 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * 
 		sizeof( doublePortals [0] ) );
 
+	if ( bproc ) {
+		R_WriteBinaryProcInt( bproc, BPROC_INTER_AREA_PORTALS );
+		R_WriteBinaryProcInt( bproc, numPortalAreas );
+		R_WriteBinaryProcInt( bproc, numInterAreaPortals );
+	}
+
 	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
 		int		numPoints, a1, a2;
 		idWinding	*w;
@@ -312,6 +486,15 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 			(*w)[j][4] = 0;
 		}
 
+		if ( bproc ) {
+			R_WriteBinaryProcInt( bproc, numPoints );
+			R_WriteBinaryProcInt( bproc, a1 );
+			R_WriteBinaryProcInt( bproc, a2 );
+			for ( j = 0 ; j < numPoints ; j++ ) {
+				R_WriteBinaryProcArray( bproc, (*w)[j].ToFloatPtr(), 3, sizeof( float ), 4 );
+			}
+		}
+
 		// add the portal to a1
 		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
 		p->intoArea = a2;
@@ -345,7 +528,7 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 idRenderWorldLocal::ParseNodes
 ================
 */
-void idRenderWorldLocal::ParseNodes( idLexer *src ) {
+void idRenderWorldLocal::ParseNodes( idLexer *src, idFile *bproc ) {
 	int			i;
 
 	src->ExpectTokenString( "{" );
@@ -366,9 +549,302 @@ void idRenderWorldLocal::ParseNodes( idLexer *src ) {
 		node->children[1] = src->ParseInt();
 	}
 
+	if ( bproc ) {
+		R_WriteBinaryProcInt( bproc, BPROC_NODES );
+		R_WriteBinaryProcInt( bproc, numAreaNodes );
+		R_WriteBinaryProcArray( bproc, areaNodes, numAreaNodes, sizeof( areaNodes[0] ), 4 );
+	}
+
 	src->ExpectTokenString( "}" );
 }
 
+/*
+================
+idRenderWorldLocal::ReadBinaryModel
+
+The binary version of ParseModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryModel( bprocCursor_t &cursor ) {
+	idRenderModel	*model;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( R_ReadBinaryProcString( cursor ) );
+
+	int numSurfaces = R_ReadBinaryProcInt( cursor );
+	if ( numSurfaces < 0 ) {
+		cursor.error = true;
+	}
+
+	for ( int i = 0 ; i < numSurfaces && !cursor.error ; i++ ) {
+		const char *shaderName = R_ReadBinaryProcString( cursor );
+		int numVerts = R_ReadBinaryProcInt( cursor );
+		int numIndexes = R_ReadBinaryProcInt( cursor );
+		const idDrawVert *verts = (const idDrawVert *)R_ReadBinaryProcArray( cursor, numVerts, sizeof( idDrawVert ), 16 );
+		glIndex_t *indexes = (glIndex_t *)R_ReadBinaryProcArray( cursor, numIndexes, sizeof( glIndex_t ), 4 );
+		if ( cursor.error ) {
+			break;
+		}
+
+		surf.shader = declManager->FindMaterial( shaderName );
+
+		((idMaterial*)surf.shader)->AddReference();
+
+		tri = R_AllocStaticTriSurf();
+		surf.geometry = tri;
+
+		tri->numVerts = numVerts;
+		tri->numIndexes = numIndexes;
+
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		memcpy( tri->verts, verts, tri->numVerts * sizeof( tri->verts[0] ) );
+
+		tri->indexes = indexes;
+		tri->mappedData = true;
+
+		// add the completed surface to the model
+		model->AddSurface( surf );
+	}
+
+	// an incomplete model is freed by the caller without finishing the surfaces
+	if ( !cursor.error ) {
+		model->FinishSurfaces();
+	}
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryShadowModel
+
+The binary version of ParseShadowModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryShadowModel( bprocCursor_t &cursor ) {
+	idRenderModel	*model;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( R_ReadBinaryProcString( cursor ) );
+
+	int numVerts = R_ReadBinaryProcInt( cursor );
+	int numShadowIndexesNoCaps = R_ReadBinaryProcInt( cursor );
+	int numShadowIndexesNoFrontCaps = R_ReadBinaryProcInt( cursor );
+	int numIndexes = R_ReadBinaryProcInt( cursor );
+	int shadowCapPlaneBits = R_ReadBinaryProcInt( cursor );
+	const idBounds *bounds = (const idBounds *)R_ReadBinaryProcArray( cursor, 1, sizeof( idBounds ), 4 );
+	shadowCache_t *shadowVertexes = (shadowCache_t *)R_ReadBinaryProcArray( cursor, numVerts, sizeof( shadowCache_t ), 16 );
+	glIndex_t *indexes = (glIndex_t *)R_ReadBinaryProcArray( cursor, numIndexes, sizeof( glIndex_t ), 4 );
+	if ( cursor.error ) {
+		return model;
+	}
+
+	surf.shader = tr.defaultMaterial;
+
+	tri = R_AllocStaticTriSurf();
+	surf.geometry = tri;
+
+	tri->numVerts = numVerts;
+	tri->numShadowIndexesNoCaps = numShadowIndexesNoCaps;
+	tri->numShadowIndexesNoFrontCaps = numShadowIndexesNoFrontCaps;
+	tri->numIndexes = numIndexes;
+	tri->shadowCapPlaneBits = shadowCapPlaneBits;
+	tri->bounds = *bounds;
+	tri->shadowVertexes = shadowVertexes;
+	tri->indexes = indexes;
+	tri->mappedData = true;
+
+	// add the completed surface to the model
+	model->AddSurface( surf );
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryInterAreaPortals
+
+The binary version of ParseInterAreaPortals
+================
+*/
+bool idRenderWorldLocal::ReadBinaryInterAreaPortals( bprocCursor_t &cursor ) {
+	int i, j;
+
+	numPortalAreas = R_ReadBinaryProcInt( cursor );
+	numInterAreaPortals = R_ReadBinaryProcInt( cursor );
+	if ( cursor.error || numPortalAreas < 0 || numInterAreaPortals < 0 || portalAreas != NULL ) {
+		numPortalAreas = 0;
+		numInterAreaPortals = 0;
+		return false;
+	}
+
+	portalAreas = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
+	areaScreenRect = (idScreenRect *) R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
+
+	// set the doubly linked lists
+	SetupAreaRefs();
+
+	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * 
+		sizeof( doublePortals [0] ) );
+
+	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
+		int		numPoints, a1, a2;
+		idWinding	*w;
+		portal_t	*p;
+
+		numPoints = R_ReadBinaryProcInt( cursor );
+		a1 = R_ReadBinaryProcInt( cursor );
+		a2 = R_ReadBinaryProcInt( cursor );
+		const idVec3 *points = (const idVec3 *)R_ReadBinaryProcArray( cursor, numPoints, sizeof( idVec3 ), 4 );
+		if ( cursor.error || a1 < 0 || a1 >= numPortalAreas || a2 < 0 || a2 >= numPortalAreas ) {
+			return false;
+		}
+
+		w = new idWinding( numPoints );
+		w->SetNumPoints( numPoints );
+		for ( j = 0 ; j < numPoints ; j++ ) {
+			(*w)[j].ToVec3() = points[j];
+			// no texture coordinates
+			(*w)[j][3] = 0;
+			(*w)[j][4] = 0;
+		}
+
+		// add the portal to a1
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a2;
+		p->doublePortal = &doublePortals[i];
+		p->w = w;
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a1].portals;
+		portalAreas[a1].portals = p;
+
+		doublePortals[i].portals[0] = p;
+
+		// reverse it for a2
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a1;
+		p->doublePortal = &doublePortals[i];
+		p->w = w->Reverse();
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a2].portals;
+		portalAreas[a2].portals = p;
+
+		doublePortals[i].portals[1] = p;
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryNodes
+
+The binary version of ParseNodes
+================
+*/
+bool idRenderWorldLocal::ReadBinaryNodes( bprocCursor_t &cursor ) {
+	int count = R_ReadBinaryProcInt( cursor );
+	const areaNode_t *nodes = (const areaNode_t *)R_ReadBinaryProcArray( cursor, count, sizeof( areaNode_t ), 4 );
+	if ( cursor.error || areaNodes != NULL ) {
+		return false;
+	}
+
+	numAreaNodes = count;
+	areaNodes = (areaNode_t *)R_ClearedStaticAlloc( numAreaNodes * sizeof( areaNodes[0] ) );
+	memcpy( areaNodes, nodes, numAreaNodes * sizeof( areaNodes[0] ) );
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::LoadBinaryProc
+
+Returns false if there is no valid binary proc file for the text file,
+anything that was loaded from an invalid file has been freed again
+================
+*/
+bool idRenderWorldLocal::LoadBinaryProc( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	bprocCursor_t	cursor;
+	void *			buffer;
+
+	cursor.length = fileSystem->MapFile( fileName, &buffer );
+	if ( cursor.length < 0 ) {
+		return false;
+	}
+	cursor.data = (byte *)buffer;
+	cursor.offset = 0;
+	cursor.error = false;
+
+	const bprocHeader_t *header = (const bprocHeader_t *)R_ReadBinaryProcArray( cursor, 1, sizeof( bprocHeader_t ), 4 );
+	if ( header == NULL || header->ident != BPROC_IDENT || header->version != BPROC_VERSION ||
+			header->drawVertSize != sizeof( idDrawVert ) || header->indexSize != sizeof( glIndex_t ) ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is from a different version\n", fileName );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+	if ( header->sourceTimeStamp != (int)sourceTimeStamp || header->sourceLength != sourceLength ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is out of date\n", fileName );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	// the indexes of the world surfaces point into the mapping, so FreeWorld releases it
+	binaryProc = buffer;
+
+	bool done = false;
+	while ( !cursor.error && !done ) {
+		idRenderModel *model = NULL;
+
+		switch( R_ReadBinaryProcInt( cursor ) ) {
+			case BPROC_END:
+				done = true;
+				break;
+			case BPROC_MODEL:
+				model = ReadBinaryModel( cursor );
+				break;
+			case BPROC_SHADOW_MODEL:
+				model = ReadBinaryShadowModel( cursor );
+				break;
+			case BPROC_INTER_AREA_PORTALS:
+				if ( !ReadBinaryInterAreaPortals( cursor ) ) {
+					cursor.error = true;
+				}
+				break;
+			case BPROC_NODES:
+				if ( !ReadBinaryNodes( cursor ) ) {
+					cursor.error = true;
+				}
+				break;
+			default:
+				cursor.error = true;
+				break;
+		}
+
+		if ( model ) {
+			// add it to the model manager list
+			renderModelManager->AddModel( model );
+
+			// save it in the list to free when clearing this map
+			localModels.Append( model );
+		}
+	}
+
+	if ( cursor.error ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is damaged\n", fileName );
+		FreeWorld();
+		return false;
+	}
+
+	return true;
+}
+
 /*
 ================
 idRenderWorldLocal::CommonChildrenArea_r
@@ -451,6 +927,8 @@ void idRenderWorldLocal::FreeDefs() {
 
 		light = lightDefs[i];
 		if ( light && light->world == this ) {
+			// the interactions are gone for good, don't cache their shadows
+			light->skipShadowCache = true;
 			FreeLightDef( i );
 			lightDefs[i] = NULL;
 		}
@@ -466,6 +944,8 @@ void idRenderWorldLocal::FreeDefs() {
 			entityDefs[i] = NULL;
 		}
 	}
+
+	R_PurgeShadowCacheWorld( this );
 }
 
 /*
@@ -480,7 +960,9 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	idLexer *		src;
 	idToken			token;
 	idStr			filename;
+	idStr			binaryFilename;
 	idRenderModel *	lastModel;
+	idFile_Memory *	bproc;
 
 	// if this is an empty world, initialize manually
 	if ( !name || !name[0] ) {
@@ -494,11 +976,13 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	// load it
 	filename = name;
 	filename.SetFileExtension( PROC_FILE_EXT );
+	binaryFilename = name;
+	binaryFilename.SetFileExtension( BPROC_FILE_EXT );
 
 	// if we are reloading the same map, check the timestamp
 	// and try to skip all the work
 	ID_TIME_T currentTimeStamp;
-	fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
+	int currentLength = fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
 
 	if ( name == mapName ) {
 		if ( currentTimeStamp != FILE_NOT_FOUND_TIMESTAMP && currentTimeStamp == mapTimeStamp ) {
@@ -514,71 +998,107 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	FreeWorld();
 
-	src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
-	if ( !src->IsLoaded() ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
-		ClearWorld();
-		return false;
-	}
+	// the binary version is only used when it was written from the current text file
+	if ( r_useBinaryProc.GetBool() && currentLength >= 0 && LoadBinaryProc( binaryFilename, currentTimeStamp, currentLength ) ) {
+		mapName = name;
+		mapTimeStamp = currentTimeStamp;
 
+		// if we are writing a demo, archive the load command
+		if ( session->writeDemo ) {
+			WriteLoadMap();
+		}
+	} else {
+		src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
+		if ( !src->IsLoaded() ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
+			ClearWorld();
+			return false;
+		}
 
-	mapName = name;
-	mapTimeStamp = currentTimeStamp;
 
-	// if we are writing a demo, archive the load command
-	if ( session->writeDemo ) {
-		WriteLoadMap();
-	}
+		mapName = name;
+		mapTimeStamp = currentTimeStamp;
 
-	if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
-		delete src;
-		return false;
-	}
+		// if we are writing a demo, archive the load command
+		if ( session->writeDemo ) {
+			WriteLoadMap();
+		}
 
-	// parse the file
-	while ( 1 ) {
-		if ( !src->ReadToken( &token ) ) {
-			break;
+		if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
+			delete src;
+			return false;
 		}
 
-		if ( token == "model" ) {
-			lastModel = ParseModel( src );
+		// everything that is parsed also goes into the binary version
+		bproc = NULL;
+		if ( r_useBinaryProc.GetBool() && currentLength >= 0 ) {
+			bprocHeader_t header;
+
+			memset( &header, 0, sizeof( header ) );
+			header.ident = BPROC_IDENT;
+			header.version = BPROC_VERSION;
+			header.drawVertSize = sizeof( idDrawVert );
+			header.indexSize = sizeof( glIndex_t );
+			header.sourceTimeStamp = (int)currentTimeStamp;
+			header.sourceLength = currentLength;
+
+			bproc = new idFile_Memory( binaryFilename );
+			bproc->Write( &header, sizeof( header ) );
+		}
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+		// parse the file
+		while ( 1 ) {
+			if ( !src->ReadToken( &token ) ) {
+				break;
+			}
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
-		}
+			if ( token == "model" ) {
+				lastModel = ParseModel( src, bproc );
 
-		if ( token == "shadowModel" ) {
-			lastModel = ParseShadowModel( src );
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
-		}
+			if ( token == "shadowModel" ) {
+				lastModel = ParseShadowModel( src, bproc );
+
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
+
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
+
+			if ( token == "interAreaPortals" ) {
+				ParseInterAreaPortals( src, bproc );
+				continue;
+			}
+
+			if ( token == "nodes" ) {
+				ParseNodes( src, bproc );
+				continue;
+			}
 
-		if ( token == "interAreaPortals" ) {
-			ParseInterAreaPortals( src );
-			continue;
+			src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
 		}
 
-		if ( token == "nodes" ) {
-			ParseNodes( src );
-			continue;
+		if ( bproc ) {
+			if ( !src->HadError() ) {
+				R_WriteBinaryProcInt( bproc, BPROC_END );
+				fileSystem->WriteFile( binaryFilename, bproc->GetDataPtr(), bproc->Length() );
+			}
+			delete bproc;
 		}
 
-		src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
+		delete src;
 	}
 
-	delete src;
-
 	// if it was a trivial map without any areas, create a single area
 	if ( !numPortalAreas ) {
 		ClearWorld();
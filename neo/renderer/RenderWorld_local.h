@@ -54,6 +54,15 @@ typedef struct doublePortal_s {
 } doublePortal_t;
 
 
+// world space boxes of the references in an area, in the order of the
+// reference list, laid out for idSIMDProcessor::CullBoxes
+typedef struct {
+	int				numBoxes;
+	int				stride;			// numBoxes rounded up to a multiple of 4
+	float *			boxes;			// BOX_SOA_COMPONENTS * stride floats
+	byte *			cullBits;		// result of the last CullBoxes
+} areaCullBoxes_t;
+
 typedef struct portalArea_s {
 	int				areaNum;
 	int				connectedAreaNum[NUM_PORTAL_ATTRIBUTES];	// if two areas have matching connectedAreaNum, they are
@@ -62,6 +71,9 @@ typedef struct portalArea_s {
 	portal_t *		portals;		// never changes after load
 	areaReference_t	entityRefs;		// head/tail of doubly linked list, may change
 	areaReference_t	lightRefs;		// head/tail of doubly linked list, may change
+	int				cullViewCount;	// the cull boxes are gathered in frame memory once per view
+	areaCullBoxes_t	entityBoxes;
+	areaCullBoxes_t	lightBoxes;
 } portalArea_t;
 
 
@@ -137,6 +149,8 @@ public:
 	idStr					mapName;				// ie: maps/tim_dm2.proc, written to demoFile
 	ID_TIME_T					mapTimeStamp;			// for fast reloads of the same level
 
+	void *					binaryProc;				// mapped .bproc file the world model indexes point into
+
 	areaNode_t *			areaNodes;
 	int						numAreaNodes;
 
@@ -173,11 +187,16 @@ public:
 	//-----------------------
 	// RenderWorld_load.cpp
 
-	idRenderModel *			ParseModel( idLexer *src );
-	idRenderModel *			ParseShadowModel( idLexer *src );
+	idRenderModel *			ParseModel( idLexer *src, idFile *bproc );
+	idRenderModel *			ParseShadowModel( idLexer *src, idFile *bproc );
 	void					SetupAreaRefs();
-	void					ParseInterAreaPortals( idLexer *src );
-	void					ParseNodes( idLexer *src );
+	void					ParseInterAreaPortals( idLexer *src, idFile *bproc );
+	void					ParseNodes( idLexer *src, idFile *bproc );
+	bool					LoadBinaryProc( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength );
+	idRenderModel *			ReadBinaryModel( struct bprocCursor_s &cursor );
+	idRenderModel *			ReadBinaryShadowModel( struct bprocCursor_s &cursor );
+	bool					ReadBinaryInterAreaPortals( struct bprocCursor_s &cursor );
+	bool					ReadBinaryNodes( struct bprocCursor_s &cursor );
 	int						CommonChildrenArea_r( areaNode_t *node );
 	void					FreeWorld();
 	void					ClearWorld();
@@ -198,6 +217,7 @@ public:
 	void					FlowLightThroughPortals( idRenderLightLocal *light );
 	areaNumRef_t *			FloodFrustumAreas_r( const idFrustum &frustum, const int areaNum, const idBounds &bounds, areaNumRef_t *areas );
 	areaNumRef_t *			FloodFrustumAreas( const idFrustum &frustum, areaNumRef_t *areas );
+	void					GatherAreaCullBoxes( portalArea_t *area );
 	bool					CullEntityByPortals( const idRenderEntityLocal *entity, const struct portalStack_s *ps );
 	void					AddAreaEntityRefs( int areaNum, const struct portalStack_s *ps );
 	bool					CullLightByPortals( const idRenderLightLocal *light, const struct portalStack_s *ps );
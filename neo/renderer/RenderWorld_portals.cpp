@@ -580,6 +580,84 @@ bool idRenderWorldLocal::CullEntityByPortals( const idRenderEntityLocal *entity,
 	return false;
 }
 
+/*
+================
+R_AllocAreaCullBoxes
+================
+*/
+static void R_AllocAreaCullBoxes( areaCullBoxes_t &cull, int numBoxes ) {
+	cull.numBoxes = numBoxes;
+	cull.stride = ( numBoxes + 3 ) & ~3;
+	cull.boxes = (float *)R_FrameAlloc( BOX_SOA_COMPONENTS * cull.stride * sizeof( float ) );
+	cull.cullBits = (byte *)R_FrameAlloc( cull.stride * sizeof( byte ) );
+}
+
+/*
+================
+R_SetAreaCullBox
+
+Stores the oriented box of local bounds transformed by a model matrix,
+a scaled model matrix just gives longer box axes.
+================
+*/
+static void R_SetAreaCullBox( areaCullBoxes_t &cull, int index, const idBounds &bounds, const float modelMatrix[16] ) {
+	idVec3	localCenter, globalCenter, extents;
+	float	*box;
+	int		i;
+
+	localCenter = ( bounds[0] + bounds[1] ) * 0.5f;
+	extents = ( bounds[1] - bounds[0] ) * 0.5f;
+	R_LocalPointToGlobal( modelMatrix, localCenter, globalCenter );
+
+	box = cull.boxes + index;
+	for ( i = 0; i < 3; i++ ) {
+		box[( 0 + i ) * cull.stride] = globalCenter[i];
+		box[( 3 + i ) * cull.stride] = modelMatrix[0 + i] * extents[0];
+		box[( 6 + i ) * cull.stride] = modelMatrix[4 + i] * extents[1];
+		box[( 9 + i ) * cull.stride] = modelMatrix[8 + i] * extents[2];
+	}
+}
+
+/*
+================
+GatherAreaCullBoxes
+
+Collects the reference bounds of all entities and the frustum bounds of all
+lights in the area into frame memory, once per view.
+================
+*/
+void idRenderWorldLocal::GatherAreaCullBoxes( portalArea_t *area ) {
+	areaReference_t	*ref;
+	int				i, num;
+	idBounds		huge( idVec3( -1e30f, -1e30f, -1e30f ), idVec3( 1e30f, 1e30f, 1e30f ) );
+
+	if ( area->cullViewCount == tr.viewCount ) {
+		return;
+	}
+	area->cullViewCount = tr.viewCount;
+
+	num = 0;
+	for ( ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; ref = ref->areaNext ) {
+		num++;
+	}
+	R_AllocAreaCullBoxes( area->entityBoxes, num );
+	for ( i = 0, ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; i++, ref = ref->areaNext ) {
+		R_SetAreaCullBox( area->entityBoxes, i, ref->entity->referenceBounds, ref->entity->modelMatrix );
+	}
+
+	num = 0;
+	for ( ref = area->lightRefs.areaNext ; ref != &area->lightRefs ; ref = ref->areaNext ) {
+		num++;
+	}
+	R_AllocAreaCullBoxes( area->lightBoxes, num );
+	for ( i = 0, ref = area->lightRefs.areaNext ; ref != &area->lightRefs ; i++, ref = ref->areaNext ) {
+		// the frustum triangles are already in world space, a light
+		// without them gets a box that is never culled
+		const srfTriangles_t *tri = ref->light->frustumTris;
+		R_SetAreaCullBox( area->lightBoxes, i, tri ? tri->bounds : huge, mat4_identity.ToFloatPtr() );
+	}
+}
+
 /*
 ===================
 AddAreaEntityRefs
@@ -597,7 +675,18 @@ void idRenderWorldLocal::AddAreaEntityRefs( int areaNum, const portalStack_t *ps
 
 	area = &portalAreas[ areaNum ];
 
-	for ( ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; ref = ref->areaNext ) {
+	// cull the reference bounds of all entities in the area at once, this is
+	// the exact box test, without the radius test of R_CullLocalBox in front
+	const byte *cullBits = NULL;
+	if ( r_useBatchedCulling.GetBool() && r_useEntityCulling.GetBool() && r_useCulling.GetInteger() >= 2 ) {
+		GatherAreaCullBoxes( area );
+		areaCullBoxes_t &cull = area->entityBoxes;
+		SIMDProcessor->CullBoxes( cull.cullBits, ps->portalPlanes, ps->numPortalPlanes, cull.boxes, cull.stride, cull.numBoxes );
+		cullBits = cull.cullBits;
+	}
+
+	int i;
+	for ( i = 0, ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; i++, ref = ref->areaNext ) {
 		entity = ref->entity;
 
 		// debug tool to allow viewing of only one entity at a time
@@ -621,7 +710,13 @@ void idRenderWorldLocal::AddAreaEntityRefs( int areaNum, const portalStack_t *ps
 		}
 
 		// cull reference bounds
-		if ( CullEntityByPortals( entity, ps ) ) {
+		if ( cullBits ) {
+			if ( cullBits[i] ) {
+				tr.pc.c_box_cull_out++;
+				continue;
+			}
+			tr.pc.c_box_cull_in++;
+		} else if ( CullEntityByPortals( entity, ps ) ) {
 			// we are culled out through this portal chain, but it might
 			// still be visible through others
 			continue;
@@ -728,7 +823,19 @@ void idRenderWorldLocal::AddAreaLightRefs( int areaNum, const portalStack_t *ps
 
 	area = &portalAreas[ areaNum ];
 
-	for ( lref = area->lightRefs.areaNext ; lref != &area->lightRefs ; lref = lref->areaNext ) {
+	// reject the lights with frustum bounds completely outside the portal
+	// stack before the more precise CullLightByPortals, the last stack
+	// plane is not used because lights are not near clipped
+	const byte *cullBits = NULL;
+	if ( r_useBatchedCulling.GetBool() && r_useLightCulling.GetInteger() != 0 ) {
+		GatherAreaCullBoxes( area );
+		areaCullBoxes_t &cull = area->lightBoxes;
+		SIMDProcessor->CullBoxes( cull.cullBits, ps->portalPlanes, ps->numPortalPlanes - 1, cull.boxes, cull.stride, cull.numBoxes );
+		cullBits = cull.cullBits;
+	}
+
+	int i;
+	for ( i = 0, lref = area->lightRefs.areaNext ; lref != &area->lightRefs ; i++, lref = lref->areaNext ) {
 		light = lref->light;
 
 		// debug tool to allow viewing of only one light at a time
@@ -745,6 +852,10 @@ void idRenderWorldLocal::AddAreaLightRefs( int areaNum, const portalStack_t *ps
 		}
 
 		// cull frustum
+		if ( cullBits && cullBits[i] ) {
+			tr.pc.c_box_cull_out++;
+			continue;
+		}
 		if ( CullLightByPortals( light, ps ) ) {
 			// we are culled out through this portal chain, but it might
 			// still be visible through others
@@ -854,6 +854,131 @@ idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 	return r;
 }
 
+/*
+=================
+R_PrepareInteractions
+
+Culls the shadow casting interactions of a light for the view.
+Every interaction belongs to a single light, so the lights can be
+handled in parallel.
+=================
+*/
+static void R_PrepareInteractions( const viewLight_t *vLight ) {
+	idInteraction *inter;
+
+	// all empty interactions are at the end of the list
+	for ( inter = vLight->lightDef->firstInteraction; inter != NULL && !inter->IsEmpty(); inter = inter->lightNext ) {
+		// the entity is neither visible nor casting a shadow into the view
+		if ( inter->entityDef->viewCount != tr.viewCount ) {
+			continue;
+		}
+		inter->PrepareShadowScissor();
+	}
+}
+
+typedef struct {
+	const viewLight_t **	lights;
+	int						numLights;
+	int						firstLight;
+	int						stride;
+} lightJob_t;
+
+static idJobGroup *			lightJobGroup;
+
+/*
+=================
+R_PrepareInteractionsJob
+=================
+*/
+static void R_PrepareInteractionsJob( void *data ) {
+	const lightJob_t *job = (const lightJob_t *)data;
+
+	for ( int i = job->firstLight; i < job->numLights; i += job->stride ) {
+		R_PrepareInteractions( job->lights[i] );
+	}
+}
+
+/*
+=================
+R_InitLightJobs
+=================
+*/
+void R_InitLightJobs( void ) {
+	lightJobGroup = jobSystem->AllocJobGroup( "lightInteractions" );
+}
+
+/*
+=================
+R_ShutdownLightJobs
+=================
+*/
+void R_ShutdownLightJobs( void ) {
+	if ( lightJobGroup ) {
+		jobSystem->FreeJobGroup( lightJobGroup );
+		lightJobGroup = NULL;
+	}
+}
+
+/*
+=================
+R_PrepareLightInteractions
+
+Does the view frustum culling and shadow scissor calculation of
+all interactions of the visible lights, which is the bulk of the
+work in R_AddModelSurfaces once the interactions have been created.
+The results are stored on each interaction and picked up by
+AddActiveInteraction, which still walks the entities in order and
+links the light surfaces serially, so the draw surface lists come
+out exactly the same as without the jobs.
+=================
+*/
+static void R_PrepareLightInteractions( void ) {
+	const viewLight_t *vLight;
+	int numLights, numJobs;
+
+	numJobs = r_interactionJobs.GetInteger();
+	if ( numJobs < 0 ) {
+		numJobs = jobSystem->GetNumThreads();
+	}
+
+	// the debug visualizations draw from inside the culling code and
+	// the precise intersection scissor is not thread safe, so leave it
+	// to AddActiveInteraction
+	if ( numJobs <= 0 || lightJobGroup == NULL || r_useInteractionScissors.GetInteger() < 0 ||
+			r_showInteractionFrustums.GetInteger() || r_showInteractionScissors.GetInteger() ) {
+		return;
+	}
+
+	numLights = 0;
+	for ( vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next ) {
+		numLights++;
+	}
+	if ( numLights == 0 ) {
+		return;
+	}
+	if ( numJobs > numLights ) {
+		numJobs = numLights;
+	}
+
+	const viewLight_t **lights = (const viewLight_t **)R_FrameAlloc( numLights * sizeof( lights[0] ) );
+	numLights = 0;
+	for ( vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next ) {
+		lights[numLights++] = vLight;
+	}
+
+	// interleave the lights over the jobs so a run of expensive lights
+	// doesn't end up in a single job
+	lightJob_t *jobs = (lightJob_t *)R_FrameAlloc( numJobs * sizeof( jobs[0] ) );
+	for ( int i = 0; i < numJobs; i++ ) {
+		jobs[i].lights = lights;
+		jobs[i].numLights = numLights;
+		jobs[i].firstLight = i;
+		jobs[i].stride = numJobs;
+		lightJobGroup->AddJob( R_PrepareInteractionsJob, &jobs[i] );
+	}
+	lightJobGroup->Run();
+}
+
 /*
 =================
 R_AddLightSurfaces
@@ -1048,6 +1173,9 @@ void R_AddLightSurfaces( void ) {
 			R_LinkLightSurf( &vLight->globalShadows, tri, NULL, light, NULL, vLight->scissorRect, true /* FIXME? */ );
 		}
 	}
+
+	// now that all interactions for the view exist, cull them in parallel
+	R_PrepareLightInteractions();
 }
 
 //===============================================================================================================
@@ -1091,6 +1219,37 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 	return update;
 }
 
+static bool							deferDynamicModels = false;
+static idList<idRenderEntityLocal *>	deferredModelDefs;
+
+/*
+===================
+R_FinishEntityDefDynamicModel
+
+Adds the overlays to a newly instantiated dynamic model.
+===================
+*/
+static void R_FinishEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	// add any overlays to the snapshot of the dynamic model
+	if ( def->overlay && !r_skipOverlays.GetBool() ) {
+		def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+	} else {
+		idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
+	}
+
+	if ( r_checkBounds.GetBool() ) {
+		idBounds b = def->cachedDynamicModel->Bounds();
+		if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+				b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+				b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+				b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+				b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+				b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+			common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
+		}
+	}
+}
+
 /*
 ===================
 R_EntityDefDynamicModel
@@ -1135,24 +1294,11 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
 
 		if ( def->cachedDynamicModel ) {
-
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+			if ( deferDynamicModels ) {
+				// the overlays need the skinned vertexes
+				deferredModelDefs.Append( def );
 			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
-
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+				R_FinishEntityDefDynamicModel( def );
 			}
 		}
 
@@ -1175,6 +1321,103 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	return def->dynamicModel;
 }
 
+/*
+===================
+R_SetEntityScissor
+
+Intersects the portal crossing scissor rectangle of the entity with the
+screen area the entity covers, once per view entity.
+===================
+*/
+static void R_SetEntityScissor( viewEntity_t *vEntity ) {
+	if ( vEntity->entityScissorSet ) {
+		return;
+	}
+	vEntity->entityScissorSet = true;
+
+	if ( r_useEntityScissors.GetBool() ) {
+		// calculate the screen area covered by the entity
+		idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
+		// intersect with the portal crossing scissor rectangle
+		vEntity->scissorRect.Intersect( scissorRect );
+
+		if ( r_showEntityScissors.GetBool() ) {
+			R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
+		}
+	}
+}
+
+/*
+===================
+R_SkinDynamicModels
+
+Instantiates the dynamic models of all entities that R_AddModelSurfaces
+is going to draw up front, so the md5 meshes can be skinned in parallel
+jobs instead of one by one as the interactions and surfaces are added.
+The surfaces are still allocated and set up in the same order on the main
+thread, and the overlays are added once the skinning is done.  Entities
+that are only visible to lights are instantiated on demand as before.
+
+Unlike the serial path, which only derives tangents for the surfaces an
+interaction actually lights, the jobs derive them for every surface with
+a lit material, because the interactions aren't known yet.  A visible
+lit-material surface that no light reaches pays for its tangents anyway.
+===================
+*/
+void R_SkinDynamicModels( void ) {
+	viewEntity_t *			vEntity;
+	idRenderEntityLocal *	def;
+	float					oldFloatTime;
+	int						oldTime;
+	int						i;
+
+	if ( !R_BeginDeferredSkinning() ) {
+		return;
+	}
+
+	deferDynamicModels = true;
+	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		def = vEntity->entityDef;
+
+		// same checks as R_AddModelSurfaces, including the entity scissor
+		R_SetEntityScissor( vEntity );
+		if ( vEntity->scissorRect.IsEmpty() ) {
+			continue;
+		}
+		if ( tr.viewDef->isXraySubview ? ( def->parms.xrayIndex == 1 ) : ( def->parms.xrayIndex == 2 ) ) {
+			continue;
+		}
+		if ( def->parms.hModel == NULL || def->parms.hModel->IsDynamicModel() != DM_CACHED ) {
+			continue;
+		}
+
+		game->SelectTimeGroup( def->parms.timeGroup );
+
+		if ( def->parms.timeGroup ) {
+			oldFloatTime = tr.viewDef->floatTime;
+			oldTime = tr.viewDef->renderView.time;
+
+			tr.viewDef->floatTime = game->GetTimeGroupTime( def->parms.timeGroup ) * 0.001;
+			tr.viewDef->renderView.time = game->GetTimeGroupTime( def->parms.timeGroup );
+		}
+
+		R_EntityDefDynamicModel( def );
+
+		if ( def->parms.timeGroup ) {
+			tr.viewDef->floatTime = oldFloatTime;
+			tr.viewDef->renderView.time = oldTime;
+		}
+	}
+	deferDynamicModels = false;
+
+	R_EndDeferredSkinning();
+
+	for ( i = 0; i < deferredModelDefs.Num(); i++ ) {
+		R_FinishEntityDefDynamicModel( deferredModelDefs[i] );
+	}
+	deferredModelDefs.SetNum( 0, false );
+}
+
 /*
 =================
 R_AddDrawSurf
@@ -1470,16 +1713,8 @@ void R_AddModelSurfaces( void ) {
 	// any light that intersects the view (for shadows)
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
 
-		if ( r_useEntityScissors.GetBool() ) {
-			// calculate the screen area covered by the entity
-			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
-			// intersect with the portal crossing scissor rectangle
-			vEntity->scissorRect.Intersect( scissorRect );
-
-			if ( r_showEntityScissors.GetBool() ) {
-				R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
-			}
-		}
+		// R_SkinDynamicModels may have done this already
+		R_SetEntityScissor( vEntity );
 
 		float oldFloatTime;
 		int oldTime;
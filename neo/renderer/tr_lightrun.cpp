@@ -775,6 +775,9 @@ void R_FreeDerivedData( void ) {
 			R_FreeLightDefDerivedData( light );
 		}
 	}
+
+	// the models may be reloaded
+	R_PurgeShadowCache();
 }
 
 /*
@@ -802,6 +805,9 @@ void R_CheckForEntityDefsUsingModel( idRenderModel *model ) {
 			}
 		}
 	}
+
+	// the cached shadows point at the surfaces of the model
+	R_PurgeShadowCacheModel( model );
 }
 
 /*
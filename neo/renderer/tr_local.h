@@ -196,6 +196,9 @@ public:
 	bool					lightHasMoved;			// the light has changed its position since it was
 													// first added, so the prelight model is not valid
 
+	bool					skipShadowCache;		// the shape changed, so the shadow volumes of the freed
+													// interactions are not worth keeping in the shadow cache
+
 	float					modelMatrix[16];		// this is just a rearrangement of parms.axis and parms.origin
 
 	idRenderWorldLocal *	world;
@@ -290,6 +293,9 @@ public:
 	idInteraction *			lastInteraction;
 
 	bool					needsPortalSky;
+
+	bool					skipShadowCache;		// the shape changed, so the shadow volumes of the freed
+													// interactions are not worth keeping in the shadow cache
 };
 
 
@@ -356,6 +362,7 @@ typedef struct viewEntity_s {
 	// a viewEntity can have a non-empty scissorRect, meaning that an area
 	// that it is in is visible, and still not be visible.
 	idScreenRect		scissorRect;
+	bool				entityScissorSet;		// scissorRect is already intersected with the entity scissor
 
 	bool				weaponDepthHack;
 	float				modelDepthHack;
@@ -518,26 +525,41 @@ typedef struct frameMemoryBlock_s {
 	struct frameMemoryBlock_s *next;
 	int		size;
 	int		used;
-	int		poop;			// so that base is 16 byte aligned
-	byte	base[4];	// dynamically allocated as [size]
+	byte *	base;		// 16 byte aligned, dynamically allocated as [size] after the header
 } frameMemoryBlock_t;
 
-// all of the information needed by the back end must be
-// contained in a frameData_t.  This entire structure is
-// duplicated so the front and back end can run in parallel
-// on an SMP machine (OBSOLETE: this capability has been removed)
+// every thread of the job system bumps its own chain of blocks,
+// so frame allocations never need a lock
 typedef struct {
-	// one or more blocks of memory for all frame
-	// temporary allocations
+	// one or more blocks of memory, kept from frame to frame
 	frameMemoryBlock_t	*memory;
 
 	// alloc will point somewhere into the memory chain
 	frameMemoryBlock_t	*alloc;
 
+	int					frameBytes;			// allocated on the current frame
+	int					numAllocs;			// allocations on the current frame
+	int					highwater;			// max allocated on any frame
+	int					numBlocks;
+
+	// keep the arenas of different threads on separate cache lines
+	byte				padding[64 - 2 * sizeof( void * ) - 4 * sizeof( int )];
+} frameArena_t;
+
+// all of the information needed by the back end must be
+// contained in a frameData_t.  This entire structure is
+// duplicated so the front and back end can run in parallel
+// on an SMP machine (OBSOLETE: this capability has been removed)
+typedef struct {
+	// the frame temporary allocations, one arena for the
+	// main thread followed by one for each job worker
+	frameArena_t *		arenas;
+	int					numArenas;
+
 	srfTriangles_t *	firstDeferredFreeTriSurf;
 	srfTriangles_t *	lastDeferredFreeTriSurf;
 
-	int					memoryHighwater;	// max used on any frame
+	int					memoryHighwater;	// max used on any frame by all arenas together
 
 	// the currently building command list 
 	// commands can be inserted at the front if needed, as for required
@@ -867,8 +889,11 @@ extern idCVar r_useLightScissors;		// 1 = use custom scissor rectangle for each
 extern idCVar r_useClippedLightScissors;// 0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always
 extern idCVar r_useEntityCulling;		// 0 = none, 1 = box
 extern idCVar r_useEntityScissors;		// 1 = use custom scissor rectangle for each entity
+extern idCVar r_useBatchedCulling;		// 1 = cull all entities and lights of an area at once with SIMD
 extern idCVar r_useInteractionCulling;	// 1 = cull interactions
 extern idCVar r_useInteractionScissors;	// 1 = use a custom scissor rectangle for each interaction
+extern idCVar r_interactionJobs;		// number of jobs the interactions are culled in, 0 = serial, -1 = one per job thread
+extern idCVar r_skinningJobs;			// number of jobs the visible md5 meshes are skinned in, 0 = serial, -1 = one per job thread
 extern idCVar r_useFrustumFarDistance;	// if != 0 force the view frustum far distance to this distance
 extern idCVar r_useShadowCulling;		// try to cull shadows from partially visible lights
 extern idCVar r_usePreciseTriangleInteractions;	// 1 = do winding clipping to determine if each ambiguous tri should be lit
@@ -877,8 +902,10 @@ extern idCVar r_useExternalShadows;		// 1 = skip drawing caps when outside the l
 extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow volumes
 extern idCVar r_useShadowVertexProgram;	// 1 = do the shadow projection in the vertex program on capable cards
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
+extern idCVar r_shadowCacheSize;		// megabytes of freed shadow volumes kept for reuse, 0 = no shadow cache
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_useBinaryProc;			// 1 = load the world from a precompiled .bproc file, written on the first load
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
@@ -1179,6 +1206,15 @@ void R_ListRenderEntityDefs_f( const idCmdArgs &args );
 
 bool R_IssueEntityDefCallback( idRenderEntityLocal *def );
 idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def );
+void R_SkinDynamicModels( void );
+idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity );
+
+// md5 meshes instantiated between these two calls are skinned in parallel jobs
+void R_InitSkinningJobs( void );
+void R_ShutdownSkinningJobs( void );
+bool R_BeginDeferredSkinning( void );
+void R_EndDeferredSkinning( void );
+void R_TestSkinning_f( const idCmdArgs &args );
 
 viewEntity_t *R_SetEntityDefViewEntity( idRenderEntityLocal *def );
 viewLight_t *R_SetLightDefViewLight( idRenderLightLocal *def );
@@ -1209,6 +1245,8 @@ void R_ModulateLights_f( const idCmdArgs &args );
 void R_SetLightProject( idPlane lightProject[4], const idVec3 origin, const idVec3 targetPoint,
 	   const idVec3 rightVector, const idVec3 upVector, const idVec3 start, const idVec3 stop );
 
+void R_InitLightJobs( void );
+void R_ShutdownLightJobs( void );
 void R_AddLightSurfaces( void );
 void R_AddModelSurfaces( void );
 void R_RemoveUnecessaryViewLights( void );
@@ -1435,6 +1473,39 @@ srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
 /*
 ============================================================
 
+TR_SHADOWCACHE
+
+Keeps the shadow volumes of freed interactions with static models around,
+so they don't have to be generated again when the same light / entity pair
+comes back with the same shape
+
+============================================================
+*/
+
+void			R_InitShadowCache( void );
+void			R_ShutdownShadowCache( void );
+
+// takes ownership of the shadow volumes of an interaction that is being freed
+void			R_StoreCachedShadows( idInteraction *inter );
+
+// returns the cached shadow volumes for an interaction that is being created, or NULL
+// the caller has to take the surfaces it uses, and then call R_ReleaseCachedShadows
+struct shadowCacheEntry_s *R_FindCachedShadows( const idInteraction *inter );
+srfTriangles_t *R_TakeCachedShadow( struct shadowCacheEntry_s *entry, int surfaceNum, const srfTriangles_t *ambientTris );
+void			R_ReleaseCachedShadows( struct shadowCacheEntry_s *entry );
+
+void			R_PurgeShadowCache( void );
+void			R_PurgeShadowCacheWorld( const idRenderWorldLocal *world );
+void			R_PurgeShadowCacheModel( const idRenderModel *model );
+
+// the shadow volumes of an entity only depend on these parms
+bool			R_EntityShadowShapeMatches( const renderEntity_t *a, const renderEntity_t *b );
+
+void			R_ShadowCacheStats_f( const idCmdArgs &args );
+
+/*
+============================================================
+
 util/shadowopt3
 
 dmap time optimization of shadow volumes, called from R_CreateShadowVolume
@@ -1572,6 +1643,8 @@ void R_ToggleSmpFrame( void );
 void *R_FrameAlloc( int bytes );
 void *R_ClearedFrameAlloc( int bytes );
 void R_FrameFree( void *data );
+void R_RecordFrameAllocs_f( const idCmdArgs &args );
+void R_TestFrameAlloc_f( const idCmdArgs &args );
 
 void *R_StaticAlloc( int bytes );		// just malloc with error checking
 void *R_ClearedStaticAlloc( int bytes );	// with memset
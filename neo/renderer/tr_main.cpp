@@ -176,6 +176,21 @@ void R_ShowColoredScreenRect( const idScreenRect &rect, int colorIndex ) {
 	}
 }
 
+#define	MEMORY_BLOCK_SIZE	0x100000
+
+// recording of the frame allocation sizes for testFrameAlloc
+enum {
+	FRAME_ALLOC_IDLE,
+	FRAME_ALLOC_ARMED,		// starts recording at the next frame
+	FRAME_ALLOC_RECORDING
+};
+
+static int			frameAllocRecordState = FRAME_ALLOC_IDLE;
+static idList<int>	frameAllocRecording;
+
+static void			R_ResetFrameArenas( frameData_t *frame );
+static void			R_UpdateFrameAllocRecording( void );
+
 /*
 ====================
 R_ToggleSmpFrame
@@ -187,22 +202,13 @@ void R_ToggleSmpFrame( void ) {
 	}
 	R_FreeDeferredTriSurfs( frameData );
 
-	// clear frame-temporary data
-	frameData_t		*frame;
-	frameMemoryBlock_t	*block;
-
 	// update the highwater mark
 	R_CountFrameData();
 
-	frame = frameData;
-
-	// reset the memory allocation to the first block
-	frame->alloc = frame->memory;
+	R_UpdateFrameAllocRecording();
 
-	// clear all the blocks
-	for ( block = frame->memory ; block ; block = block->next ) {
-		block->used = 0;
-	}
+	// clear frame-temporary data
+	R_ResetFrameArenas( frameData );
 
 	R_ClearCommandChain();
 }
@@ -210,31 +216,154 @@ void R_ToggleSmpFrame( void ) {
 
 //=====================================================
 
-#define	MEMORY_BLOCK_SIZE	0x100000
+/*
+=====================
+R_AllocFrameMemoryBlock
+
+The blocks come from malloc instead of Mem_Alloc, which is not thread
+safe, so a job can grow the arena of its thread. Blocks are kept from
+frame to frame, so this only happens while the frame memory use grows.
+=====================
+*/
+static frameMemoryBlock_t *R_AllocFrameMemoryBlock( int size ) {
+	frameMemoryBlock_t *block;
+
+	block = (frameMemoryBlock_t *)malloc( sizeof( *block ) + size + 15 );
+	if ( !block ) {
+		common->FatalError( "R_AllocFrameMemoryBlock: malloc() failed" );
+	}
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	block->base = (byte *)( ( (intptr_t)( block + 1 ) + 15 ) & ~15 );
+	return block;
+}
 
 /*
 =====================
-R_ShutdownFrameData
+R_AllocFrameData
 =====================
 */
-void R_ShutdownFrameData( void ) {
+static frameData_t *R_AllocFrameData( int numArenas ) {
 	frameData_t *frame;
-	frameMemoryBlock_t *block;
 
+	frame = (frameData_t *)Mem_ClearedAlloc( sizeof( *frame ) );
+	frame->arenas = (frameArena_t *)Mem_ClearedAlloc( numArenas * sizeof( frame->arenas[0] ) );
+	frame->numArenas = numArenas;
+	frame->memoryHighwater = 0;
+
+	// the main thread always needs frame memory, the job threads get
+	// their first block when they allocate something
+	frame->arenas[0].memory = R_AllocFrameMemoryBlock( MEMORY_BLOCK_SIZE );
+	frame->arenas[0].alloc = frame->arenas[0].memory;
+	frame->arenas[0].numBlocks = 1;
+
+	return frame;
+}
+
+/*
+=====================
+R_FreeFrameData
+=====================
+*/
+static void R_FreeFrameData( frameData_t *frame ) {
+	frameMemoryBlock_t *block, *nextBlock;
+
+	for ( int i = 0; i < frame->numArenas; i++ ) {
+		for ( block = frame->arenas[i].memory; block; block = nextBlock ) {
+			nextBlock = block->next;
+			free( block );
+		}
+	}
+	Mem_Free( frame->arenas );
+	Mem_Free( frame );
+}
+
+/*
+=====================
+R_ResetFrameArenas
+
+Constant time per arena, blocks further down a chain are
+reset when the allocation advances into them.
+=====================
+*/
+static void R_ResetFrameArenas( frameData_t *frame ) {
+	for ( int i = 0; i < frame->numArenas; i++ ) {
+		frameArena_t *arena = &frame->arenas[i];
+
+		// reset the memory allocation to the first block
+		arena->alloc = arena->memory;
+		if ( arena->memory ) {
+			arena->memory->used = 0;
+		}
+		arena->frameBytes = 0;
+		arena->numAllocs = 0;
+	}
+}
+
+/*
+=====================
+R_ArenaAlloc
+=====================
+*/
+static void *R_ArenaAlloc( frameArena_t *arena, int bytes ) {
+	frameMemoryBlock_t	*block;
+	void			*buf;
+
+	bytes = (bytes+16)&~15;
+
+	arena->frameBytes += bytes;
+	arena->numAllocs++;
+
+	// see if it can be satisfied in the current block
+	block = arena->alloc;
+	if ( block && block->size - block->used >= bytes ) {
+		buf = block->base + block->used;
+		block->used += bytes;
+		return buf;
+	}
+
+	// we could fix this if we needed to...
+	if ( bytes > MEMORY_BLOCK_SIZE ) {
+		common->FatalError( "R_FrameAlloc of %i exceeded MEMORY_BLOCK_SIZE",
+			bytes );
+	}
+
+	// advance to the next memory block if available
+	block = block ? block->next : NULL;
+	// create a new block if we are at the end of
+	// the chain
+	if ( !block ) {
+		block = R_AllocFrameMemoryBlock( MEMORY_BLOCK_SIZE );
+		if ( arena->alloc ) {
+			arena->alloc->next = block;
+		} else {
+			arena->memory = block;
+		}
+		arena->numBlocks++;
+	}
+
+	arena->alloc = block;
+
+	block->used = bytes;
+
+	return block->base;
+}
+
+/*
+=====================
+R_ShutdownFrameData
+=====================
+*/
+void R_ShutdownFrameData( void ) {
 	// free any current data
-	frame = frameData;
-	if ( !frame ) {
+	if ( !frameData ) {
 		return;
 	}
 
-	R_FreeDeferredTriSurfs( frame );
+	R_FreeDeferredTriSurfs( frameData );
 
-	frameMemoryBlock_t *nextBlock;
-	for ( block = frame->memory ; block ; block = nextBlock ) {
-		nextBlock = block->next;
-		Mem_Free( block );
-	}
-	Mem_Free( frame );
+	R_FreeFrameData( frameData );
 	frameData = NULL;
 }
 
@@ -244,24 +373,10 @@ R_InitFrameData
 =====================
 */
 void R_InitFrameData( void ) {
-	int size;
-	frameData_t *frame;
-	frameMemoryBlock_t *block;
-
 	R_ShutdownFrameData();
 
-	frameData = (frameData_t *)Mem_ClearedAlloc( sizeof( *frameData ));
-	frame = frameData;
-	size = MEMORY_BLOCK_SIZE;
-	block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-	if ( !block ) {
-		common->FatalError( "R_InitFrameData: Mem_Alloc() failed" );
-	}
-	block->size = size;
-	block->used = 0;
-	block->next = NULL;
-	frame->memory = block;
-	frame->memoryHighwater = 0;
+	// one arena for the main thread and one for each job worker
+	frameData = R_AllocFrameData( jobSystem->GetNumThreads() );
 
 	R_ToggleSmpFrame();
 }
@@ -269,19 +384,21 @@ void R_InitFrameData( void ) {
 /*
 ================
 R_CountFrameData
+
+Also updates the highwater marks of the arenas.
 ================
 */
 int R_CountFrameData( void ) {
 	frameData_t		*frame;
-	frameMemoryBlock_t	*block;
 	int				count;
 
 	count = 0;
 	frame = frameData;
-	for ( block = frame->memory ; block ; block=block->next ) {
-		count += block->used;
-		if ( block == frame->alloc ) {
-			break;
+	for ( int i = 0; i < frame->numArenas; i++ ) {
+		frameArena_t *arena = &frame->arenas[i];
+		count += arena->frameBytes;
+		if ( arena->frameBytes > arena->highwater ) {
+			arena->highwater = arena->frameBytes;
 		}
 	}
 
@@ -347,13 +464,13 @@ current frame's back end completes.
 This should only be called by the front end.  The
 back end shouldn't need to allocate memory.
 
-If we passed smpFrame in, the back end could
-alloc memory, because it will always be a
-different frameData than the front end is using.
-
 All temporary data, like dynamic tesselations
 and local spaces are allocated here.
 
+Every thread of the job system allocates from its own
+arena, so this can be called from front end jobs without
+any locking. Other threads share the main thread's arena.
+
 The memory will not move, but it may not be
 contiguous with previous allocations even
 from this frame.
@@ -363,14 +480,101 @@ Should part of this be inlined in a macro?
 ================
 */
 void *R_FrameAlloc( int bytes ) {
-	frameData_t		*frame;
+	int threadIndex = jobSystem->GetThreadIndex();
+	if ( threadIndex < 0 ) {
+		threadIndex = 0;
+	} else if ( threadIndex >= frameData->numArenas ) {
+		common->FatalError( "R_FrameAlloc: no arena for job thread %i", threadIndex );
+	}
+
+	if ( frameAllocRecordState == FRAME_ALLOC_RECORDING && threadIndex == 0 ) {
+		frameAllocRecording.Append( bytes );
+	}
+
+	return R_ArenaAlloc( &frameData->arenas[threadIndex], bytes );
+}
+
+/*
+==================
+R_ClearedFrameAlloc
+==================
+*/
+void *R_ClearedFrameAlloc( int bytes ) {
+	void	*r;
+
+	r = R_FrameAlloc( bytes );
+	SIMDProcessor->Memset( r, 0, bytes );
+	return r;
+}
+
+
+/*
+==================
+R_FrameFree
+
+This does nothing at all, as the frame data is reused every frame
+and can only be stack allocated.
+
+The only reason for it's existance is so functions that can
+use either static or frame memory can set function pointers
+to both alloc and free.
+==================
+*/
+void R_FrameFree( void *data ) {
+}
+
+/*
+==================
+R_RecordFrameAllocs_f
+
+Records the sizes of the main thread frame allocations
+of the next frame, which testFrameAlloc replays.
+==================
+*/
+void R_RecordFrameAllocs_f( const idCmdArgs &args ) {
+	frameAllocRecordState = FRAME_ALLOC_ARMED;
+	common->Printf( "recording the frame allocations of the next frame\n" );
+}
+
+/*
+==================
+R_UpdateFrameAllocRecording
+
+Called at the frame boundary, a recording covers exactly one frame.
+==================
+*/
+static void R_UpdateFrameAllocRecording( void ) {
+	if ( frameAllocRecordState == FRAME_ALLOC_ARMED ) {
+		frameAllocRecording.Clear();
+		frameAllocRecordState = FRAME_ALLOC_RECORDING;
+	} else if ( frameAllocRecordState == FRAME_ALLOC_RECORDING ) {
+		int total = 0;
+		for ( int i = 0; i < frameAllocRecording.Num(); i++ ) {
+			total += frameAllocRecording[i];
+		}
+		common->Printf( "recorded %i frame allocations, %i bytes\n", frameAllocRecording.Num(), total );
+		frameAllocRecordState = FRAME_ALLOC_IDLE;
+	}
+}
+
+// the single block chain R_FrameAlloc used before the per thread arenas
+typedef struct {
+	frameMemoryBlock_t	*memory;
+	frameMemoryBlock_t	*alloc;
+} frameBlockChain_t;
+
+/*
+==================
+R_BlockChainAlloc
+==================
+*/
+static void *R_BlockChainAlloc( frameBlockChain_t *chain, int bytes ) {
 	frameMemoryBlock_t	*block;
 	void			*buf;
-    
+
 	bytes = (bytes+16)&~15;
 	// see if it can be satisfied in the current block
-	frame = frameData;
-	block = frame->alloc;
+	block = chain->alloc;
 
 	if ( block->size - block->used >= bytes ) {
 		buf = block->base + block->used;
@@ -383,26 +587,11 @@ void *R_FrameAlloc( int bytes ) {
 	// create a new block if we are at the end of
 	// the chain
 	if ( !block ) {
-		int		size;
-
-		size = MEMORY_BLOCK_SIZE;
-		block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-		if ( !block ) {
-			common->FatalError( "R_FrameAlloc: Mem_Alloc() failed" );
-		}
-		block->size = size;
-		block->used = 0;
-		block->next = NULL;
-		frame->alloc->next = block;
+		block = R_AllocFrameMemoryBlock( MEMORY_BLOCK_SIZE );
+		chain->alloc->next = block;
 	}
 
-	// we could fix this if we needed to...
-	if ( bytes > block->size ) {
-		common->FatalError( "R_FrameAlloc of %i exceeded MEMORY_BLOCK_SIZE",
-			bytes );
-	}
-
-	frame->alloc = block;
+	chain->alloc = block;
 
 	block->used = bytes;
 
@@ -411,31 +600,157 @@ void *R_FrameAlloc( int bytes ) {
 
 /*
 ==================
-R_ClearedFrameAlloc
+R_ResetBlockChain
 ==================
 */
-void *R_ClearedFrameAlloc( int bytes ) {
-	void	*r;
+static void R_ResetBlockChain( frameBlockChain_t *chain ) {
+	frameMemoryBlock_t	*block;
 
-	r = R_FrameAlloc( bytes );
-	SIMDProcessor->Memset( r, 0, bytes );
-	return r;
+	// reset the memory allocation to the first block
+	chain->alloc = chain->memory;
+
+	// clear all the blocks
+	for ( block = chain->memory ; block ; block = block->next ) {
+		block->used = 0;
+	}
 }
 
+typedef struct {
+	frameData_t *		frame;
+	const int *			sizes;
+	int					numSizes;
+} frameAllocJob_t;
 
 /*
 ==================
-R_FrameFree
+R_ReplayFrameAllocsJob
+==================
+*/
+static void R_ReplayFrameAllocsJob( void *data ) {
+	const frameAllocJob_t *job = (const frameAllocJob_t *)data;
+	int threadIndex = Max( jobSystem->GetThreadIndex(), 0 );
+	frameArena_t *arena = &job->frame->arenas[threadIndex];
+
+	for ( int i = 0; i < job->numSizes; i++ ) {
+		byte *buf = (byte *)R_ArenaAlloc( arena, job->sizes[i] );
+		buf[0] = 0;
+	}
+}
 
-This does nothing at all, as the frame data is reused every frame
-and can only be stack allocated.
+/*
+==================
+R_TestFrameAlloc_f
 
-The only reason for it's existance is so functions that can
-use either static or frame memory can set function pointers
-to both alloc and free.
+Replays the allocation sizes of a frame recorded with recordFrameAllocs
+through the old single block chain and the per thread arenas, both on
+the main thread and spread over jobs.
 ==================
 */
-void R_FrameFree( void *data ) {
+void R_TestFrameAlloc_f( const idCmdArgs &args ) {
+	idList<int>		sizes;
+	int				iterations;
+	int				totalBytes;
+	double			start;
+
+	iterations = 100;
+	if ( args.Argc() > 1 ) {
+		iterations = Max( 1, atoi( args.Argv( 1 ) ) );
+	}
+
+	if ( frameAllocRecording.Num() && frameAllocRecordState == FRAME_ALLOC_IDLE ) {
+		sizes = frameAllocRecording;
+	} else {
+		// mostly small structures like drawSurfs and shader registers
+		// with the occasional deformed or gui surface
+		common->Printf( "no recorded frame, replaying a synthetic frame (use recordFrameAllocs to record one)\n" );
+		idRandom random( 0 );
+		sizes.SetNum( 20000 );
+		for ( int i = 0; i < sizes.Num(); i++ ) {
+			int r = random.RandomInt( 100 );
+			if ( r < 70 ) {
+				sizes[i] = 16 + random.RandomInt( 240 );
+			} else if ( r < 95 ) {
+				sizes[i] = 256 + random.RandomInt( 3840 );
+			} else {
+				sizes[i] = 4096 + random.RandomInt( 61440 );
+			}
+		}
+	}
+
+	totalBytes = 0;
+	for ( int i = 0; i < sizes.Num(); i++ ) {
+		totalBytes += sizes[i];
+	}
+
+	common->Printf( "testFrameAlloc: %i allocations, %i bytes per frame, %i iterations\n", sizes.Num(), totalBytes, iterations );
+
+	// the single block chain
+	frameBlockChain_t chain;
+	chain.memory = chain.alloc = R_AllocFrameMemoryBlock( MEMORY_BLOCK_SIZE );
+
+	start = Sys_GetClockTicks();
+	for ( int j = 0; j < iterations; j++ ) {
+		R_ResetBlockChain( &chain );
+		for ( int i = 0; i < sizes.Num(); i++ ) {
+			byte *buf = (byte *)R_BlockChainAlloc( &chain, sizes[i] );
+			buf[0] = 0;
+		}
+	}
+	double chainTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	frameMemoryBlock_t *block, *nextBlock;
+	for ( block = chain.memory; block; block = nextBlock ) {
+		nextBlock = block->next;
+		free( block );
+	}
+
+	// the arena of the main thread
+	frameData_t *frame = R_AllocFrameData( jobSystem->GetNumThreads() );
+
+	start = Sys_GetClockTicks();
+	for ( int j = 0; j < iterations; j++ ) {
+		R_ResetFrameArenas( frame );
+		for ( int i = 0; i < sizes.Num(); i++ ) {
+			byte *buf = (byte *)R_ArenaAlloc( &frame->arenas[0], sizes[i] );
+			buf[0] = 0;
+		}
+	}
+	double arenaTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	// the same allocations spread over jobs on all threads
+	int numJobs = frame->numArenas * 4;
+	frameAllocJob_t *jobs = new frameAllocJob_t[numJobs];
+	int sizesPerJob = ( sizes.Num() + numJobs - 1 ) / numJobs;
+	for ( int i = 0; i < numJobs; i++ ) {
+		int first = Min( i * sizesPerJob, sizes.Num() );
+		jobs[i].frame = frame;
+		jobs[i].sizes = sizes.Ptr() + first;
+		jobs[i].numSizes = Min( sizesPerJob, sizes.Num() - first );
+	}
+
+	idJobGroup *group = jobSystem->AllocJobGroup( "testFrameAlloc" );
+
+	start = Sys_GetClockTicks();
+	for ( int j = 0; j < iterations; j++ ) {
+		R_ResetFrameArenas( frame );
+		for ( int i = 0; i < numJobs; i++ ) {
+			group->AddJob( R_ReplayFrameAllocsJob, &jobs[i] );
+		}
+		group->Run();
+	}
+	double jobTime = ( Sys_GetClockTicks() - start ) / Sys_ClockTicksPerSecond();
+
+	jobSystem->FreeJobGroup( group );
+	delete[] jobs;
+
+	common->Printf( "block chain: %8.3f usec per frame\n", chainTime * 1e6 / iterations );
+	common->Printf( "arena:       %8.3f usec per frame\n", arenaTime * 1e6 / iterations );
+	common->Printf( "arena jobs:  %8.3f usec per frame in %i jobs on %i threads\n", jobTime * 1e6 / iterations, numJobs, frame->numArenas );
+	for ( int i = 0; i < frame->numArenas; i++ ) {
+		common->Printf( "thread %2i: %i blocks\n", i, frame->arenas[i].numBlocks );
+	}
+
+	R_FreeFrameData( frame );
 }
 
 
@@ -1126,6 +1441,9 @@ void R_RenderView( viewDef_t *parms ) {
 	// constrain the view frustum to the view lights and entities
 	R_ConstrainViewFrustum();
 
+	// instantiate the dynamic models of the visible entities and skin them in parallel
+	R_SkinDynamicModels();
+
 	// make sure that interactions exist for all light / entity combinations
 	// that are visible
 	// add any pre-generated light shadows, and calculate the light shader values
@@ -0,0 +1,529 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+
+The shadow volumes of an interaction are thrown away whenever the interaction is
+freed, which happens on every entity update that isn't an exact match, even if
+only the shader parms changed, and whenever a light or entity is removed and added
+back again.  The shadow cache takes over the shadow volumes of static models when
+their interaction is freed, and hands them back when an interaction between the
+same lightDef and entityDef is created again.
+
+Entries are keyed on the lightDef and entityDef handles and checked against everything
+the shadow volumes were generated from, so a handle that was reused for a different
+light or entity just misses.  UpdateEntityDef and UpdateLightDef don't let the shadow
+volumes in when the shape changed, and entries that went stale anyway are freed when
+they are looked up.  The total size is limited by r_shadowCacheSize, and
+the least recently stored entries are evicted first.
+
+*/
+
+idCVar r_shadowCacheSize( "r_shadowCacheSize", "8", CVAR_RENDERER | CVAR_INTEGER, "megabytes of freed shadow volumes kept for reuse, 0 = no shadow cache", 0, 256 );
+
+const int SHADOW_CACHE_HASH_SIZE	= 1024;
+
+typedef struct shadowCacheSurface_s {
+	const srfTriangles_t *		ambientTris;		// the model surface the shadow volume was created from
+	srfTriangles_t *			shadowTris;
+} shadowCacheSurface_t;
+
+typedef struct shadowCacheEntry_s {
+	const idRenderWorldLocal *	world;
+	int							lightIndex;
+	int							entityIndex;
+
+	// everything the shadow volumes were created from
+	renderEntity_t				entityParms;
+	idVec3						globalLightOrigin;
+	idPlane						lightProject[4];
+	int							shadowMode;
+
+	int							numSurfaces;
+	shadowCacheSurface_t *		surfaces;
+	int							memory;
+
+	struct shadowCacheEntry_s *	hashNext;
+	struct shadowCacheEntry_s *	lruPrev;			// more recently stored
+	struct shadowCacheEntry_s *	lruNext;			// less recently stored
+} shadowCacheEntry_t;
+
+typedef struct {
+	int							numEntries;
+	int							memory;
+	int							peakMemory;
+
+	int							stores;
+	int							reuses;				// interactions created from a cache entry
+	int							hits;				// surfaces that didn't need a new shadow volume
+	int							misses;				// interactions created without a cache entry
+	int							stale;				// entries found with a different shape
+	int							evictions;
+	int							purges;
+} shadowCacheStats_t;
+
+static idBlockAlloc<shadowCacheEntry_t, 64>	shadowCacheEntryAllocator;
+static shadowCacheEntry_t *					shadowCacheHash[SHADOW_CACHE_HASH_SIZE];
+static shadowCacheEntry_t *					shadowCacheHead;	// most recently stored
+static shadowCacheEntry_t *					shadowCacheTail;	// least recently stored
+static shadowCacheStats_t					shadowCacheStats;
+
+/*
+=================
+R_ShadowCacheHash
+=================
+*/
+static ID_INLINE int R_ShadowCacheHash( int lightIndex, int entityIndex ) {
+	return ( lightIndex * 31 + entityIndex ) & ( SHADOW_CACHE_HASH_SIZE - 1 );
+}
+
+/*
+=================
+R_ShadowCacheMode
+
+The cvars that change how R_CreateShadowVolume builds a shadow volume
+=================
+*/
+static int R_ShadowCacheMode( void ) {
+	int mode = 0;
+	if ( r_shadows.GetBool() ) {
+		mode |= 8;
+	}
+	if ( r_useTurboShadow.GetBool() ) {
+		mode |= 1;
+	}
+	if ( tr.backEndRendererHasVertexPrograms && r_useShadowVertexProgram.GetBool() ) {
+		mode |= 2;
+	}
+	if ( r_skipSuppress.GetBool() ) {
+		mode |= 4;
+	}
+	return mode;
+}
+
+/*
+=================
+R_EntityShadowShapeMatches
+=================
+*/
+bool R_EntityShadowShapeMatches( const renderEntity_t *a, const renderEntity_t *b ) {
+	return ( a->hModel == b->hModel && a->origin == b->origin && a->axis == b->axis &&
+			a->customSkin == b->customSkin && a->customShader == b->customShader &&
+			a->noShadow == b->noShadow && a->suppressSurfaceInViewID == b->suppressSurfaceInViewID );
+}
+
+/*
+=================
+R_ShadowCacheable
+=================
+*/
+static bool R_ShadowCacheable( const idInteraction *inter ) {
+	const idRenderEntityLocal *def = inter->entityDef;
+
+	if ( def == NULL || def->parms.hModel == NULL || def->parms.callback != NULL ) {
+		return false;
+	}
+	// dynamic models generate new surfaces all the time
+	if ( def->parms.hModel->IsDynamicModel() != DM_STATIC ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+=================
+R_UnlinkShadowCacheEntry
+=================
+*/
+static void R_UnlinkShadowCacheEntry( shadowCacheEntry_t *entry ) {
+	shadowCacheEntry_t **prev;
+
+	for ( prev = &shadowCacheHash[ R_ShadowCacheHash( entry->lightIndex, entry->entityIndex ) ]; *prev != NULL; prev = &(*prev)->hashNext ) {
+		if ( *prev == entry ) {
+			*prev = entry->hashNext;
+			break;
+		}
+	}
+
+	if ( entry->lruPrev ) {
+		entry->lruPrev->lruNext = entry->lruNext;
+	} else {
+		shadowCacheHead = entry->lruNext;
+	}
+	if ( entry->lruNext ) {
+		entry->lruNext->lruPrev = entry->lruPrev;
+	} else {
+		shadowCacheTail = entry->lruPrev;
+	}
+
+	shadowCacheStats.numEntries--;
+	shadowCacheStats.memory -= entry->memory;
+}
+
+/*
+=================
+R_FreeShadowCacheEntry
+
+Unlinks the entry and frees any shadow volumes that are still in it
+=================
+*/
+static void R_FreeShadowCacheEntry( shadowCacheEntry_t *entry ) {
+	R_UnlinkShadowCacheEntry( entry );
+
+	for ( int i = 0; i < entry->numSurfaces; i++ ) {
+		if ( entry->surfaces[i].shadowTris ) {
+			R_FreeStaticTriSurf( entry->surfaces[i].shadowTris );
+		}
+	}
+	R_StaticFree( entry->surfaces );
+	entry->surfaces = NULL;
+
+	shadowCacheEntryAllocator.Free( entry );
+}
+
+/*
+=================
+R_FindShadowCacheEntry
+=================
+*/
+static shadowCacheEntry_t *R_FindShadowCacheEntry( const idRenderWorldLocal *world, int lightIndex, int entityIndex ) {
+	for ( shadowCacheEntry_t *entry = shadowCacheHash[ R_ShadowCacheHash( lightIndex, entityIndex ) ]; entry != NULL; entry = entry->hashNext ) {
+		if ( entry->world == world && entry->lightIndex == lightIndex && entry->entityIndex == entityIndex ) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+R_EvictShadowCache
+
+Frees the least recently stored entries until the cache fits in the budget
+=================
+*/
+static void R_EvictShadowCache( int budget ) {
+	while ( shadowCacheTail != NULL && shadowCacheStats.memory > budget ) {
+		R_FreeShadowCacheEntry( shadowCacheTail );
+		shadowCacheStats.evictions++;
+	}
+}
+
+/*
+=================
+R_InitShadowCache
+=================
+*/
+void R_InitShadowCache( void ) {
+	memset( shadowCacheHash, 0, sizeof( shadowCacheHash ) );
+	memset( &shadowCacheStats, 0, sizeof( shadowCacheStats ) );
+	shadowCacheHead = NULL;
+	shadowCacheTail = NULL;
+}
+
+/*
+=================
+R_ShutdownShadowCache
+=================
+*/
+void R_ShutdownShadowCache( void ) {
+	R_PurgeShadowCache();
+	shadowCacheEntryAllocator.Shutdown();
+}
+
+/*
+=================
+R_StoreCachedShadows
+
+Called by idInteraction::FreeSurfaces before the surfaces are freed.  Any
+shadow volume that is taken over is removed from the interaction.
+=================
+*/
+void R_StoreCachedShadows( idInteraction *inter ) {
+	int		i, memory;
+
+	if ( inter->surfaces == NULL || inter->numSurfaces <= 0 ) {
+		return;
+	}
+
+	int budget = r_shadowCacheSize.GetInteger() * 1024 * 1024;
+	if ( budget <= 0 ) {
+		return;
+	}
+
+	const idRenderEntityLocal *def = inter->entityDef;
+	const idRenderLightLocal *light = inter->lightDef;
+
+	if ( def->skipShadowCache || light->skipShadowCache || !R_ShadowCacheable( inter ) ) {
+		return;
+	}
+
+	memory = 0;
+	for ( i = 0; i < inter->numSurfaces; i++ ) {
+		if ( inter->surfaces[i].shadowTris ) {
+			memory += R_TriSurfMemory( inter->surfaces[i].shadowTris );
+		}
+	}
+	if ( memory == 0 || memory > budget ) {
+		return;
+	}
+
+	// an older entry for the same pair can't be valid anymore
+	shadowCacheEntry_t *entry = R_FindShadowCacheEntry( def->world, light->index, def->index );
+	if ( entry != NULL ) {
+		R_FreeShadowCacheEntry( entry );
+	}
+
+	R_EvictShadowCache( budget - memory );
+
+	entry = shadowCacheEntryAllocator.Alloc();
+	entry->world = def->world;
+	entry->lightIndex = light->index;
+	entry->entityIndex = def->index;
+	entry->entityParms = def->parms;
+	entry->globalLightOrigin = light->globalLightOrigin;
+	for ( i = 0; i < 4; i++ ) {
+		entry->lightProject[i] = light->lightProject[i];
+	}
+	entry->shadowMode = R_ShadowCacheMode();
+	entry->numSurfaces = inter->numSurfaces;
+	entry->surfaces = (shadowCacheSurface_t *)R_ClearedStaticAlloc( inter->numSurfaces * sizeof( entry->surfaces[0] ) );
+	entry->memory = memory;
+
+	for ( i = 0; i < inter->numSurfaces; i++ ) {
+		surfaceInteraction_t *sint = &inter->surfaces[i];
+		srfTriangles_t *tri = sint->shadowTris;
+
+		if ( tri == NULL ) {
+			continue;
+		}
+
+		// don't hold on to vertex cache space, it will be uploaded again when the shadow is used
+		R_FreeStaticTriSurfVertexCaches( tri );
+		if ( tri->shadowVertexes == NULL && tri->verts == NULL ) {
+			// a reference to the shadowCache of the ambient surface
+			tri->shadowCache = NULL;
+		}
+
+		entry->surfaces[i].ambientTris = sint->ambientTris;
+		entry->surfaces[i].shadowTris = tri;
+		sint->shadowTris = NULL;
+	}
+
+	int hash = R_ShadowCacheHash( entry->lightIndex, entry->entityIndex );
+	entry->hashNext = shadowCacheHash[hash];
+	shadowCacheHash[hash] = entry;
+
+	entry->lruPrev = NULL;
+	entry->lruNext = shadowCacheHead;
+	if ( shadowCacheHead ) {
+		shadowCacheHead->lruPrev = entry;
+	} else {
+		shadowCacheTail = entry;
+	}
+	shadowCacheHead = entry;
+
+	shadowCacheStats.numEntries++;
+	shadowCacheStats.memory += memory;
+	if ( shadowCacheStats.memory > shadowCacheStats.peakMemory ) {
+		shadowCacheStats.peakMemory = shadowCacheStats.memory;
+	}
+	shadowCacheStats.stores++;
+}
+
+/*
+=================
+R_FindCachedShadows
+
+The entry is unlinked from the cache, so it is owned by the caller
+until R_ReleaseCachedShadows
+=================
+*/
+shadowCacheEntry_t *R_FindCachedShadows( const idInteraction *inter ) {
+	if ( !R_ShadowCacheable( inter ) ) {
+		return NULL;
+	}
+
+	const idRenderEntityLocal *def = inter->entityDef;
+	const idRenderLightLocal *light = inter->lightDef;
+
+	shadowCacheEntry_t *entry = R_FindShadowCacheEntry( def->world, light->index, def->index );
+	if ( entry == NULL ) {
+		shadowCacheStats.misses++;
+		return NULL;
+	}
+
+	bool match = ( entry->shadowMode == R_ShadowCacheMode() && entry->globalLightOrigin == light->globalLightOrigin &&
+					entry->numSurfaces == def->parms.hModel->NumSurfaces() &&
+					R_EntityShadowShapeMatches( &entry->entityParms, &def->parms ) );
+	for ( int i = 0; i < 4 && match; i++ ) {
+		match = ( entry->lightProject[i] == light->lightProject[i] );
+	}
+
+	if ( !match ) {
+		R_FreeShadowCacheEntry( entry );
+		shadowCacheStats.stale++;
+		return NULL;
+	}
+
+	R_UnlinkShadowCacheEntry( entry );
+	shadowCacheStats.reuses++;
+	return entry;
+}
+
+/*
+=================
+R_TakeCachedShadow
+
+Returns the cached shadow volume for a surface and removes it from the entry
+=================
+*/
+srfTriangles_t *R_TakeCachedShadow( shadowCacheEntry_t *entry, int surfaceNum, const srfTriangles_t *ambientTris ) {
+	if ( entry == NULL || surfaceNum < 0 || surfaceNum >= entry->numSurfaces ) {
+		return NULL;
+	}
+
+	shadowCacheSurface_t *surf = &entry->surfaces[surfaceNum];
+	if ( surf->shadowTris == NULL || surf->ambientTris != ambientTris ) {
+		return NULL;
+	}
+
+	srfTriangles_t *tri = surf->shadowTris;
+	surf->shadowTris = NULL;
+
+	shadowCacheStats.hits++;
+	return tri;
+}
+
+/*
+=================
+R_ReleaseCachedShadows
+
+Frees an entry returned by R_FindCachedShadows together with the shadow volumes that weren't taken
+=================
+*/
+void R_ReleaseCachedShadows( shadowCacheEntry_t *entry ) {
+	if ( entry == NULL ) {
+		return;
+	}
+	for ( int i = 0; i < entry->numSurfaces; i++ ) {
+		if ( entry->surfaces[i].shadowTris ) {
+			R_FreeStaticTriSurf( entry->surfaces[i].shadowTris );
+		}
+	}
+	R_StaticFree( entry->surfaces );
+	entry->surfaces = NULL;
+
+	shadowCacheEntryAllocator.Free( entry );
+}
+
+/*
+=================
+R_PurgeShadowCache
+=================
+*/
+void R_PurgeShadowCache( void ) {
+	while ( shadowCacheHead != NULL ) {
+		R_FreeShadowCacheEntry( shadowCacheHead );
+		shadowCacheStats.purges++;
+	}
+}
+
+/*
+=================
+R_PurgeShadowCacheWorld
+=================
+*/
+void R_PurgeShadowCacheWorld( const idRenderWorldLocal *world ) {
+	shadowCacheEntry_t *entry, *next;
+
+	for ( entry = shadowCacheHead; entry != NULL; entry = next ) {
+		next = entry->lruNext;
+		if ( entry->world == world ) {
+			R_FreeShadowCacheEntry( entry );
+			shadowCacheStats.purges++;
+		}
+	}
+}
+
+/*
+=================
+R_PurgeShadowCacheModel
+
+The cached ambientTris pointers are no longer valid when a model is freed or reloaded
+=================
+*/
+void R_PurgeShadowCacheModel( const idRenderModel *model ) {
+	shadowCacheEntry_t *entry, *next;
+
+	for ( entry = shadowCacheHead; entry != NULL; entry = next ) {
+		next = entry->lruNext;
+		if ( entry->entityParms.hModel == model ) {
+			R_FreeShadowCacheEntry( entry );
+			shadowCacheStats.purges++;
+		}
+	}
+}
+
+/*
+=================
+R_ShadowCacheStats_f
+=================
+*/
+void R_ShadowCacheStats_f( const idCmdArgs &args ) {
+	if ( args.Argc() > 1 ) {
+		if ( !idStr::Icmp( args.Argv( 1 ), "purge" ) ) {
+			R_PurgeShadowCache();
+		} else if ( !idStr::Icmp( args.Argv( 1 ), "reset" ) ) {
+			int numEntries = shadowCacheStats.numEntries;
+			int memory = shadowCacheStats.memory;
+			memset( &shadowCacheStats, 0, sizeof( shadowCacheStats ) );
+			shadowCacheStats.numEntries = numEntries;
+			shadowCacheStats.memory = memory;
+			shadowCacheStats.peakMemory = memory;
+		} else {
+			common->Printf( "usage: shadowCacheStats [purge|reset]\n" );
+			return;
+		}
+	}
+
+	int lookups = shadowCacheStats.reuses + shadowCacheStats.misses + shadowCacheStats.stale;
+
+	common->Printf( "%5i entries using %ik of %ik, peak %ik\n", shadowCacheStats.numEntries, shadowCacheStats.memory / 1024,
+					r_shadowCacheSize.GetInteger() * 1024, shadowCacheStats.peakMemory / 1024 );
+	common->Printf( "%5i stores, %i evictions, %i purged\n", shadowCacheStats.stores, shadowCacheStats.evictions, shadowCacheStats.purges );
+	common->Printf( "%5i interactions reused %i shadow volumes, %i missed, %i stale (%i%% reuse)\n",
+					shadowCacheStats.reuses, shadowCacheStats.hits, shadowCacheStats.misses, shadowCacheStats.stale,
+					lookups ? shadowCacheStats.reuses * 100 / lookups : 0 );
+}
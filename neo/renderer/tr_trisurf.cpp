@@ -386,7 +386,7 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 	}
 
 	if ( !tri->deformedSurface ) {
-		if ( tri->indexes != NULL ) {
+		if ( tri->indexes != NULL && !tri->mappedData ) {
 			// if a surface is completely inside a light volume R_CreateLightTris points tri->indexes at the indexes of the ambient surface
 			if ( tri->ambientSurface == NULL || tri->indexes != tri->ambientSurface->indexes ) {
 				triIndexAllocator.Free( tri->indexes );
@@ -413,7 +413,7 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 		triPlaneAllocator.Free( tri->facePlanes );
 	}
 
-	if ( tri->shadowVertexes != NULL ) {
+	if ( tri->shadowVertexes != NULL && !tri->mappedData ) {
 		triShadowVertexAllocator.Free( tri->shadowVertexes );
 	}
 
@@ -443,7 +443,7 @@ void R_CheckStaticTriSurfMemory( const srfTriangles_t *tri ) {
 	}
 
 	if ( !tri->deformedSurface ) {
-		if ( tri->indexes != NULL ) {
+		if ( tri->indexes != NULL && !tri->mappedData ) {
 			// if a surface is completely inside a light volume R_CreateLightTris points tri->indexes at the indexes of the ambient surface
 			if ( tri->ambientSurface == NULL || tri->indexes != tri->ambientSurface->indexes ) {
 				const char *error = triIndexAllocator.CheckMemory( tri->indexes );
@@ -452,7 +452,7 @@ void R_CheckStaticTriSurfMemory( const srfTriangles_t *tri ) {
 		}
 	}
 
-	if ( tri->shadowVertexes != NULL ) {
+	if ( tri->shadowVertexes != NULL && !tri->mappedData ) {
 		const char *error = triShadowVertexAllocator.CheckMemory( tri->shadowVertexes );
 		assert( error == NULL );
 	}
@@ -1657,7 +1657,8 @@ void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes ) {
 		return;
 	}
 
-	tr.pc.c_tangentIndexes += tri->numIndexes;
+	// deformed surfaces are derived in the skinning jobs as well
+	Sys_InterlockedAdd( tr.pc.c_tangentIndexes, tri->numIndexes );
 
 	if ( !tri->facePlanes && allocFacePlanes ) {
 		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
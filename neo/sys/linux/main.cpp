@@ -36,6 +36,9 @@ If you have questions concerning this license or the applicable additional terms
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#if defined( __i386__ ) || defined( __x86_64__ )
+#include <cpuid.h>
+#endif
 
 #ifdef ID_MCHECK
 #include <mcheck.h>
@@ -201,13 +204,118 @@ void Sys_Shutdown( void ) {
 	Posix_Shutdown();
 }
 
+#if defined( __i386__ ) || defined( __x86_64__ )
+
+/*
+===============
+Sys_GetXCR0
+===============
+*/
+static unsigned int Sys_GetXCR0( void ) {
+	unsigned int lo, hi;
+
+	// xgetbv, spelled out for assemblers that don't know the mnemonic
+	__asm__ __volatile__ ( ".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0) );
+	return lo;
+}
+
+/*
+===============
+Sys_HasDAZ
+===============
+*/
+static bool Sys_HasDAZ( void ) {
+	unsigned char fxArea[512+16];
+	unsigned char *fx = (unsigned char *)( ( (size_t)fxArea + 15 ) & ~(size_t)15 );
+	unsigned int mask;
+
+	memset( fx, 0, 512 );
+	__asm__ __volatile__ ( "fxsave %0" : "=m" (*(unsigned char (*)[512])fx) );
+	memcpy( &mask, fx + 28, sizeof( mask ) );		// MXCSR mask
+	return ( mask & ( 1 << 6 ) ) != 0;				// DAZ bit
+}
+
+#endif
+
 /*
 ===============
 Sys_GetProcessorId
 ===============
 */
 cpuid_t Sys_GetProcessorId( void ) {
+#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned int maxFunc, eax, ebx, ecx, edx;
+	int flags;
+
+	if ( !__get_cpuid( 0, &maxFunc, &ebx, &ecx, &edx ) ) {
+		return CPUID_UNSUPPORTED;
+	}
+
+	// "AuthenticAMD"
+	if ( ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163 ) {
+		flags = CPUID_AMD;
+	} else {
+		flags = CPUID_INTEL;
+	}
+
+	__get_cpuid( 1, &eax, &ebx, &ecx, &edx );
+
+	// bit 23 of EDX denotes MMX existence
+	if ( edx & ( 1 << 23 ) ) {
+		flags |= CPUID_MMX;
+	}
+	// bit 25 of EDX denotes SSE existence
+	if ( edx & ( 1 << 25 ) ) {
+		flags |= CPUID_SSE | CPUID_FTZ;
+		if ( Sys_HasDAZ() ) {
+			flags |= CPUID_DAZ;
+		}
+	}
+	// bit 26 of EDX denotes SSE2 existence
+	if ( edx & ( 1 << 26 ) ) {
+		flags |= CPUID_SSE2;
+	}
+	// bit 0 of ECX denotes SSE3 existence
+	if ( ecx & ( 1 << 0 ) ) {
+		flags |= CPUID_SSE3;
+	}
+	// bit 15 of EDX denotes CMOV existence
+	if ( edx & ( 1 << 15 ) ) {
+		flags |= CPUID_CMOV;
+	}
+	// bit 28 of EDX denotes HTT existence
+	if ( edx & ( 1 << 28 ) ) {
+		flags |= CPUID_HTT;
+	}
+
+	// bit 28 of ECX denotes AVX existence, bit 27 that the OS uses XSAVE
+	// and XCR0 tells whether the OS saves the XMM and YMM state
+	if ( ( ecx & ( 1 << 28 ) ) && ( ecx & ( 1 << 27 ) ) && ( Sys_GetXCR0() & 6 ) == 6 ) {
+		flags |= CPUID_AVX;
+
+		// bit 12 of ECX denotes FMA3 existence
+		if ( ecx & ( 1 << 12 ) ) {
+			flags |= CPUID_FMA3;
+		}
+
+		// bit 5 of EBX in the structured extended feature flags denotes AVX2 existence
+		if ( maxFunc >= 7 ) {
+			__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+			if ( ebx & ( 1 << 5 ) ) {
+				flags |= CPUID_AVX2;
+			}
+		}
+	}
+
+	// bit 31 of EDX in the extended feature flags denotes 3DNow! existence
+	if ( __get_cpuid( 0x80000001, &eax, &ebx, &ecx, &edx ) && ( edx & ( 1u << 31 ) ) ) {
+		flags |= CPUID_3DNOW;
+	}
+
+	return (cpuid_t)flags;
+#else
 	return CPUID_GENERIC;
+#endif
 }
 
 /*
@@ -216,7 +324,55 @@ Sys_GetProcessorString
 ===============
 */
 const char *Sys_GetProcessorString( void ) {
-	return "generic";
+	static char cpuString[256];
+	idStr string;
+	cpuid_t cpuid;
+
+	cpuid = Sys_GetProcessorId();
+
+	if ( cpuid & CPUID_AMD ) {
+		string = "AMD CPU";
+	} else if ( cpuid & CPUID_INTEL ) {
+		string = "Intel CPU";
+	} else if ( cpuid & CPUID_UNSUPPORTED ) {
+		string = "unsupported CPU";
+	} else {
+		return "generic";
+	}
+
+	string += " with ";
+	if ( cpuid & CPUID_MMX ) {
+		string += "MMX & ";
+	}
+	if ( cpuid & CPUID_3DNOW ) {
+		string += "3DNow! & ";
+	}
+	if ( cpuid & CPUID_SSE ) {
+		string += "SSE & ";
+	}
+	if ( cpuid & CPUID_SSE2 ) {
+		string += "SSE2 & ";
+	}
+	if ( cpuid & CPUID_SSE3 ) {
+		string += "SSE3 & ";
+	}
+	if ( cpuid & CPUID_AVX ) {
+		string += "AVX & ";
+	}
+	if ( cpuid & CPUID_AVX2 ) {
+		string += "AVX2 & ";
+	}
+	if ( cpuid & CPUID_FMA3 ) {
+		string += "FMA3 & ";
+	}
+	if ( cpuid & CPUID_HTT ) {
+		string += "HTT & ";
+	}
+	string.StripTrailing( " & " );
+	string.StripTrailing( " with " );
+
+	idStr::Copynz( cpuString, string.c_str(), sizeof( cpuString ) );
+	return cpuString;
 }
 
 /*
@@ -473,21 +629,14 @@ Sys_FPU_SetDAZ
 ================
 */
 void Sys_FPU_SetDAZ( bool enable ) {
-	/*
-	DWORD dwData;
-
-	_asm {
-		movzx	ecx, byte ptr enable
-		and		ecx, 1
-		shl		ecx, 6
-		STMXCSR	dword ptr dwData
-		mov		eax, dwData
-		and		eax, ~(1<<6)	// clear DAX bit
-		or		eax, ecx		// set the DAZ bit
-		mov		dwData, eax
-		LDMXCSR	dword ptr dwData
-	}
-	*/
+#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned int mxcsr;
+
+	__asm__ __volatile__ ( "stmxcsr %0" : "=m" (mxcsr) );
+	mxcsr &= ~( 1 << 6 );							// clear DAZ bit
+	mxcsr |= ( enable ? 1 : 0 ) << 6;				// set the DAZ bit
+	__asm__ __volatile__ ( "ldmxcsr %0" : : "m" (mxcsr) );
+#endif
 }
 
 /*
@@ -496,21 +645,14 @@ Sys_FPU_SetFTZ
 ================
 */
 void Sys_FPU_SetFTZ( bool enable ) {
-	/*
-	DWORD dwData;
-
-	_asm {
-		movzx	ecx, byte ptr enable
-		and		ecx, 1
-		shl		ecx, 15
-		STMXCSR	dword ptr dwData
-		mov		eax, dwData
-		and		eax, ~(1<<15)	// clear FTZ bit
-		or		eax, ecx		// set the FTZ bit
-		mov		dwData, eax
-		LDMXCSR	dword ptr dwData
-	}
-	*/
+#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned int mxcsr;
+
+	__asm__ __volatile__ ( "stmxcsr %0" : "=m" (mxcsr) );
+	mxcsr &= ~( 1 << 15 );							// clear FTZ bit
+	mxcsr |= ( enable ? 1 : 0 ) << 15;				// set the FTZ bit
+	__asm__ __volatile__ ( "ldmxcsr %0" : : "m" (mxcsr) );
+#endif
 }
 
 /*
@@ -436,6 +436,45 @@ long Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+/*
+==================
+Sys_MapFile
+==================
+*/
+void *Sys_MapFile( FILE *fp, int offset, int length, sysFileMapping_t &mapping ) {
+	memset( &mapping, 0, sizeof( mapping ) );
+
+	if ( offset < 0 || length <= 0 ) {
+		return NULL;
+	}
+
+	// the offset of the view has to be page aligned
+	long pageSize = sysconf( _SC_PAGESIZE );
+	int alignedOffset = offset - ( offset % pageSize );
+	size_t size = length + ( offset - alignedOffset );
+
+	void *base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno( fp ), alignedOffset );
+	if ( base == MAP_FAILED ) {
+		return NULL;
+	}
+
+	mapping.base = base;
+	mapping.size = size;
+	return (byte *)base + ( offset - alignedOffset );
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile( sysFileMapping_t &mapping ) {
+	if ( mapping.base ) {
+		munmap( mapping.base, mapping.size );
+	}
+	memset( &mapping, 0, sizeof( mapping ) );
+}
+
 void Sys_Sleep(int msec) {
 	if ( msec < 20 ) {
 		static int last = 0;
@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include <sys/time.h>
 #include <pwd.h>
 #include <pthread.h>
+#include <sched.h>
 
 #include "../../idlib/precompiled.h"
 #include "posix_public.h"
@@ -142,6 +143,100 @@ void Sys_TriggerEvent( int index ) {
 	Sys_LeaveCriticalSection( MAX_LOCAL_CRITICAL_SECTIONS - 1 );
 }
 
+/*
+======================================================
+semaphores
+built on a mutex and a condition so they behave the same on every posix flavor
+( OSX has no unnamed sem_t )
+======================================================
+*/
+
+struct xsemaphore_s {
+	pthread_mutex_t		mutex;
+	pthread_cond_t		cond;
+	int					count;
+};
+
+/*
+==================
+Sys_CreateSemaphore
+==================
+*/
+xsemaphoreHandle_t Sys_CreateSemaphore( int initialCount ) {
+	xsemaphore_s *semaphore = (xsemaphore_s *)malloc( sizeof( xsemaphore_s ) );
+	pthread_mutex_init( &semaphore->mutex, NULL );
+	pthread_cond_init( &semaphore->cond, NULL );
+	semaphore->count = initialCount;
+	return semaphore;
+}
+
+/*
+==================
+Sys_DestroySemaphore
+==================
+*/
+void Sys_DestroySemaphore( xsemaphoreHandle_t semaphore ) {
+	if ( !semaphore ) {
+		return;
+	}
+	pthread_cond_destroy( &semaphore->cond );
+	pthread_mutex_destroy( &semaphore->mutex );
+	free( semaphore );
+}
+
+/*
+==================
+Sys_WaitSemaphore
+==================
+*/
+void Sys_WaitSemaphore( xsemaphoreHandle_t semaphore ) {
+	pthread_mutex_lock( &semaphore->mutex );
+	while ( semaphore->count <= 0 ) {
+		pthread_cond_wait( &semaphore->cond, &semaphore->mutex );
+	}
+	semaphore->count--;
+	pthread_mutex_unlock( &semaphore->mutex );
+}
+
+/*
+==================
+Sys_PostSemaphore
+==================
+*/
+void Sys_PostSemaphore( xsemaphoreHandle_t semaphore, int count ) {
+	assert( count > 0 );
+	pthread_mutex_lock( &semaphore->mutex );
+	semaphore->count += count;
+	if ( count == 1 ) {
+		pthread_cond_signal( &semaphore->cond );
+	} else {
+		pthread_cond_broadcast( &semaphore->cond );
+	}
+	pthread_mutex_unlock( &semaphore->mutex );
+}
+
+/*
+==================
+Sys_Yield
+==================
+*/
+void Sys_Yield( void ) {
+	sched_yield();
+}
+
+/*
+==================
+Sys_GetProcessorCount
+==================
+*/
+int Sys_GetProcessorCount( void ) {
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	if ( count < 1 ) {
+		return 1;
+	}
+	return (int)count;
+}
+
 /*
 ======================================================
 thread create and destroy
@@ -189,7 +284,9 @@ Sys_DestroyThread
 void Sys_DestroyThread( xthreadInfo& info ) {
 	// the target thread must have a cancelation point, otherwise pthread_cancel is useless
 	assert( info.threadHandle );
-	if ( pthread_cancel( ( pthread_t )info.threadHandle ) != 0 ) {
+	// ESRCH means the thread already returned on its own, it still needs to be joined
+	int ret = pthread_cancel( ( pthread_t )info.threadHandle );
+	if ( ret != 0 && ret != ESRCH ) {
 		common->Error( "ERROR: pthread_cancel %s failed\n", info.name );
 	}
 	if ( pthread_join( ( pthread_t )info.threadHandle, NULL ) != 0 ) {
@@ -136,6 +136,14 @@ sysEvent_t	Sys_GetEvent( void ) {
 void	Sys_Mkdir( const char *path ) {
 }
 
+void *	Sys_MapFile( FILE *fp, int offset, int length, sysFileMapping_t &mapping ) {
+	memset( &mapping, 0, sizeof( mapping ) );
+	return NULL;
+}
+
+void	Sys_UnmapFile( sysFileMapping_t &mapping ) {
+}
+
 const char *Sys_DefaultCDPath(void) {
 	return "";
 }
@@ -154,7 +154,10 @@ typedef enum {
 	CPUID_HTT							= 0x01000,	// Hyper-Threading Technology
 	CPUID_CMOV							= 0x02000,	// Conditional Move (CMOV) and fast floating point comparison (FCOMI) instructions
 	CPUID_FTZ							= 0x04000,	// Flush-To-Zero mode (denormal results are flushed to zero)
-	CPUID_DAZ							= 0x08000	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_DAZ							= 0x08000,	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_AVX							= 0x10000,	// Advanced Vector Extensions (with operating system support for the YMM state)
+	CPUID_AVX2							= 0x20000,	// Advanced Vector Extensions 2
+	CPUID_FMA3							= 0x40000	// Fused Multiply-Add (three operand form)
 } cpuid_t;
 
 typedef enum {
@@ -231,6 +234,12 @@ typedef struct sysMemoryStats_s {
 	int availExtendedVirtual;
 } sysMemoryStats_t;
 
+typedef struct sysFileMapping_s {
+	void *			base;				// start of the mapped view, aligned to the mapping granularity
+	size_t			size;				// size of the mapped view
+	void *			handle;				// platform file mapping object, if any
+} sysFileMapping_t;
+
 typedef unsigned long address_t;
 
 template<class type> class idList;		// for Sys_ListFiles
@@ -369,6 +378,10 @@ void			Sys_ShowConsole( int visLevel, bool quitOnClose );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp );
+// maps length bytes of an open file starting at offset with copy-on-write access,
+// returns NULL if the file can't be mapped, the file may be closed while it is mapped
+void *			Sys_MapFile( FILE *fp, int offset, int length, sysFileMapping_t &mapping );
+void			Sys_UnmapFile( sysFileMapping_t &mapping );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 const char *	Sys_DefaultCDPath( void );
@@ -487,7 +500,7 @@ typedef enum {
 
 typedef struct {
 	const char *	name;
-	int				threadHandle;
+	intptr_t		threadHandle;	// wide enough for a pthread_t on 64 bit
 	unsigned long	threadId;
 } xthreadInfo;
 
@@ -526,6 +539,141 @@ enum {
 void				Sys_WaitForEvent( int index = TRIGGER_EVENT_ZERO );
 void				Sys_TriggerEvent( int index = TRIGGER_EVENT_ZERO );
 
+// counting semaphores, a wait blocks until the count is non-zero and then decrements it
+typedef struct xsemaphore_s *		xsemaphoreHandle_t;
+
+xsemaphoreHandle_t	Sys_CreateSemaphore( int initialCount = 0 );
+void				Sys_DestroySemaphore( xsemaphoreHandle_t semaphore );
+void				Sys_WaitSemaphore( xsemaphoreHandle_t semaphore );
+void				Sys_PostSemaphore( xsemaphoreHandle_t semaphore, int count = 1 );
+
+// gives up the remainder of the time slice of the calling thread
+void				Sys_Yield( void );
+
+// returns the number of logical processors available to the process
+int					Sys_GetProcessorCount( void );
+
+// thread local storage, only use for plain data
+#ifdef _WIN32
+#define ID_THREAD_LOCAL						__declspec( thread )
+#else
+#define ID_THREAD_LOCAL						__thread
+#endif
+
+// atomic operations, all of these act as a full memory barrier
+// they are inline so they can be used from the game code as well
+#ifdef _WIN32
+
+ID_INLINE int Sys_InterlockedIncrement( volatile int &value ) {
+	return InterlockedIncrement( (volatile LONG *)&value );
+}
+
+ID_INLINE int Sys_InterlockedDecrement( volatile int &value ) {
+	return InterlockedDecrement( (volatile LONG *)&value );
+}
+
+// returns the new value
+ID_INLINE int Sys_InterlockedAdd( volatile int &value, int i ) {
+	return InterlockedExchangeAdd( (volatile LONG *)&value, i ) + i;
+}
+
+// returns the previous value
+ID_INLINE int Sys_InterlockedExchange( volatile int &value, int exchange ) {
+	return InterlockedExchange( (volatile LONG *)&value, exchange );
+}
+
+// returns the previous value, the exchange only happened if that equals comparand
+ID_INLINE int Sys_InterlockedCompareExchange( volatile int &value, int comparand, int exchange ) {
+	return InterlockedCompareExchange( (volatile LONG *)&value, exchange, comparand );
+}
+
+ID_INLINE void *Sys_InterlockedCompareExchangePointer( void * volatile &ptr, void *comparand, void *exchange ) {
+	return InterlockedCompareExchangePointer( &ptr, exchange, comparand );
+}
+
+ID_INLINE void Sys_CPUPause( void ) {
+	YieldProcessor();
+}
+
+#else
+
+#include <sched.h>
+
+ID_INLINE int Sys_InterlockedIncrement( volatile int &value ) {
+	return __sync_add_and_fetch( &value, 1 );
+}
+
+ID_INLINE int Sys_InterlockedDecrement( volatile int &value ) {
+	return __sync_sub_and_fetch( &value, 1 );
+}
+
+// returns the new value
+ID_INLINE int Sys_InterlockedAdd( volatile int &value, int i ) {
+	return __sync_add_and_fetch( &value, i );
+}
+
+// returns the previous value
+ID_INLINE int Sys_InterlockedExchange( volatile int &value, int exchange ) {
+	__sync_synchronize();
+	return __sync_lock_test_and_set( &value, exchange );
+}
+
+// returns the previous value, the exchange only happened if that equals comparand
+ID_INLINE int Sys_InterlockedCompareExchange( volatile int &value, int comparand, int exchange ) {
+	return __sync_val_compare_and_swap( &value, comparand, exchange );
+}
+
+ID_INLINE void *Sys_InterlockedCompareExchangePointer( void * volatile &ptr, void *comparand, void *exchange ) {
+	return __sync_val_compare_and_swap( &ptr, comparand, exchange );
+}
+
+ID_INLINE void Sys_CPUPause( void ) {
+#if defined( __i386__ ) || defined( __x86_64__ )
+	__asm__ __volatile__( "pause" );
+#endif
+}
+
+#endif
+
+/*
+================================================
+idSysSpinLock
+
+Light weight lock for very short critical sections, it spins
+and then yields instead of going to sleep in the kernel.
+================================================
+*/
+class idSysSpinLock {
+public:
+					idSysSpinLock( void ) : locked( 0 ) {}
+
+	bool			TryLock( void ) { return Sys_InterlockedCompareExchange( locked, 0, 1 ) == 0; }
+	void			Lock( void );
+	void			Unlock( void ) { Sys_InterlockedExchange( locked, 0 ); }
+
+private:
+	volatile int	locked;
+};
+
+ID_INLINE void idSysSpinLock::Lock( void ) {
+	int spins = 0;
+	while( !TryLock() ) {
+		while( locked ) {
+			if ( ++spins < 64 ) {
+				Sys_CPUPause();
+			} else {
+				// give the owner a chance to run
+				spins = 0;
+#ifdef _WIN32
+				SwitchToThread();
+#else
+				sched_yield();
+#endif
+			}
+		}
+	}
+}
+
 /*
 ==============================================================
 
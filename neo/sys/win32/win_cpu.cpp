@@ -190,6 +190,31 @@ static void CPUID( int func, unsigned regs[4] ) {
 	regs[_REG_EDX] = regEDX;
 }
 
+/*
+================
+CPUIDEX
+================
+*/
+static void CPUIDEX( int func, int subfunc, unsigned regs[4] ) {
+	unsigned regEAX, regEBX, regECX, regEDX;
+
+	__asm pusha
+	__asm mov eax, func
+	__asm mov ecx, subfunc
+	__asm __emit 00fh
+	__asm __emit 0a2h
+	__asm mov regEAX, eax
+	__asm mov regEBX, ebx
+	__asm mov regECX, ecx
+	__asm mov regEDX, edx
+	__asm popa
+
+	regs[_REG_EAX] = regEAX;
+	regs[_REG_EBX] = regEBX;
+	regs[_REG_ECX] = regECX;
+	regs[_REG_EDX] = regEDX;
+}
+
 
 /*
 ================
@@ -335,6 +360,86 @@ static bool HasSSE3( void ) {
 	return false;
 }
 
+/*
+================
+HasAVX
+================
+*/
+static bool HasAVX( void ) {
+	unsigned regs[4];
+	unsigned xcr0;
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 28 of ECX denotes AVX existence and bit 27 denotes the OS uses XSAVE/XRSTOR
+	if ( ( regs[_REG_ECX] & ( ( 1 << 28 ) | ( 1 << 27 ) ) ) != ( ( 1 << 28 ) | ( 1 << 27 ) ) ) {
+		return false;
+	}
+
+	// read XCR0 with XGETBV
+	__asm pusha
+	__asm xor ecx, ecx
+	__asm __emit 00fh
+	__asm __emit 001h
+	__asm __emit 0d0h
+	__asm mov xcr0, eax
+	__asm popa
+
+	// the OS has to save both the XMM and YMM state on context switches
+	return ( ( xcr0 & 6 ) == 6 );
+}
+
+/*
+================
+HasAVX2
+================
+*/
+static bool HasAVX2( void ) {
+	unsigned regs[4];
+
+	if ( !HasAVX() ) {
+		return false;
+	}
+
+	// get the highest supported standard function
+	CPUID( 0, regs );
+	if ( regs[_REG_EAX] < 7 ) {
+		return false;
+	}
+
+	// get structured extended feature bits
+	CPUIDEX( 7, 0, regs );
+
+	// bit 5 of EBX denotes AVX2 existence
+	if ( regs[_REG_EBX] & ( 1 << 5 ) ) {
+		return true;
+	}
+	return false;
+}
+
+/*
+================
+HasFMA3
+================
+*/
+static bool HasFMA3( void ) {
+	unsigned regs[4];
+
+	if ( !HasAVX() ) {
+		return false;
+	}
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 12 of ECX denotes FMA3 existence
+	if ( regs[_REG_ECX] & ( 1 << 12 ) ) {
+		return true;
+	}
+	return false;
+}
+
 /*
 ================
 LogicalProcPerPhysicalProc
@@ -571,6 +676,21 @@ cpuid_t Sys_GetCPUId( void ) {
 		flags |= CPUID_SSE3;
 	}
 
+	// check for Advanced Vector Extensions
+	if ( HasAVX() ) {
+		flags |= CPUID_AVX;
+	}
+
+	// check for Advanced Vector Extensions 2
+	if ( HasAVX2() ) {
+		flags |= CPUID_AVX2;
+	}
+
+	// check for Fused Multiply-Add
+	if ( HasFMA3() ) {
+		flags |= CPUID_FMA3;
+	}
+
 	// check for Hyper-Threading Technology
 	if ( HasHTT() ) {
 		flags |= CPUID_HTT;
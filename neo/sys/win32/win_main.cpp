@@ -200,6 +200,65 @@ void Sys_TriggerEvent( int index ) {
 	SetEvent( win32.backgroundDownloadSemaphore );
 }
 
+/*
+==================
+Sys_CreateSemaphore
+==================
+*/
+xsemaphoreHandle_t Sys_CreateSemaphore( int initialCount ) {
+	return (xsemaphoreHandle_t)CreateSemaphore( NULL, initialCount, 0x7fffffff, NULL );
+}
+
+/*
+==================
+Sys_DestroySemaphore
+==================
+*/
+void Sys_DestroySemaphore( xsemaphoreHandle_t semaphore ) {
+	if ( semaphore ) {
+		CloseHandle( (HANDLE)semaphore );
+	}
+}
+
+/*
+==================
+Sys_WaitSemaphore
+==================
+*/
+void Sys_WaitSemaphore( xsemaphoreHandle_t semaphore ) {
+	WaitForSingleObject( (HANDLE)semaphore, INFINITE );
+}
+
+/*
+==================
+Sys_PostSemaphore
+==================
+*/
+void Sys_PostSemaphore( xsemaphoreHandle_t semaphore, int count ) {
+	assert( count > 0 );
+	ReleaseSemaphore( (HANDLE)semaphore, count, NULL );
+}
+
+/*
+==================
+Sys_Yield
+==================
+*/
+void Sys_Yield( void ) {
+	SwitchToThread();
+}
+
+/*
+==================
+Sys_GetProcessorCount
+==================
+*/
+int Sys_GetProcessorCount( void ) {
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
 
 
 #pragma optimize( "", on )
@@ -482,6 +541,61 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return (long) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+void *Sys_MapFile( FILE *fp, int offset, int length, sysFileMapping_t &mapping ) {
+	memset( &mapping, 0, sizeof( mapping ) );
+
+	if ( offset < 0 || length <= 0 ) {
+		return NULL;
+	}
+
+	HANDLE file = (HANDLE)_get_osfhandle( _fileno( fp ) );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+
+	HANDLE fileMapping = CreateFileMapping( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	if ( fileMapping == NULL ) {
+		return NULL;
+	}
+
+	// the offset of the view has to be aligned to the allocation granularity
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	int alignedOffset = offset - ( offset % info.dwAllocationGranularity );
+	size_t size = length + ( offset - alignedOffset );
+
+	void *base = MapViewOfFile( fileMapping, FILE_MAP_COPY, 0, alignedOffset, size );
+	if ( base == NULL ) {
+		CloseHandle( fileMapping );
+		return NULL;
+	}
+
+	mapping.base = base;
+	mapping.size = size;
+	mapping.handle = fileMapping;
+	return (byte *)base + ( offset - alignedOffset );
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( sysFileMapping_t &mapping ) {
+	if ( mapping.base ) {
+		UnmapViewOfFile( mapping.base );
+	}
+	if ( mapping.handle ) {
+		CloseHandle( (HANDLE)mapping.handle );
+	}
+	memset( &mapping, 0, sizeof( mapping ) );
+}
+
 /*
 ==============
 Sys_Cwd
@@ -1075,6 +1189,15 @@ void Sys_Init( void ) {
 		if ( win32.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( win32.cpuid & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( win32.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( win32.cpuid & CPUID_FMA3 ) {
+			string += "FMA3 & ";
+		}
 		if ( win32.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -1104,6 +1227,12 @@ void Sys_Init( void ) {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "avx" ) == 0 ) {
+				id |= CPUID_AVX;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma3" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}